@@ -0,0 +1,541 @@
+/*
+ * caercolumnar.c
+ *
+ *  Columnar file format for polarity events, see caercolumnar.h for the
+ *  layout.
+ */
+
+#include "caercolumnar.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <endian.h>
+
+// Polarity event layout, see libcaer/events/polarity.h.
+#define POLARITY_VALID_MASK 0x01
+#define POLARITY_POLARITY_SHIFT 1
+#define POLARITY_Y_SHIFT 2
+#define POLARITY_X_SHIFT 17
+#define POLARITY_ADDRESS_MASK 0x7FFF
+#define POLARITY_TS_OVERFLOW_SHIFT 31
+
+#define VARINT64_MAX_BYTES 10
+#define VARINT16_MAX_BYTES 3 // A zig-zag encoded 16 bit difference fits 17 bits.
+
+#define BLOCK_HEADER_SIZE sizeof(struct caer_columnar_block_header)
+
+struct caer_columnar_writer {
+	int64_t blockInterval;
+	uint32_t blockMaxEvents;
+	int16_t source;
+	// Current block, one array per column.
+	size_t count;
+	size_t capacity;
+	int64_t *timestamps;
+	uint16_t *xAddresses;
+	uint16_t *yAddresses;
+	uint8_t *polarities;
+	// Encoded block, header included.
+	uint8_t *encoded;
+	size_t encodedSize;
+	// Total size of all blocks written out so far.
+	uint64_t bytesWritten;
+};
+
+static bool ensureCapacity(caerColumnarWriter writer, size_t capacity);
+static bool writeUntilDone(int fileDescriptor, const uint8_t *buffer, size_t length);
+static size_t writeVarint(uint8_t *out, uint64_t value);
+static size_t encodeTimestamps(uint8_t *out, const int64_t *timestamps, size_t count, int64_t base);
+static size_t encodeAddresses(uint8_t *out, const uint16_t *addresses, size_t count, uint16_t base);
+static size_t encodePolarities(uint8_t *out, const uint8_t *polarities, size_t count);
+static bool readVarint(const uint8_t *in, size_t inLength, size_t *position, uint64_t *value);
+static bool decodeTimestamps(const uint8_t *in, size_t inLength, int64_t *timestamps, size_t count, int64_t base);
+static bool decodeAddresses(const uint8_t *in, size_t inLength, uint16_t *addresses, size_t count, uint16_t base);
+static bool decodePolarities(const uint8_t *in, size_t inLength, uint8_t *polarities, size_t count);
+
+static inline uint64_t zigZagEncode(int64_t value) {
+	return ((uint64_t) (value << 1) ^ (uint64_t) (value >> 63));
+}
+
+static inline int64_t zigZagDecode(uint64_t value) {
+	return ((int64_t) (value >> 1) ^ -((int64_t) (value & 0x01)));
+}
+
+caerColumnarWriter caerColumnarWriterInit(int64_t blockInterval, uint32_t blockMaxEvents) {
+	caerColumnarWriter writer = calloc(1, sizeof(struct caer_columnar_writer));
+	if (writer == NULL) {
+		return (NULL);
+	}
+
+	caerColumnarWriterSetBlock(writer, blockInterval, blockMaxEvents);
+
+	return (writer);
+}
+
+void caerColumnarWriterFree(caerColumnarWriter writer) {
+	if (writer == NULL) {
+		return;
+	}
+
+	free(writer->timestamps);
+	free(writer->xAddresses);
+	free(writer->yAddresses);
+	free(writer->polarities);
+	free(writer->encoded);
+	free(writer);
+}
+
+void caerColumnarWriterSetBlock(caerColumnarWriter writer, int64_t blockInterval, uint32_t blockMaxEvents) {
+	writer->blockInterval = blockInterval;
+	writer->blockMaxEvents = (blockMaxEvents == 0) ? (1) : (blockMaxEvents);
+}
+
+static bool ensureCapacity(caerColumnarWriter writer, size_t capacity) {
+	if (capacity <= writer->capacity) {
+		return (true);
+	}
+
+	int64_t *newTimestamps = realloc(writer->timestamps, capacity * sizeof(int64_t));
+	if (newTimestamps == NULL) {
+		return (false);
+	}
+	writer->timestamps = newTimestamps;
+
+	uint16_t *newXAddresses = realloc(writer->xAddresses, capacity * sizeof(uint16_t));
+	if (newXAddresses == NULL) {
+		return (false);
+	}
+	writer->xAddresses = newXAddresses;
+
+	uint16_t *newYAddresses = realloc(writer->yAddresses, capacity * sizeof(uint16_t));
+	if (newYAddresses == NULL) {
+		return (false);
+	}
+	writer->yAddresses = newYAddresses;
+
+	uint8_t *newPolarities = realloc(writer->polarities, capacity * sizeof(uint8_t));
+	if (newPolarities == NULL) {
+		return (false);
+	}
+	writer->polarities = newPolarities;
+
+	writer->capacity = capacity;
+
+	return (true);
+}
+
+static bool writeUntilDone(int fileDescriptor, const uint8_t *buffer, size_t length) {
+	size_t written = 0;
+
+	while (written < length) {
+		ssize_t result = write(fileDescriptor, buffer + written, length - written);
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return (false);
+		}
+
+		written += (size_t) result;
+	}
+
+	return (true);
+}
+
+size_t caerColumnarWriteFileHeader(int fileDescriptor) {
+	struct caer_columnar_file_header fileHeader;
+	memcpy(fileHeader.magic, CAER_COLUMNAR_FILE_MAGIC, CAER_COLUMNAR_FILE_MAGIC_LENGTH);
+	fileHeader.version = htole32(CAER_COLUMNAR_FILE_VERSION);
+	fileHeader.reserved = 0;
+
+	if (!writeUntilDone(fileDescriptor, (const uint8_t *) &fileHeader, sizeof(struct caer_columnar_file_header))) {
+		return (0);
+	}
+
+	return (sizeof(struct caer_columnar_file_header));
+}
+
+bool caerColumnarWriterAddPolarity(caerColumnarWriter writer, int fileDescriptor, const uint8_t *events,
+	int32_t eventSize, int32_t eventCount, int32_t tsOverflow, int16_t source) {
+	// A block holds events from one source only.
+	if (writer->count > 0 && source != writer->source) {
+		if (!caerColumnarWriterFlush(writer, fileDescriptor)) {
+			return (false);
+		}
+	}
+
+	writer->source = source;
+
+	int64_t overflow = (int64_t) tsOverflow << POLARITY_TS_OVERFLOW_SHIFT;
+
+	for (size_t i = 0; i < (size_t) eventCount; i++) {
+		const uint8_t *event = events + (i * (size_t) eventSize);
+
+		uint32_t data;
+		int32_t timestamp;
+		memcpy(&data, event, sizeof(uint32_t));
+		memcpy(&timestamp, event + sizeof(uint32_t), sizeof(int32_t));
+		data = le32toh(data);
+
+		if ((data & POLARITY_VALID_MASK) == 0) {
+			continue;
+		}
+
+		int64_t timestamp64 = overflow | (int64_t) le32toh((uint32_t) timestamp);
+
+		// Close the block once it's full or spans enough time. It also has to
+		// be closed at timestamp overflows, all events of a block share one.
+		if (writer->count > 0
+			&& (writer->count >= writer->blockMaxEvents
+				|| (timestamp64 - writer->timestamps[0]) >= writer->blockInterval
+				|| (timestamp64 >> POLARITY_TS_OVERFLOW_SHIFT)
+					!= (writer->timestamps[0] >> POLARITY_TS_OVERFLOW_SHIFT))) {
+			if (!caerColumnarWriterFlush(writer, fileDescriptor)) {
+				return (false);
+			}
+		}
+
+		if (writer->count == writer->capacity) {
+			size_t newCapacity = (writer->capacity == 0) ? (4096) : (writer->capacity * 2);
+			if (newCapacity > writer->blockMaxEvents) {
+				newCapacity = writer->blockMaxEvents;
+			}
+
+			if (!ensureCapacity(writer, newCapacity)) {
+				return (false);
+			}
+		}
+
+		writer->timestamps[writer->count] = timestamp64;
+		writer->xAddresses[writer->count] = (uint16_t) ((data >> POLARITY_X_SHIFT) & POLARITY_ADDRESS_MASK);
+		writer->yAddresses[writer->count] = (uint16_t) ((data >> POLARITY_Y_SHIFT) & POLARITY_ADDRESS_MASK);
+		writer->polarities[writer->count] = (uint8_t) ((data >> POLARITY_POLARITY_SHIFT) & 0x01);
+		writer->count++;
+	}
+
+	return (true);
+}
+
+bool caerColumnarWriterFlush(caerColumnarWriter writer, int fileDescriptor) {
+	size_t count = writer->count;
+
+	if (count == 0) {
+		return (true);
+	}
+
+	// Block statistics, so readers can skip blocks they don't need.
+	int64_t timestampMin = writer->timestamps[0];
+	int64_t timestampMax = writer->timestamps[0];
+	uint16_t xMin = UINT16_MAX, xMax = 0, yMin = UINT16_MAX, yMax = 0;
+	uint32_t onCount = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		if (writer->timestamps[i] < timestampMin) {
+			timestampMin = writer->timestamps[i];
+		}
+		if (writer->timestamps[i] > timestampMax) {
+			timestampMax = writer->timestamps[i];
+		}
+
+		if (writer->xAddresses[i] < xMin) {
+			xMin = writer->xAddresses[i];
+		}
+		if (writer->xAddresses[i] > xMax) {
+			xMax = writer->xAddresses[i];
+		}
+
+		if (writer->yAddresses[i] < yMin) {
+			yMin = writer->yAddresses[i];
+		}
+		if (writer->yAddresses[i] > yMax) {
+			yMax = writer->yAddresses[i];
+		}
+
+		onCount += writer->polarities[i];
+	}
+
+	size_t maxSize = BLOCK_HEADER_SIZE + (count * (VARINT64_MAX_BYTES + (2 * VARINT16_MAX_BYTES))) + ((count + 7) / 8);
+
+	if (maxSize > writer->encodedSize) {
+		uint8_t *newEncoded = realloc(writer->encoded, maxSize);
+		if (newEncoded == NULL) {
+			return (false);
+		}
+
+		writer->encoded = newEncoded;
+		writer->encodedSize = maxSize;
+	}
+
+	uint8_t *columns = writer->encoded + BLOCK_HEADER_SIZE;
+	size_t columnLength[CAER_COLUMNAR_COLUMNS];
+
+	columnLength[CAER_COLUMNAR_TIMESTAMP] = encodeTimestamps(columns, writer->timestamps, count, timestampMin);
+	columns += columnLength[CAER_COLUMNAR_TIMESTAMP];
+
+	columnLength[CAER_COLUMNAR_X] = encodeAddresses(columns, writer->xAddresses, count, xMin);
+	columns += columnLength[CAER_COLUMNAR_X];
+
+	columnLength[CAER_COLUMNAR_Y] = encodeAddresses(columns, writer->yAddresses, count, yMin);
+	columns += columnLength[CAER_COLUMNAR_Y];
+
+	columnLength[CAER_COLUMNAR_POLARITY] = encodePolarities(columns, writer->polarities, count);
+	columns += columnLength[CAER_COLUMNAR_POLARITY];
+
+	struct caer_columnar_block_header header;
+	header.magic = htole32(CAER_COLUMNAR_BLOCK_MAGIC);
+	header.eventCount = htole32((uint32_t) count);
+	header.timestampMin = (int64_t) htole64((uint64_t) timestampMin);
+	header.timestampMax = (int64_t) htole64((uint64_t) timestampMax);
+	header.xMin = htole16(xMin);
+	header.xMax = htole16(xMax);
+	header.yMin = htole16(yMin);
+	header.yMax = htole16(yMax);
+	header.onCount = htole32(onCount);
+	header.source = (int16_t) htole16((uint16_t) writer->source);
+	header.reserved = 0;
+	for (size_t c = 0; c < CAER_COLUMNAR_COLUMNS; c++) {
+		header.columnLength[c] = htole32((uint32_t) columnLength[c]);
+	}
+
+	memcpy(writer->encoded, &header, BLOCK_HEADER_SIZE);
+
+	writer->count = 0;
+
+	size_t encodedLength = (size_t) (columns - writer->encoded);
+
+	if (!writeUntilDone(fileDescriptor, writer->encoded, encodedLength)) {
+		return (false);
+	}
+
+	writer->bytesWritten += encodedLength;
+
+	return (true);
+}
+
+uint64_t caerColumnarWriterBytesWritten(caerColumnarWriter writer) {
+	return (writer->bytesWritten);
+}
+
+static size_t writeVarint(uint8_t *out, uint64_t value) {
+	size_t length = 0;
+
+	while (value >= 0x80) {
+		out[length++] = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+
+	out[length++] = (uint8_t) value;
+
+	return (length);
+}
+
+static size_t encodeTimestamps(uint8_t *out, const int64_t *timestamps, size_t count, int64_t base) {
+	size_t length = 0;
+	int64_t previous = base;
+
+	for (size_t i = 0; i < count; i++) {
+		length += writeVarint(out + length, zigZagEncode(timestamps[i] - previous));
+		previous = timestamps[i];
+	}
+
+	return (length);
+}
+
+static size_t encodeAddresses(uint8_t *out, const uint16_t *addresses, size_t count, uint16_t base) {
+	size_t length = 0;
+	int32_t previous = base;
+
+	for (size_t i = 0; i < count; i++) {
+		length += writeVarint(out + length, zigZagEncode(addresses[i] - previous));
+		previous = addresses[i];
+	}
+
+	return (length);
+}
+
+static size_t encodePolarities(uint8_t *out, const uint8_t *polarities, size_t count) {
+	size_t length = (count + 7) / 8;
+
+	memset(out, 0, length);
+
+	for (size_t i = 0; i < count; i++) {
+		out[i / 8] |= (uint8_t) (polarities[i] << (i % 8));
+	}
+
+	return (length);
+}
+
+bool caerColumnarReadFileHeader(int fileDescriptor, off_t *firstBlock) {
+	struct caer_columnar_file_header fileHeader;
+
+	if (pread(fileDescriptor, &fileHeader, sizeof(struct caer_columnar_file_header), 0)
+		!= (ssize_t) sizeof(struct caer_columnar_file_header)) {
+		return (false);
+	}
+
+	if (memcmp(fileHeader.magic, CAER_COLUMNAR_FILE_MAGIC, CAER_COLUMNAR_FILE_MAGIC_LENGTH) != 0
+		|| le32toh(fileHeader.version) != CAER_COLUMNAR_FILE_VERSION) {
+		return (false);
+	}
+
+	*firstBlock = (off_t) sizeof(struct caer_columnar_file_header);
+
+	return (true);
+}
+
+bool caerColumnarReadBlockHeader(int fileDescriptor, off_t blockOffset, caerColumnarBlockHeader header) {
+	if (pread(fileDescriptor, header, BLOCK_HEADER_SIZE, blockOffset) != (ssize_t) BLOCK_HEADER_SIZE) {
+		return (false);
+	}
+
+	if (le32toh(header->magic) != CAER_COLUMNAR_BLOCK_MAGIC) {
+		return (false);
+	}
+
+	header->magic = le32toh(header->magic);
+	header->eventCount = le32toh(header->eventCount);
+	header->timestampMin = (int64_t) le64toh((uint64_t) header->timestampMin);
+	header->timestampMax = (int64_t) le64toh((uint64_t) header->timestampMax);
+	header->xMin = le16toh(header->xMin);
+	header->xMax = le16toh(header->xMax);
+	header->yMin = le16toh(header->yMin);
+	header->yMax = le16toh(header->yMax);
+	header->onCount = le32toh(header->onCount);
+	header->source = (int16_t) le16toh((uint16_t) header->source);
+	for (size_t c = 0; c < CAER_COLUMNAR_COLUMNS; c++) {
+		header->columnLength[c] = le32toh(header->columnLength[c]);
+	}
+
+	return (true);
+}
+
+off_t caerColumnarBlockNext(caerColumnarBlockHeader header, off_t blockOffset) {
+	off_t next = blockOffset + (off_t) BLOCK_HEADER_SIZE;
+
+	for (size_t c = 0; c < CAER_COLUMNAR_COLUMNS; c++) {
+		next += (off_t) header->columnLength[c];
+	}
+
+	return (next);
+}
+
+bool caerColumnarReadColumn(int fileDescriptor, off_t blockOffset, caerColumnarBlockHeader header,
+	enum caer_columnar_columns column, void *values) {
+	off_t columnOffset = blockOffset + (off_t) BLOCK_HEADER_SIZE;
+
+	for (size_t c = 0; c < (size_t) column; c++) {
+		columnOffset += (off_t) header->columnLength[c];
+	}
+
+	size_t columnLength = header->columnLength[column];
+	size_t count = header->eventCount;
+
+	uint8_t *columnData = malloc((columnLength == 0) ? (1) : (columnLength));
+	if (columnData == NULL) {
+		return (false);
+	}
+
+	if (pread(fileDescriptor, columnData, columnLength, columnOffset) != (ssize_t) columnLength) {
+		free(columnData);
+		return (false);
+	}
+
+	bool result;
+
+	switch (column) {
+		case CAER_COLUMNAR_TIMESTAMP:
+			result = decodeTimestamps(columnData, columnLength, values, count, header->timestampMin);
+			break;
+
+		case CAER_COLUMNAR_X:
+			result = decodeAddresses(columnData, columnLength, values, count, header->xMin);
+			break;
+
+		case CAER_COLUMNAR_Y:
+			result = decodeAddresses(columnData, columnLength, values, count, header->yMin);
+			break;
+
+		case CAER_COLUMNAR_POLARITY:
+			result = decodePolarities(columnData, columnLength, values, count);
+			break;
+
+		default:
+			result = false;
+			break;
+	}
+
+	free(columnData);
+
+	return (result);
+}
+
+static bool readVarint(const uint8_t *in, size_t inLength, size_t *position, uint64_t *value) {
+	uint64_t result = 0;
+
+	for (size_t shift = 0; shift < (7 * VARINT64_MAX_BYTES); shift += 7) {
+		if (*position >= inLength) {
+			return (false);
+		}
+
+		uint8_t byte = in[(*position)++];
+		result |= (uint64_t) (byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0) {
+			*value = result;
+			return (true);
+		}
+	}
+
+	return (false);
+}
+
+static bool decodeTimestamps(const uint8_t *in, size_t inLength, int64_t *timestamps, size_t count, int64_t base) {
+	size_t position = 0;
+	int64_t previous = base;
+
+	for (size_t i = 0; i < count; i++) {
+		uint64_t value;
+		if (!readVarint(in, inLength, &position, &value)) {
+			return (false);
+		}
+
+		previous += zigZagDecode(value);
+		timestamps[i] = previous;
+	}
+
+	return (position == inLength);
+}
+
+static bool decodeAddresses(const uint8_t *in, size_t inLength, uint16_t *addresses, size_t count, uint16_t base) {
+	size_t position = 0;
+	int64_t previous = base;
+
+	for (size_t i = 0; i < count; i++) {
+		uint64_t value;
+		if (!readVarint(in, inLength, &position, &value)) {
+			return (false);
+		}
+
+		previous += zigZagDecode(value);
+		if (previous < 0 || previous > UINT16_MAX) {
+			return (false);
+		}
+
+		addresses[i] = (uint16_t) previous;
+	}
+
+	return (position == inLength);
+}
+
+static bool decodePolarities(const uint8_t *in, size_t inLength, uint8_t *polarities, size_t count) {
+	if (inLength != ((count + 7) / 8)) {
+		return (false);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		polarities[i] = (in[i / 8] >> (i % 8)) & 0x01;
+	}
+
+	return (true);
+}
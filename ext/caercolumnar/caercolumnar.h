@@ -0,0 +1,112 @@
+/*
+ * caercolumnar.h
+ *
+ *  Columnar (structure-of-arrays) file format for polarity events, meant
+ *  for offline analysis: instead of whole events, each column (timestamp,
+ *  X, Y, polarity) is stored separately, so it can be read without the
+ *  others and without any transposition.
+ *
+ *  A file starts with a caer_columnar_file_header, followed by blocks. Each
+ *  block covers a span of time, and is a caer_columnar_block_header (with
+ *  statistics, so blocks outside a time range can be skipped unread)
+ *  followed by its columns, in order:
+ *    timestamp: zig-zag LEB128 varint per event, difference to the previous
+ *      event's timestamp (the first one to the block's minimum timestamp)
+ *    X address: zig-zag LEB128 varint per event, difference to the previous
+ *      event's X address (the first one to the block's minimum X address)
+ *    Y address: same as X
+ *    polarity: one bit per event, packed LSB-first
+ *  Only valid events are stored. All values are little-endian.
+ */
+
+#ifndef CAERCOLUMNAR_H_
+#define CAERCOLUMNAR_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#define CAER_COLUMNAR_FORMAT_NAME "CAERCOL"
+#define CAER_COLUMNAR_FILE_EXTENSION "caercol"
+
+#define CAER_COLUMNAR_FILE_MAGIC "CAERCOL1"
+#define CAER_COLUMNAR_FILE_MAGIC_LENGTH 8
+#define CAER_COLUMNAR_FILE_VERSION 1
+
+#define CAER_COLUMNAR_BLOCK_MAGIC 0x4B424343 // "CCBK" in little-endian.
+
+enum caer_columnar_columns {
+	CAER_COLUMNAR_TIMESTAMP = 0,
+	CAER_COLUMNAR_X = 1,
+	CAER_COLUMNAR_Y = 2,
+	CAER_COLUMNAR_POLARITY = 3,
+	CAER_COLUMNAR_COLUMNS = 4,
+};
+
+struct caer_columnar_file_header {
+	char magic[CAER_COLUMNAR_FILE_MAGIC_LENGTH];
+	uint32_t version;
+	uint32_t reserved;
+}__attribute__((__packed__));
+
+struct caer_columnar_block_header {
+	uint32_t magic;
+	uint32_t eventCount;
+	int64_t timestampMin;
+	int64_t timestampMax;
+	uint16_t xMin;
+	uint16_t xMax;
+	uint16_t yMin;
+	uint16_t yMax;
+	uint32_t onCount; // Events with polarity ON.
+	int16_t source;
+	uint16_t reserved;
+	uint32_t columnLength[CAER_COLUMNAR_COLUMNS]; // In bytes.
+}__attribute__((__packed__));
+
+typedef struct caer_columnar_block_header *caerColumnarBlockHeader;
+
+typedef struct caer_columnar_writer *caerColumnarWriter;
+
+// Writer side. Events are collected into a block, which is written out
+// once it spans blockInterval µs or holds blockMaxEvents events, or when
+// flushed. Blocks never span a timestamp overflow or more than one source.
+caerColumnarWriter caerColumnarWriterInit(int64_t blockInterval, uint32_t blockMaxEvents);
+void caerColumnarWriterFree(caerColumnarWriter writer);
+void caerColumnarWriterSetBlock(caerColumnarWriter writer, int64_t blockInterval, uint32_t blockMaxEvents);
+
+// Write the file header, returns the number of bytes written, or 0 on error.
+size_t caerColumnarWriteFileHeader(int fileDescriptor);
+
+// Add eventCount polarity events (in the AEDAT 3.x in-memory layout, eventSize
+// bytes each) with the given timestamp overflow and source, writing out full
+// blocks to fileDescriptor. Invalid events are skipped.
+bool caerColumnarWriterAddPolarity(caerColumnarWriter writer, int fileDescriptor, const uint8_t *events,
+	int32_t eventSize, int32_t eventCount, int32_t tsOverflow, int16_t source);
+
+// Write out the current block, if it holds any events.
+bool caerColumnarWriterFlush(caerColumnarWriter writer, int fileDescriptor);
+
+// Total number of bytes of all blocks written out so far, to any file.
+uint64_t caerColumnarWriterBytesWritten(caerColumnarWriter writer);
+
+// Reader side. Check the file header at the start of the file, and return
+// the offset of the first block in firstBlock.
+bool caerColumnarReadFileHeader(int fileDescriptor, off_t *firstBlock);
+
+// Read the block header at blockOffset, converting it to host byte order.
+// Returns false at the end of the file, or if there is no valid block.
+bool caerColumnarReadBlockHeader(int fileDescriptor, off_t blockOffset, caerColumnarBlockHeader header);
+
+// Offset of the block following the one at blockOffset.
+off_t caerColumnarBlockNext(caerColumnarBlockHeader header, off_t blockOffset);
+
+// Decode one column of the block at blockOffset, without touching the
+// others. The output array must hold eventCount elements, of type int64_t
+// for timestamps, uint16_t for X and Y addresses, uint8_t (0 or 1) for
+// polarities.
+bool caerColumnarReadColumn(int fileDescriptor, off_t blockOffset, caerColumnarBlockHeader header,
+	enum caer_columnar_columns column, void *values);
+
+#endif /* CAERCOLUMNAR_H_ */
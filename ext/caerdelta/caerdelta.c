@@ -0,0 +1,639 @@
+/*
+ * caerdelta.c
+ *
+ *  Lossless compression codec for AEDAT 3.x event packets.
+ *
+ *  Polarity payload layout (all values little-endian):
+ *    byte 0: codec (CAERDELTA_CODEC_POLARITY)
+ *    byte 1: number of bits used for the X address
+ *    byte 2: number of bits used for the Y address
+ *    byte 3: reserved (zero)
+ *    byte 4-7: length of the timestamp stream in bytes
+ *    timestamp stream: one zig-zag LEB128 varint per event, difference to
+ *      the previous event's timestamp (the first one to zero)
+ *    address stream: one (X bits + Y bits + 2) wide record per event, packed
+ *      LSB-first, holding X, Y, polarity and valid mark
+ */
+
+#include "caerdelta.h"
+#include <string.h>
+#include <endian.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define CAERDELTA_SIMD_SSE2 1
+#elif defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	#include <arm_neon.h>
+	#define CAERDELTA_SIMD_NEON 1
+#endif
+
+// Polarity event layout, see libcaer/events/polarity.h.
+#define POLARITY_EVENT_TYPE 1
+#define POLARITY_EVENT_SIZE 8
+#define POLARITY_X_SHIFT 17
+#define POLARITY_MAX_ADDRESS_BITS 15
+#define POLARITY_LOW_BITS 17 // Valid mark, polarity and Y address.
+
+#define POLARITY_PAYLOAD_HEADER_SIZE 8
+#define VARINT_MAX_BYTES 5
+
+struct caer_delta_buffer {
+	uint8_t *payload;
+	size_t payloadSize;
+	uint32_t *timestamps;
+	uint32_t *addresses;
+	size_t scratchSize;
+};
+
+static bool ensureCapacity(caerDeltaBuffer buffer, size_t payloadSize, size_t scratchSize);
+static uint32_t bitsNeeded(uint32_t value);
+static uint32_t gatherPolarityEvents(caerDeltaBuffer buffer, const uint8_t *events, size_t eventCount,
+	bool validOnly, size_t *gatheredCount);
+static size_t writeVarint(uint8_t *out, uint32_t value);
+static size_t encodeTimestamps(uint8_t *out, const uint32_t *timestamps, size_t count);
+static void packAddresses(uint32_t *addresses, size_t count, uint32_t yBits);
+static size_t bitPackAddresses(uint8_t *out, const uint32_t *addresses, size_t count, uint32_t width);
+static bool decodeTimestamps(const uint8_t *in, size_t inLength, uint8_t *events, size_t count);
+static bool decodeAddresses(const uint8_t *in, size_t inLength, uint8_t *events, size_t count, uint32_t xBits,
+	uint32_t yBits);
+static uint8_t *encodeRaw(caerDeltaBuffer buffer, const uint8_t *events, size_t eventSize, size_t eventCount,
+	bool validOnly, int32_t *encodedEvents, size_t *payloadLength);
+
+caerDeltaBuffer caerDeltaBufferInit(void) {
+	return (calloc(1, sizeof(struct caer_delta_buffer)));
+}
+
+void caerDeltaBufferFree(caerDeltaBuffer buffer) {
+	if (buffer == NULL) {
+		return;
+	}
+
+	free(buffer->payload);
+	free(buffer->timestamps);
+	free(buffer->addresses);
+	free(buffer);
+}
+
+static bool ensureCapacity(caerDeltaBuffer buffer, size_t payloadSize, size_t scratchSize) {
+	if (payloadSize > buffer->payloadSize) {
+		uint8_t *newPayload = realloc(buffer->payload, payloadSize);
+		if (newPayload == NULL) {
+			return (false);
+		}
+
+		buffer->payload = newPayload;
+		buffer->payloadSize = payloadSize;
+	}
+
+	if (scratchSize > buffer->scratchSize) {
+		uint32_t *newTimestamps = realloc(buffer->timestamps, scratchSize * sizeof(uint32_t));
+		if (newTimestamps == NULL) {
+			return (false);
+		}
+		buffer->timestamps = newTimestamps;
+
+		uint32_t *newAddresses = realloc(buffer->addresses, scratchSize * sizeof(uint32_t));
+		if (newAddresses == NULL) {
+			return (false);
+		}
+		buffer->addresses = newAddresses;
+
+		buffer->scratchSize = scratchSize;
+	}
+
+	return (true);
+}
+
+static uint32_t bitsNeeded(uint32_t value) {
+	return ((value == 0) ? (0) : (32 - (uint32_t) __builtin_clz(value)));
+}
+
+uint8_t *caerDeltaEncode(caerDeltaBuffer buffer, int16_t eventType, const uint8_t *events, int32_t eventSize,
+	int32_t eventCount, bool validOnly, int32_t *encodedEvents, size_t *payloadLength) {
+	size_t count = (size_t) eventCount;
+
+	if (eventType != POLARITY_EVENT_TYPE || eventSize != POLARITY_EVENT_SIZE) {
+		return (encodeRaw(buffer, events, (size_t) eventSize, count, validOnly, encodedEvents, payloadLength));
+	}
+
+	size_t rawLength = 1 + (count * POLARITY_EVENT_SIZE);
+	size_t maxLength = POLARITY_PAYLOAD_HEADER_SIZE + (count * (VARINT_MAX_BYTES + sizeof(uint32_t)));
+
+	if (!ensureCapacity(buffer, (maxLength > rawLength) ? (maxLength) : (rawLength), count)) {
+		return (NULL);
+	}
+
+	// Split events into separate address and timestamp arrays, so that they
+	// can be processed in bulk. This also drops invalid events if needed.
+	size_t gatheredCount = 0;
+	uint32_t addressesOr = gatherPolarityEvents(buffer, events, count, validOnly, &gatheredCount);
+
+	// The widest address determines how many bits are needed per address.
+	uint32_t xBits = bitsNeeded(addressesOr >> POLARITY_X_SHIFT);
+	uint32_t yBits = bitsNeeded((addressesOr & ((UINT32_C(1) << POLARITY_LOW_BITS) - 1)) >> 2);
+
+	uint8_t *payload = buffer->payload;
+
+	payload[0] = CAERDELTA_CODEC_POLARITY;
+	payload[1] = (uint8_t) xBits;
+	payload[2] = (uint8_t) yBits;
+	payload[3] = 0;
+
+	size_t tsLength = encodeTimestamps(payload + POLARITY_PAYLOAD_HEADER_SIZE, buffer->timestamps, gatheredCount);
+
+	uint32_t tsLengthLE = htole32((uint32_t) tsLength);
+	memcpy(payload + 4, &tsLengthLE, sizeof(uint32_t));
+
+	packAddresses(buffer->addresses, gatheredCount, yBits);
+
+	size_t addressesLength = bitPackAddresses(payload + POLARITY_PAYLOAD_HEADER_SIZE + tsLength, buffer->addresses,
+		gatheredCount, xBits + yBits + 2);
+
+	size_t encodedLength = POLARITY_PAYLOAD_HEADER_SIZE + tsLength + addressesLength;
+
+	// Data that doesn't compress is stored as-is, so output never grows.
+	if (encodedLength >= (1 + (gatheredCount * POLARITY_EVENT_SIZE))) {
+		return (encodeRaw(buffer, events, POLARITY_EVENT_SIZE, count, validOnly, encodedEvents, payloadLength));
+	}
+
+	*encodedEvents = (int32_t) gatheredCount;
+	*payloadLength = encodedLength;
+
+	return (payload);
+}
+
+bool caerDeltaDecode(const uint8_t *payload, size_t payloadLength, uint8_t *events, int32_t eventSize,
+	int32_t eventCount) {
+	size_t count = (size_t) eventCount;
+
+	if (payloadLength < 1) {
+		return (false);
+	}
+
+	if (payload[0] == CAERDELTA_CODEC_RAW) {
+		if (payloadLength != (1 + ((size_t) eventSize * count))) {
+			return (false);
+		}
+
+		memcpy(events, payload + 1, payloadLength - 1);
+
+		return (true);
+	}
+
+	if (payload[0] != CAERDELTA_CODEC_POLARITY || eventSize != POLARITY_EVENT_SIZE
+		|| payloadLength < POLARITY_PAYLOAD_HEADER_SIZE) {
+		return (false);
+	}
+
+	uint32_t xBits = payload[1];
+	uint32_t yBits = payload[2];
+
+	if (xBits > POLARITY_MAX_ADDRESS_BITS || yBits > POLARITY_MAX_ADDRESS_BITS) {
+		return (false);
+	}
+
+	uint32_t tsLengthLE;
+	memcpy(&tsLengthLE, payload + 4, sizeof(uint32_t));
+	size_t tsLength = le32toh(tsLengthLE);
+
+	if (tsLength > (payloadLength - POLARITY_PAYLOAD_HEADER_SIZE)) {
+		return (false);
+	}
+
+	if (!decodeTimestamps(payload + POLARITY_PAYLOAD_HEADER_SIZE, tsLength, events, count)) {
+		return (false);
+	}
+
+	return (decodeAddresses(payload + POLARITY_PAYLOAD_HEADER_SIZE + tsLength,
+		payloadLength - POLARITY_PAYLOAD_HEADER_SIZE - tsLength, events, count, xBits, yBits));
+}
+
+static uint8_t *encodeRaw(caerDeltaBuffer buffer, const uint8_t *events, size_t eventSize, size_t eventCount,
+	bool validOnly, int32_t *encodedEvents, size_t *payloadLength) {
+	if (!ensureCapacity(buffer, 1 + (eventSize * eventCount), 0)) {
+		return (NULL);
+	}
+
+	buffer->payload[0] = CAERDELTA_CODEC_RAW;
+
+	size_t copiedCount = 0;
+
+	if (!validOnly) {
+		memcpy(buffer->payload + 1, events, eventSize * eventCount);
+		copiedCount = eventCount;
+	}
+	else {
+		// Valid mark is always bit 0 of the first 32 bits of an event.
+		for (size_t i = 0; i < eventCount; i++) {
+			if (events[i * eventSize] & 0x01) {
+				memcpy(buffer->payload + 1 + (copiedCount * eventSize), events + (i * eventSize), eventSize);
+				copiedCount++;
+			}
+		}
+	}
+
+	*encodedEvents = (int32_t) copiedCount;
+	*payloadLength = 1 + (eventSize * copiedCount);
+
+	return (buffer->payload);
+}
+
+static uint32_t gatherPolarityEvents(caerDeltaBuffer buffer, const uint8_t *events, size_t eventCount,
+	bool validOnly, size_t *gatheredCount) {
+	uint32_t *timestamps = buffer->timestamps;
+	uint32_t *addresses = buffer->addresses;
+	uint32_t addressesOr = 0;
+	size_t i = 0;
+
+	if (!validOnly) {
+#if defined(CAERDELTA_SIMD_SSE2)
+		__m128i orVec = _mm_setzero_si128();
+
+		for (; i + 4 <= eventCount; i += 4) {
+			__m128 lo = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) (events + (i * POLARITY_EVENT_SIZE))));
+			__m128 hi = _mm_castsi128_ps(
+				_mm_loadu_si128((const __m128i *) (events + ((i + 2) * POLARITY_EVENT_SIZE))));
+
+			__m128i data = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i ts = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+
+			_mm_storeu_si128((__m128i *) (addresses + i), data);
+			_mm_storeu_si128((__m128i *) (timestamps + i), ts);
+
+			orVec = _mm_or_si128(orVec, data);
+		}
+
+		orVec = _mm_or_si128(orVec, _mm_srli_si128(orVec, 8));
+		orVec = _mm_or_si128(orVec, _mm_srli_si128(orVec, 4));
+		addressesOr = (uint32_t) _mm_cvtsi128_si32(orVec);
+#elif defined(CAERDELTA_SIMD_NEON)
+		uint32x4_t orVec = vdupq_n_u32(0);
+
+		for (; i + 4 <= eventCount; i += 4) {
+			uint32x4x2_t split = vld2q_u32((const uint32_t *) (const void *) (events + (i * POLARITY_EVENT_SIZE)));
+
+			vst1q_u32(addresses + i, split.val[0]);
+			vst1q_u32(timestamps + i, split.val[1]);
+
+			orVec = vorrq_u32(orVec, split.val[0]);
+		}
+
+		uint32x2_t orHalf = vorr_u32(vget_low_u32(orVec), vget_high_u32(orVec));
+		addressesOr = vget_lane_u32(orHalf, 0) | vget_lane_u32(orHalf, 1);
+#endif
+
+		for (; i < eventCount; i++) {
+			uint32_t data, ts;
+			memcpy(&data, events + (i * POLARITY_EVENT_SIZE), sizeof(uint32_t));
+			memcpy(&ts, events + (i * POLARITY_EVENT_SIZE) + 4, sizeof(uint32_t));
+
+			addresses[i] = le32toh(data);
+			timestamps[i] = le32toh(ts);
+
+			addressesOr |= addresses[i];
+		}
+
+		*gatheredCount = eventCount;
+	}
+	else {
+		size_t count = 0;
+
+		for (; i < eventCount; i++) {
+			uint32_t data, ts;
+			memcpy(&data, events + (i * POLARITY_EVENT_SIZE), sizeof(uint32_t));
+			data = le32toh(data);
+
+			if (!(data & 0x01)) {
+				continue;
+			}
+
+			memcpy(&ts, events + (i * POLARITY_EVENT_SIZE) + 4, sizeof(uint32_t));
+
+			addresses[count] = data;
+			timestamps[count] = le32toh(ts);
+			count++;
+
+			addressesOr |= data;
+		}
+
+		*gatheredCount = count;
+	}
+
+	return (addressesOr);
+}
+
+static size_t writeVarint(uint8_t *out, uint32_t value) {
+	size_t length = 0;
+
+	while (value >= 0x80) {
+		out[length++] = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+
+	out[length++] = (uint8_t) value;
+
+	return (length);
+}
+
+static size_t encodeTimestamps(uint8_t *out, const uint32_t *timestamps, size_t count) {
+	size_t length = 0;
+	size_t i = 0;
+
+	// Fast path: compute four deltas at once, and if they all fit in a single
+	// byte (the common case with dense event streams), store them directly.
+#if defined(CAERDELTA_SIMD_SSE2)
+	__m128i prevVec = _mm_setzero_si128();
+	const __m128i highBits = _mm_set1_epi32(~0x7F);
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i curr = _mm_loadu_si128((const __m128i *) (timestamps + i));
+		__m128i prev = _mm_or_si128(_mm_slli_si128(curr, 4), _mm_srli_si128(prevVec, 12));
+
+		__m128i delta = _mm_sub_epi32(curr, prev);
+		__m128i zigzag = _mm_xor_si128(_mm_slli_epi32(delta, 1), _mm_srai_epi32(delta, 31));
+
+		prevVec = curr;
+
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(zigzag, highBits), _mm_setzero_si128())) == 0xFFFF) {
+			__m128i packed = _mm_packs_epi32(zigzag, zigzag);
+			packed = _mm_packus_epi16(packed, packed);
+
+			uint32_t fourBytes = (uint32_t) _mm_cvtsi128_si32(packed);
+			memcpy(out + length, &fourBytes, sizeof(uint32_t));
+			length += 4;
+		}
+		else {
+			uint32_t zigzags[4];
+			_mm_storeu_si128((__m128i *) zigzags, zigzag);
+
+			for (size_t j = 0; j < 4; j++) {
+				length += writeVarint(out + length, zigzags[j]);
+			}
+		}
+	}
+#elif defined(CAERDELTA_SIMD_NEON)
+	uint32x4_t prevVec = vdupq_n_u32(0);
+
+	for (; i + 4 <= count; i += 4) {
+		uint32x4_t curr = vld1q_u32(timestamps + i);
+		uint32x4_t prev = vextq_u32(prevVec, curr, 3);
+
+		uint32x4_t delta = vsubq_u32(curr, prev);
+		uint32x4_t zigzag = veorq_u32(vshlq_n_u32(delta, 1),
+			vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(delta), 31)));
+
+		prevVec = curr;
+
+		uint32x2_t maxHalf = vpmax_u32(vget_low_u32(zigzag), vget_high_u32(zigzag));
+		maxHalf = vpmax_u32(maxHalf, maxHalf);
+
+		if (vget_lane_u32(maxHalf, 0) < 0x80) {
+			uint16x4_t narrow16 = vmovn_u32(zigzag);
+			uint8x8_t narrow8 = vmovn_u16(vcombine_u16(narrow16, narrow16));
+
+			uint32_t fourBytes = vget_lane_u32(vreinterpret_u32_u8(narrow8), 0);
+			memcpy(out + length, &fourBytes, sizeof(uint32_t));
+			length += 4;
+		}
+		else {
+			uint32_t zigzags[4];
+			vst1q_u32(zigzags, zigzag);
+
+			for (size_t j = 0; j < 4; j++) {
+				length += writeVarint(out + length, zigzags[j]);
+			}
+		}
+	}
+#endif
+
+	uint32_t prev = (i > 0) ? (timestamps[i - 1]) : (0);
+
+	for (; i < count; i++) {
+		uint32_t delta = timestamps[i] - prev;
+		uint32_t zigzag = (delta << 1) ^ (uint32_t) ((int32_t) delta >> 31);
+
+		length += writeVarint(out + length, zigzag);
+
+		prev = timestamps[i];
+	}
+
+	return (length);
+}
+
+static void packAddresses(uint32_t *addresses, size_t count, uint32_t yBits) {
+	// Y, polarity and valid mark are already in place in the low 17 bits, Y
+	// just doesn't use all of them, so X is moved down right after Y.
+	uint32_t xShift = yBits + 2;
+	const uint32_t lowMask = (UINT32_C(1) << POLARITY_LOW_BITS) - 1;
+	size_t i = 0;
+
+#if defined(CAERDELTA_SIMD_SSE2)
+	const __m128i lowMaskVec = _mm_set1_epi32((int32_t) lowMask);
+	const __m128i xShiftVec = _mm_cvtsi32_si128((int32_t) xShift);
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i data = _mm_loadu_si128((const __m128i *) (addresses + i));
+
+		__m128i x = _mm_sll_epi32(_mm_srli_epi32(data, POLARITY_X_SHIFT), xShiftVec);
+		__m128i packed = _mm_or_si128(x, _mm_and_si128(data, lowMaskVec));
+
+		_mm_storeu_si128((__m128i *) (addresses + i), packed);
+	}
+#elif defined(CAERDELTA_SIMD_NEON)
+	const uint32x4_t lowMaskVec = vdupq_n_u32(lowMask);
+	const int32x4_t xShiftVec = vdupq_n_s32((int32_t) xShift);
+
+	for (; i + 4 <= count; i += 4) {
+		uint32x4_t data = vld1q_u32(addresses + i);
+
+		uint32x4_t x = vshlq_u32(vshrq_n_u32(data, POLARITY_X_SHIFT), xShiftVec);
+		uint32x4_t packed = vorrq_u32(x, vandq_u32(data, lowMaskVec));
+
+		vst1q_u32(addresses + i, packed);
+	}
+#endif
+
+	for (; i < count; i++) {
+		addresses[i] = ((addresses[i] >> POLARITY_X_SHIFT) << xShift) | (addresses[i] & lowMask);
+	}
+}
+
+static size_t bitPackAddresses(uint8_t *out, const uint32_t *addresses, size_t count, uint32_t width) {
+	uint64_t accumulator = 0;
+	uint32_t accumulatorBits = 0;
+	size_t length = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		accumulator |= ((uint64_t) addresses[i]) << accumulatorBits;
+		accumulatorBits += width;
+
+		while (accumulatorBits >= 8) {
+			out[length++] = (uint8_t) accumulator;
+			accumulator >>= 8;
+			accumulatorBits -= 8;
+		}
+	}
+
+	if (accumulatorBits > 0) {
+		out[length++] = (uint8_t) accumulator;
+	}
+
+	return (length);
+}
+
+static bool decodeTimestamps(const uint8_t *in, size_t inLength, uint8_t *events, size_t count) {
+	uint32_t prev = 0;
+	size_t pos = 0;
+	size_t i = 0;
+
+	while (i < count) {
+#if defined(CAERDELTA_SIMD_SSE2) || defined(CAERDELTA_SIMD_NEON)
+		// Fast path: four single-byte varints in a row.
+		if (i + 4 <= count && pos + 4 <= inLength) {
+			uint32_t fourBytes;
+			memcpy(&fourBytes, in + pos, sizeof(uint32_t));
+
+			if ((fourBytes & 0x80808080) == 0) {
+				uint32_t timestamps[4];
+
+	#if defined(CAERDELTA_SIMD_SSE2)
+				const __m128i zero = _mm_setzero_si128();
+
+				__m128i zigzag = _mm_cvtsi32_si128((int32_t) fourBytes);
+				zigzag = _mm_unpacklo_epi16(_mm_unpacklo_epi8(zigzag, zero), zero);
+
+				__m128i delta = _mm_xor_si128(_mm_srli_epi32(zigzag, 1),
+					_mm_sub_epi32(zero, _mm_and_si128(zigzag, _mm_set1_epi32(1))));
+
+				// Prefix sum of the deltas gives the timestamps.
+				delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+				delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+
+				_mm_storeu_si128((__m128i *) timestamps, _mm_add_epi32(delta, _mm_set1_epi32((int32_t) prev)));
+	#else
+				const uint32x4_t zero = vdupq_n_u32(0);
+
+				uint32x4_t zigzag = vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(fourBytes))));
+
+				uint32x4_t delta = veorq_u32(vshrq_n_u32(zigzag, 1),
+					vreinterpretq_u32_s32(vnegq_s32(vreinterpretq_s32_u32(vandq_u32(zigzag, vdupq_n_u32(1))))));
+
+				// Prefix sum of the deltas gives the timestamps.
+				delta = vaddq_u32(delta, vextq_u32(zero, delta, 3));
+				delta = vaddq_u32(delta, vextq_u32(zero, delta, 2));
+
+				vst1q_u32(timestamps, vaddq_u32(delta, vdupq_n_u32(prev)));
+	#endif
+
+				for (size_t j = 0; j < 4; j++) {
+					uint32_t ts = htole32(timestamps[j]);
+					memcpy(events + ((i + j) * POLARITY_EVENT_SIZE) + 4, &ts, sizeof(uint32_t));
+				}
+
+				prev = timestamps[3];
+				pos += 4;
+				i += 4;
+
+				continue;
+			}
+		}
+#endif
+
+		uint32_t zigzag = 0;
+		uint32_t shift = 0;
+
+		while (true) {
+			if (pos >= inLength || shift >= (7 * VARINT_MAX_BYTES)) {
+				return (false);
+			}
+
+			uint8_t byte = in[pos++];
+			zigzag |= ((uint32_t) (byte & 0x7F)) << shift;
+			shift += 7;
+
+			if (!(byte & 0x80)) {
+				break;
+			}
+		}
+
+		prev += (zigzag >> 1) ^ (uint32_t) -(int32_t) (zigzag & 0x01);
+
+		uint32_t ts = htole32(prev);
+		memcpy(events + (i * POLARITY_EVENT_SIZE) + 4, &ts, sizeof(uint32_t));
+
+		i++;
+	}
+
+	return (pos == inLength);
+}
+
+static bool decodeAddresses(const uint8_t *in, size_t inLength, uint8_t *events, size_t count, uint32_t xBits,
+	uint32_t yBits) {
+	uint32_t width = xBits + yBits + 2;
+	uint32_t xShift = yBits + 2;
+	uint32_t recordMask = (uint32_t) ((UINT64_C(1) << width) - 1);
+	uint32_t lowMask = (UINT32_C(1) << xShift) - 1;
+
+	if (inLength != (((count * width) + 7) / 8)) {
+		return (false);
+	}
+
+	uint64_t accumulator = 0;
+	uint32_t accumulatorBits = 0;
+	size_t pos = 0;
+	size_t i = 0;
+
+	while (i < count) {
+		// Unpack up to four records, then rebuild the full addresses.
+		uint32_t addresses[4];
+		size_t groupSize = ((count - i) < 4) ? (count - i) : (4);
+
+		for (size_t j = 0; j < groupSize; j++) {
+			while (accumulatorBits < width) {
+				accumulator |= ((uint64_t) in[pos++]) << accumulatorBits;
+				accumulatorBits += 8;
+			}
+
+			addresses[j] = (uint32_t) accumulator & recordMask;
+			accumulator >>= width;
+			accumulatorBits -= width;
+		}
+
+#if defined(CAERDELTA_SIMD_SSE2)
+		if (groupSize == 4) {
+			__m128i packed = _mm_loadu_si128((const __m128i *) addresses);
+
+			__m128i x = _mm_slli_epi32(_mm_srl_epi32(packed, _mm_cvtsi32_si128((int32_t) xShift)),
+				POLARITY_X_SHIFT);
+			__m128i data = _mm_or_si128(x, _mm_and_si128(packed, _mm_set1_epi32((int32_t) lowMask)));
+
+			_mm_storeu_si128((__m128i *) addresses, data);
+		}
+		else
+#elif defined(CAERDELTA_SIMD_NEON)
+		if (groupSize == 4) {
+			uint32x4_t packed = vld1q_u32(addresses);
+
+			uint32x4_t x = vshlq_n_u32(vshlq_u32(packed, vdupq_n_s32(-(int32_t) xShift)), POLARITY_X_SHIFT);
+			uint32x4_t data = vorrq_u32(x, vandq_u32(packed, vdupq_n_u32(lowMask)));
+
+			vst1q_u32(addresses, data);
+		}
+		else
+#endif
+		{
+			for (size_t j = 0; j < groupSize; j++) {
+				addresses[j] = ((addresses[j] >> xShift) << POLARITY_X_SHIFT) | (addresses[j] & lowMask);
+			}
+		}
+
+		for (size_t j = 0; j < groupSize; j++) {
+			uint32_t data = htole32(addresses[j]);
+			memcpy(events + ((i + j) * POLARITY_EVENT_SIZE), &data, sizeof(uint32_t));
+		}
+
+		i += groupSize;
+	}
+
+	return (true);
+}
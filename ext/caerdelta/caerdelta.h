@@ -0,0 +1,53 @@
+/*
+ * caerdelta.h
+ *
+ *  Lossless compression codec for AEDAT 3.x event packets, used by the
+ *  '#Format: CAERDELTA' file format variant and by the network outputs.
+ *
+ *  Polarity events are stored as zig-zag varint timestamp deltas, followed
+ *  by the X/Y address, polarity and valid mark of each event bit-packed at
+ *  the minimum width needed by the packet. All other event types are stored
+ *  unchanged. The codec works on raw event memory only, the packet header
+ *  and its framing are the caller's business.
+ */
+
+#ifndef CAERDELTA_H_
+#define CAERDELTA_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CAERDELTA_FORMAT_NAME "CAERDELTA"
+
+// First byte of every encoded payload, selects how it was encoded.
+#define CAERDELTA_CODEC_RAW 0
+#define CAERDELTA_CODEC_POLARITY 1
+
+typedef struct caer_delta_buffer *caerDeltaBuffer;
+
+caerDeltaBuffer caerDeltaBufferInit(void);
+void caerDeltaBufferFree(caerDeltaBuffer buffer);
+
+// Encodes eventCount events of eventSize bytes each, starting at events.
+// Polarity events (eventType 1, 8 bytes) get compressed, all others are
+// copied. If validOnly is set, invalid events are dropped, the number of
+// events actually encoded is returned in encodedEvents.
+// Returns the encoded payload, valid until the next call on the same
+// buffer, and its length in payloadLength; or NULL on memory failure.
+uint8_t *caerDeltaEncode(caerDeltaBuffer buffer, int16_t eventType, const uint8_t *events, int32_t eventSize,
+	int32_t eventCount, bool validOnly, int32_t *encodedEvents, size_t *payloadLength);
+
+// Decodes a payload back into eventCount events of eventSize bytes each,
+// written to events. Returns false if the payload is malformed.
+bool caerDeltaDecode(const uint8_t *payload, size_t payloadLength, uint8_t *events, int32_t eventSize,
+	int32_t eventCount);
+
+// Maximum size of an encoded payload for the given events, useful to split
+// packets so that each encoded part fits within a certain size.
+static inline size_t caerDeltaMaxPayloadSize(int32_t eventSize, int32_t eventCount) {
+	// Never bigger than the raw events, plus the codec identifier byte.
+	return (1 + ((size_t) eventSize * (size_t) eventCount));
+}
+
+#endif /* CAERDELTA_H_ */
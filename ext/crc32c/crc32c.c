@@ -0,0 +1,285 @@
+/*
+ * crc32c.c
+ *
+ *  CRC-32C kernels. The hardware ones follow Mark Adler's approach: data is
+ *  split in three blocks that are computed in parallel, and the CRCs of the
+ *  first two are then shifted over the length of the following blocks with
+ *  pre-computed tables and combined.
+ */
+
+#include "crc32c.h"
+#include <string.h>
+#include <endian.h>
+
+#ifdef HAVE_PTHREADS
+	#include "ext/c11threads_posix.h"
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+	#include <immintrin.h>
+	#define CRC32C_SSE42 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+	#include <arm_acle.h>
+	#define CRC32C_ARMV8 1
+#elif defined(__aarch64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+	// Not compiled for the CRC extension, check for it at run-time instead.
+	#include <arm_acle.h>
+	#include <stdbool.h>
+	#include <sys/auxv.h>
+	#define CRC32C_ARMV8 1
+	#define CRC32C_ARMV8_RUNTIME 1
+
+	#if !defined(HWCAP_CRC32)
+		#define HWCAP_CRC32 (1 << 7)
+	#endif
+#endif
+
+// Reversed CRC-32C polynomial.
+#define CRC32C_POLYNOMIAL 0x82F63B78
+
+// Block lengths for the three parallel streams, must be powers of two.
+#define CRC32C_LONG 8192
+#define CRC32C_SHORT 256
+
+static once_flag crc32cTablesOnce = ONCE_FLAG_INIT;
+static uint32_t crc32cTable[8][256];
+static uint32_t crc32cLongShift[4][256];
+static uint32_t crc32cShortShift[4][256];
+#if defined(CRC32C_ARMV8_RUNTIME)
+static bool crc32cArmv8Supported = false;
+#endif
+
+static void crc32cTablesInit(void);
+static uint32_t gf2MatrixTimes(const uint32_t *matrix, uint32_t vector);
+static void gf2MatrixSquare(uint32_t *square, const uint32_t *matrix);
+static void crc32cZerosOperator(uint32_t *even, size_t length);
+static void crc32cZeros(uint32_t zeros[4][256], size_t length);
+static inline uint32_t crc32cShift(uint32_t zeros[4][256], uint32_t crc);
+static uint32_t crc32cSoftware(uint32_t crc, const uint8_t *data, size_t length);
+#if defined(CRC32C_SSE42) || defined(CRC32C_ARMV8)
+static uint32_t crc32cHardware(uint32_t crc, const uint8_t *data, size_t length);
+#endif
+
+uint32_t caerCrc32c(uint32_t crc, const void *data, size_t length) {
+	call_once(&crc32cTablesOnce, &crc32cTablesInit);
+
+#if defined(CRC32C_SSE42)
+	if (__builtin_cpu_supports("sse4.2")) {
+		return (crc32cHardware(crc, data, length));
+	}
+#elif defined(CRC32C_ARMV8_RUNTIME)
+	if (crc32cArmv8Supported) {
+		return (crc32cHardware(crc, data, length));
+	}
+#elif defined(CRC32C_ARMV8)
+	return (crc32cHardware(crc, data, length));
+#endif
+
+	return (crc32cSoftware(crc, data, length));
+}
+
+static void crc32cTablesInit(void) {
+	for (uint32_t n = 0; n < 256; n++) {
+		uint32_t crc = n;
+
+		for (size_t k = 0; k < 8; k++) {
+			crc = (crc & 0x01) ? ((crc >> 1) ^ CRC32C_POLYNOMIAL) : (crc >> 1);
+		}
+
+		crc32cTable[0][n] = crc;
+	}
+
+	for (size_t n = 0; n < 256; n++) {
+		uint32_t crc = crc32cTable[0][n];
+
+		for (size_t k = 1; k < 8; k++) {
+			crc = crc32cTable[0][crc & 0xFF] ^ (crc >> 8);
+			crc32cTable[k][n] = crc;
+		}
+	}
+
+	crc32cZeros(crc32cLongShift, CRC32C_LONG);
+	crc32cZeros(crc32cShortShift, CRC32C_SHORT);
+
+#if defined(CRC32C_ARMV8_RUNTIME)
+	crc32cArmv8Supported = ((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0);
+#endif
+}
+
+static uint32_t gf2MatrixTimes(const uint32_t *matrix, uint32_t vector) {
+	uint32_t sum = 0;
+
+	while (vector != 0) {
+		if (vector & 0x01) {
+			sum ^= *matrix;
+		}
+
+		vector >>= 1;
+		matrix++;
+	}
+
+	return (sum);
+}
+
+static void gf2MatrixSquare(uint32_t *square, const uint32_t *matrix) {
+	for (size_t n = 0; n < 32; n++) {
+		square[n] = gf2MatrixTimes(matrix, matrix[n]);
+	}
+}
+
+// Build the operator that applies length zero bytes to a CRC, by repeated
+// squaring of the operator for a single zero bit. length must be a power of
+// two.
+static void crc32cZerosOperator(uint32_t *even, size_t length) {
+	uint32_t odd[32];
+
+	odd[0] = CRC32C_POLYNOMIAL;
+
+	uint32_t row = 1;
+	for (size_t n = 1; n < 32; n++) {
+		odd[n] = row;
+		row <<= 1;
+	}
+
+	gf2MatrixSquare(even, odd); // Two zero bits.
+	gf2MatrixSquare(odd, even); // Four zero bits.
+
+	// The first square gives the operator for one zero byte, each further one
+	// doubles that, alternating between even and odd.
+	do {
+		gf2MatrixSquare(even, odd);
+		length >>= 1;
+		if (length == 0) {
+			return;
+		}
+
+		gf2MatrixSquare(odd, even);
+		length >>= 1;
+	}
+	while (length != 0);
+
+	memcpy(even, odd, sizeof(odd));
+}
+
+static void crc32cZeros(uint32_t zeros[4][256], size_t length) {
+	uint32_t zerosOperator[32];
+	crc32cZerosOperator(zerosOperator, length);
+
+	for (uint32_t n = 0; n < 256; n++) {
+		zeros[0][n] = gf2MatrixTimes(zerosOperator, n);
+		zeros[1][n] = gf2MatrixTimes(zerosOperator, n << 8);
+		zeros[2][n] = gf2MatrixTimes(zerosOperator, n << 16);
+		zeros[3][n] = gf2MatrixTimes(zerosOperator, n << 24);
+	}
+}
+
+static inline uint32_t crc32cShift(uint32_t zeros[4][256], uint32_t crc) {
+	return (zeros[0][crc & 0xFF] ^ zeros[1][(crc >> 8) & 0xFF] ^ zeros[2][(crc >> 16) & 0xFF] ^ zeros[3][crc >> 24]);
+}
+
+static uint32_t crc32cSoftware(uint32_t crc, const uint8_t *data, size_t length) {
+	crc = ~crc;
+
+	while (length > 0 && ((uintptr_t) data & 0x07) != 0) {
+		crc = crc32cTable[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+		length--;
+	}
+
+	while (length >= 8) {
+		uint64_t word;
+		memcpy(&word, data, sizeof(uint64_t));
+		word = le64toh(word) ^ crc;
+
+		crc = crc32cTable[7][word & 0xFF] ^ crc32cTable[6][(word >> 8) & 0xFF]
+			^ crc32cTable[5][(word >> 16) & 0xFF] ^ crc32cTable[4][(word >> 24) & 0xFF]
+			^ crc32cTable[3][(word >> 32) & 0xFF] ^ crc32cTable[2][(word >> 40) & 0xFF]
+			^ crc32cTable[1][(word >> 48) & 0xFF] ^ crc32cTable[0][word >> 56];
+
+		data += 8;
+		length -= 8;
+	}
+
+	while (length > 0) {
+		crc = crc32cTable[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+		length--;
+	}
+
+	return (~crc);
+}
+
+#if defined(CRC32C_SSE42) || defined(CRC32C_ARMV8)
+
+#if defined(CRC32C_SSE42)
+	#define CRC32C_U8(crc, value) _mm_crc32_u8(crc, value)
+	#define CRC32C_U64(crc, value) ((uint32_t) _mm_crc32_u64(crc, value))
+__attribute__((target("sse4.2")))
+#else
+	#define CRC32C_U8(crc, value) __crc32cb(crc, value)
+	#define CRC32C_U64(crc, value) __crc32cd(crc, value)
+	#if defined(CRC32C_ARMV8_RUNTIME)
+__attribute__((target("+crc")))
+	#endif
+#endif
+static uint32_t crc32cHardware(uint32_t crc, const uint8_t *data, size_t length) {
+	uint32_t crc0 = ~crc;
+
+	while (length > 0 && ((uintptr_t) data & 0x07) != 0) {
+		crc0 = CRC32C_U8(crc0, *data++);
+		length--;
+	}
+
+	// Three streams over long blocks, then over short ones.
+	const size_t blockLengths[2] = { CRC32C_LONG, CRC32C_SHORT };
+
+	for (size_t b = 0; b < 2; b++) {
+		size_t blockLength = blockLengths[b];
+
+		while (length >= (3 * blockLength)) {
+			uint32_t crc1 = 0;
+			uint32_t crc2 = 0;
+
+			const uint8_t *end = data + blockLength;
+
+			do {
+				uint64_t word0, word1, word2;
+				memcpy(&word0, data, sizeof(uint64_t));
+				memcpy(&word1, data + blockLength, sizeof(uint64_t));
+				memcpy(&word2, data + (2 * blockLength), sizeof(uint64_t));
+
+				crc0 = CRC32C_U64(crc0, word0);
+				crc1 = CRC32C_U64(crc1, word1);
+				crc2 = CRC32C_U64(crc2, word2);
+
+				data += 8;
+			}
+			while (data < end);
+
+			uint32_t (*shift)[256] = (b == 0) ? (crc32cLongShift) : (crc32cShortShift);
+
+			crc0 = crc32cShift(shift, crc0) ^ crc1;
+			crc0 = crc32cShift(shift, crc0) ^ crc2;
+
+			data += 2 * blockLength;
+			length -= 3 * blockLength;
+		}
+	}
+
+	while (length >= 8) {
+		uint64_t word;
+		memcpy(&word, data, sizeof(uint64_t));
+
+		crc0 = CRC32C_U64(crc0, word);
+
+		data += 8;
+		length -= 8;
+	}
+
+	while (length > 0) {
+		crc0 = CRC32C_U8(crc0, *data++);
+		length--;
+	}
+
+	return (~crc0);
+}
+
+#endif
@@ -0,0 +1,23 @@
+/*
+ * crc32c.h
+ *
+ *  CRC-32C (Castagnoli polynomial, as used by iSCSI, ext4 and SCTP), to
+ *  check event packets for corruption on storage and over the network.
+ *
+ *  Uses the SSE4.2 crc32 instruction (x86-64) or the ARMv8 CRC32
+ *  instructions (AArch64), both selected at run-time where needed, with
+ *  three independent streams to hide the instruction latency. Otherwise a
+ *  slicing-by-8 table implementation is used.
+ */
+
+#ifndef CRC32C_H_
+#define CRC32C_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+
+// CRC-32C of length bytes at data, continuing from crc, which must be 0 for
+// the first block of data. Calls can be chained to cover non-contiguous data.
+uint32_t caerCrc32c(uint32_t crc, const void *data, size_t length);
+
+#endif /* CRC32C_H_ */
@@ -0,0 +1,54 @@
+/*
+ * netreplay.h
+ *
+ *  Start request, sent by clients of the replay server output right after
+ *  connecting, to choose where in the recording their stream starts. It's
+ *  optional: clients that don't send one within the server's request
+ *  timeout start at the server's default position.
+ */
+
+#ifndef NETREPLAY_H_
+#define NETREPLAY_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+
+#define CAER_NET_REPLAY_MAGIC 0x50524143 // "CARP" in little-endian.
+
+// All values are little-endian.
+struct caer_net_replay_request {
+	uint32_t magic;
+	uint32_t reserved;
+	// Where to start, in µs of event time from the start of the recording.
+	// Negative: use the server's default.
+	int64_t startOffset;
+}__attribute__((__packed__));
+
+typedef struct caer_net_replay_request *caerNetReplayRequest;
+
+#define CAER_NET_REPLAY_REQUEST_SIZE sizeof(struct caer_net_replay_request)
+
+static inline void caerNetReplayRequestSet(caerNetReplayRequest request, int64_t startOffset) {
+	request->magic = htole32(CAER_NET_REPLAY_MAGIC);
+	request->reserved = 0;
+	request->startOffset = (int64_t) htole64((uint64_t) startOffset);
+}
+
+// Convert a received request to host byte order in place. Returns false if
+// it isn't a valid start request.
+static inline bool caerNetReplayRequestParse(caerNetReplayRequest request) {
+	if (le32toh(request->magic) != CAER_NET_REPLAY_MAGIC) {
+		return (false);
+	}
+
+	request->magic = le32toh(request->magic);
+	request->reserved = 0;
+	request->startOffset = (int64_t) le64toh((uint64_t) request->startOffset);
+
+	return (true);
+}
+
+#endif /* NETREPLAY_H_ */
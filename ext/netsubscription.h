@@ -0,0 +1,107 @@
+/*
+ * netsubscription.h
+ *
+ *  Subscription message, sent by clients of the TCP server output to
+ *  restrict what they receive: which event types, a region of interest
+ *  for polarity events, a subsample factor (keep one in N events) and a
+ *  maximum event rate. Clients can send a new one at any time after
+ *  connecting; until they do, they get the full, unfiltered stream.
+ */
+
+#ifndef NETSUBSCRIPTION_H_
+#define NETSUBSCRIPTION_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+
+#define CAER_NET_SUBSCRIPTION_MAGIC 0x55534143 // "CASU" in little-endian.
+
+// All values are little-endian.
+struct caer_net_subscription {
+	uint32_t magic;
+	// Bit N set: event type N is wanted. Zero: all types are wanted.
+	// Types 32 and up can only be received with all types wanted.
+	uint32_t typeMask;
+	// Region of interest for polarity events, inclusive. Set start to 0 and
+	// end to UINT16_MAX to get the whole sensor.
+	uint16_t roiStartX;
+	uint16_t roiStartY;
+	uint16_t roiEndX;
+	uint16_t roiEndY;
+	// Keep only one in every subsample events (0 or 1: keep all).
+	// Special events are never subsampled or rate limited.
+	uint16_t subsample;
+	uint16_t reserved;
+	// Maximum number of events per second (0: unlimited).
+	uint32_t maxRate;
+}__attribute__((__packed__));
+
+typedef struct caer_net_subscription *caerNetSubscription;
+typedef const struct caer_net_subscription *caerNetSubscriptionConst;
+
+#define CAER_NET_SUBSCRIPTION_SIZE sizeof(struct caer_net_subscription)
+
+static inline void caerNetSubscriptionSet(caerNetSubscription subscription, uint32_t typeMask, uint16_t roiStartX,
+	uint16_t roiStartY, uint16_t roiEndX, uint16_t roiEndY, uint16_t subsample, uint32_t maxRate) {
+	subscription->magic = htole32(CAER_NET_SUBSCRIPTION_MAGIC);
+	subscription->typeMask = htole32(typeMask);
+	subscription->roiStartX = htole16(roiStartX);
+	subscription->roiStartY = htole16(roiStartY);
+	subscription->roiEndX = htole16(roiEndX);
+	subscription->roiEndY = htole16(roiEndY);
+	subscription->subsample = htole16(subsample);
+	subscription->reserved = 0;
+	subscription->maxRate = htole32(maxRate);
+}
+
+// Convert a received message to host byte order in place, and normalize
+// it, so that equal subscriptions compare equal with memcmp(). Returns
+// false if it isn't a valid subscription message.
+static inline bool caerNetSubscriptionParse(caerNetSubscription subscription) {
+	if (le32toh(subscription->magic) != CAER_NET_SUBSCRIPTION_MAGIC) {
+		return (false);
+	}
+
+	subscription->magic = le32toh(subscription->magic);
+	subscription->typeMask = le32toh(subscription->typeMask);
+	subscription->roiStartX = le16toh(subscription->roiStartX);
+	subscription->roiStartY = le16toh(subscription->roiStartY);
+	subscription->roiEndX = le16toh(subscription->roiEndX);
+	subscription->roiEndY = le16toh(subscription->roiEndY);
+	subscription->subsample = le16toh(subscription->subsample);
+	subscription->reserved = 0;
+	subscription->maxRate = le32toh(subscription->maxRate);
+
+	if (subscription->subsample == 0) {
+		subscription->subsample = 1;
+	}
+
+	return (true);
+}
+
+static inline bool caerNetSubscriptionWantsType(caerNetSubscriptionConst subscription, int16_t eventType) {
+	if (subscription->typeMask == 0) {
+		return (true);
+	}
+
+	if (eventType < 0 || eventType >= 32) {
+		return (false);
+	}
+
+	return ((subscription->typeMask & (UINT32_C(1) << eventType)) != 0);
+}
+
+static inline bool caerNetSubscriptionHasROI(caerNetSubscriptionConst subscription) {
+	return (subscription->roiStartX != 0 || subscription->roiStartY != 0 || subscription->roiEndX != UINT16_MAX
+		|| subscription->roiEndY != UINT16_MAX);
+}
+
+// Whether events have to be looked at, or whole packets can be passed on.
+static inline bool caerNetSubscriptionFiltersEvents(caerNetSubscriptionConst subscription) {
+	return (caerNetSubscriptionHasROI(subscription) || subscription->subsample > 1 || subscription->maxRate != 0);
+}
+
+#endif /* NETSUBSCRIPTION_H_ */
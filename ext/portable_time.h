@@ -68,6 +68,29 @@
 
 		return (true);
 	}
+
+	static inline bool portable_clock_gettime_thread_cputime(struct timespec *cpuTime) {
+		kern_return_t kRet;
+		thread_basic_info_data_t threadInfo;
+		mach_msg_type_number_t threadInfoCount = THREAD_BASIC_INFO_COUNT;
+
+		mach_port_t thread = mach_thread_self();
+
+		kRet = thread_info(thread, THREAD_BASIC_INFO, (thread_info_t) &threadInfo, &threadInfoCount);
+		mach_port_deallocate(mach_task_self(), thread);
+
+		if (kRet != KERN_SUCCESS) {
+			errno = EINVAL;
+			return (false);
+		}
+
+		long microseconds = threadInfo.user_time.microseconds + threadInfo.system_time.microseconds;
+
+		cpuTime->tv_sec  = threadInfo.user_time.seconds + threadInfo.system_time.seconds + (microseconds / 1000000);
+		cpuTime->tv_nsec = (microseconds % 1000000) * 1000;
+
+		return (true);
+	}
 #elif (_POSIX_C_SOURCE >= 200112L || _XOPEN_SOURCE >= 600)
 	#include <time.h>
 
@@ -78,6 +101,10 @@
 	static inline bool portable_clock_gettime_realtime(struct timespec *realTime) {
 		return (clock_gettime(CLOCK_REALTIME, realTime) == 0);
 	}
+
+	static inline bool portable_clock_gettime_thread_cputime(struct timespec *cpuTime) {
+		return (clock_gettime(CLOCK_THREAD_CPUTIME_ID, cpuTime) == 0);
+	}
 #else
 	#error "No portable way of getting absolute monotonic time."
 #endif
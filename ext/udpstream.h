@@ -0,0 +1,294 @@
+/*
+ * udpstream.h
+ *
+ *  Framing for event packets sent over UDP (unicast or multicast), so that
+ *  receivers can detect loss and reordering, measure latency, and recover
+ *  lost datagrams using parity (FEC) datagrams.
+ *
+ *  Every datagram starts with a caer_udp_stream_header, followed by the
+ *  payload: a complete event packet (header and whole events) for data
+ *  datagrams, or the XOR of the payloads of a group of data datagrams for
+ *  parity datagrams, padded with zeros to the longest one in the group.
+ *  A single lost data datagram per group can be rebuilt from the others.
+ */
+
+#ifndef UDPSTREAM_H_
+#define UDPSTREAM_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+
+#define CAER_UDP_STREAM_MAGIC 0x53554143 // "CAUS" in little-endian.
+
+#define CAER_UDP_STREAM_FLAG_PARITY 0x0001
+
+// Maximum UDP payload over IPv4.
+#define CAER_UDP_STREAM_MAX_DATAGRAM 65507
+
+// Default datagram size, if none is given: Ethernet MTU minus IPv4 and
+// UDP headers, to avoid IP fragmentation.
+#define CAER_UDP_STREAM_DEFAULT_DATAGRAM 1472
+
+// All values are little-endian.
+struct caer_udp_stream_header {
+	uint32_t magic;
+	// Data: increases by one for every data datagram.
+	// Parity: sequence number of the first data datagram of its group.
+	uint32_t sequenceNumber;
+	// Wall-clock time at which the datagram was sent, in µs since the epoch.
+	uint64_t sourceTimestamp;
+	uint16_t flags;
+	// Data: number of datagrams in the FEC group (0 = no FEC).
+	// Parity: number of data datagrams it covers.
+	uint16_t fecGroupSize;
+	// Data: position inside the FEC group. Parity: unused (zero).
+	uint16_t fecGroupIndex;
+	// Data: length of the payload. Parity: XOR of the group's payload lengths.
+	uint16_t payloadLength;
+}__attribute__((__packed__));
+
+typedef struct caer_udp_stream_header *caerUDPStreamHeader;
+
+#define CAER_UDP_STREAM_HEADER_SIZE sizeof(struct caer_udp_stream_header)
+#define CAER_UDP_STREAM_MAX_PAYLOAD (CAER_UDP_STREAM_MAX_DATAGRAM - CAER_UDP_STREAM_HEADER_SIZE)
+
+static inline void caerUDPStreamHeaderSet(caerUDPStreamHeader header, uint32_t sequenceNumber,
+	uint64_t sourceTimestamp, uint16_t flags, uint16_t fecGroupSize, uint16_t fecGroupIndex, uint16_t payloadLength) {
+	header->magic = htole32(CAER_UDP_STREAM_MAGIC);
+	header->sequenceNumber = htole32(sequenceNumber);
+	header->sourceTimestamp = htole64(sourceTimestamp);
+	header->flags = htole16(flags);
+	header->fecGroupSize = htole16(fecGroupSize);
+	header->fecGroupIndex = htole16(fecGroupIndex);
+	header->payloadLength = htole16(payloadLength);
+}
+
+// Convert a received header to host byte order in place. Returns false if
+// the datagram doesn't start with a valid stream header.
+static inline bool caerUDPStreamHeaderParse(caerUDPStreamHeader header, size_t datagramLength) {
+	if (datagramLength < CAER_UDP_STREAM_HEADER_SIZE || le32toh(header->magic) != CAER_UDP_STREAM_MAGIC) {
+		return (false);
+	}
+
+	header->magic = le32toh(header->magic);
+	header->sequenceNumber = le32toh(header->sequenceNumber);
+	header->sourceTimestamp = le64toh(header->sourceTimestamp);
+	header->flags = le16toh(header->flags);
+	header->fecGroupSize = le16toh(header->fecGroupSize);
+	header->fecGroupIndex = le16toh(header->fecGroupIndex);
+	header->payloadLength = le16toh(header->payloadLength);
+
+	if ((header->flags & CAER_UDP_STREAM_FLAG_PARITY) == 0
+		&& header->payloadLength != (datagramLength - CAER_UDP_STREAM_HEADER_SIZE)) {
+		return (false);
+	}
+
+	return (true);
+}
+
+// XOR length bytes of data into parity.
+static inline void caerUDPStreamXOR(uint8_t *parity, const uint8_t *data, size_t length) {
+	size_t i = 0;
+
+	for (; (i + 8) <= length; i += 8) {
+		uint64_t p, d;
+		memcpy(&p, parity + i, 8);
+		memcpy(&d, data + i, 8);
+		p ^= d;
+		memcpy(parity + i, &p, 8);
+	}
+
+	for (; i < length; i++) {
+		parity[i] ^= data[i];
+	}
+}
+
+/*
+ * Receiver side loss accounting, based on sequence numbers. A datagram
+ * arriving after a later one was already seen is counted as reordered,
+ * and is removed from the lost count again, as it was counted there when
+ * the gap was first seen.
+ */
+struct caer_udp_stream_stats {
+	bool started;
+	uint32_t nextSequenceNumber;
+	uint64_t received;
+	uint64_t lost;
+	uint64_t reordered;
+	uint64_t recovered;
+	uint64_t parityReceived;
+	uint64_t latencySum; // In µs, for averaging.
+	uint64_t latencyCount;
+};
+
+typedef struct caer_udp_stream_stats *caerUDPStreamStats;
+
+// Update the statistics with a newly received data datagram.
+static inline void caerUDPStreamStatsUpdate(caerUDPStreamStats stats, uint32_t sequenceNumber) {
+	stats->received++;
+
+	if (!stats->started) {
+		stats->started = true;
+		stats->nextSequenceNumber = sequenceNumber + 1;
+		return;
+	}
+
+	int32_t distance = (int32_t) (sequenceNumber - stats->nextSequenceNumber);
+
+	if (distance >= 0) {
+		// In order, or with a gap of 'distance' datagrams before it.
+		stats->lost += (uint64_t) distance;
+		stats->nextSequenceNumber = sequenceNumber + 1;
+	}
+	else {
+		// Late arrival, was counted as lost before.
+		stats->reordered++;
+
+		if (stats->lost > 0) {
+			stats->lost--;
+		}
+	}
+}
+
+// Update the statistics with a data datagram rebuilt from parity.
+static inline void caerUDPStreamStatsRecovered(caerUDPStreamStats stats, uint32_t sequenceNumber) {
+	stats->recovered++;
+
+	if (!stats->started) {
+		return;
+	}
+
+	int32_t distance = (int32_t) (sequenceNumber - stats->nextSequenceNumber);
+
+	if (distance >= 0) {
+		// Loss not seen yet (last of its group), skip over it.
+		stats->lost += (uint64_t) distance;
+		stats->nextSequenceNumber = sequenceNumber + 1;
+	}
+	else if (stats->lost > 0) {
+		stats->lost--;
+	}
+}
+
+// Update the latency statistics with a received source timestamp.
+static inline void caerUDPStreamStatsLatency(caerUDPStreamStats stats, uint64_t sourceTimestamp,
+	uint64_t receiveTimestamp) {
+	// Clocks of sender and receiver may not be perfectly in sync, ignore
+	// datagrams that seem to come from the future.
+	if (receiveTimestamp >= sourceTimestamp) {
+		stats->latencySum += (receiveTimestamp - sourceTimestamp);
+		stats->latencyCount++;
+	}
+}
+
+/*
+ * Receiver side FEC state for the group currently being received: the XOR
+ * of all its data payloads and lengths, and which of its datagrams arrived.
+ */
+struct caer_udp_stream_fec {
+	bool active;
+	uint32_t groupStart;
+	uint16_t groupSize;
+	uint64_t receivedMask; // Groups are limited to 64 datagrams.
+	uint16_t lengthXOR;
+	uint16_t maxLength;
+	uint8_t payloadXOR[CAER_UDP_STREAM_MAX_PAYLOAD];
+};
+
+typedef struct caer_udp_stream_fec *caerUDPStreamFEC;
+
+#define CAER_UDP_STREAM_FEC_MAX_GROUP 64
+
+// Add a received data datagram to the FEC state.
+static inline void caerUDPStreamFECAddData(caerUDPStreamFEC fec, caerUDPStreamHeader header, const uint8_t *payload) {
+	if (header->fecGroupSize == 0 || header->fecGroupSize > CAER_UDP_STREAM_FEC_MAX_GROUP
+		|| header->fecGroupIndex >= header->fecGroupSize) {
+		return;
+	}
+
+	uint32_t groupStart = header->sequenceNumber - header->fecGroupIndex;
+
+	if (!fec->active || fec->groupStart != groupStart) {
+		// New group, the old one can't be recovered anymore.
+		fec->active = true;
+		fec->groupStart = groupStart;
+		fec->groupSize = header->fecGroupSize;
+		fec->receivedMask = 0;
+		fec->lengthXOR = 0;
+		// Only the part used by the last group needs clearing.
+		memset(fec->payloadXOR, 0, fec->maxLength);
+		fec->maxLength = 0;
+	}
+
+	uint64_t indexBit = UINT64_C(1) << header->fecGroupIndex;
+
+	if (fec->receivedMask & indexBit) {
+		return; // Duplicate.
+	}
+
+	fec->receivedMask |= indexBit;
+	fec->lengthXOR ^= header->payloadLength;
+	if (header->payloadLength > fec->maxLength) {
+		fec->maxLength = header->payloadLength;
+	}
+
+	caerUDPStreamXOR(fec->payloadXOR, payload, header->payloadLength);
+}
+
+// Use a received parity datagram to rebuild the one missing data datagram
+// of its group, if exactly one is missing. On success, returns the rebuilt
+// payload (inside the FEC state, valid until the next call), with its
+// length and sequence number. Returns NULL if nothing can be recovered.
+static inline uint8_t *caerUDPStreamFECRecover(caerUDPStreamFEC fec, caerUDPStreamHeader header,
+	const uint8_t *payload, size_t payloadLength, uint16_t *recoveredLength, uint32_t *recoveredSequenceNumber) {
+	if (header->fecGroupSize == 0 || header->fecGroupSize > CAER_UDP_STREAM_FEC_MAX_GROUP
+		|| payloadLength > CAER_UDP_STREAM_MAX_PAYLOAD) {
+		return (NULL);
+	}
+
+	if (!fec->active || fec->groupStart != header->sequenceNumber) {
+		// Nothing received from this group. Only a group of one can be
+		// recovered then, its parity is the data itself.
+		if (header->fecGroupSize != 1) {
+			return (NULL);
+		}
+
+		fec->groupStart = header->sequenceNumber;
+		fec->receivedMask = 0;
+		fec->lengthXOR = 0;
+		memset(fec->payloadXOR, 0, fec->maxLength);
+		fec->maxLength = 0;
+	}
+
+	uint64_t groupMask = (header->fecGroupSize == 64) ? (UINT64_MAX) : ((UINT64_C(1) << header->fecGroupSize) - 1);
+	uint64_t missingMask = groupMask & ~fec->receivedMask;
+
+	// Exactly one missing: a single bit set.
+	if (missingMask == 0 || (missingMask & (missingMask - 1)) != 0) {
+		return (NULL);
+	}
+
+	uint16_t missingIndex = (uint16_t) __builtin_ctzll(missingMask);
+
+	caerUDPStreamXOR(fec->payloadXOR, payload, payloadLength);
+	if (payloadLength > fec->maxLength) {
+		fec->maxLength = (uint16_t) payloadLength;
+	}
+
+	*recoveredLength = (uint16_t) (fec->lengthXOR ^ header->payloadLength);
+	*recoveredSequenceNumber = fec->groupStart + missingIndex;
+
+	// Group is done now.
+	fec->active = false;
+
+	if (*recoveredLength > payloadLength) {
+		return (NULL); // Inconsistent parity.
+	}
+
+	return (fec->payloadXOR);
+}
+
+#endif /* UDPSTREAM_H_ */
@@ -0,0 +1,207 @@
+/*
+ * validcompact.c
+ *
+ *  Valid event stream compaction kernels.
+ *
+ *  All event types store the valid mark in bit 0 of their first 32 bits
+ *  (little-endian), see libcaer/events/common.h. The kernels read it from
+ *  there directly, without going through the per-type accessors.
+ */
+
+#include "validcompact.h"
+#include <endian.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+	#include <immintrin.h>
+	#define VALIDCOMPACT_AVX2 1
+#elif defined(__aarch64__) && defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	#include <arm_neon.h>
+	#define VALIDCOMPACT_NEON 1
+#endif
+
+// Events up to this size are copied unconditionally and then kept or not,
+// which avoids unpredictable branches. Must not exceed the slack.
+#define BRANCHLESS_MAX_EVENT_SIZE CAER_VALID_COMPACT_SLACK
+
+struct caer_valid_compact_buffer {
+	uint8_t *memory;
+	size_t memorySize;
+};
+
+static inline uint32_t eventValidMark(const uint8_t *event);
+static size_t compactBranchless(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber);
+static size_t compactRuns(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber);
+#if defined(VALIDCOMPACT_AVX2)
+static size_t compact8AVX2(uint8_t *out, const uint8_t *events, size_t eventNumber);
+#elif defined(VALIDCOMPACT_NEON)
+static size_t compact8NEON(uint8_t *out, const uint8_t *events, size_t eventNumber);
+#endif
+
+caerValidCompactBuffer caerValidCompactBufferInit(void) {
+	return (calloc(1, sizeof(struct caer_valid_compact_buffer)));
+}
+
+void caerValidCompactBufferFree(caerValidCompactBuffer buffer) {
+	if (buffer == NULL) {
+		return;
+	}
+
+	free(buffer->memory);
+	free(buffer);
+}
+
+uint8_t *caerValidCompactBufferReserve(caerValidCompactBuffer buffer, size_t size) {
+	size += CAER_VALID_COMPACT_SLACK;
+
+	if (size > buffer->memorySize) {
+		// Grow geometrically, packet sizes vary a lot from one to the next.
+		size_t newSize = (buffer->memorySize * 2);
+		if (newSize < size) {
+			newSize = size;
+		}
+
+		uint8_t *newMemory = realloc(buffer->memory, newSize);
+		if (newMemory == NULL) {
+			return (NULL);
+		}
+
+		buffer->memory = newMemory;
+		buffer->memorySize = newSize;
+	}
+
+	return (buffer->memory);
+}
+
+size_t caerValidCompactEvents(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber) {
+	if (eventSize == 8) {
+#if defined(VALIDCOMPACT_AVX2)
+		if (__builtin_cpu_supports("avx2")) {
+			return (compact8AVX2(out, events, eventNumber));
+		}
+#elif defined(VALIDCOMPACT_NEON)
+		return (compact8NEON(out, events, eventNumber));
+#endif
+	}
+
+	if (eventSize <= BRANCHLESS_MAX_EVENT_SIZE) {
+		return (compactBranchless(out, events, eventSize, eventNumber));
+	}
+
+	return (compactRuns(out, events, eventSize, eventNumber));
+}
+
+static inline uint32_t eventValidMark(const uint8_t *event) {
+	uint32_t data;
+	memcpy(&data, event, sizeof(uint32_t));
+
+	return (le32toh(data) & 0x01);
+}
+
+static size_t compactBranchless(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber) {
+	uint8_t *outStart = out;
+
+	for (size_t i = 0; i < eventNumber; i++) {
+		const uint8_t *event = events + (i * eventSize);
+
+		// Always copy, but only advance if the event was valid; the next
+		// event then overwrites an invalid one.
+		memcpy(out, event, eventSize);
+		out += eventValidMark(event) * eventSize;
+	}
+
+	return ((size_t) (out - outStart) / eventSize);
+}
+
+static size_t compactRuns(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber) {
+	size_t outEvents = 0;
+	size_t i = 0;
+
+	while (i < eventNumber) {
+		// Skip invalid events.
+		while (i < eventNumber && !eventValidMark(events + (i * eventSize))) {
+			i++;
+		}
+
+		// Find the end of the valid run and copy it in one go.
+		size_t runStart = i;
+
+		while (i < eventNumber && eventValidMark(events + (i * eventSize))) {
+			i++;
+		}
+
+		if (i > runStart) {
+			memcpy(out + (outEvents * eventSize), events + (runStart * eventSize), (i - runStart) * eventSize);
+			outEvents += (i - runStart);
+		}
+	}
+
+	return (outEvents);
+}
+
+#if defined(VALIDCOMPACT_AVX2)
+
+// For each 4-bit mask of valid events, the 32-bit lane permutation that
+// moves the valid 64-bit events to the front, in order.
+static const int32_t compact8Permutations[16][8] = {
+	{ 0, 1, 0, 1, 0, 1, 0, 1 }, { 0, 1, 0, 1, 0, 1, 0, 1 }, { 2, 3, 0, 1, 0, 1, 0, 1 }, { 0, 1, 2, 3, 0, 1, 0, 1 },
+	{ 4, 5, 0, 1, 0, 1, 0, 1 }, { 0, 1, 4, 5, 0, 1, 0, 1 }, { 2, 3, 4, 5, 0, 1, 0, 1 }, { 0, 1, 2, 3, 4, 5, 0, 1 },
+	{ 6, 7, 0, 1, 0, 1, 0, 1 }, { 0, 1, 6, 7, 0, 1, 0, 1 }, { 2, 3, 6, 7, 0, 1, 0, 1 }, { 0, 1, 2, 3, 6, 7, 0, 1 },
+	{ 4, 5, 6, 7, 0, 1, 0, 1 }, { 0, 1, 4, 5, 6, 7, 0, 1 }, { 2, 3, 4, 5, 6, 7, 0, 1 }, { 0, 1, 2, 3, 4, 5, 6, 7 } };
+
+__attribute__((target("avx2")))
+static size_t compact8AVX2(uint8_t *out, const uint8_t *events, size_t eventNumber) {
+	uint8_t *outStart = out;
+	size_t i = 0;
+
+	// Four events per iteration: move the valid mark (bit 0) of each 64-bit
+	// event into its sign bit, get the 4-bit mask, permute the valid events
+	// to the front and store all 32 bytes; then advance by the valid ones.
+	for (; (i + 4) <= eventNumber; i += 4) {
+		__m256i data = _mm256_loadu_si256((const __m256i *) (const void *) (events + (i * 8)));
+
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(data, 63)));
+
+		__m256i permutation = _mm256_loadu_si256((const __m256i *) (const void *) compact8Permutations[mask]);
+		_mm256_storeu_si256((__m256i *) (void *) out, _mm256_permutevar8x32_epi32(data, permutation));
+
+		out += (size_t) __builtin_popcount((unsigned int) mask) * 8;
+	}
+
+	out += compactBranchless(out, events + (i * 8), 8, eventNumber - i) * 8;
+
+	return ((size_t) (out - outStart) / 8);
+}
+
+#elif defined(VALIDCOMPACT_NEON)
+
+// For each 2-bit mask of valid events, the byte shuffle that moves the
+// valid 64-bit events to the front, in order.
+static const uint8_t compact8Shuffles[4][16] = {
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 0, 1, 2, 3, 4, 5, 6, 7 },
+	{ 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7 },
+	{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 } };
+
+static size_t compact8NEON(uint8_t *out, const uint8_t *events, size_t eventNumber) {
+	uint8_t *outStart = out;
+	size_t i = 0;
+
+	// Two events per iteration, same approach as the AVX2 kernel, using a
+	// table lookup to do the shuffle.
+	for (; (i + 2) <= eventNumber; i += 2) {
+		uint8x16_t data = vld1q_u8(events + (i * 8));
+
+		uint64x2_t valid = vandq_u64(vreinterpretq_u64_u8(data), vdupq_n_u64(1));
+		uint32_t mask = (uint32_t) (vgetq_lane_u64(valid, 0) | (vgetq_lane_u64(valid, 1) << 1));
+
+		vst1q_u8(out, vqtbl1q_u8(data, vld1q_u8(compact8Shuffles[mask])));
+
+		out += (size_t) ((mask & 0x01) + (mask >> 1)) * 8;
+	}
+
+	out += compactBranchless(out, events + (i * 8), 8, eventNumber - i) * 8;
+
+	return ((size_t) (out - outStart) / 8);
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+ * validcompact.h
+ *
+ *  Stream compaction of event packets: copies only the valid events of a
+ *  packet, back-to-back, into a destination buffer. Used wherever only the
+ *  valid events are of interest (outputs with validEventsOnly, visualizer),
+ *  as filters like the BAFilter leave valid and invalid events finely
+ *  interleaved, which makes per-run approaches (scatter/gather) inefficient.
+ *
+ *  8 byte events (polarity) use an AVX2 (x86-64, selected at run-time) or
+ *  NEON (AArch64) kernel, other small events a branch-free scalar copy, and
+ *  large events (frames) a run-based memcpy().
+ */
+
+#ifndef VALIDCOMPACT_H_
+#define VALIDCOMPACT_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <libcaer/events/common.h>
+
+// Extra bytes the destination must have after the space needed for the
+// valid events, as the kernels write ahead in full vectors/events.
+#define CAER_VALID_COMPACT_SLACK 32
+
+typedef struct caer_valid_compact_buffer *caerValidCompactBuffer;
+
+caerValidCompactBuffer caerValidCompactBufferInit(void);
+void caerValidCompactBufferFree(caerValidCompactBuffer buffer);
+
+// Get memory for at least size bytes, plus the slack needed by the kernels.
+// The memory is reused across calls, and only valid until the next call on
+// the same buffer. Returns NULL on memory allocation failure.
+uint8_t *caerValidCompactBufferReserve(caerValidCompactBuffer buffer, size_t size);
+
+// Copy the valid events out of eventNumber events of eventSize bytes each,
+// starting at events, to out, which must have space for all of them plus
+// CAER_VALID_COMPACT_SLACK bytes. Returns the number of events copied.
+size_t caerValidCompactEvents(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber);
+
+// Size to reserve for a compacted copy of a packet (header and events).
+static inline size_t caerValidCompactPacketSize(caerEventPacketHeaderConst packetHeader) {
+	return (CAER_EVENT_PACKET_HEADER_SIZE
+		+ ((size_t) caerEventPacketHeaderGetEventSize(packetHeader)
+			* (size_t) caerEventPacketHeaderGetEventNumber(packetHeader)));
+}
+
+// Write a complete packet, holding only the valid events of packetHeader,
+// to out, which must be at least caerValidCompactPacketSize() bytes plus
+// CAER_VALID_COMPACT_SLACK. Capacity, number and valid are all set to the
+// number of valid events. Returns the size of the new packet in bytes.
+static inline size_t caerValidCompactPacket(uint8_t *out, caerEventPacketHeaderConst packetHeader) {
+	size_t eventSize = (size_t) caerEventPacketHeaderGetEventSize(packetHeader);
+	size_t eventNumber = (size_t) caerEventPacketHeaderGetEventNumber(packetHeader);
+	const uint8_t *events = ((const uint8_t *) packetHeader) + CAER_EVENT_PACKET_HEADER_SIZE;
+
+	size_t validEvents;
+
+	if (caerEventPacketHeaderGetEventValid(packetHeader) == (int32_t) eventNumber) {
+		// All valid, nothing to compact.
+		memcpy(out + CAER_EVENT_PACKET_HEADER_SIZE, events, eventSize * eventNumber);
+		validEvents = eventNumber;
+	}
+	else {
+		validEvents = caerValidCompactEvents(out + CAER_EVENT_PACKET_HEADER_SIZE, events, eventSize, eventNumber);
+	}
+
+	memcpy(out, packetHeader, CAER_EVENT_PACKET_HEADER_SIZE);
+
+	caerEventPacketHeader outHeader = (caerEventPacketHeader) out;
+	caerEventPacketHeaderSetEventCapacity(outHeader, (int32_t) validEvents);
+	caerEventPacketHeaderSetEventNumber(outHeader, (int32_t) validEvents);
+	caerEventPacketHeaderSetEventValid(outHeader, (int32_t) validEvents);
+
+	return (CAER_EVENT_PACKET_HEADER_SIZE + (validEvents * eventSize));
+}
+
+#endif /* VALIDCOMPACT_H_ */
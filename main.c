@@ -29,6 +29,12 @@
 #ifdef DAVISFX3
 	#include "modules/ini/davis_fx3.h"
 #endif
+#ifdef DAVISSIM
+	#include "modules/ini/davis_sim.h"
+#endif
+#ifdef ENABLE_DAVIS_SYNC
+	#include "modules/ini/davis_sync.h"
+#endif
 
 // Input/Output support.
 #ifdef ENABLE_FILE_OUTPUT
@@ -40,6 +46,9 @@
 	#include "modules/misc/out/net_udp.h"
 	#include "modules/misc/out/unixs.h"
 #endif
+#ifdef ENABLE_REPLAY_SERVER
+	#include "modules/misc/out/replay_server.h"
+#endif
 
 // Common filters support.
 #ifdef ENABLE_BAFILTER
@@ -48,6 +57,12 @@
 #ifdef ENABLE_CAMERACALIBRATION
 	#include "modules/cameracalibration/cameracalibration.h"
 #endif
+#ifdef ENABLE_COALESCE
+	#include "modules/coalesce/coalesce.h"
+#endif
+#ifdef ENABLE_MOTIONCOMPENSATION
+	#include "modules/motioncompensation/motioncompensation.h"
+#endif
 #ifdef ENABLE_FRAMEENHANCER
 	#include "modules/frameenhancer/frameenhancer.h"
 #endif
@@ -84,24 +99,46 @@ static bool mainloop_1(void) {
 	container = caerInputDVS128(1);
 #endif
 #ifdef DAVISFX2
+	#ifdef ENABLE_DAVIS_SYNC
+	// Two cameras connected by a sync cable, packets of the first one are
+	// where a single camera's are.
+	container = caerInputDAVISSync(12, 2, caerInputDAVISFX2(1), caerInputDAVISFX2(11));
+	#else
 	container = caerInputDAVISFX2(1);
+	#endif
 #endif
 #ifdef DAVISFX3
+	#ifdef ENABLE_DAVIS_SYNC
+	// Two cameras connected by a sync cable, packets of the first one are
+	// where a single camera's are.
+	container = caerInputDAVISSync(12, 2, caerInputDAVISFX3(1), caerInputDAVISFX3(11));
+	#else
 	container = caerInputDAVISFX3(1);
+	#endif
+#endif
+#ifdef DAVISSIM
+	// No camera needed: a recording is replayed as if it came from one.
+	container = caerInputDAVISSim(1);
 #endif
 
-#if defined(DVS128) || defined(DAVISFX2) || defined(DAVISFX3)
+#if defined(DVS128) || defined(DAVISFX2) || defined(DAVISFX3) || defined(DAVISSIM)
 	// Typed EventPackets contain events of a certain type.
 	caerSpecialEventPacket special = (caerSpecialEventPacket) caerEventPacketContainerGetEventPacket(container, SPECIAL_EVENT);
 	caerPolarityEventPacket polarity = (caerPolarityEventPacket) caerEventPacketContainerGetEventPacket(container, POLARITY_EVENT);
 #endif
 
-#if defined(DAVISFX2) || defined(DAVISFX3)
+#if defined(DAVISFX2) || defined(DAVISFX3) || defined(DAVISSIM)
 	// Frame and IMU events exist only with DAVIS cameras.
 	caerFrameEventPacket frame = (caerFrameEventPacket) caerEventPacketContainerGetEventPacket(container, FRAME_EVENT);
 	caerIMU6EventPacket imu = (caerIMU6EventPacket) caerEventPacketContainerGetEventPacket(container, IMU6_EVENT);
 #endif
 
+	// Small packets can be joined into bigger ones, so that all modules after
+	// this one have fewer of them to handle.
+#ifdef ENABLE_COALESCE
+	caerCoalesce(15, 2, (caerEventPacketHeader *) &special, (caerEventPacketHeader *) &polarity);
+#endif
+
 	// Filters process event packets: for example to suppress certain events,
 	// like with the Background Activity Filter, which suppresses events that
 	// look to be uncorrelated with real scene changes (noise reduction).
@@ -125,9 +162,16 @@ static bool mainloop_1(void) {
 	caerCameraCalibration(5, polarity, frame);
 #endif
 
+	// Camera rotation, as measured by the gyro, can be taken out of the
+	// polarity events. Addresses come out undistorted, so don't undistort
+	// events with the camera calibration too.
+#if defined(ENABLE_MOTIONCOMPENSATION) && (defined(DAVISFX2) || defined(DAVISFX3) || defined(DAVISSIM))
+	caerMotionCompensation(16, polarity, imu);
+#endif
+
 	// A small visualizer exists to show what the output looks like.
 #ifdef ENABLE_VISUALIZER
-	#if defined(DAVISFX2) || defined(DAVISFX3)
+	#if defined(DAVISFX2) || defined(DAVISFX3) || defined(DAVISSIM)
 		caerVisualizer(60, "Polarity", &caerVisualizerRendererPolarityEvents, NULL, (caerEventPacketHeader) polarity);
 		caerVisualizer(61, "Frame", &caerVisualizerRendererFrameEvents, NULL, (caerEventPacketHeader) frame);
 		caerVisualizer(62, "IMU6", &caerVisualizerRendererIMU6Events, NULL, (caerEventPacketHeader) imu);
@@ -152,6 +196,12 @@ static bool mainloop_1(void) {
 	caerOutputNetUDP(9, 1, polarity);// or (9, 2, polarity, frame) for polarity and frames
 #endif
 
+#ifdef ENABLE_REPLAY_SERVER
+	// Stream a recording to any number of TCP clients, paced to its timestamps.
+	// This runs on its own, independent of the data flowing through here.
+	caerOutputReplayServer(10);
+#endif
+
 #ifdef ENABLE_IMAGEGENERATOR
 	// save images of accumulated spikes and frames
 	int CLASSIFY_IMG_SIZE = CLASSIFYSIZE;
@@ -212,7 +262,7 @@ static bool mainloop_1(void) {
 		return (false);
 	}
 
-#if defined(DAVISFX2) || defined(DAVISFX3)
+#if defined(DAVISFX2) || defined(DAVISFX3) || defined(DAVISSIM)
 	/* frame_img_ptr:
 	 *
 	 * (Not used so far.)
@@ -249,7 +299,7 @@ static bool mainloop_1(void) {
 	// display images of accumulated spikes
 	// this also requires image generator
 #ifdef ENABLE_IMAGEGENERATOR
-#if defined(DAVISFX2) || defined(DAVISFX3)
+#if defined(DAVISFX2) || defined(DAVISFX3) || defined(DAVISSIM)
 	caerImagestreamerVisualizer(22, *display_img_ptr, DISPLAY_IMG_SIZE, classification_results, class_region_sizes, (int) MAX_IMG_QTY);
 #else //without Frames
 	caerImagestreamerVisualizer(22, *display_img_ptr, DISPLAY_IMG_SIZE, classificationResults, class_region_sizes, (int) MAX_IMG_QTY);
@@ -0,0 +1,506 @@
+/*
+ * coalesce.c
+ *
+ *  Every packet costs the modules after it the same fixed amount of work,
+ *  no matter how few events it holds. At low event rates, or with short
+ *  packet intervals at the input, most of that is overhead. This module
+ *  holds back packets smaller than packetSize events and appends the
+ *  following ones of the same source and type, until the result is big
+ *  enough, spans packetInterval µs of event time, or its first events have
+ *  waited maxLatency µs. Packets big enough on their own pass unchanged.
+ *
+ *  The mainloop only runs when there is data, or about once a second, so a
+ *  wake-up thread raises dataAvailable when the oldest held packet is due,
+ *  and the next run sends it on. The thread sleeps on a condition variable
+ *  while nothing is held, and otherwise until the oldest packet is due.
+ */
+
+#include "coalesce.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "ext/portable_time.h"
+#include "ext/c11threads_posix.h"
+
+// How often the statistics are updated, in seconds.
+#define COALESCE_STATS_INTERVAL 1
+
+struct coalesce_stream {
+	int16_t sourceID;
+	int16_t eventType;
+	// Position of the packet pointer the stream comes in through, and goes
+	// out through.
+	size_t argument;
+	caerEventPacketHeader pending;
+	int64_t firstTimestamp;
+	struct timespec firstArrival;
+};
+
+struct coalesce_state {
+	struct coalesce_stream *streams;
+	size_t streamsLength;
+	// Settings.
+	int32_t packetSize;
+	int64_t packetInterval;
+	double maxLatency;
+	// Wake-up thread: wakeDeadline is when the oldest held packet is due
+	// (monotonic µs, 0 if nothing is held), wakeRaised if the thread has
+	// raised dataAvailable and the next run has to take it back. All three
+	// are protected by wakeLock, wakeSignal tells the thread they changed.
+	caerMainloopData mainloop;
+	thrd_t wakeThread;
+	mtx_t wakeLock;
+	cnd_t wakeSignal;
+	bool wakeRunning;
+	int64_t wakeDeadline;
+	bool wakeRaised;
+	// Statistics.
+	struct timespec statsTime;
+	int64_t packetsIn;
+	int64_t packetsOut;
+	int64_t statsPacketsIn;
+	int64_t statsPacketsOut;
+};
+
+typedef struct coalesce_state *coalesceState;
+
+static bool caerCoalesceInit(caerModuleData moduleData);
+static void caerCoalesceRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerCoalesceConfig(caerModuleData moduleData);
+static void caerCoalesceExit(caerModuleData moduleData);
+static struct coalesce_stream *streamFind(coalesceState state, int16_t sourceID, int16_t eventType);
+static bool streamAppend(struct coalesce_stream *stream, caerEventPacketHeader packet, const struct timespec *now);
+static bool streamDue(coalesceState state, struct coalesce_stream *stream, const struct timespec *now);
+static caerEventPacketHeader streamRelease(coalesceState state, struct coalesce_stream *stream);
+static void updateStatistics(caerModuleData moduleData, const struct timespec *now);
+static void updateWakeDeadline(coalesceState state);
+static int wakeThread(void *stateArg);
+static void wakeThreadStop(coalesceState state);
+static int64_t timespecToMicro(const struct timespec *time);
+static void mainloopDataNotifyIncrease(void *p);
+static void mainloopDataNotifyDecrease(void *p);
+
+static struct caer_module_functions caerCoalesceFunctions = { .moduleInit = &caerCoalesceInit, .moduleRun =
+	&caerCoalesceRun, .moduleConfig = &caerCoalesceConfig, .moduleExit = &caerCoalesceExit };
+
+void caerCoalesce(uint16_t moduleID, size_t packetsNumber, ...) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "Coalesce");
+
+	va_list args;
+	va_start(args, packetsNumber);
+	caerModuleSMv(&caerCoalesceFunctions, moduleData, sizeof(struct coalesce_state), packetsNumber, args);
+	va_end(args);
+}
+
+static bool caerCoalesceInit(caerModuleData moduleData) {
+	// Packets with at least this many events go out.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "packetSize", 4096);
+	// Packets spanning this many µs of event time go out.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "packetInterval", 10000);
+	// No event is held back longer than this, in µs.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxLatency", 2000);
+
+	// Statistics, read-only.
+	sshsNodePutLong(moduleData->moduleNode, "packetsIn", 0);
+	sshsNodePutLong(moduleData->moduleNode, "packetsOut", 0);
+	sshsNodePutDouble(moduleData->moduleNode, "coalescingRatio", 1);
+
+	coalesceState state = moduleData->moduleState;
+
+	caerCoalesceConfig(moduleData);
+
+	portable_clock_gettime_monotonic(&state->statsTime);
+
+	// Init runs in the mainloop thread.
+	state->mainloop = caerMainloopGetReference();
+
+	state->wakeDeadline = 0;
+	state->wakeRaised = false;
+	state->wakeRunning = true;
+
+	if (mtx_init(&state->wakeLock, mtx_plain) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to initialize wake-up lock.");
+		return (false);
+	}
+
+	if (cnd_init(&state->wakeSignal) != thrd_success) {
+		mtx_destroy(&state->wakeLock);
+
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to initialize wake-up condition.");
+		return (false);
+	}
+
+	if (thrd_create(&state->wakeThread, &wakeThread, state) != thrd_success) {
+		cnd_destroy(&state->wakeSignal);
+		mtx_destroy(&state->wakeLock);
+
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to start wake-up thread.");
+		return (false);
+	}
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	return (true);
+}
+
+static void caerCoalesceRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	if (argsNumber == 0) {
+		return;
+	}
+
+	coalesceState state = moduleData->moduleState;
+
+	// This run is the one the wake-up thread asked for, if any. The thread
+	// waits for a new deadline after raising, so it needs no signal here.
+	mtx_lock(&state->wakeLock);
+
+	if (state->wakeRaised) {
+		state->wakeRaised = false;
+		mainloopDataNotifyDecrease(state->mainloop);
+	}
+
+	mtx_unlock(&state->wakeLock);
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	// Interpret variable arguments (same as above in main function).
+	caerEventPacketHeader *packets[argsNumber];
+
+	for (size_t i = 0; i < argsNumber; i++) {
+		packets[i] = va_arg(args, caerEventPacketHeader *);
+
+		if (packets[i] == NULL) {
+			continue;
+		}
+
+		caerEventPacketHeader packet = *packets[i];
+		if (packet == NULL || caerEventPacketHeaderGetEventNumber(packet) == 0) {
+			continue;
+		}
+
+		state->packetsIn++;
+
+		struct coalesce_stream *stream = streamFind(state, caerEventPacketHeaderGetEventSource(packet),
+			caerEventPacketHeaderGetEventType(packet));
+		if (stream == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to allocate memory for new stream, passing packet on.");
+			state->packetsOut++;
+			continue;
+		}
+
+		stream->argument = i;
+
+		// Big enough on its own.
+		if (stream->pending == NULL && caerEventPacketHeaderGetEventNumber(packet) >= state->packetSize) {
+			state->packetsOut++;
+			continue;
+		}
+
+		// What's held can't be joined with packets of a different timestamp
+		// overflow or event size, so it goes out in place of this one.
+		if (stream->pending != NULL
+			&& (caerEventPacketHeaderGetEventTSOverflow(stream->pending)
+				!= caerEventPacketHeaderGetEventTSOverflow(packet)
+				|| caerEventPacketHeaderGetEventSize(stream->pending) != caerEventPacketHeaderGetEventSize(packet))) {
+			*packets[i] = streamRelease(state, stream);
+		}
+		else {
+			*packets[i] = NULL;
+		}
+
+		if (!streamAppend(stream, packet, &now)) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to allocate memory for coalesced packet, dropping %" PRIi32 " events.",
+				caerEventPacketHeaderGetEventNumber(packet));
+		}
+	}
+
+	// Send on what's ready, through the pointer the stream came in, if that
+	// one is free in this run.
+	for (size_t i = 0; i < state->streamsLength; i++) {
+		struct coalesce_stream *stream = &state->streams[i];
+
+		if (stream->pending == NULL || stream->argument >= argsNumber || packets[stream->argument] == NULL
+			|| *packets[stream->argument] != NULL) {
+			continue;
+		}
+
+		if (streamDue(state, stream, &now)) {
+			*packets[stream->argument] = streamRelease(state, stream);
+		}
+	}
+
+	updateWakeDeadline(state);
+
+	updateStatistics(moduleData, &now);
+}
+
+static void caerCoalesceConfig(caerModuleData moduleData) {
+	caerModuleConfigUpdateReset(moduleData);
+
+	coalesceState state = moduleData->moduleState;
+
+	state->packetSize = sshsNodeGetInt(moduleData->moduleNode, "packetSize");
+	state->packetInterval = I64T(sshsNodeGetInt(moduleData->moduleNode, "packetInterval"));
+
+	int32_t maxLatency = sshsNodeGetInt(moduleData->moduleNode, "maxLatency");
+	state->maxLatency = (double) maxLatency / 1000000;
+}
+
+static void caerCoalesceExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	coalesceState state = moduleData->moduleState;
+
+	wakeThreadStop(state);
+
+	if (thrd_join(state->wakeThread, NULL) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to join wake-up thread.");
+	}
+
+	cnd_destroy(&state->wakeSignal);
+	mtx_destroy(&state->wakeLock);
+
+	if (state->wakeRaised) {
+		state->wakeRaised = false;
+		mainloopDataNotifyDecrease(state->mainloop);
+	}
+
+	for (size_t i = 0; i < state->streamsLength; i++) {
+		free(state->streams[i].pending);
+	}
+
+	free(state->streams);
+	state->streams = NULL;
+	state->streamsLength = 0;
+}
+
+static struct coalesce_stream *streamFind(coalesceState state, int16_t sourceID, int16_t eventType) {
+	for (size_t i = 0; i < state->streamsLength; i++) {
+		if (state->streams[i].sourceID == sourceID && state->streams[i].eventType == eventType) {
+			return (&state->streams[i]);
+		}
+	}
+
+	struct coalesce_stream *newStreams = realloc(state->streams,
+		(state->streamsLength + 1) * sizeof(struct coalesce_stream));
+	if (newStreams == NULL) {
+		return (NULL);
+	}
+
+	state->streams = newStreams;
+
+	struct coalesce_stream *stream = &state->streams[state->streamsLength++];
+	memset(stream, 0, sizeof(struct coalesce_stream));
+
+	stream->sourceID = sourceID;
+	stream->eventType = eventType;
+
+	return (stream);
+}
+
+// Append all events of packet to the ones held, growing the held packet as
+// needed.
+static bool streamAppend(struct coalesce_stream *stream, caerEventPacketHeader packet, const struct timespec *now) {
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	int32_t heldNumber = 0;
+	int32_t heldCapacity = 0;
+
+	if (stream->pending != NULL) {
+		heldNumber = caerEventPacketHeaderGetEventNumber(stream->pending);
+		heldCapacity = caerEventPacketHeaderGetEventCapacity(stream->pending);
+	}
+
+	if ((heldNumber + eventNumber) > heldCapacity) {
+		int32_t newCapacity = (heldCapacity == 0) ? (eventNumber * 4) : (heldCapacity * 2);
+		if (newCapacity < (heldNumber + eventNumber)) {
+			newCapacity = heldNumber + eventNumber;
+		}
+
+		caerEventPacketHeader newPending = realloc(stream->pending,
+			CAER_EVENT_PACKET_HEADER_SIZE + ((size_t) newCapacity * (size_t) eventSize));
+		if (newPending == NULL) {
+			return (false);
+		}
+
+		if (stream->pending == NULL) {
+			// Same layout as the packets it's made of.
+			memcpy(newPending, packet, CAER_EVENT_PACKET_HEADER_SIZE);
+			caerEventPacketHeaderSetEventNumber(newPending, 0);
+			caerEventPacketHeaderSetEventValid(newPending, 0);
+
+			stream->firstTimestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packet, 0), packet);
+			stream->firstArrival = *now;
+		}
+
+		caerEventPacketHeaderSetEventCapacity(newPending, newCapacity);
+		stream->pending = newPending;
+	}
+
+	memcpy(caerGenericEventGetEvent(stream->pending, heldNumber), caerGenericEventGetEvent(packet, 0),
+		(size_t) eventNumber * (size_t) eventSize);
+
+	caerEventPacketHeaderSetEventNumber(stream->pending, heldNumber + eventNumber);
+	caerEventPacketHeaderSetEventValid(stream->pending,
+		caerEventPacketHeaderGetEventValid(stream->pending) + caerEventPacketHeaderGetEventValid(packet));
+
+	return (true);
+}
+
+static bool streamDue(coalesceState state, struct coalesce_stream *stream, const struct timespec *now) {
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(stream->pending);
+
+	if (eventNumber >= state->packetSize) {
+		return (true);
+	}
+
+	int64_t lastTimestamp = caerGenericEventGetTimestamp64(
+		caerGenericEventGetEvent(stream->pending, eventNumber - 1), stream->pending);
+
+	if ((lastTimestamp - stream->firstTimestamp) >= state->packetInterval) {
+		return (true);
+	}
+
+	double waited = (double) (now->tv_sec - stream->firstArrival.tv_sec)
+		+ ((double) (now->tv_nsec - stream->firstArrival.tv_nsec) / 1000000000);
+
+	return (waited >= state->maxLatency);
+}
+
+static caerEventPacketHeader streamRelease(coalesceState state, struct coalesce_stream *stream) {
+	caerEventPacketHeader packet = stream->pending;
+	stream->pending = NULL;
+
+	caerMainloopFreeAfterLoop(&free, packet);
+
+	state->packetsOut++;
+
+	return (packet);
+}
+
+static void updateStatistics(caerModuleData moduleData, const struct timespec *now) {
+	coalesceState state = moduleData->moduleState;
+
+	double elapsed = (double) (now->tv_sec - state->statsTime.tv_sec)
+		+ ((double) (now->tv_nsec - state->statsTime.tv_nsec) / 1000000000);
+
+	if (elapsed < COALESCE_STATS_INTERVAL) {
+		return;
+	}
+
+	// Input packets per output packet, over the last interval.
+	int64_t packetsIn = state->packetsIn - state->statsPacketsIn;
+	int64_t packetsOut = state->packetsOut - state->statsPacketsOut;
+
+	if (packetsOut > 0) {
+		sshsNodePutDouble(moduleData->moduleNode, "coalescingRatio", (double) packetsIn / (double) packetsOut);
+	}
+
+	sshsNodePutLong(moduleData->moduleNode, "packetsIn", state->packetsIn);
+	sshsNodePutLong(moduleData->moduleNode, "packetsOut", state->packetsOut);
+
+	state->statsPacketsIn = state->packetsIn;
+	state->statsPacketsOut = state->packetsOut;
+	state->statsTime = *now;
+}
+
+// Tell the wake-up thread when the oldest held packet reaches maxLatency.
+static void updateWakeDeadline(coalesceState state) {
+	int64_t deadline = 0;
+
+	for (size_t i = 0; i < state->streamsLength; i++) {
+		if (state->streams[i].pending == NULL) {
+			continue;
+		}
+
+		int64_t due = timespecToMicro(&state->streams[i].firstArrival) + I64T(state->maxLatency * 1000000);
+
+		if (deadline == 0 || due < deadline) {
+			deadline = due;
+		}
+	}
+
+	mtx_lock(&state->wakeLock);
+
+	// Only wake the thread if there's something new to wait for.
+	if (deadline != state->wakeDeadline) {
+		state->wakeDeadline = deadline;
+		cnd_signal(&state->wakeSignal);
+	}
+
+	mtx_unlock(&state->wakeLock);
+}
+
+// Raise dataAvailable once the deadline passes, so the mainloop runs and
+// sends the held packet on. Raised only once until the run takes it back.
+static int wakeThread(void *stateArg) {
+	coalesceState state = stateArg;
+
+	mtx_lock(&state->wakeLock);
+
+	while (state->wakeRunning) {
+		if (state->wakeDeadline == 0 || state->wakeRaised) {
+			// Nothing held, or already raised: wait for the next deadline.
+			cnd_wait(&state->wakeSignal, &state->wakeLock);
+			continue;
+		}
+
+		struct timespec now;
+		portable_clock_gettime_monotonic(&now);
+
+		int64_t remaining = state->wakeDeadline - timespecToMicro(&now);
+
+		if (remaining <= 0) {
+			state->wakeRaised = true;
+			mainloopDataNotifyIncrease(state->mainloop);
+			continue;
+		}
+
+		// cnd_timedwait() takes a wall-clock time. Waking early (spurious
+		// wake-ups, clock changes) just checks the deadline again.
+		struct timespec wakeTime;
+		portable_clock_gettime_realtime(&wakeTime);
+
+		int64_t wakeNanos = I64T(wakeTime.tv_nsec) + ((remaining % 1000000) * 1000);
+		wakeTime.tv_sec += (time_t) ((remaining / 1000000) + (wakeNanos / 1000000000));
+		wakeTime.tv_nsec = (long) (wakeNanos % 1000000000);
+
+		cnd_timedwait(&state->wakeSignal, &state->wakeLock, &wakeTime);
+	}
+
+	mtx_unlock(&state->wakeLock);
+
+	return (thrd_success);
+}
+
+static void wakeThreadStop(coalesceState state) {
+	mtx_lock(&state->wakeLock);
+
+	state->wakeRunning = false;
+	cnd_signal(&state->wakeSignal);
+
+	mtx_unlock(&state->wakeLock);
+}
+
+static int64_t timespecToMicro(const struct timespec *time) {
+	return ((I64T(time->tv_sec) * 1000000LL) + (I64T(time->tv_nsec) / 1000));
+}
+
+static void mainloopDataNotifyIncrease(void *p) {
+	caerMainloopData mainloopData = p;
+
+	atomic_fetch_add_explicit(&mainloopData->dataAvailable, 1, memory_order_release);
+}
+
+static void mainloopDataNotifyDecrease(void *p) {
+	caerMainloopData mainloopData = p;
+
+	// No special memory order for decrease, because the acquire load to even start running
+	// through a mainloop already synchronizes with the release store above.
+	atomic_fetch_sub_explicit(&mainloopData->dataAvailable, 1, memory_order_relaxed);
+}
@@ -0,0 +1,19 @@
+/*
+ * coalesce.h
+ *
+ *  Joins consecutive small packets of the same source and event type, so
+ *  that the modules after it handle fewer, bigger packets.
+ */
+
+#ifndef COALESCE_H_
+#define COALESCE_H_
+
+#include "main.h"
+
+// Takes packetsNumber pointers to event packets (caerEventPacketHeader *).
+// Each packet is either passed on as it is, or taken and replaced by NULL;
+// taken events come out later through the same pointer, joined into one
+// packet with the ones that follow.
+void caerCoalesce(uint16_t moduleID, size_t packetsNumber, ...);
+
+#endif /* COALESCE_H_ */
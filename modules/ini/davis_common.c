@@ -1,35 +1,211 @@
 #include "davis_common.h"
+#include "ext/portable_time.h"
+#include "ext/uthash/uthash.h"
+#include "ext/uthash/utarray.h"
+
+#include <libcaer/events/special.h>
+#include <libcaer/events/frame.h>
+#include <math.h>
+
+// Rough number of bytes each event takes on USB, used to estimate the
+// transfer rate from the events received. Frames are sized per pixel.
+#define USB_TUNER_BYTES_PER_EVENT 4
+#define USB_TUNER_BYTES_PER_IMU6_EVENT 32
+
+// USB bulk transfers are made of 512 byte packets at high-speed.
+#define USB_TUNER_BUFFER_SIZE_ALIGN 512
+
+// Consecutive tuning intervals that must agree before buffers are shrunk.
+#define USB_TUNER_SHRINK_INTERVALS 3
+
+// Closed-loop tuning of the USB transfer buffers, driven by what arrives in
+// the packet containers. The module's state is the libcaer device handle,
+// so the tuner lives separately, one per module. Init, Run and Exit always
+// happen in the thread of the module's mainloop, so no locking is needed.
+struct davis_usb_tuner {
+	UT_hash_handle hh;
+	uint16_t moduleID;
+	sshsNode usbNode;
+	sshsNode sysNode;
+	double interval; // In seconds.
+	struct timespec intervalStart;
+	struct timespec lastContainer;
+	bool lastContainerValid;
+	// Statistics for the current tuning interval.
+	uint64_t bytes;
+	uint64_t events;
+	uint64_t rowOnlyEvents;
+	uint64_t containers;
+	double containerIntervals; // In seconds.
+	uint64_t polarityPackets;
+	double polarityFill;
+	// Decisions.
+	uint32_t shrinkIntervals;
+	int64_t totalRowOnlyEvents;
+	int64_t adjustments;
+};
+
+typedef struct davis_usb_tuner *davisUSBTuner;
+
+static _Thread_local davisUSBTuner glUSBTuners = NULL;
+
+// Packets are sized to hold this many times the events expected per interval,
+// so that they're normally committed on time and not on size.
+#define PACKET_TUNER_SIZE_HEADROOM 2
+
+// Smallest packet sizes for the rarer event types.
+#define PACKET_TUNER_SPECIAL_SIZE_MIN 16
+#define PACKET_TUNER_IMU6_SIZE_MIN 4
+
+// Smaller relative changes to the container interval are ignored, in percent.
+#define PACKET_TUNER_INTERVAL_HYSTERESIS 10
+
+// The interval is only shrunk while the CPU load is below this percentage of
+// the budget, and only as far as the load is predicted to stay below it, so
+// that there's a band between shrinking and growing again.
+#define PACKET_TUNER_SHRINK_LOAD 75
+
+// Consecutive tuning intervals that must agree before the interval is shrunk.
+#define PACKET_TUNER_SHRINK_INTERVALS 3
+
+// Closed-loop sizing of packets and containers: as short an interval as the
+// target latency asks for, as long as the mainloop stays within its CPU
+// budget, which at high event rates means larger batches. Like the USB tuner,
+// this lives next to the module, in the module's mainloop thread.
+struct davis_packet_tuner {
+	UT_hash_handle hh;
+	uint16_t moduleID;
+	sshsNode sysNode;
+	double interval; // In seconds.
+	struct timespec intervalStart;
+	struct timespec cpuStart;
+	// Statistics for the current tuning interval.
+	uint64_t containers;
+	uint64_t polarityEvents;
+	uint64_t specialEvents;
+	uint64_t imu6Events;
+	// Decisions.
+	uint32_t shrinkIntervals;
+	int64_t adjustments;
+};
+
+typedef struct davis_packet_tuner *davisPacketTuner;
+
+static _Thread_local davisPacketTuner glPacketTuners = NULL;
+
+// One device configuration parameter, as passed to glBackend->configSet().
+struct davis_config_param {
+	int8_t modAddr;
+	uint8_t paramAddr;
+	uint32_t param;
+};
+
+static const UT_icd ut_davisConfigParam_icd = { sizeof(struct davis_config_param), NULL, NULL, NULL };
+
+// The configuration a device held when its module last stopped, sorted for
+// lookup. A device keeps it for as long as it stays connected, so a restart
+// only has to upload what changed since. Reconnecting a device changes its
+// USB address, and with that its device string, which invalidates this.
+struct davis_config_shadow {
+	UT_hash_handle hh;
+	uint16_t moduleID;
+	char *deviceString;
+	UT_array *params;
+	struct timespec stopTime;
+};
+
+typedef struct davis_config_shadow *davisConfigShadow;
+
+static _Thread_local davisConfigShadow glConfigShadows = NULL;
+
+// Watches over the device across disconnects. A device lost while running
+// is looked for again every ReconnectInterval ms, by its serial number, as
+// it may come back on another USB port, and restarted with the current
+// configuration. Outlives the module's restarts, like the shadow above.
+struct davis_supervisor {
+	UT_hash_handle hh;
+	uint16_t moduleID;
+	sshsNode moduleNode;
+	// Set from the device's data acquisition thread when it dies.
+	atomic_bool deviceLost;
+	struct timespec lostTime;
+	// An outage lasts from the loss to the first data afterwards.
+	bool outage;
+	struct timespec outageStart;
+	char serialNumber[8 + 1];
+	int64_t attempts;
+	struct timespec lastAttempt;
+	bool reopened;
+	struct timespec reopenTime;
+	// Statistics.
+	int64_t disconnects;
+	int64_t totalOutageTime;
+};
+
+typedef struct davis_supervisor *davisSupervisor;
+
+static _Thread_local davisSupervisor glSupervisors = NULL;
+
+// All device access goes through a backend, libcaer's unless another one,
+// like a fake device for testing, was set before the mainloops started.
+static const struct caer_input_davis_backend libcaerBackend = { .open = &caerDeviceOpen, .close =
+	&caerDeviceClose, .dataStart = &caerDeviceDataStart, .dataStop = &caerDeviceDataStop, .dataGet =
+	&caerDeviceDataGet, .configSet = &caerDeviceConfigSet, .configGet = &caerDeviceConfigGet, .infoGet =
+	&caerDavisInfoGet };
+
+static const struct caer_input_davis_backend *glBackend = &libcaerBackend;
 
 static void createDefaultConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo);
 static void sendDefaultConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo);
+static void collectConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo, UT_array *batch);
+static void configBatchAdd(UT_array *batch, int8_t modAddr, uint8_t paramAddr, uint32_t param);
+static int configParamCompare(const void *a, const void *b);
+static bool configParamIsCommand(const struct davis_config_param *param);
+static bool configParamIsSet(caerDeviceHandle handle, UT_array *deviceParams, const struct davis_config_param *param);
+static void configShadowSave(caerModuleData moduleData, struct caer_davis_info *devInfo);
 static void mainloopDataNotifyIncrease(void *p);
 static void mainloopDataNotifyDecrease(void *p);
 static void moduleShutdownNotify(void *p);
-static void biasConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo);
+static davisSupervisor supervisorGet(caerModuleData moduleData);
+static bool supervisorAttemptDue(caerModuleData moduleData, davisSupervisor supervisor);
+static void supervisorDeviceLost(caerModuleData moduleData, davisSupervisor supervisor,
+	struct caer_davis_info *devInfo);
+static void supervisorUpdate(caerModuleData moduleData, caerEventPacketContainer container);
+static void biasConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo);
 static void biasConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void chipConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo);
+static void chipConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo);
 static void chipConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void muxConfigSend(sshsNode node, caerModuleData moduleData);
+static void muxConfigSend(sshsNode node, UT_array *batch);
 static void muxConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void dvsConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo);
+static void dvsConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo);
 static void dvsConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void apsConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo);
+static void apsConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo);
 static void apsConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void imuConfigSend(sshsNode node, caerModuleData moduleData);
+static void imuConfigSend(sshsNode node, UT_array *batch);
 static void imuConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void extInputConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo);
+static void extInputConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo);
 static void extInputConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void usbConfigSend(sshsNode node, caerModuleData moduleData);
+static void usbConfigSend(sshsNode node, UT_array *batch);
 static void usbConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
-static void systemConfigSend(sshsNode node, caerModuleData moduleData);
+static void systemConfigSend(sshsNode node, UT_array *batch);
+static void usbTunerInit(caerModuleData moduleData, sshsNode usbNode);
+static void usbTunerExit(caerModuleData moduleData);
+static void usbTunerUpdate(caerModuleData moduleData, caerEventPacketContainer container);
+static void usbTunerDecide(davisUSBTuner tuner, const char *subSystemString, double elapsed);
+static int32_t usbTunerClamp(int32_t value, int32_t min, int32_t max);
+static void packetTunerInit(caerModuleData moduleData, sshsNode sysNode);
+static void packetTunerExit(caerModuleData moduleData);
+static void packetTunerUpdate(caerModuleData moduleData, caerEventPacketContainer container);
+static void packetTunerDecide(davisPacketTuner tuner, const char *subSystemString, double elapsed, double cpuTime);
+static int32_t packetTunerSize(double eventRate, int32_t interval, int32_t min, int32_t max);
 static void systemConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 static void createVDACBiasSetting(caerModuleData moduleData, sshsNode biasNode, const char *biasName,
@@ -94,6 +270,9 @@ static inline const char *chipIDToName(int16_t chipID) {
 bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType) {
 	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Initializing module ...");
 
+	struct timespec startupStart;
+	portable_clock_gettime_monotonic(&startupStart);
+
 	// USB port/bus/SN settings/restrictions.
 	// These can be used to force connection to one specific device at startup.
 	sshsNodePutShortIfAbsent(moduleData->moduleNode, "BusNumber", 0);
@@ -103,12 +282,45 @@ bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType) {
 	// Add auto-restart setting.
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "Auto-Restart", true);
 
+	// After the device was lost (with Auto-Restart): how often to look for it
+	// again in ms, and whether only the same device, by serial number, will do.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "ReconnectInterval", 1000);
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "ReconnectSameDevice", true);
+
+	// Outage statistics, read-only.
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "Disconnects", 0);
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "ReconnectAttempts", 0);
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "ReconnectLatency", 0);
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "OutageTime", 0);
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "TotalOutageTime", 0);
+
+	davisSupervisor supervisor = supervisorGet(moduleData);
+	if (supervisor == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for device supervisor.");
+		return (false);
+	}
+
+	if (!supervisorAttemptDue(moduleData, supervisor)) {
+		return (false);
+	}
+
 	/// Start data acquisition, and correctly notify mainloop of new data and module of exceptional
 	// shutdown cases (device pulled, ...).
 	char *serialNumber = sshsNodeGetString(moduleData->moduleNode, "SerialNumber");
-	moduleData->moduleState = caerDeviceOpen(moduleData->moduleID, deviceType,
-		U8T(sshsNodeGetShort(moduleData->moduleNode, "BusNumber")),
-		U8T(sshsNodeGetShort(moduleData->moduleNode, "DevAddress")), serialNumber);
+	const char *serialNumberRestrict = serialNumber;
+	uint8_t busNumberRestrict = U8T(sshsNodeGetShort(moduleData->moduleNode, "BusNumber"));
+	uint8_t devAddressRestrict = U8T(sshsNodeGetShort(moduleData->moduleNode, "DevAddress"));
+
+	// A replugged device gets a new USB address, so look for the lost one by
+	// its serial number only.
+	if (supervisor->outage && sshsNodeGetBool(moduleData->moduleNode, "ReconnectSameDevice")) {
+		serialNumberRestrict = supervisor->serialNumber;
+		busNumberRestrict = 0;
+		devAddressRestrict = 0;
+	}
+
+	moduleData->moduleState = glBackend->open(moduleData->moduleID, deviceType, busNumberRestrict, devAddressRestrict,
+		serialNumberRestrict);
 	free(serialNumber);
 
 	if (moduleData->moduleState == NULL) {
@@ -116,8 +328,13 @@ bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType) {
 		return (false);
 	}
 
+	if (supervisor->outage) {
+		supervisor->reopened = true;
+		supervisor->reopenTime = startupStart;
+	}
+
 	// Put global source information into SSHS.
-	struct caer_davis_info devInfo = caerDavisInfoGet(moduleData->moduleState);
+	struct caer_davis_info devInfo = glBackend->infoGet(moduleData->moduleState);
 
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
 
@@ -147,11 +364,11 @@ bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType) {
 	// Ensure good defaults for data acquisition settings.
 	// No blocking behavior due to mainloop notification, and no auto-start of
 	// all producers to ensure cAER settings are respected.
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_DATAEXCHANGE,
+	glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_DATAEXCHANGE,
 	CAER_HOST_CONFIG_DATAEXCHANGE_BLOCKING, false);
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_DATAEXCHANGE,
+	glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_DATAEXCHANGE,
 	CAER_HOST_CONFIG_DATAEXCHANGE_START_PRODUCERS, false);
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_DATAEXCHANGE,
+	glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_DATAEXCHANGE,
 	CAER_HOST_CONFIG_DATAEXCHANGE_STOP_PRODUCERS, true);
 
 	// Create default settings and send them to the device.
@@ -159,12 +376,12 @@ bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType) {
 	sendDefaultConfiguration(moduleData, &devInfo);
 
 	// Start data acquisition.
-	bool ret = caerDeviceDataStart(moduleData->moduleState, &mainloopDataNotifyIncrease, &mainloopDataNotifyDecrease,
-		caerMainloopGetReference(), &moduleShutdownNotify, moduleData->moduleNode);
+	bool ret = glBackend->dataStart(moduleData->moduleState, &mainloopDataNotifyIncrease, &mainloopDataNotifyDecrease,
+		caerMainloopGetReference(), &moduleShutdownNotify, supervisor);
 
 	if (!ret) {
 		// Failed to start data acquisition, close device and exit.
-		caerDeviceClose((caerDeviceHandle *) &moduleData->moduleState);
+		glBackend->close((caerDeviceHandle *) &moduleData->moduleState);
 
 		return (false);
 	}
@@ -194,9 +411,13 @@ bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType) {
 	sshsNode usbNode = sshsGetRelativeNode(deviceConfigNode, "usb/");
 	sshsNodeAddAttributeListener(usbNode, moduleData, &usbConfigListener);
 
+	usbTunerInit(moduleData, usbNode);
+
 	sshsNode sysNode = sshsGetRelativeNode(moduleData->moduleNode, "system/");
 	sshsNodeAddAttributeListener(sysNode, moduleData, &systemConfigListener);
 
+	packetTunerInit(moduleData, sysNode);
+
 	sshsNode biasNode = sshsGetRelativeNode(deviceConfigNode, "bias/");
 
 	size_t biasNodesLength = 0;
@@ -211,12 +432,38 @@ bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType) {
 		free(biasNodes);
 	}
 
+	// Startup time, and for restarts also how long the module was down, which
+	// on a replugged device is how long the data stream stalled.
+	struct timespec startupEnd;
+	portable_clock_gettime_monotonic(&startupEnd);
+
+	int64_t startupTime = I64T(startupEnd.tv_sec - startupStart.tv_sec) * 1000000LL
+		+ I64T(startupEnd.tv_nsec - startupStart.tv_nsec) / 1000;
+
+	sshsNodePutLong(moduleData->moduleNode, "StartupTime", startupTime);
+
+	davisConfigShadow shadow = NULL;
+	HASH_FIND(hh, glConfigShadows, &moduleData->moduleID, sizeof(uint16_t), shadow);
+
+	if (shadow != NULL) {
+		int64_t reconnectTime = I64T(startupEnd.tv_sec - shadow->stopTime.tv_sec) * 1000000LL
+			+ I64T(startupEnd.tv_nsec - shadow->stopTime.tv_nsec) / 1000;
+
+		sshsNodePutLong(moduleData->moduleNode, "ReconnectTime", reconnectTime);
+
+		caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString,
+			"Restarted in %" PRIi64 " µs, down for %" PRIi64 " µs in total.", startupTime, reconnectTime);
+	}
+	else {
+		caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "Started in %" PRIi64 " µs.", startupTime);
+	}
+
 	return (true);
 }
 
 void caerInputDAVISExit(caerModuleData moduleData) {
 	// Device related configuration has its own sub-node.
-	struct caer_davis_info devInfo = caerDavisInfoGet(moduleData->moduleState);
+	struct caer_davis_info devInfo = glBackend->infoGet(moduleData->moduleState);
 	sshsNode deviceConfigNode = sshsGetRelativeNode(moduleData->moduleNode, chipIDToName(devInfo.chipID));
 
 	// Remove listener, which can reference invalid memory in userData.
@@ -241,9 +488,13 @@ void caerInputDAVISExit(caerModuleData moduleData) {
 	sshsNode usbNode = sshsGetRelativeNode(deviceConfigNode, "usb/");
 	sshsNodeRemoveAttributeListener(usbNode, moduleData, &usbConfigListener);
 
+	usbTunerExit(moduleData);
+
 	sshsNode sysNode = sshsGetRelativeNode(moduleData->moduleNode, "system/");
 	sshsNodeRemoveAttributeListener(sysNode, moduleData, &systemConfigListener);
 
+	packetTunerExit(moduleData);
+
 	sshsNode biasNode = sshsGetRelativeNode(deviceConfigNode, "bias/");
 
 	size_t biasNodesLength = 0;
@@ -258,9 +509,23 @@ void caerInputDAVISExit(caerModuleData moduleData) {
 		free(biasNodes);
 	}
 
-	caerDeviceDataStop(moduleData->moduleState);
+	// Remember what the device holds, before stopping changes anything.
+	configShadowSave(moduleData, &devInfo);
 
-	caerDeviceClose((caerDeviceHandle *) &moduleData->moduleState);
+	davisSupervisor supervisor = supervisorGet(moduleData);
+
+	if (supervisor != NULL && atomic_load_explicit(&supervisor->deviceLost, memory_order_acquire)) {
+		supervisorDeviceLost(moduleData, supervisor, &devInfo);
+	}
+
+	glBackend->dataStop(moduleData->moduleState);
+
+	glBackend->close((caerDeviceHandle *) &moduleData->moduleState);
+
+	// Stopping may notify too, that's no loss.
+	if (supervisor != NULL) {
+		atomic_store_explicit(&supervisor->deviceLost, false, memory_order_relaxed);
+	}
 
 	if (sshsNodeGetBool(moduleData->moduleNode, "Auto-Restart")) {
 		// Prime input module again so that it will try to restart if new devices detected.
@@ -274,11 +539,31 @@ void caerInputDAVISRun(caerModuleData moduleData, size_t argsNumber, va_list arg
 	// Interpret variable arguments (same as above in main function).
 	caerEventPacketContainer *container = va_arg(args, caerEventPacketContainer *);
 
-	*container = caerDeviceDataGet(moduleData->moduleState);
+	*container = glBackend->dataGet(moduleData->moduleState);
 
 	if (*container != NULL) {
 		caerMainloopFreeAfterLoop((void (*)(void *)) &caerEventPacketContainerFree, *container);
 	}
+
+	usbTunerUpdate(moduleData, *container);
+	packetTunerUpdate(moduleData, *container);
+	supervisorUpdate(moduleData, *container);
+}
+
+void caerInputDAVISCreateConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo) {
+	createDefaultConfiguration(moduleData, devInfo);
+}
+
+const char *caerInputDAVISChipName(int16_t chipID) {
+	return (chipIDToName(chipID));
+}
+
+void caerInputDAVISSetBackend(const struct caer_input_davis_backend *backend) {
+	glBackend = (backend != NULL) ? (backend) : (&libcaerBackend);
+}
+
+bool caerInputDAVISConfigSet(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t param) {
+	return (glBackend->configSet(handle, modAddr, paramAddr, param));
 }
 
 static void createDefaultConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo) {
@@ -639,6 +924,18 @@ static void createDefaultConfiguration(caerModuleData moduleData, struct caer_da
 	sshsNodePutIntIfAbsent(usbNode, "BufferNumber", 8);
 	sshsNodePutIntIfAbsent(usbNode, "BufferSize", 8192);
 
+	// Automatically adjust BufferNumber and BufferSize to the data rate, within
+	// these bounds. Each buffer should fill up within BufferTargetLatency µs,
+	// and all of them together hold BufferTargetCapacity ms of data.
+	sshsNodePutBoolIfAbsent(usbNode, "BufferAutoTune", false);
+	sshsNodePutIntIfAbsent(usbNode, "BufferAutoTuneInterval", 1000); // In ms.
+	sshsNodePutIntIfAbsent(usbNode, "BufferNumberMin", 4);
+	sshsNodePutIntIfAbsent(usbNode, "BufferNumberMax", 64);
+	sshsNodePutIntIfAbsent(usbNode, "BufferSizeMin", 1024);
+	sshsNodePutIntIfAbsent(usbNode, "BufferSizeMax", 65536);
+	sshsNodePutIntIfAbsent(usbNode, "BufferTargetLatency", 1000);
+	sshsNodePutIntIfAbsent(usbNode, "BufferTargetCapacity", 20);
+
 	sshsNode sysNode = sshsGetRelativeNode(moduleData->moduleNode, "system/");
 
 	// Packet settings (size (in events) and time interval (in µs)).
@@ -653,24 +950,200 @@ static void createDefaultConfiguration(caerModuleData moduleData, struct caer_da
 	sshsNodePutIntIfAbsent(sysNode, "IMU6PacketMaxSize", 8);
 	sshsNodePutIntIfAbsent(sysNode, "IMU6PacketMaxInterval", 5000);
 
+	// Automatically adjust the above packet settings to the event rate. The
+	// container interval is kept short enough to meet PacketTargetLatency µs,
+	// unless the mainloop thread uses more than PacketTargetCPU percent of a
+	// core, in which case larger batches are made. Frame packets are left
+	// alone, as exposure and readout dominate their latency anyway.
+	sshsNodePutBoolIfAbsent(sysNode, "PacketAutoTune", false);
+	sshsNodePutIntIfAbsent(sysNode, "PacketAutoTuneInterval", 1000); // In ms.
+	sshsNodePutIntIfAbsent(sysNode, "PacketTargetLatency", 2000);
+	sshsNodePutIntIfAbsent(sysNode, "PacketTargetCPU", 50);
+	sshsNodePutIntIfAbsent(sysNode, "PacketIntervalMin", 250);
+	sshsNodePutIntIfAbsent(sysNode, "PacketIntervalMax", 100000);
+	sshsNodePutIntIfAbsent(sysNode, "PacketSizeMin", 256);
+	sshsNodePutIntIfAbsent(sysNode, "PacketSizeMax", 131072);
+
 	// Ring-buffer setting (only changes value on module init/shutdown cycles).
 	sshsNodePutIntIfAbsent(sysNode, "DataExchangeBufferSize", 64);
 }
 
-static void sendDefaultConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo) {
+static void collectConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo, UT_array *batch) {
 	// Device related configuration has its own sub-node.
 	sshsNode deviceConfigNode = sshsGetRelativeNode(moduleData->moduleNode, chipIDToName(devInfo->chipID));
 
-	// Send cAER configuration to libcaer and device.
-	biasConfigSend(sshsGetRelativeNode(deviceConfigNode, "bias/"), moduleData, devInfo);
-	chipConfigSend(sshsGetRelativeNode(deviceConfigNode, "chip/"), moduleData, devInfo);
-	systemConfigSend(sshsGetRelativeNode(moduleData->moduleNode, "system/"), moduleData);
-	usbConfigSend(sshsGetRelativeNode(deviceConfigNode, "usb/"), moduleData);
-	muxConfigSend(sshsGetRelativeNode(deviceConfigNode, "multiplexer/"), moduleData);
-	dvsConfigSend(sshsGetRelativeNode(deviceConfigNode, "dvs/"), moduleData, devInfo);
-	apsConfigSend(sshsGetRelativeNode(deviceConfigNode, "aps/"), moduleData, devInfo);
-	imuConfigSend(sshsGetRelativeNode(deviceConfigNode, "imu/"), moduleData);
-	extInputConfigSend(sshsGetRelativeNode(deviceConfigNode, "externalInput/"), moduleData, devInfo);
+	// Collect cAER configuration, in the order it has to reach libcaer and device.
+	biasConfigSend(sshsGetRelativeNode(deviceConfigNode, "bias/"), batch, devInfo);
+	chipConfigSend(sshsGetRelativeNode(deviceConfigNode, "chip/"), batch, devInfo);
+	systemConfigSend(sshsGetRelativeNode(moduleData->moduleNode, "system/"), batch);
+	usbConfigSend(sshsGetRelativeNode(deviceConfigNode, "usb/"), batch);
+	muxConfigSend(sshsGetRelativeNode(deviceConfigNode, "multiplexer/"), batch);
+	dvsConfigSend(sshsGetRelativeNode(deviceConfigNode, "dvs/"), batch, devInfo);
+	apsConfigSend(sshsGetRelativeNode(deviceConfigNode, "aps/"), batch, devInfo);
+	imuConfigSend(sshsGetRelativeNode(deviceConfigNode, "imu/"), batch);
+	extInputConfigSend(sshsGetRelativeNode(deviceConfigNode, "externalInput/"), batch, devInfo);
+}
+
+static void sendDefaultConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo) {
+	UT_array *batch;
+	utarray_new(batch, &ut_davisConfigParam_icd);
+
+	collectConfiguration(moduleData, devInfo, batch);
+
+	// What the device still holds from when the module last stopped, if it
+	// has stayed connected since.
+	davisConfigShadow shadow = NULL;
+	HASH_FIND(hh, glConfigShadows, &moduleData->moduleID, sizeof(uint16_t), shadow);
+
+	UT_array *deviceParams = NULL;
+	if (shadow != NULL && caerStrEquals(shadow->deviceString, devInfo->deviceString)) {
+		deviceParams = shadow->params;
+	}
+
+	struct timespec uploadStart, uploadEnd;
+	portable_clock_gettime_monotonic(&uploadStart);
+
+	int32_t uploaded = 0;
+	int32_t skipped = 0;
+	int32_t failed = 0;
+
+	struct davis_config_param *param = NULL;
+	while ((param = (struct davis_config_param *) utarray_next(batch, param)) != NULL) {
+		if (configParamIsSet(moduleData->moduleState, deviceParams, param)) {
+			skipped++;
+			continue;
+		}
+
+		if (!glBackend->configSet(moduleData->moduleState, param->modAddr, param->paramAddr, param->param)) {
+			failed++;
+		}
+
+		uploaded++;
+	}
+
+	portable_clock_gettime_monotonic(&uploadEnd);
+
+	utarray_free(batch);
+
+	int64_t uploadTime = I64T(uploadEnd.tv_sec - uploadStart.tv_sec) * 1000000LL
+		+ I64T(uploadEnd.tv_nsec - uploadStart.tv_nsec) / 1000;
+
+	if (failed > 0) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Failed to upload %" PRIi32 " of %" PRIi32 " configuration parameters.", failed, uploaded);
+	}
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString,
+		"Uploaded %" PRIi32 " configuration parameters in %" PRIi64 " µs, %" PRIi32 " were already set.", uploaded,
+		uploadTime, skipped);
+
+	sshsNodePutLong(moduleData->moduleNode, "ConfigUploadTime", uploadTime);
+	sshsNodePutInt(moduleData->moduleNode, "ConfigUploaded", uploaded);
+	sshsNodePutInt(moduleData->moduleNode, "ConfigSkipped", skipped);
+}
+
+static void configBatchAdd(UT_array *batch, int8_t modAddr, uint8_t paramAddr, uint32_t param) {
+	struct davis_config_param configParam = { .modAddr = modAddr, .paramAddr = paramAddr, .param = param };
+
+	utarray_push_back(batch, &configParam);
+}
+
+static int configParamCompare(const void *a, const void *b) {
+	const struct davis_config_param *aa = a;
+	const struct davis_config_param *bb = b;
+
+	if (aa->modAddr != bb->modAddr) {
+		return ((aa->modAddr < bb->modAddr) ? (-1) : (1));
+	}
+
+	if (aa->paramAddr != bb->paramAddr) {
+		return ((aa->paramAddr < bb->paramAddr) ? (-1) : (1));
+	}
+
+	return (0);
+}
+
+static bool configParamIsCommand(const struct davis_config_param *param) {
+	// These start or stop parts of the device, or trigger an action, and are
+	// also changed by libcaer when stopping, so they're always sent.
+	switch (param->modAddr) {
+		case DAVIS_CONFIG_MUX:
+			return (param->paramAddr == DAVIS_CONFIG_MUX_RUN || param->paramAddr == DAVIS_CONFIG_MUX_TIMESTAMP_RUN
+				|| param->paramAddr == DAVIS_CONFIG_MUX_TIMESTAMP_RESET
+				|| param->paramAddr == DAVIS_CONFIG_MUX_FORCE_CHIP_BIAS_ENABLE);
+
+		case DAVIS_CONFIG_DVS:
+			return (param->paramAddr == DAVIS_CONFIG_DVS_RUN);
+
+		case DAVIS_CONFIG_APS:
+			return (param->paramAddr == DAVIS_CONFIG_APS_RUN || param->paramAddr == DAVIS_CONFIG_APS_SNAPSHOT);
+
+		case DAVIS_CONFIG_IMU:
+			return (param->paramAddr == DAVIS_CONFIG_IMU_RUN);
+
+		case DAVIS_CONFIG_EXTINPUT:
+			return (param->paramAddr == DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR
+				|| param->paramAddr == DAVIS_CONFIG_EXTINPUT_RUN_GENERATOR);
+
+		case DAVIS_CONFIG_USB:
+			return (param->paramAddr == DAVIS_CONFIG_USB_RUN);
+
+		default:
+			return (false);
+	}
+}
+
+static bool configParamIsSet(caerDeviceHandle handle, UT_array *deviceParams, const struct davis_config_param *param) {
+	if (configParamIsCommand(param)) {
+		return (false);
+	}
+
+	if (param->modAddr < 0) {
+		// Host-side configuration is kept by libcaer, so reading it is free.
+		uint32_t currentValue = 0;
+
+		return (glBackend->configGet(handle, param->modAddr, param->paramAddr, &currentValue)
+			&& currentValue == param->param);
+	}
+
+	if (deviceParams == NULL) {
+		return (false);
+	}
+
+	const struct davis_config_param *deviceParam = utarray_find(deviceParams, param, &configParamCompare);
+
+	return (deviceParam != NULL && deviceParam->param == param->param);
+}
+
+static void configShadowSave(caerModuleData moduleData, struct caer_davis_info *devInfo) {
+	davisConfigShadow shadow = NULL;
+	HASH_FIND(hh, glConfigShadows, &moduleData->moduleID, sizeof(uint16_t), shadow);
+
+	if (shadow == NULL) {
+		shadow = calloc(1, sizeof(struct davis_config_shadow));
+		if (shadow == NULL) {
+			return;
+		}
+
+		shadow->moduleID = moduleData->moduleID;
+		utarray_new(shadow->params, &ut_davisConfigParam_icd);
+
+		HASH_ADD(hh, glConfigShadows, moduleID, sizeof(uint16_t), shadow);
+	}
+
+	free(shadow->deviceString);
+	shadow->deviceString = strdup(devInfo->deviceString);
+
+	// Listeners keep the device in sync with SSHS while running, so the
+	// current configuration is what the device holds.
+	utarray_clear(shadow->params);
+
+	if (shadow->deviceString != NULL) {
+		collectConfiguration(moduleData, devInfo, shadow->params);
+		utarray_sort(shadow->params, &configParamCompare);
+	}
+
+	portable_clock_gettime_monotonic(&shadow->stopTime);
 }
 
 static void mainloopDataNotifyIncrease(void *p) {
@@ -688,212 +1161,323 @@ static void mainloopDataNotifyDecrease(void *p) {
 }
 
 static void moduleShutdownNotify(void *p) {
-	sshsNode moduleNode = p;
+	davisSupervisor supervisor = p;
+
+	// The device stopped on its own, tell the supervisor it's lost.
+	portable_clock_gettime_monotonic(&supervisor->lostTime);
+	atomic_store_explicit(&supervisor->deviceLost, true, memory_order_release);
 
 	// Ensure parent also shuts down (on disconnected device for example).
-	sshsNodePutBool(moduleNode, "shutdown", true);
+	sshsNodePutBool(supervisor->moduleNode, "shutdown", true);
+}
+
+static davisSupervisor supervisorGet(caerModuleData moduleData) {
+	davisSupervisor supervisor = NULL;
+	HASH_FIND(hh, glSupervisors, &moduleData->moduleID, sizeof(uint16_t), supervisor);
+
+	if (supervisor == NULL) {
+		supervisor = calloc(1, sizeof(struct davis_supervisor));
+		if (supervisor == NULL) {
+			return (NULL);
+		}
+
+		supervisor->moduleID = moduleData->moduleID;
+		supervisor->moduleNode = moduleData->moduleNode;
+		atomic_init(&supervisor->deviceLost, false);
+
+		HASH_ADD(hh, glSupervisors, moduleID, sizeof(uint16_t), supervisor);
+	}
+
+	return (supervisor);
+}
+
+// During an outage, only try to open the device every ReconnectInterval ms:
+// other sources may run the mainloop far more often than that.
+static bool supervisorAttemptDue(caerModuleData moduleData, davisSupervisor supervisor) {
+	supervisor->reopened = false;
+
+	if (!supervisor->outage) {
+		return (true);
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	int64_t sinceLastAttempt = I64T(now.tv_sec - supervisor->lastAttempt.tv_sec) * 1000000LL
+		+ I64T(now.tv_nsec - supervisor->lastAttempt.tv_nsec) / 1000;
+
+	if (supervisor->attempts > 0
+		&& sinceLastAttempt < I64T(sshsNodeGetInt(moduleData->moduleNode, "ReconnectInterval")) * 1000LL) {
+		return (false);
+	}
+
+	supervisor->lastAttempt = now;
+	supervisor->attempts++;
+
+	sshsNodePutLong(moduleData->moduleNode, "ReconnectAttempts", supervisor->attempts);
+
+	return (true);
+}
+
+static void supervisorDeviceLost(caerModuleData moduleData, davisSupervisor supervisor,
+	struct caer_davis_info *devInfo) {
+	// Lost again before any data came: still the same outage.
+	if (!supervisor->outage) {
+		supervisor->outage = true;
+		supervisor->outageStart = supervisor->lostTime;
+		supervisor->attempts = 0;
+
+		strncpy(supervisor->serialNumber, devInfo->deviceSerialNumber, 8);
+		supervisor->serialNumber[8] = '\0';
+
+		supervisor->disconnects++;
+		sshsNodePutLong(moduleData->moduleNode, "Disconnects", supervisor->disconnects);
+	}
+
+	if (sshsNodeGetBool(moduleData->moduleNode, "Auto-Restart")) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Device lost, looking for it again every %" PRIi32 " ms.",
+			sshsNodeGetInt(moduleData->moduleNode, "ReconnectInterval"));
+	}
+	else {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString, "Device lost, Auto-Restart is disabled.");
+	}
+}
+
+// The first data from the device after an outage ends it.
+static void supervisorUpdate(caerModuleData moduleData, caerEventPacketContainer container) {
+	if (container == NULL) {
+		return;
+	}
+
+	davisSupervisor supervisor = NULL;
+	HASH_FIND(hh, glSupervisors, &moduleData->moduleID, sizeof(uint16_t), supervisor);
+
+	if (supervisor == NULL || !supervisor->outage || !supervisor->reopened) {
+		return;
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	int64_t outageTime = I64T(now.tv_sec - supervisor->outageStart.tv_sec) * 1000000LL
+		+ I64T(now.tv_nsec - supervisor->outageStart.tv_nsec) / 1000;
+	int64_t reconnectLatency = I64T(now.tv_sec - supervisor->reopenTime.tv_sec) * 1000000LL
+		+ I64T(now.tv_nsec - supervisor->reopenTime.tv_nsec) / 1000;
+
+	supervisor->totalOutageTime += outageTime;
+	supervisor->outage = false;
+	supervisor->reopened = false;
+
+	sshsNodePutLong(moduleData->moduleNode, "OutageTime", outageTime);
+	sshsNodePutLong(moduleData->moduleNode, "TotalOutageTime", supervisor->totalOutageTime);
+	sshsNodePutLong(moduleData->moduleNode, "ReconnectLatency", reconnectLatency);
+
+	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString,
+		"Device back after %" PRIi64 " attempts, data stalled for %" PRIi64 " µs, %" PRIi64 " µs of it to restart.",
+		supervisor->attempts, outageTime, reconnectLatency);
 }
 
-static void biasConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo) {
+static void biasConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo) {
 	// All chips of a kind have the same bias address for the same bias!
 	if (IS_DAVIS240(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFBN,
 			generateCoarseFineBiasParent(node, "DiffBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_ONBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_ONBN,
 			generateCoarseFineBiasParent(node, "OnBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_OFFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_OFFBN,
 			generateCoarseFineBiasParent(node, "OffBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSCASEPC,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSCASEPC,
 			generateCoarseFineBiasParent(node, "ApsCasEpc"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFCASBNC,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFCASBNC,
 			generateCoarseFineBiasParent(node, "DiffCasBnc"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSROSFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSROSFBN,
 			generateCoarseFineBiasParent(node, "ApsROSFBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LOCALBUFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LOCALBUFBN,
 			generateCoarseFineBiasParent(node, "LocalBufBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PIXINVBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PIXINVBN,
 			generateCoarseFineBiasParent(node, "PixInvBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRBP,
 			generateCoarseFineBiasParent(node, "PrBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRSFBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRSFBP,
 			generateCoarseFineBiasParent(node, "PrSFBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_REFRBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_REFRBP,
 			generateCoarseFineBiasParent(node, "RefrBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPDBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPDBN,
 			generateCoarseFineBiasParent(node, "AEPdBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LCOLTIMEOUTBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LCOLTIMEOUTBN,
 			generateCoarseFineBiasParent(node, "LcolTimeoutBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUXBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUXBP,
 			generateCoarseFineBiasParent(node, "AEPuXBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUYBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUYBP,
 			generateCoarseFineBiasParent(node, "AEPuYBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFTHRBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFTHRBN,
 			generateCoarseFineBiasParent(node, "IFThrBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFREFRBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFREFRBN,
 			generateCoarseFineBiasParent(node, "IFRefrBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PADFOLLBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PADFOLLBN,
 			generateCoarseFineBiasParent(node, "PadFollBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSOVERFLOWLEVELBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSOVERFLOWLEVELBN,
 			generateCoarseFineBiasParent(node, "ApsOverflowLevelBn"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_BIASBUFFER,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_BIASBUFFER,
 			generateCoarseFineBiasParent(node, "BiasBuffer"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSP,
 			generateShiftedSourceBiasParent(node, "SSP"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSN,
 			generateShiftedSourceBiasParent(node, "SSN"));
 	}
 
 	if (IS_DAVIS128(devInfo->chipID) || IS_DAVIS208(devInfo->chipID) || IS_DAVIS346(devInfo->chipID)
 	|| IS_DAVIS640(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSOVERFLOWLEVEL,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSOVERFLOWLEVEL,
 			generateVDACBiasParent(node, "ApsOverflowLevel"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSCAS,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSCAS,
 			generateVDACBiasParent(node, "ApsCas"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFHIGH,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFHIGH,
 			generateVDACBiasParent(node, "AdcRefHigh"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFLOW,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFLOW,
 			generateVDACBiasParent(node, "AdcRefLow"));
 
 		if (IS_DAVIS346(devInfo->chipID) || IS_DAVIS640(devInfo->chipID)) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS346_CONFIG_BIAS_ADCTESTVOLTAGE,
+			configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS346_CONFIG_BIAS_ADCTESTVOLTAGE,
 				generateVDACBiasParent(node, "AdcTestVoltage"));
 		}
 
 		if (IS_DAVIS208(devInfo->chipID)) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_RESETHIGHPASS,
+			configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_RESETHIGHPASS,
 				generateVDACBiasParent(node, "ResetHighPass"));
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSS,
+			configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSS,
 				generateVDACBiasParent(node, "RefSS"));
 
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REGBIASBP,
+			configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REGBIASBP,
 				generateCoarseFineBiasParent(node, "RegBiasBp"));
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSSBN,
+			configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSSBN,
 				generateCoarseFineBiasParent(node, "RefSSBn"));
 		}
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LOCALBUFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LOCALBUFBN,
 			generateCoarseFineBiasParent(node, "LocalBufBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PADFOLLBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PADFOLLBN,
 			generateCoarseFineBiasParent(node, "PadFollBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DIFFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DIFFBN,
 			generateCoarseFineBiasParent(node, "DiffBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ONBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ONBN,
 			generateCoarseFineBiasParent(node, "OnBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_OFFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_OFFBN,
 			generateCoarseFineBiasParent(node, "OffBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PIXINVBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PIXINVBN,
 			generateCoarseFineBiasParent(node, "PixInvBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRBP,
 			generateCoarseFineBiasParent(node, "PrBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRSFBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRSFBP,
 			generateCoarseFineBiasParent(node, "PrSFBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_REFRBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_REFRBP,
 			generateCoarseFineBiasParent(node, "RefrBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_READOUTBUFBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_READOUTBUFBP,
 			generateCoarseFineBiasParent(node, "ReadoutBufBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSROSFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSROSFBN,
 			generateCoarseFineBiasParent(node, "ApsROSFBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCCOMPBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCCOMPBP,
 			generateCoarseFineBiasParent(node, "AdcCompBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_COLSELLOWBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_COLSELLOWBN,
 			generateCoarseFineBiasParent(node, "ColSelLowBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DACBUFBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DACBUFBP,
 			generateCoarseFineBiasParent(node, "DACBufBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LCOLTIMEOUTBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LCOLTIMEOUTBN,
 			generateCoarseFineBiasParent(node, "LcolTimeoutBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPDBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPDBN,
 			generateCoarseFineBiasParent(node, "AEPdBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUXBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUXBP,
 			generateCoarseFineBiasParent(node, "AEPuXBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUYBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUYBP,
 			generateCoarseFineBiasParent(node, "AEPuYBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFREFRBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFREFRBN,
 			generateCoarseFineBiasParent(node, "IFRefrBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFTHRBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFTHRBN,
 			generateCoarseFineBiasParent(node, "IFThrBn"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_BIASBUFFER,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_BIASBUFFER,
 			generateCoarseFineBiasParent(node, "BiasBuffer"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSP,
 			generateShiftedSourceBiasParent(node, "SSP"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSN,
 			generateShiftedSourceBiasParent(node, "SSN"));
 	}
 
 	if (IS_DAVISRGB(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSCAS,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSCAS,
 			generateVDACBiasParent(node, "ApsCas"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG1LO,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG1LO,
 			generateVDACBiasParent(node, "OVG1Lo"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG2LO,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG2LO,
 			generateVDACBiasParent(node, "OVG2Lo"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_TX2OVG2HI,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_TX2OVG2HI,
 			generateVDACBiasParent(node, "TX2OVG2Hi"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_GND07,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_GND07,
 			generateVDACBiasParent(node, "Gnd07"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCTESTVOLTAGE,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCTESTVOLTAGE,
 			generateVDACBiasParent(node, "AdcTestVoltage"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFHIGH,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFHIGH,
 			generateVDACBiasParent(node, "AdcRefHigh"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFLOW,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFLOW,
 			generateVDACBiasParent(node, "AdcRefLow"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFREFRBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFREFRBN,
 			generateCoarseFineBiasParent(node, "IFRefrBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFTHRBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFTHRBN,
 			generateCoarseFineBiasParent(node, "IFThrBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LOCALBUFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LOCALBUFBN,
 			generateCoarseFineBiasParent(node, "LocalBufBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PADFOLLBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PADFOLLBN,
 			generateCoarseFineBiasParent(node, "PadFollBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PIXINVBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PIXINVBN,
 			generateCoarseFineBiasParent(node, "PixInvBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DIFFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DIFFBN,
 			generateCoarseFineBiasParent(node, "DiffBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ONBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ONBN,
 			generateCoarseFineBiasParent(node, "OnBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OFFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OFFBN,
 			generateCoarseFineBiasParent(node, "OffBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRBP,
 			generateCoarseFineBiasParent(node, "PrBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRSFBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRSFBP,
 			generateCoarseFineBiasParent(node, "PrSFBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_REFRBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_REFRBP,
 			generateCoarseFineBiasParent(node, "RefrBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ARRAYBIASBUFFERBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ARRAYBIASBUFFERBN,
 			generateCoarseFineBiasParent(node, "ArrayBiasBufferBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ARRAYLOGICBUFFERBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ARRAYLOGICBUFFERBN,
 			generateCoarseFineBiasParent(node, "ArrayLogicBufferBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_FALLTIMEBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_FALLTIMEBN,
 			generateCoarseFineBiasParent(node, "FalltimeBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_RISETIMEBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_RISETIMEBP,
 			generateCoarseFineBiasParent(node, "RisetimeBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_READOUTBUFBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_READOUTBUFBP,
 			generateCoarseFineBiasParent(node, "ReadoutBufBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSROSFBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSROSFBN,
 			generateCoarseFineBiasParent(node, "ApsROSFBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCCOMPBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCCOMPBP,
 			generateCoarseFineBiasParent(node, "AdcCompBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DACBUFBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DACBUFBP,
 			generateCoarseFineBiasParent(node, "DACBufBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LCOLTIMEOUTBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LCOLTIMEOUTBN,
 			generateCoarseFineBiasParent(node, "LcolTimeoutBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPDBN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPDBN,
 			generateCoarseFineBiasParent(node, "AEPdBn"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUXBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUXBP,
 			generateCoarseFineBiasParent(node, "AEPuXBp"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUYBP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUYBP,
 			generateCoarseFineBiasParent(node, "AEPuYBp"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_BIASBUFFER,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_BIASBUFFER,
 			generateCoarseFineBiasParent(node, "BiasBuffer"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSP,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSP,
 			generateShiftedSourceBiasParent(node, "SSP"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSN,
+		configBatchAdd(batch, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSN,
 			generateShiftedSourceBiasParent(node, "SSN"));
 	}
 }
@@ -905,98 +1489,98 @@ static void biasConfigListener(sshsNode node, void *userData, enum sshs_node_att
 	UNUSED_ARGUMENT(changeValue);
 
 	caerModuleData moduleData = userData;
-	struct caer_davis_info devInfo = caerDavisInfoGet(moduleData->moduleState);
+	struct caer_davis_info devInfo = glBackend->infoGet(moduleData->moduleState);
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		const char *nodeName = sshsNodeGetName(node);
 
 		if (IS_DAVIS240(devInfo.chipID)) {
 			if (caerStrEquals(nodeName, "DiffBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OnBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_ONBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_ONBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OffBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_OFFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_OFFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ApsCasEpc")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSCASEPC,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSCASEPC,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "DiffCasBnc")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFCASBNC,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_DIFFCASBNC,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ApsROSFBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSROSFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSROSFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "LocalBufBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LOCALBUFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LOCALBUFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PixInvBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PIXINVBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PIXINVBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PrBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PrSFBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRSFBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PRSFBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "RefrBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_REFRBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_REFRBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPdBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPDBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPDBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "LcolTimeoutBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LCOLTIMEOUTBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_LCOLTIMEOUTBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPuXBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUXBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUXBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPuYBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUYBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_AEPUYBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "IFThrBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFTHRBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFTHRBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "IFRefrBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFREFRBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_IFREFRBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PadFollBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PADFOLLBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_PADFOLLBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ApsOverflowLevelBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_APSOVERFLOWLEVELBN,
-					generateCoarseFineBias(node));
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS,
+					DAVIS240_CONFIG_BIAS_APSOVERFLOWLEVELBN, generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "BiasBuffer")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_BIASBUFFER,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_BIASBUFFER,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "SSP")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSP,
 					generateShiftedSourceBias(node));
 			}
 			else if (caerStrEquals(nodeName, "SSP")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS240_CONFIG_BIAS_SSN,
 					generateShiftedSourceBias(node));
 			}
 		}
@@ -1004,342 +1588,342 @@ static void biasConfigListener(sshsNode node, void *userData, enum sshs_node_att
 		if (IS_DAVIS128(devInfo.chipID) || IS_DAVIS208(devInfo.chipID) || IS_DAVIS346(devInfo.chipID)
 		|| IS_DAVIS640(devInfo.chipID)) {
 			if (caerStrEquals(nodeName, "ApsOverflowLevel")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSOVERFLOWLEVEL,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSOVERFLOWLEVEL,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ApsCas")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSCAS,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSCAS,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AdcRefHigh")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFHIGH,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFHIGH,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AdcRefLow")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFLOW,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCREFLOW,
 					generateVDACBias(node));
 			}
 			else if ((IS_DAVIS346(devInfo.chipID) || IS_DAVIS640(devInfo.chipID))
 				&& caerStrEquals(nodeName, "AdcTestVoltage")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS346_CONFIG_BIAS_ADCTESTVOLTAGE,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS346_CONFIG_BIAS_ADCTESTVOLTAGE,
 					generateVDACBias(node));
 			}
 			else if ((IS_DAVIS208(devInfo.chipID)) && caerStrEquals(nodeName, "ResetHighPass")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_RESETHIGHPASS,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_RESETHIGHPASS,
 					generateVDACBias(node));
 			}
 			else if ((IS_DAVIS208(devInfo.chipID)) && caerStrEquals(nodeName, "RefSS")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSS,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSS,
 					generateVDACBias(node));
 			}
 			else if ((IS_DAVIS208(devInfo.chipID)) && caerStrEquals(nodeName, "RegBiasBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REGBIASBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REGBIASBP,
 					generateCoarseFineBias(node));
 			}
 			else if ((IS_DAVIS208(devInfo.chipID)) && caerStrEquals(nodeName, "RefSSBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSSBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS208_CONFIG_BIAS_REFSSBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "LocalBufBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LOCALBUFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LOCALBUFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PadFollBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PADFOLLBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PADFOLLBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "DiffBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DIFFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DIFFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OnBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ONBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ONBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OffBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_OFFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_OFFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PixInvBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PIXINVBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PIXINVBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PrBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PrSFBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRSFBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_PRSFBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "RefrBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_REFRBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_REFRBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ReadoutBufBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_READOUTBUFBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_READOUTBUFBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ApsROSFBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSROSFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_APSROSFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AdcCompBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCCOMPBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_ADCCOMPBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ColSelLowBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_COLSELLOWBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_COLSELLOWBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "DACBufBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DACBUFBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_DACBUFBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "LcolTimeoutBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LCOLTIMEOUTBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_LCOLTIMEOUTBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPdBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPDBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPDBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPuXBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUXBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUXBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPuYBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUYBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_AEPUYBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "IFRefrBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFREFRBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFREFRBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "IFThrBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFTHRBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_IFTHRBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "BiasBuffer")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_BIASBUFFER,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_BIASBUFFER,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "SSP")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSP,
 					generateShiftedSourceBias(node));
 			}
 			else if (caerStrEquals(nodeName, "SSN")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVIS128_CONFIG_BIAS_SSN,
 					generateShiftedSourceBias(node));
 			}
 		}
 
 		if (IS_DAVISRGB(devInfo.chipID)) {
 			if (caerStrEquals(nodeName, "ApsCas")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSCAS,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSCAS,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OVG1Lo")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG1LO,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG1LO,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OVG2Lo")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG2LO,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OVG2LO,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "TX2OVG2Hi")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_TX2OVG2HI,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_TX2OVG2HI,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "Gnd07")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_GND07,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_GND07,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AdcTestVoltage")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCTESTVOLTAGE,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCTESTVOLTAGE,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AdcRefHigh")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFHIGH,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFHIGH,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AdcRefLow")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFLOW,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCREFLOW,
 					generateVDACBias(node));
 			}
 			else if (caerStrEquals(nodeName, "IFRefrBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFREFRBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFREFRBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "IFThrBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFTHRBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_IFTHRBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "LocalBufBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LOCALBUFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LOCALBUFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PadFollBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PADFOLLBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PADFOLLBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PixInvBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PIXINVBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PIXINVBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "DiffBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DIFFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DIFFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OnBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ONBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ONBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "OffBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OFFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_OFFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PrBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "PrSFBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRSFBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_PRSFBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "RefrBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_REFRBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_REFRBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ArrayBiasBufferBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ARRAYBIASBUFFERBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ARRAYBIASBUFFERBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ArrayLogicBufferBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ARRAYLOGICBUFFERBN,
-					generateCoarseFineBias(node));
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS,
+					DAVISRGB_CONFIG_BIAS_ARRAYLOGICBUFFERBN, generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "FalltimeBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_FALLTIMEBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_FALLTIMEBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "RisetimeBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_RISETIMEBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_RISETIMEBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ReadoutBufBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_READOUTBUFBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_READOUTBUFBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "ApsROSFBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSROSFBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_APSROSFBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AdcCompBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCCOMPBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_ADCCOMPBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "DACBufBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DACBUFBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_DACBUFBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "LcolTimeoutBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LCOLTIMEOUTBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_LCOLTIMEOUTBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPdBn")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPDBN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPDBN,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPuXBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUXBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUXBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "AEPuYBp")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUYBP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_AEPUYBP,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "BiasBuffer")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_BIASBUFFER,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_BIASBUFFER,
 					generateCoarseFineBias(node));
 			}
 			else if (caerStrEquals(nodeName, "SSP")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSP,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSP,
 					generateShiftedSourceBias(node));
 			}
 			else if (caerStrEquals(nodeName, "SSN")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSN,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_BIAS, DAVISRGB_CONFIG_BIAS_SSN,
 					generateShiftedSourceBias(node));
 			}
 		}
 	}
 }
 
-static void chipConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo) {
+static void chipConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo) {
 	// All chips have the same parameter address for the same setting!
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX0,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX0,
 		U32T(sshsNodeGetByte(node, "DigitalMux0")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX1,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX1,
 		U32T(sshsNodeGetByte(node, "DigitalMux1")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX2,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX2,
 		U32T(sshsNodeGetByte(node, "DigitalMux2")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX3,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX3,
 		U32T(sshsNodeGetByte(node, "DigitalMux3")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX0,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX0,
 		U32T(sshsNodeGetByte(node, "AnalogMux0")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX1,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX1,
 		U32T(sshsNodeGetByte(node, "AnalogMux1")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX2,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX2,
 		U32T(sshsNodeGetByte(node, "AnalogMux2")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_BIASMUX0,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_BIASMUX0,
 		U32T(sshsNodeGetByte(node, "BiasMux0")));
 
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETCALIBNEURON,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETCALIBNEURON,
 		sshsNodeGetBool(node, "ResetCalibNeuron"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_TYPENCALIBNEURON,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_TYPENCALIBNEURON,
 		sshsNodeGetBool(node, "TypeNCalibNeuron"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETTESTPIXEL,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETTESTPIXEL,
 		sshsNodeGetBool(node, "ResetTestPixel"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_AERNAROW,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_AERNAROW,
 		sshsNodeGetBool(node, "AERnArow"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_USEAOUT,
+	configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_USEAOUT,
 		sshsNodeGetBool(node, "UseAOut"));
 
 	if (IS_DAVIS240A(devInfo->chipID) || IS_DAVIS240B(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS240_CONFIG_CHIP_SPECIALPIXELCONTROL,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS240_CONFIG_CHIP_SPECIALPIXELCONTROL,
 			sshsNodeGetBool(node, "SpecialPixelControl"));
 	}
 
 	if (IS_DAVIS128(devInfo->chipID) || IS_DAVIS208(devInfo->chipID) || IS_DAVIS346(devInfo->chipID)
 	|| IS_DAVIS640(devInfo->chipID) || IS_DAVISRGB(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_SELECTGRAYCOUNTER,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_SELECTGRAYCOUNTER,
 			sshsNodeGetBool(node, "SelectGrayCounter"));
 	}
 
 	if (IS_DAVIS346(devInfo->chipID) || IS_DAVIS640(devInfo->chipID) || IS_DAVISRGB(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS346_CONFIG_CHIP_TESTADC,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS346_CONFIG_CHIP_TESTADC,
 			sshsNodeGetBool(node, "TestADC"));
 	}
 
 	if (IS_DAVIS208(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPREAMPAVG,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPREAMPAVG,
 			sshsNodeGetBool(node, "SelectPreAmpAvg"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTBIASREFSS,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTBIASREFSS,
 			sshsNodeGetBool(node, "SelectBiasRefSS"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTSENSE,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTSENSE,
 			sshsNodeGetBool(node, "SelectSense"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPOSFB,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPOSFB,
 			sshsNodeGetBool(node, "SelectPosFb"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTHIGHPASS,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTHIGHPASS,
 			sshsNodeGetBool(node, "SelectHighPass"));
 	}
 
 	if (IS_DAVISRGB(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG1LO,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG1LO,
 			sshsNodeGetBool(node, "AdjustOVG1Lo"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG2LO,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG2LO,
 			sshsNodeGetBool(node, "AdjustOVG2Lo"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTTX2OVG2HI,
+		configBatchAdd(batch, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTTX2OVG2HI,
 			sshsNodeGetBool(node, "AdjustTX2OVG2Hi"));
 	}
 }
@@ -1349,134 +1933,134 @@ static void chipConfigListener(sshsNode node, void *userData, enum sshs_node_att
 	UNUSED_ARGUMENT(node);
 
 	caerModuleData moduleData = userData;
-	struct caer_davis_info devInfo = caerDavisInfoGet(moduleData->moduleState);
+	struct caer_davis_info devInfo = glBackend->infoGet(moduleData->moduleState);
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == BYTE && caerStrEquals(changeKey, "DigitalMux0")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX0,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX0,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "DigitalMux1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX1,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "DigitalMux2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX2,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "DigitalMux3")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX3,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_DIGITALMUX3,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "AnalogMux0")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX0,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX0,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "AnalogMux1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX1,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "AnalogMux2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_ANALOGMUX2,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "BiasMux0")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_BIASMUX0,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_BIASMUX0,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "ResetCalibNeuron")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETCALIBNEURON,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETCALIBNEURON,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "TypeNCalibNeuron")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_TYPENCALIBNEURON,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_TYPENCALIBNEURON,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "ResetTestPixel")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETTESTPIXEL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_RESETTESTPIXEL,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "AERnArow")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_AERNAROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_AERNAROW,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "UseAOut")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_USEAOUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_USEAOUT,
 				changeValue.boolean);
 		}
 		else if ((IS_DAVIS240A(devInfo.chipID) || IS_DAVIS240B(devInfo.chipID)) && changeType == BOOL
 			&& caerStrEquals(changeKey, "SpecialPixelControl")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS240_CONFIG_CHIP_SPECIALPIXELCONTROL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS240_CONFIG_CHIP_SPECIALPIXELCONTROL,
 				changeValue.boolean);
 		}
 		else if ((IS_DAVIS128(devInfo.chipID) || IS_DAVIS208(devInfo.chipID) || IS_DAVIS346(devInfo.chipID)
 			|| IS_DAVIS640(devInfo.chipID) || IS_DAVISRGB(devInfo.chipID)) && changeType == BOOL
 			&& caerStrEquals(changeKey, "SelectGrayCounter")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_SELECTGRAYCOUNTER,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS128_CONFIG_CHIP_SELECTGRAYCOUNTER,
 				changeValue.boolean);
 		}
 		else if ((IS_DAVIS346(devInfo.chipID) || IS_DAVIS640(devInfo.chipID) || IS_DAVISRGB(devInfo.chipID))
 			&& changeType == BOOL && caerStrEquals(changeKey, "TestADC")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS346_CONFIG_CHIP_TESTADC,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS346_CONFIG_CHIP_TESTADC,
 				changeValue.boolean);
 		}
 
 		if (IS_DAVIS208(devInfo.chipID)) {
 			if (changeType == BOOL && caerStrEquals(changeKey, "SelectPreAmpAvg")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPREAMPAVG,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPREAMPAVG,
 					changeValue.boolean);
 			}
 			else if (changeType == BOOL && caerStrEquals(changeKey, "SelectBiasRefSS")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTBIASREFSS,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTBIASREFSS,
 					changeValue.boolean);
 			}
 			else if (changeType == BOOL && caerStrEquals(changeKey, "SelectSense")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTSENSE,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTSENSE,
 					changeValue.boolean);
 			}
 			else if (changeType == BOOL && caerStrEquals(changeKey, "SelectPosFb")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPOSFB,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTPOSFB,
 					changeValue.boolean);
 			}
 			else if (changeType == BOOL && caerStrEquals(changeKey, "SelectHighPass")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTHIGHPASS,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVIS208_CONFIG_CHIP_SELECTHIGHPASS,
 					changeValue.boolean);
 			}
 		}
 
 		if (IS_DAVISRGB(devInfo.chipID)) {
 			if (changeType == BOOL && caerStrEquals(changeKey, "AdjustOVG1Lo")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG1LO,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG1LO,
 					changeValue.boolean);
 			}
 			else if (changeType == BOOL && caerStrEquals(changeKey, "AdjustOVG2Lo")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG2LO,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTOVG2LO,
 					changeValue.boolean);
 			}
 			else if (changeType == BOOL && caerStrEquals(changeKey, "AdjustTX2OVG2Hi")) {
-				caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTTX2OVG2HI,
+				glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_CHIP, DAVISRGB_CONFIG_CHIP_ADJUSTTX2OVG2HI,
 					changeValue.boolean);
 			}
 		}
 	}
 }
 
-static void muxConfigSend(sshsNode node, caerModuleData moduleData) {
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RESET,
+static void muxConfigSend(sshsNode node, UT_array *batch) {
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RESET,
 		sshsNodeGetBool(node, "TimestampReset"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_FORCE_CHIP_BIAS_ENABLE,
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_FORCE_CHIP_BIAS_ENABLE,
 		sshsNodeGetBool(node, "ForceChipBiasEnable"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_DVS_ON_TRANSFER_STALL,
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_DVS_ON_TRANSFER_STALL,
 		sshsNodeGetBool(node, "DropDVSOnTransferStall"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_APS_ON_TRANSFER_STALL,
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_APS_ON_TRANSFER_STALL,
 		sshsNodeGetBool(node, "DropAPSOnTransferStall"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_IMU_ON_TRANSFER_STALL,
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_IMU_ON_TRANSFER_STALL,
 		sshsNodeGetBool(node, "DropIMUOnTransferStall"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_EXTINPUT_ON_TRANSFER_STALL,
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_EXTINPUT_ON_TRANSFER_STALL,
 		sshsNodeGetBool(node, "DropExtInputOnTransferStall"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RUN,
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RUN,
 		sshsNodeGetBool(node, "TimestampRun"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_RUN, sshsNodeGetBool(node, "Run"));
+	configBatchAdd(batch, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_RUN, sshsNodeGetBool(node, "Run"));
 }
 
 static void muxConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -1487,104 +2071,104 @@ static void muxConfigListener(sshsNode node, void *userData, enum sshs_node_attr
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == BOOL && caerStrEquals(changeKey, "TimestampReset")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RESET,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RESET,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "ForceChipBiasEnable")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_FORCE_CHIP_BIAS_ENABLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_FORCE_CHIP_BIAS_ENABLE,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DropDVSOnTransferStall")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_DVS_ON_TRANSFER_STALL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_DVS_ON_TRANSFER_STALL,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DropAPSOnTransferStall")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_APS_ON_TRANSFER_STALL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_APS_ON_TRANSFER_STALL,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DropIMUOnTransferStall")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_IMU_ON_TRANSFER_STALL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_DROP_IMU_ON_TRANSFER_STALL,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DropExtInputOnTransferStall")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX,
 			DAVIS_CONFIG_MUX_DROP_EXTINPUT_ON_TRANSFER_STALL, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "TimestampRun")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RUN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RUN,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "Run")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_RUN, changeValue.boolean);
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_RUN, changeValue.boolean);
 		}
 	}
 }
 
-static void dvsConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo) {
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_ROW,
+static void dvsConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo) {
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_ROW,
 		U32T(sshsNodeGetByte(node, "AckDelayRow")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_COLUMN,
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_COLUMN,
 		U32T(sshsNodeGetByte(node, "AckDelayColumn")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_ROW,
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_ROW,
 		U32T(sshsNodeGetByte(node, "AckExtensionRow")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_COLUMN,
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_COLUMN,
 		U32T(sshsNodeGetByte(node, "AckExtensionColumn")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_WAIT_ON_TRANSFER_STALL,
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_WAIT_ON_TRANSFER_STALL,
 		U32T(sshsNodeGetBool(node, "WaitOnTransferStall")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_ROW_ONLY_EVENTS,
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_ROW_ONLY_EVENTS,
 		U32T(sshsNodeGetBool(node, "FilterRowOnlyEvents")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_EXTERNAL_AER_CONTROL,
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_EXTERNAL_AER_CONTROL,
 		U32T(sshsNodeGetBool(node, "ExternalAERControl")));
 
 	if (devInfo->dvsHasPixelFilter) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel0Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel0Column")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel1Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel1Column")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel2Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel2Column")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel3Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel3Column")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel4Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel4Column")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel5Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel5Column")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel6Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel6Column")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_ROW,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_ROW,
 			U32T(sshsNodeGetShort(node, "FilterPixel7Row")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_COLUMN,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_COLUMN,
 			U32T(sshsNodeGetShort(node, "FilterPixel7Column")));
 	}
 
 	if (devInfo->dvsHasBackgroundActivityFilter) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_BACKGROUND_ACTIVITY,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_BACKGROUND_ACTIVITY,
 			sshsNodeGetBool(node, "FilterBackgroundActivity"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS,
 		DAVIS_CONFIG_DVS_FILTER_BACKGROUND_ACTIVITY_DELTAT,
 			U32T(sshsNodeGetInt(node, "FilterBackgroundActivityDeltaTime")));
 	}
 
 	if (devInfo->dvsHasTestEventGenerator) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_TEST_EVENT_GENERATOR_ENABLE,
+		configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_TEST_EVENT_GENERATOR_ENABLE,
 			sshsNodeGetBool(node, "TestEventGeneratorEnable"));
 	}
 
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_RUN, sshsNodeGetBool(node, "Run"));
+	configBatchAdd(batch, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_RUN, sshsNodeGetBool(node, "Run"));
 }
 
 static void dvsConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -1595,210 +2179,210 @@ static void dvsConfigListener(sshsNode node, void *userData, enum sshs_node_attr
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == BYTE && caerStrEquals(changeKey, "AckDelayRow")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_ROW,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "AckDelayColumn")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_DELAY_COLUMN,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "AckExtensionRow")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_ROW,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "AckExtensionColumn")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_ACK_EXTENSION_COLUMN,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "WaitOnTransferStall")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_WAIT_ON_TRANSFER_STALL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_WAIT_ON_TRANSFER_STALL,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "FilterRowOnlyEvents")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_ROW_ONLY_EVENTS,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_ROW_ONLY_EVENTS,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "ExternalAERControl")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_EXTERNAL_AER_CONTROL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_EXTERNAL_AER_CONTROL,
 				changeValue.boolean);
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel0Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel0Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_0_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel1Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel1Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_1_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel2Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel2Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_2_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel3Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel3Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_3_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel4Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel4Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_4_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel5Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel5Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_5_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel6Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel6Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_6_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel7Row")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_ROW,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_ROW,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "FilterPixel7Column")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_COLUMN,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_PIXEL_7_COLUMN,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "FilterBackgroundActivity")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_BACKGROUND_ACTIVITY,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_FILTER_BACKGROUND_ACTIVITY,
 				changeValue.boolean);
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "FilterBackgroundActivityDeltaTime")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS,
 			DAVIS_CONFIG_DVS_FILTER_BACKGROUND_ACTIVITY_DELTAT, U32T(changeValue.iint));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "TestEventGeneratorEnable")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_TEST_EVENT_GENERATOR_ENABLE,
-				changeValue.boolean);
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS,
+				DAVIS_CONFIG_DVS_TEST_EVENT_GENERATOR_ENABLE, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "Run")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_RUN, changeValue.boolean);
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_DVS, DAVIS_CONFIG_DVS_RUN, changeValue.boolean);
 		}
 	}
 }
 
-static void apsConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo) {
+static void apsConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo) {
 	if (devInfo->apsHasGlobalShutter) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_GLOBAL_SHUTTER,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_GLOBAL_SHUTTER,
 			sshsNodeGetBool(node, "GlobalShutter"));
 	}
 
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_READ,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_READ,
 		sshsNodeGetBool(node, "ResetRead"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_WAIT_ON_TRANSFER_STALL,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_WAIT_ON_TRANSFER_STALL,
 		sshsNodeGetBool(node, "WaitOnTransferStall"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_0,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_0,
 		U32T(sshsNodeGetShort(node, "StartColumn0")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_0,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_0,
 		U32T(sshsNodeGetShort(node, "StartRow0")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_0,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_0,
 		U32T(sshsNodeGetShort(node, "EndColumn0")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_0,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_0,
 		U32T(sshsNodeGetShort(node, "EndRow0")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_EXPOSURE,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_EXPOSURE,
 		U32T(sshsNodeGetInt(node, "Exposure")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_FRAME_DELAY,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_FRAME_DELAY,
 		U32T(sshsNodeGetInt(node, "FrameDelay")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ROW_SETTLE,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ROW_SETTLE,
 		U32T(sshsNodeGetShort(node, "RowSettle")));
 
 	// Not supported on DAVIS RGB.
 	if (!IS_DAVISRGB(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_SETTLE,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_SETTLE,
 			U32T(sshsNodeGetShort(node, "ResetSettle")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_COLUMN_SETTLE,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_COLUMN_SETTLE,
 			U32T(sshsNodeGetShort(node, "ColumnSettle")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_NULL_SETTLE,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_NULL_SETTLE,
 			U32T(sshsNodeGetShort(node, "NullSettle")));
 	}
 
 	if (devInfo->apsHasQuadROI) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_1,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_1,
 			U32T(sshsNodeGetShort(node, "StartColumn1")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_1,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_1,
 			U32T(sshsNodeGetShort(node, "StartRow1")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_1,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_1,
 			U32T(sshsNodeGetShort(node, "EndColumn1")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_1,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_1,
 			U32T(sshsNodeGetShort(node, "EndRow1")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_2,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_2,
 			U32T(sshsNodeGetShort(node, "StartColumn2")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_2,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_2,
 			U32T(sshsNodeGetShort(node, "StartRow2")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_2,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_2,
 			U32T(sshsNodeGetShort(node, "EndColumn2")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_2,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_2,
 			U32T(sshsNodeGetShort(node, "EndRow2")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_3,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_3,
 			U32T(sshsNodeGetShort(node, "StartColumn3")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_3,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_3,
 			U32T(sshsNodeGetShort(node, "StartRow3")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_3,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_3,
 			U32T(sshsNodeGetShort(node, "EndColumn3")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_3,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_3,
 			U32T(sshsNodeGetShort(node, "EndRow3")));
 	}
 
 	if (devInfo->apsHasInternalADC) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_USE_INTERNAL_ADC,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_USE_INTERNAL_ADC,
 			sshsNodeGetBool(node, "UseInternalADC"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_ENABLE,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_ENABLE,
 			sshsNodeGetBool(node, "SampleEnable"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_SETTLE,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_SETTLE,
 			U32T(sshsNodeGetShort(node, "SampleSettle")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_RESET,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_RESET,
 			U32T(sshsNodeGetShort(node, "RampReset")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_SHORT_RESET,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_SHORT_RESET,
 			sshsNodeGetBool(node, "RampShortReset"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ADC_TEST_MODE,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ADC_TEST_MODE,
 			sshsNodeGetBool(node, "ADCTestMode"));
 	}
 
 	// DAVIS RGB extra timing support.
 	if (IS_DAVISRGB(devInfo->chipID)) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_TRANSFER,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_TRANSFER,
 			U32T(sshsNodeGetShort(node, "TransferTime")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_RSFDSETTLE,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_RSFDSETTLE,
 			U32T(sshsNodeGetShort(node, "RSFDSettleTime")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSPDRESET,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSPDRESET,
 			U32T(sshsNodeGetShort(node, "GSPDResetTime")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSRESETFALL,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSRESETFALL,
 			U32T(sshsNodeGetShort(node, "GSResetFallTime")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSTXFALL,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSTXFALL,
 			U32T(sshsNodeGetShort(node, "GSTXFallTime")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSFDRESET,
+		configBatchAdd(batch, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSFDRESET,
 			U32T(sshsNodeGetShort(node, "GSFDResetTime")));
 	}
 
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RUN, sshsNodeGetBool(node, "Run"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SNAPSHOT,
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RUN, sshsNodeGetBool(node, "Run"));
+	configBatchAdd(batch, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SNAPSHOT,
 		sshsNodeGetBool(node, "TakeSnapShot"));
 }
 
@@ -1810,192 +2394,192 @@ static void apsConfigListener(sshsNode node, void *userData, enum sshs_node_attr
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == BOOL && caerStrEquals(changeKey, "GlobalShutter")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_GLOBAL_SHUTTER,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_GLOBAL_SHUTTER,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "ResetRead")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_READ,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_READ,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "WaitOnTransferStall")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_WAIT_ON_TRANSFER_STALL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_WAIT_ON_TRANSFER_STALL,
 				changeValue.boolean);
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartColumn0")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_0,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_0,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartRow0")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_0,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_0,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndColumn0")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_0,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_0,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndRow0")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_0,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_0,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "Exposure")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_EXPOSURE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_EXPOSURE,
 				U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "FrameDelay")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_FRAME_DELAY,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_FRAME_DELAY,
 				U32T(changeValue.iint));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "ResetSettle")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_SETTLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RESET_SETTLE,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "ColumnSettle")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_COLUMN_SETTLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_COLUMN_SETTLE,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "RowSettle")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ROW_SETTLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ROW_SETTLE,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "NullSettle")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_NULL_SETTLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_NULL_SETTLE,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartColumn1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_1,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartRow1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_1,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndColumn1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_1,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndRow1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_1,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartColumn2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_2,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartRow2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_2,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndColumn2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_2,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndRow2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_2,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartColumn3")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_3,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_COLUMN_3,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "StartRow3")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_3,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_START_ROW_3,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndColumn3")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_3,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_COLUMN_3,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EndRow3")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_3,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_END_ROW_3,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "UseInternalADC")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_USE_INTERNAL_ADC,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_USE_INTERNAL_ADC,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "SampleEnable")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_ENABLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_ENABLE,
 				changeValue.boolean);
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "SampleSettle")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_SETTLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SAMPLE_SETTLE,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "RampReset")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_RESET,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_RESET,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "RampShortReset")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_SHORT_RESET,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RAMP_SHORT_RESET,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "ADCTestMode")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ADC_TEST_MODE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_ADC_TEST_MODE,
 				changeValue.boolean);
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "TransferTime")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_TRANSFER,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_TRANSFER,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "RSFDSettleTime")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_RSFDSETTLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_RSFDSETTLE,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "GSPDResetTime")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSPDRESET,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSPDRESET,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "GSResetFallTime")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSRESETFALL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSRESETFALL,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "GSTXFallTime")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSTXFALL,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSTXFALL,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "GSFDResetTime")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSFDRESET,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVISRGB_CONFIG_APS_GSFDRESET,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "Run")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RUN, changeValue.boolean);
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_RUN, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "TakeSnapShot")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SNAPSHOT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_APS, DAVIS_CONFIG_APS_SNAPSHOT,
 				changeValue.boolean);
 		}
 	}
 }
 
-static void imuConfigSend(sshsNode node, caerModuleData moduleData) {
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_TEMP_STANDBY,
+static void imuConfigSend(sshsNode node, UT_array *batch) {
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_TEMP_STANDBY,
 		sshsNodeGetBool(node, "TempStandby"));
 
 	uint8_t accelStandby = 0;
 	accelStandby |= U8T(sshsNodeGetBool(node, "AccelXStandby") << 2);
 	accelStandby |= U8T(sshsNodeGetBool(node, "AccelYStandby") << 1);
 	accelStandby |= U8T(sshsNodeGetBool(node, "AccelZStandby") << 0);
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_STANDBY, accelStandby);
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_STANDBY, accelStandby);
 
 	uint8_t gyroStandby = 0;
 	gyroStandby |= U8T(sshsNodeGetBool(node, "GyroXStandby") << 2);
 	gyroStandby |= U8T(sshsNodeGetBool(node, "GyroYStandby") << 1);
 	gyroStandby |= U8T(sshsNodeGetBool(node, "GyroZStandby") << 0);
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_STANDBY, gyroStandby);
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_STANDBY, gyroStandby);
 
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_CYCLE,
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_CYCLE,
 		sshsNodeGetBool(node, "LowPowerCycle"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_WAKEUP,
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_WAKEUP,
 		U32T(sshsNodeGetByte(node, "LowPowerWakeupFrequency")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_SAMPLE_RATE_DIVIDER,
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_SAMPLE_RATE_DIVIDER,
 		U32T(sshsNodeGetShort(node, "SampleRateDivider")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_DIGITAL_LOW_PASS_FILTER,
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_DIGITAL_LOW_PASS_FILTER,
 		U32T(sshsNodeGetByte(node, "DigitalLowPassFilter")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_FULL_SCALE,
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_FULL_SCALE,
 		U32T(sshsNodeGetByte(node, "AccelFullScale")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_FULL_SCALE,
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_FULL_SCALE,
 		U32T(sshsNodeGetByte(node, "GyroFullScale")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_RUN, sshsNodeGetBool(node, "Run"));
+	configBatchAdd(batch, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_RUN, sshsNodeGetBool(node, "Run"));
 }
 
 static void imuConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -2006,7 +2590,7 @@ static void imuConfigListener(sshsNode node, void *userData, enum sshs_node_attr
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == BOOL && caerStrEquals(changeKey, "TempStandby")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_TEMP_STANDBY,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_TEMP_STANDBY,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL
@@ -2017,7 +2601,7 @@ static void imuConfigListener(sshsNode node, void *userData, enum sshs_node_attr
 			accelStandby |= U8T(sshsNodeGetBool(node, "AccelYStandby") << 1);
 			accelStandby |= U8T(sshsNodeGetBool(node, "AccelZStandby") << 0);
 
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_STANDBY,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_STANDBY,
 				accelStandby);
 		}
 		else if (changeType == BOOL
@@ -2028,94 +2612,94 @@ static void imuConfigListener(sshsNode node, void *userData, enum sshs_node_attr
 			gyroStandby |= U8T(sshsNodeGetBool(node, "GyroYStandby") << 1);
 			gyroStandby |= U8T(sshsNodeGetBool(node, "GyroZStandby") << 0);
 
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_STANDBY, gyroStandby);
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_STANDBY, gyroStandby);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "LowPowerCycle")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_CYCLE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_CYCLE,
 				changeValue.boolean);
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "LowPowerWakeupFrequency")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_WAKEUP,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_LP_WAKEUP,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "SampleRateDivider")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_SAMPLE_RATE_DIVIDER,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_SAMPLE_RATE_DIVIDER,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "DigitalLowPassFilter")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_DIGITAL_LOW_PASS_FILTER,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_DIGITAL_LOW_PASS_FILTER,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "AccelFullScale")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_FULL_SCALE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_ACCEL_FULL_SCALE,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BYTE && caerStrEquals(changeKey, "GyroFullScale")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_FULL_SCALE,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_GYRO_FULL_SCALE,
 				U32T(changeValue.ibyte));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "Run")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_RUN, changeValue.boolean);
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_IMU, DAVIS_CONFIG_IMU_RUN, changeValue.boolean);
 		}
 	}
 }
 
-static void extInputConfigSend(sshsNode node, caerModuleData moduleData, struct caer_davis_info *devInfo) {
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES,
+static void extInputConfigSend(sshsNode node, UT_array *batch, struct caer_davis_info *devInfo) {
+	configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES,
 		sshsNodeGetBool(node, "DetectRisingEdges"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES,
+	configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES,
 		sshsNodeGetBool(node, "DetectFallingEdges"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES,
+	configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES,
 		sshsNodeGetBool(node, "DetectPulses"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_POLARITY,
+	configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_POLARITY,
 		sshsNodeGetBool(node, "DetectPulsePolarity"));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH,
+	configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH,
 		U32T(sshsNodeGetInt(node, "DetectPulseLength")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR,
+	configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR,
 		sshsNodeGetBool(node, "RunDetector"));
 
 	if (devInfo->extInputHasGenerator) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT,
 		DAVIS_CONFIG_EXTINPUT_GENERATE_USE_CUSTOM_SIGNAL, sshsNodeGetBool(node, "GenerateUseCustomSignal"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT,
 		DAVIS_CONFIG_EXTINPUT_GENERATE_PULSE_POLARITY, sshsNodeGetBool(node, "GeneratePulsePolarity"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT,
 		DAVIS_CONFIG_EXTINPUT_GENERATE_PULSE_INTERVAL, U32T(sshsNodeGetInt(node, "GeneratePulseInterval")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_GENERATE_PULSE_LENGTH,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_GENERATE_PULSE_LENGTH,
 			U32T(sshsNodeGetInt(node, "GeneratePulseLength")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT,
 		DAVIS_CONFIG_EXTINPUT_GENERATE_INJECT_ON_RISING_EDGE, sshsNodeGetBool(node, "GenerateInjectOnRisingEdge"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT,
 		DAVIS_CONFIG_EXTINPUT_GENERATE_INJECT_ON_FALLING_EDGE, sshsNodeGetBool(node, "GenerateInjectOnFallingEdge"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_GENERATOR,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_GENERATOR,
 			sshsNodeGetBool(node, "RunGenerator"));
 	}
 
 	if (devInfo->extInputHasExtraDetectors) {
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES1,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES1,
 			sshsNodeGetBool(node, "DetectRisingEdges1"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES1,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES1,
 			sshsNodeGetBool(node, "DetectFallingEdges1"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES1,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES1,
 			sshsNodeGetBool(node, "DetectPulses1"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT,
 		DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_POLARITY1, sshsNodeGetBool(node, "DetectPulsePolarity1"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH1,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH1,
 			U32T(sshsNodeGetInt(node, "DetectPulseLength1")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR1,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR1,
 			sshsNodeGetBool(node, "RunDetector1"));
 
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES2,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES2,
 			sshsNodeGetBool(node, "DetectRisingEdges2"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES2,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES2,
 			sshsNodeGetBool(node, "DetectFallingEdges2"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES2,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES2,
 			sshsNodeGetBool(node, "DetectPulses2"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT,
 		DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_POLARITY2, sshsNodeGetBool(node, "DetectPulsePolarity2"));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH2,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH2,
 			U32T(sshsNodeGetInt(node, "DetectPulseLength2")));
-		caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR2,
+		configBatchAdd(batch, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR2,
 			sshsNodeGetBool(node, "RunDetector2"));
 	}
 }
@@ -2128,117 +2712,117 @@ static void extInputConfigListener(sshsNode node, void *userData, enum sshs_node
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == BOOL && caerStrEquals(changeKey, "DetectRisingEdges")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectFallingEdges")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectPulses")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectPulsePolarity")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_POLARITY, changeValue.boolean);
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "DetectPulseLength")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH, U32T(changeValue.iint));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "RunDetector")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "GenerateUseCustomSignal")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_GENERATE_USE_CUSTOM_SIGNAL, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "GeneratePulsePolarity")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_GENERATE_PULSE_POLARITY, changeValue.boolean);
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "GeneratePulseInterval")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_GENERATE_PULSE_INTERVAL, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "GeneratePulseLength")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_GENERATE_PULSE_LENGTH, U32T(changeValue.iint));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "GenerateInjectOnRisingEdge")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_GENERATE_INJECT_ON_RISING_EDGE, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "GenerateInjectOnFallingEdge")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_GENERATE_INJECT_ON_FALLING_EDGE, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "RunGenerator")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_GENERATOR,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_GENERATOR,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectRisingEdges1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES1, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectFallingEdges1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES1, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectPulses1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES1,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectPulsePolarity1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_POLARITY1, changeValue.boolean);
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "DetectPulseLength1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH1, U32T(changeValue.iint));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "RunDetector1")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR1,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR1,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectRisingEdge2s")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_RISING_EDGES2, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectFallingEdges2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_FALLING_EDGES2, changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectPulses2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_DETECT_PULSES2,
 				changeValue.boolean);
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "DetectPulsePolarity2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_POLARITY2, changeValue.boolean);
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "DetectPulseLength2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT,
 			DAVIS_CONFIG_EXTINPUT_DETECT_PULSE_LENGTH2, U32T(changeValue.iint));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "RunDetector2")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR2,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_EXTINPUT, DAVIS_CONFIG_EXTINPUT_RUN_DETECTOR2,
 				changeValue.boolean);
 		}
 	}
 }
 
-static void usbConfigSend(sshsNode node, caerModuleData moduleData) {
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_NUMBER,
+static void usbConfigSend(sshsNode node, UT_array *batch) {
+	configBatchAdd(batch, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_NUMBER,
 		U32T(sshsNodeGetInt(node, "BufferNumber")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_SIZE,
+	configBatchAdd(batch, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_SIZE,
 		U32T(sshsNodeGetInt(node, "BufferSize")));
 
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_EARLY_PACKET_DELAY,
+	configBatchAdd(batch, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_EARLY_PACKET_DELAY,
 		U32T(sshsNodeGetShort(node, "EarlyPacketDelay")));
-	caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_RUN, sshsNodeGetBool(node, "Run"));
+	configBatchAdd(batch, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_RUN, sshsNodeGetBool(node, "Run"));
 }
 
 static void usbConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -2249,47 +2833,47 @@ static void usbConfigListener(sshsNode node, void *userData, enum sshs_node_attr
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == INT && caerStrEquals(changeKey, "BufferNumber")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_NUMBER,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_NUMBER,
 				U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "BufferSize")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_SIZE,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_USB, CAER_HOST_CONFIG_USB_BUFFER_SIZE,
 				U32T(changeValue.iint));
 		}
 		else if (changeType == SHORT && caerStrEquals(changeKey, "EarlyPacketDelay")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_EARLY_PACKET_DELAY,
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_EARLY_PACKET_DELAY,
 				U32T(changeValue.ishort));
 		}
 		else if (changeType == BOOL && caerStrEquals(changeKey, "Run")) {
-			caerDeviceConfigSet(moduleData->moduleState, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_RUN, changeValue.boolean);
+			glBackend->configSet(moduleData->moduleState, DAVIS_CONFIG_USB, DAVIS_CONFIG_USB_RUN, changeValue.boolean);
 		}
 	}
 }
 
-static void systemConfigSend(sshsNode node, caerModuleData moduleData) {
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_CONTAINER_SIZE,
+static void systemConfigSend(sshsNode node, UT_array *batch) {
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_CONTAINER_SIZE,
 		U32T(sshsNodeGetInt(node, "PacketContainerMaxSize")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS,
 	CAER_HOST_CONFIG_PACKETS_MAX_CONTAINER_INTERVAL, U32T(sshsNodeGetInt(node, "PacketContainerMaxInterval")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_POLARITY_SIZE,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_POLARITY_SIZE,
 		U32T(sshsNodeGetInt(node, "PolarityPacketMaxSize")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS,
 	CAER_HOST_CONFIG_PACKETS_MAX_POLARITY_INTERVAL, U32T(sshsNodeGetInt(node, "PolarityPacketMaxInterval")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_SPECIAL_SIZE,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_SPECIAL_SIZE,
 		U32T(sshsNodeGetInt(node, "SpecialPacketMaxSize")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS,
 	CAER_HOST_CONFIG_PACKETS_MAX_SPECIAL_INTERVAL, U32T(sshsNodeGetInt(node, "SpecialPacketMaxInterval")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_FRAME_SIZE,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_FRAME_SIZE,
 		U32T(sshsNodeGetInt(node, "FramePacketMaxSize")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS,
 	CAER_HOST_CONFIG_PACKETS_MAX_FRAME_INTERVAL, U32T(sshsNodeGetInt(node, "FramePacketMaxInterval")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_IMU6_SIZE,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS, CAER_HOST_CONFIG_PACKETS_MAX_IMU6_SIZE,
 		U32T(sshsNodeGetInt(node, "IMU6PacketMaxSize")));
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+	configBatchAdd(batch, CAER_HOST_CONFIG_PACKETS,
 	CAER_HOST_CONFIG_PACKETS_MAX_IMU6_INTERVAL, U32T(sshsNodeGetInt(node, "IMU6PacketMaxInterval")));
 
 	// Changes only take effect on module start!
-	caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_DATAEXCHANGE,
+	configBatchAdd(batch, CAER_HOST_CONFIG_DATAEXCHANGE,
 	CAER_HOST_CONFIG_DATAEXCHANGE_BUFFER_SIZE, U32T(sshsNodeGetInt(node, "DataExchangeBufferSize")));
 }
 
@@ -2301,43 +2885,43 @@ static void systemConfigListener(sshsNode node, void *userData, enum sshs_node_a
 
 	if (event == ATTRIBUTE_MODIFIED) {
 		if (changeType == INT && caerStrEquals(changeKey, "PacketContainerMaxSize")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_CONTAINER_SIZE, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "PacketContainerMaxInterval")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_CONTAINER_INTERVAL, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "PolarityPacketMaxSize")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_POLARITY_SIZE, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "PolarityPacketMaxInterval")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_POLARITY_INTERVAL, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "SpecialPacketMaxSize")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_SPECIAL_SIZE, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "SpecialPacketMaxInterval")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_SPECIAL_INTERVAL, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "FramePacketMaxSize")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_FRAME_SIZE, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "FramePacketMaxInterval")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_FRAME_INTERVAL, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "IMU6PacketMaxSize")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_IMU6_SIZE, U32T(changeValue.iint));
 		}
 		else if (changeType == INT && caerStrEquals(changeKey, "IMU6PacketMaxInterval")) {
-			caerDeviceConfigSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
+			glBackend->configSet(moduleData->moduleState, CAER_HOST_CONFIG_PACKETS,
 			CAER_HOST_CONFIG_PACKETS_MAX_IMU6_INTERVAL, U32T(changeValue.iint));
 		}
 	}
@@ -2477,3 +3061,494 @@ static uint16_t generateShiftedSourceBias(sshsNode biasNode) {
 
 	return (caerBiasShiftedSourceGenerate(biasValue));
 }
+
+static void usbTunerInit(caerModuleData moduleData, sshsNode usbNode) {
+	davisUSBTuner tuner = calloc(1, sizeof(struct davis_usb_tuner));
+	if (tuner == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to allocate memory for USB buffer tuner, it is disabled.");
+		return;
+	}
+
+	tuner->moduleID = moduleData->moduleID;
+	tuner->usbNode = usbNode;
+	tuner->sysNode = sshsGetRelativeNode(moduleData->moduleNode, "system/");
+	int32_t interval = sshsNodeGetInt(usbNode, "BufferAutoTuneInterval");
+	tuner->interval = (double) interval / 1000;
+	portable_clock_gettime_monotonic(&tuner->intervalStart);
+
+	// Tuner statistics and decisions, read-only.
+	sshsNodePutLong(usbNode, "AutoTuneEventRate", 0);
+	sshsNodePutLong(usbNode, "AutoTuneByteRate", 0);
+	sshsNodePutInt(usbNode, "AutoTunePacketFill", 0);
+	sshsNodePutInt(usbNode, "AutoTuneContainerInterval", 0);
+	sshsNodePutLong(usbNode, "AutoTuneRowOnlyEvents", 0);
+	sshsNodePutLong(usbNode, "AutoTuneAdjustments", 0);
+
+	HASH_ADD(hh, glUSBTuners, moduleID, sizeof(uint16_t), tuner);
+}
+
+static void usbTunerExit(caerModuleData moduleData) {
+	davisUSBTuner tuner = NULL;
+	HASH_FIND(hh, glUSBTuners, &moduleData->moduleID, sizeof(uint16_t), tuner);
+
+	if (tuner != NULL) {
+		HASH_DEL(glUSBTuners, tuner);
+		free(tuner);
+	}
+}
+
+static void usbTunerUpdate(caerModuleData moduleData, caerEventPacketContainer container) {
+	davisUSBTuner tuner = NULL;
+	HASH_FIND(hh, glUSBTuners, &moduleData->moduleID, sizeof(uint16_t), tuner);
+
+	if (tuner == NULL) {
+		return;
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	if (container != NULL) {
+		if (tuner->lastContainerValid) {
+			tuner->containerIntervals += (double) (now.tv_sec - tuner->lastContainer.tv_sec)
+				+ ((double) (now.tv_nsec - tuner->lastContainer.tv_nsec) / 1000000000);
+			tuner->containers++;
+		}
+
+		tuner->lastContainer = now;
+		tuner->lastContainerValid = true;
+
+		for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+			caerEventPacketHeader packetHeader = caerEventPacketContainerGetEventPacket(container, i);
+			if (packetHeader == NULL) {
+				continue;
+			}
+
+			int16_t eventType = caerEventPacketHeaderGetEventType(packetHeader);
+			uint64_t eventNumber = U64T(caerEventPacketHeaderGetEventNumber(packetHeader));
+
+			tuner->events += eventNumber;
+
+			if (eventType == FRAME_EVENT) {
+				// Two 16 bit samples per pixel (reset and signal read), as
+				// the frame event holds one 16 bit value per pixel.
+				tuner->bytes += eventNumber * 2 * U64T(caerEventPacketHeaderGetEventSize(packetHeader));
+			}
+			else if (eventType == IMU6_EVENT) {
+				tuner->bytes += eventNumber * USB_TUNER_BYTES_PER_IMU6_EVENT;
+			}
+			else {
+				tuner->bytes += eventNumber * USB_TUNER_BYTES_PER_EVENT;
+			}
+
+			if (eventType == POLARITY_EVENT) {
+				// How full packets are, relative to their configured maximum.
+				int32_t eventCapacity = caerEventPacketHeaderGetEventCapacity(packetHeader);
+
+				if (eventCapacity > 0) {
+					tuner->polarityPackets++;
+					tuner->polarityFill += (double) eventNumber / (double) eventCapacity;
+				}
+			}
+
+			if (eventType == SPECIAL_EVENT) {
+				// A row address without columns means the device lost data,
+				// because it couldn't send it out fast enough.
+				CAER_SPECIAL_ITERATOR_VALID_START((caerSpecialEventPacket) packetHeader)
+					if (caerSpecialEventGetType(caerSpecialIteratorElement) == DVS_ROW_ONLY) {
+						tuner->rowOnlyEvents++;
+					}
+				CAER_SPECIAL_ITERATOR_VALID_END
+			}
+		}
+	}
+
+	double elapsed = (double) (now.tv_sec - tuner->intervalStart.tv_sec)
+		+ ((double) (now.tv_nsec - tuner->intervalStart.tv_nsec) / 1000000000);
+
+	if (elapsed < tuner->interval) {
+		return;
+	}
+
+	usbTunerDecide(tuner, moduleData->moduleSubSystemString, elapsed);
+
+	// Start a new interval, its length can change at any time.
+	int32_t interval = sshsNodeGetInt(tuner->usbNode, "BufferAutoTuneInterval");
+	tuner->interval = (double) interval / 1000;
+	tuner->intervalStart = now;
+	tuner->bytes = 0;
+	tuner->events = 0;
+	tuner->rowOnlyEvents = 0;
+	tuner->containers = 0;
+	tuner->containerIntervals = 0;
+	tuner->polarityPackets = 0;
+	tuner->polarityFill = 0;
+}
+
+static int32_t usbTunerClamp(int32_t value, int32_t min, int32_t max) {
+	if (value > max) {
+		value = max;
+	}
+
+	if (value < min) {
+		value = min;
+	}
+
+	return (value);
+}
+
+static void usbTunerDecide(davisUSBTuner tuner, const char *subSystemString, double elapsed) {
+	double byteRate = (double) tuner->bytes / elapsed;
+	double packetFill = (tuner->polarityPackets > 0) ? (tuner->polarityFill / (double) tuner->polarityPackets) : (0);
+	double containerInterval = (tuner->containers > 0) ? (tuner->containerIntervals / (double) tuner->containers) : (0);
+
+	tuner->totalRowOnlyEvents += I64T(tuner->rowOnlyEvents);
+
+	sshsNodePutLong(tuner->usbNode, "AutoTuneEventRate", I64T((double) tuner->events / elapsed));
+	sshsNodePutLong(tuner->usbNode, "AutoTuneByteRate", I64T(byteRate));
+	sshsNodePutInt(tuner->usbNode, "AutoTunePacketFill", I32T(packetFill * 100));
+	sshsNodePutInt(tuner->usbNode, "AutoTuneContainerInterval", I32T(containerInterval * 1000000));
+	sshsNodePutLong(tuner->usbNode, "AutoTuneRowOnlyEvents", tuner->totalRowOnlyEvents);
+
+	if (!sshsNodeGetBool(tuner->usbNode, "BufferAutoTune")) {
+		tuner->shrinkIntervals = 0;
+		return;
+	}
+
+	int32_t bufferNumber = sshsNodeGetInt(tuner->usbNode, "BufferNumber");
+	int32_t bufferSize = sshsNodeGetInt(tuner->usbNode, "BufferSize");
+
+	int32_t bufferNumberMin = sshsNodeGetInt(tuner->usbNode, "BufferNumberMin");
+	int32_t bufferNumberMax = sshsNodeGetInt(tuner->usbNode, "BufferNumberMax");
+	int32_t bufferSizeMin = sshsNodeGetInt(tuner->usbNode, "BufferSizeMin");
+	int32_t bufferSizeMax = sshsNodeGetInt(tuner->usbNode, "BufferSizeMax");
+
+	// Each buffer should fill up within the target latency: a power of two
+	// number of USB packets.
+	int32_t targetLatency = sshsNodeGetInt(tuner->usbNode, "BufferTargetLatency");
+	double targetSize = byteRate * (double) targetLatency / 1000000;
+
+	int32_t newSize = USB_TUNER_BUFFER_SIZE_ALIGN;
+	while ((double) newSize < targetSize && newSize < bufferSizeMax) {
+		newSize *= 2;
+	}
+
+	newSize = usbTunerClamp(newSize, bufferSizeMin, bufferSizeMax);
+
+	// Together, all buffers must be able to hold the target capacity, so that
+	// the host can be late collecting them without the device losing data.
+	int32_t capacityTime = sshsNodeGetInt(tuner->usbNode, "BufferTargetCapacity");
+	double targetCapacity = byteRate * (double) capacityTime / 1000;
+
+	double targetNumber = ceil(targetCapacity / (double) newSize);
+	int32_t newNumber = usbTunerClamp(I32T(targetNumber), bufferNumberMin, bufferNumberMax);
+
+	const char *reason = "data rate";
+
+	if (tuner->rowOnlyEvents > 0) {
+		// The device is losing data: never shrink now, and add buffers.
+		newSize = (newSize > bufferSize) ? (newSize) : (bufferSize);
+		newNumber = usbTunerClamp((newNumber > (2 * bufferNumber)) ? (newNumber) : (2 * bufferNumber),
+			bufferNumberMin, bufferNumberMax);
+		reason = "data loss";
+	}
+
+	// Containers should arrive at least as often as they're closed on time.
+	// If not, and packets aren't full either, buffers take too long to fill.
+	int32_t containerMaxInterval = sshsNodeGetInt(tuner->sysNode, "PacketContainerMaxInterval");
+	bool latencyHigh = (tuner->rowOnlyEvents == 0) && (tuner->containers > 0)
+		&& (containerInterval > ((double) containerMaxInterval * 2 / 1000000)) && ((packetFill * 100) < 95);
+
+	if (latencyHigh && newSize >= bufferSize && bufferSize > bufferSizeMin) {
+		newSize = usbTunerClamp(bufferSize / 2, bufferSizeMin, bufferSizeMax);
+		reason = "container latency";
+	}
+
+	// Grow right away, but only shrink once it has been wanted for a while,
+	// to not oscillate around a boundary. Too much latency is acted on at once.
+	bool shrink = (newSize < bufferSize) || (newNumber < bufferNumber);
+	bool grow = (newSize > bufferSize) || (newNumber > bufferNumber);
+
+	if (shrink && !grow && !latencyHigh) {
+		tuner->shrinkIntervals++;
+
+		if (tuner->shrinkIntervals < USB_TUNER_SHRINK_INTERVALS) {
+			return;
+		}
+	}
+
+	tuner->shrinkIntervals = 0;
+
+	if (newNumber == bufferNumber && newSize == bufferSize) {
+		return;
+	}
+
+	caerLog(CAER_LOG_INFO, subSystemString,
+		"USB buffers: %" PRIi32 " x %" PRIi32 " bytes -> %" PRIi32 " x %" PRIi32 " bytes, because of %s (%.0f bytes/s, "
+		"%" PRIu64 " row-only events, %.0f%% packet fill, %.0f µs container interval).", bufferNumber, bufferSize,
+		newNumber, newSize, reason, byteRate, tuner->rowOnlyEvents, packetFill * 100, containerInterval * 1000000);
+
+	// Goes to the device through the usb/ node listener.
+	sshsNodePutInt(tuner->usbNode, "BufferNumber", newNumber);
+	sshsNodePutInt(tuner->usbNode, "BufferSize", newSize);
+
+	tuner->adjustments++;
+	sshsNodePutLong(tuner->usbNode, "AutoTuneAdjustments", tuner->adjustments);
+}
+
+static void packetTunerInit(caerModuleData moduleData, sshsNode sysNode) {
+	davisPacketTuner tuner = calloc(1, sizeof(struct davis_packet_tuner));
+	if (tuner == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to allocate memory for packet tuner, it is disabled.");
+		return;
+	}
+
+	tuner->moduleID = moduleData->moduleID;
+	tuner->sysNode = sysNode;
+	int32_t interval = sshsNodeGetInt(sysNode, "PacketAutoTuneInterval");
+	tuner->interval = (double) interval / 1000;
+	portable_clock_gettime_monotonic(&tuner->intervalStart);
+	portable_clock_gettime_thread_cputime(&tuner->cpuStart);
+
+	// Tuner statistics and decisions, read-only.
+	sshsNodePutInt(sysNode, "AutoTuneCPULoad", 0);
+	sshsNodePutInt(sysNode, "AutoTuneContainerRate", 0);
+	sshsNodePutInt(sysNode, "AutoTuneContainerCPUTime", 0);
+	sshsNodePutInt(sysNode, "AutoTuneLatency", 0);
+	sshsNodePutLong(sysNode, "AutoTuneAdjustments", 0);
+
+	HASH_ADD(hh, glPacketTuners, moduleID, sizeof(uint16_t), tuner);
+}
+
+static void packetTunerExit(caerModuleData moduleData) {
+	davisPacketTuner tuner = NULL;
+	HASH_FIND(hh, glPacketTuners, &moduleData->moduleID, sizeof(uint16_t), tuner);
+
+	if (tuner != NULL) {
+		HASH_DEL(glPacketTuners, tuner);
+		free(tuner);
+	}
+}
+
+static void packetTunerUpdate(caerModuleData moduleData, caerEventPacketContainer container) {
+	davisPacketTuner tuner = NULL;
+	HASH_FIND(hh, glPacketTuners, &moduleData->moduleID, sizeof(uint16_t), tuner);
+
+	if (tuner == NULL) {
+		return;
+	}
+
+	if (container != NULL) {
+		tuner->containers++;
+
+		for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+			caerEventPacketHeader packetHeader = caerEventPacketContainerGetEventPacket(container, i);
+			if (packetHeader == NULL) {
+				continue;
+			}
+
+			uint64_t eventNumber = U64T(caerEventPacketHeaderGetEventNumber(packetHeader));
+
+			switch (caerEventPacketHeaderGetEventType(packetHeader)) {
+				case POLARITY_EVENT:
+					tuner->polarityEvents += eventNumber;
+					break;
+
+				case SPECIAL_EVENT:
+					tuner->specialEvents += eventNumber;
+					break;
+
+				case IMU6_EVENT:
+					tuner->imu6Events += eventNumber;
+					break;
+
+				default:
+					break;
+			}
+		}
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	double elapsed = (double) (now.tv_sec - tuner->intervalStart.tv_sec)
+		+ ((double) (now.tv_nsec - tuner->intervalStart.tv_nsec) / 1000000000);
+
+	if (elapsed < tuner->interval) {
+		return;
+	}
+
+	// The mainloop runs all its modules in this thread, and sleeps while there
+	// is no data, so its CPU time is what processing all containers cost.
+	struct timespec cpuNow;
+	portable_clock_gettime_thread_cputime(&cpuNow);
+
+	double cpuTime = (double) (cpuNow.tv_sec - tuner->cpuStart.tv_sec)
+		+ ((double) (cpuNow.tv_nsec - tuner->cpuStart.tv_nsec) / 1000000000);
+
+	packetTunerDecide(tuner, moduleData->moduleSubSystemString, elapsed, cpuTime);
+
+	// Start a new interval, its length can change at any time.
+	int32_t interval = sshsNodeGetInt(tuner->sysNode, "PacketAutoTuneInterval");
+	tuner->interval = (double) interval / 1000;
+	tuner->intervalStart = now;
+	tuner->cpuStart = cpuNow;
+	tuner->containers = 0;
+	tuner->polarityEvents = 0;
+	tuner->specialEvents = 0;
+	tuner->imu6Events = 0;
+}
+
+static int32_t packetTunerSize(double eventRate, int32_t interval, int32_t min, int32_t max) {
+	double targetSize = eventRate * (double) interval * PACKET_TUNER_SIZE_HEADROOM / 1000000;
+
+	// Powers of two, so that small rate changes don't change the size.
+	int32_t size = 1;
+	while ((double) size < targetSize && size < max) {
+		size *= 2;
+	}
+
+	return (usbTunerClamp(size, min, max));
+}
+
+static void packetTunerDecide(davisPacketTuner tuner, const char *subSystemString, double elapsed, double cpuTime) {
+	double cpuLoad = cpuTime / elapsed;
+	double containerRate = (double) tuner->containers / elapsed;
+	double containerCPUTime = (tuner->containers > 0) ? (cpuTime / (double) tuner->containers) : (0);
+
+	int32_t containerInterval = sshsNodeGetInt(tuner->sysNode, "PacketContainerMaxInterval");
+
+	// Events wait up to one interval in their packet, and then for the
+	// mainloop to get through the container.
+	double latency = ((double) containerInterval / 1000000) + containerCPUTime;
+
+	sshsNodePutInt(tuner->sysNode, "AutoTuneCPULoad", I32T(cpuLoad * 100));
+	sshsNodePutInt(tuner->sysNode, "AutoTuneContainerRate", I32T(containerRate));
+	sshsNodePutInt(tuner->sysNode, "AutoTuneContainerCPUTime", I32T(containerCPUTime * 1000000));
+	sshsNodePutInt(tuner->sysNode, "AutoTuneLatency", I32T(latency * 1000000));
+
+	if (!sshsNodeGetBool(tuner->sysNode, "PacketAutoTune")) {
+		return;
+	}
+
+	int32_t intervalMin = sshsNodeGetInt(tuner->sysNode, "PacketIntervalMin");
+	int32_t intervalMax = sshsNodeGetInt(tuner->sysNode, "PacketIntervalMax");
+	int32_t sizeMin = sshsNodeGetInt(tuner->sysNode, "PacketSizeMin");
+	int32_t sizeMax = sshsNodeGetInt(tuner->sysNode, "PacketSizeMax");
+
+	int32_t targetLatency = sshsNodeGetInt(tuner->sysNode, "PacketTargetLatency");
+	int32_t targetCPU = sshsNodeGetInt(tuner->sysNode, "PacketTargetCPU");
+	double cpuBudget = (double) targetCPU / 100;
+
+	// The longest interval that still meets the latency target.
+	double latencyInterval = (double) targetLatency - (containerCPUTime * 1000000);
+
+	double newInterval = (double) containerInterval;
+	const char *reason = "latency target";
+
+	if (cpuLoad > cpuBudget && cpuBudget > 0) {
+		// Over budget: the per-container overhead is too high, make fewer and
+		// larger containers, even if that means missing the latency target.
+		double factor = cpuLoad / cpuBudget;
+		newInterval *= (factor < 2) ? (factor) : (2);
+		reason = "CPU budget";
+	}
+	else if (cpuLoad < (PACKET_TUNER_SHRINK_LOAD * cpuBudget / 100) || newInterval < latencyInterval) {
+		// Enough headroom to approach the latency target, at most halving the
+		// interval at once, since CPU load goes up as it shrinks.
+		newInterval = (latencyInterval > (newInterval / 2)) ? (latencyInterval) : (newInterval / 2);
+
+		// The per-container cost is paid more often with a shorter interval:
+		// don't go below where the load is predicted to leave the headroom.
+		if (cpuBudget > 0) {
+			double budgetInterval = (double) containerInterval * cpuLoad / (PACKET_TUNER_SHRINK_LOAD * cpuBudget / 100);
+
+			if (newInterval < budgetInterval) {
+				newInterval = budgetInterval;
+			}
+		}
+	}
+
+	int32_t newContainerInterval = usbTunerClamp(I32T(newInterval), intervalMin, intervalMax);
+
+	if (fabs((double) (newContainerInterval - containerInterval))
+		< (PACKET_TUNER_INTERVAL_HYSTERESIS * (double) containerInterval / 100)) {
+		newContainerInterval = containerInterval;
+	}
+
+	// Grow right away, but only shrink once it has been wanted for a while,
+	// like the USB tuner, so that load noise doesn't flip the interval.
+	if (newContainerInterval < containerInterval) {
+		tuner->shrinkIntervals++;
+
+		if (tuner->shrinkIntervals < PACKET_TUNER_SHRINK_INTERVALS) {
+			newContainerInterval = containerInterval;
+		}
+		else {
+			tuner->shrinkIntervals = 0;
+		}
+	}
+	else {
+		tuner->shrinkIntervals = 0;
+	}
+
+	// Packets hold the events of a few intervals at the current rates.
+	int32_t polarityPacketSize = sshsNodeGetInt(tuner->sysNode, "PolarityPacketMaxSize");
+	int32_t specialPacketSize = sshsNodeGetInt(tuner->sysNode, "SpecialPacketMaxSize");
+	int32_t imu6PacketSize = sshsNodeGetInt(tuner->sysNode, "IMU6PacketMaxSize");
+	int32_t framePacketSize = sshsNodeGetInt(tuner->sysNode, "FramePacketMaxSize");
+
+	int32_t newPolarityPacketSize = packetTunerSize((double) tuner->polarityEvents / elapsed, newContainerInterval,
+		sizeMin, sizeMax);
+	int32_t newSpecialPacketSize = packetTunerSize((double) tuner->specialEvents / elapsed, newContainerInterval,
+		PACKET_TUNER_SPECIAL_SIZE_MIN, sizeMax);
+	int32_t newIMU6PacketSize = packetTunerSize((double) tuner->imu6Events / elapsed, newContainerInterval,
+		PACKET_TUNER_IMU6_SIZE_MIN, sizeMax);
+
+	// With an unchanged interval, only grow packets, so that they keep being
+	// committed on time; shrinking waits for the next interval change.
+	if (newContainerInterval == containerInterval) {
+		if (newPolarityPacketSize < polarityPacketSize) {
+			newPolarityPacketSize = polarityPacketSize;
+		}
+
+		if (newSpecialPacketSize < specialPacketSize) {
+			newSpecialPacketSize = specialPacketSize;
+		}
+
+		if (newIMU6PacketSize < imu6PacketSize) {
+			newIMU6PacketSize = imu6PacketSize;
+		}
+
+		if (newPolarityPacketSize == polarityPacketSize && newSpecialPacketSize == specialPacketSize
+			&& newIMU6PacketSize == imu6PacketSize) {
+			return;
+		}
+
+		reason = "event rate";
+	}
+
+	int32_t newContainerSize = newPolarityPacketSize + newSpecialPacketSize + newIMU6PacketSize + framePacketSize;
+
+	caerLog(CAER_LOG_INFO, subSystemString,
+		"Packets: container interval %" PRIi32 " µs -> %" PRIi32 " µs, polarity packet size %" PRIi32 " -> %" PRIi32
+		", because of %s (%.0f%% CPU load, %.0f containers/s, %.0f µs CPU per container).", containerInterval,
+		newContainerInterval, polarityPacketSize, newPolarityPacketSize, reason, cpuLoad * 100, containerRate,
+		containerCPUTime * 1000000);
+
+	// Goes to the device through the system/ node listener. Packet sizes go
+	// first, so that the container is never sized smaller than its packets.
+	sshsNodePutInt(tuner->sysNode, "PolarityPacketMaxSize", newPolarityPacketSize);
+	sshsNodePutInt(tuner->sysNode, "PolarityPacketMaxInterval", newContainerInterval);
+	sshsNodePutInt(tuner->sysNode, "SpecialPacketMaxSize", newSpecialPacketSize);
+	sshsNodePutInt(tuner->sysNode, "SpecialPacketMaxInterval", newContainerInterval);
+	sshsNodePutInt(tuner->sysNode, "IMU6PacketMaxSize", newIMU6PacketSize);
+	sshsNodePutInt(tuner->sysNode, "IMU6PacketMaxInterval", newContainerInterval);
+	sshsNodePutInt(tuner->sysNode, "PacketContainerMaxSize", newContainerSize);
+	sshsNodePutInt(tuner->sysNode, "PacketContainerMaxInterval", newContainerInterval);
+
+	tuner->adjustments++;
+	sshsNodePutLong(tuner->sysNode, "AutoTuneAdjustments", tuner->adjustments);
+}
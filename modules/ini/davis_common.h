@@ -11,4 +11,33 @@ bool caerInputDAVISInit(caerModuleData moduleData, uint16_t deviceType);
 void caerInputDAVISExit(caerModuleData moduleData);
 void caerInputDAVISRun(caerModuleData moduleData, size_t argsNumber, va_list args);
 
+// The configuration tree of a DAVIS with the chip in devInfo, created with
+// default values for any setting that doesn't exist yet. Nothing is sent.
+void caerInputDAVISCreateConfiguration(caerModuleData moduleData, struct caer_davis_info *devInfo);
+// Name of the sub-node (with trailing slash) holding a chip's configuration.
+const char *caerInputDAVISChipName(int16_t chipID);
+
+// The device calls of the DAVIS inputs, so they can run against something
+// other than libcaer, like a fake device that disconnects on demand.
+struct caer_input_davis_backend {
+	caerDeviceHandle (*open)(uint16_t deviceID, uint16_t deviceType, uint8_t busNumberRestrict,
+		uint8_t devAddressRestrict, const char *serialNumberRestrict);
+	bool (*close)(caerDeviceHandle *handlePtr);
+	bool (*dataStart)(caerDeviceHandle handle, void (*dataNotifyIncrease)(void *ptr),
+		void (*dataNotifyDecrease)(void *ptr), void *dataNotifyUserPtr, void (*dataShutdownNotify)(void *ptr),
+		void *dataShutdownUserPtr);
+	bool (*dataStop)(caerDeviceHandle handle);
+	caerEventPacketContainer (*dataGet)(caerDeviceHandle handle);
+	bool (*configSet)(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t param);
+	bool (*configGet)(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t *param);
+	struct caer_davis_info (*infoGet)(caerDeviceHandle handle);
+};
+
+// Use backend for all DAVIS inputs, or libcaer again if NULL. Only call
+// this before the mainloops start.
+void caerInputDAVISSetBackend(const struct caer_input_davis_backend *backend);
+// Set a device configuration parameter through the current backend, for
+// modules that act on the handle of a DAVIS input (like the sync input).
+bool caerInputDAVISConfigSet(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t param);
+
 #endif /* DAVIS_COMMON_H_ */
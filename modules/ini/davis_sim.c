@@ -0,0 +1,1009 @@
+/*
+ * davis_sim.c
+ *
+ *  Replays an AEDAT 3.x recording of a DAVIS as if the camera were attached.
+ *  The module has the configuration tree of the recorded chip, like the real
+ *  DAVIS inputs, and a data thread in place of the device's, which paces the
+ *  events by their timestamps and builds packets and containers following
+ *  the system/ settings. Data is handed over through a ring-buffer of
+ *  DataExchangeBufferSize containers, which in real time drops what doesn't fit.
+ *
+ *  Some settings act on the data: the multiplexer, dvs, aps and imu Run
+ *  switches drop their events, TimestampReset resets timestamps, and the
+ *  refractory bias (RefrBp) thins out polarity events. The recording is
+ *  taken to be made with the default biases, and as events can't be made
+ *  up, a larger refractory current than that has no effect.
+ */
+
+#include "davis_common.h"
+#include "davis_sim.h"
+#include "modules/misc/in/in_common.h"
+#include "modules/misc/file_index.h"
+#include "ext/portable_time.h"
+#include "ext/ringbuffer/ringbuffer.h"
+
+#include <fcntl.h>
+#include <math.h>
+
+// Packets of the event types a DAVIS produces, at the index of their type.
+#define DAVIS_SIM_EVENT_TYPES 4
+
+// Longest single sleep while pacing, so that stopping doesn't wait on it (ns).
+#define DAVIS_SIM_SLEEP_MAX 50000000L
+
+// What the data thread does, from the configuration. Read once per recorded
+// packet, like a device would apply changes with some delay.
+struct davis_sim_settings {
+	bool muxRun;
+	bool dvsRun;
+	bool apsRun;
+	bool imuRun;
+	double polarityRate; // Fraction of polarity events to keep.
+	int32_t containerMaxSize;
+	int32_t containerMaxInterval;
+	int32_t packetMaxSize[DAVIS_SIM_EVENT_TYPES];
+	int32_t packetMaxInterval[DAVIS_SIM_EVENT_TYPES];
+	bool realTime;
+	bool loop;
+};
+
+struct davis_sim_state {
+	// Recording.
+	int fileDescriptor;
+	bool compressed;
+	bool checksum;
+	uint64_t checksumFailures;
+	off_t dataOffset;
+	int16_t recordedSource; // Only the first source is replayed, -1 until known.
+	// Simulated device.
+	struct caer_davis_info devInfo;
+	char deviceString[64];
+	sshsNode moduleNode;
+	sshsNode deviceConfigNode;
+	sshsNode sysNode;
+	sshsNode refractoryNode;
+	// Data thread and exchange with the mainloop.
+	thrd_t dataThread;
+	atomic_bool running;
+	atomic_bool timestampReset;
+	RingBuffer dataExchange;
+	void *dataNotifyUserPtr;
+	// Everything below belongs to the data thread while it runs.
+	struct davis_sim_settings settings;
+	caerEventPacketHeader packets[DAVIS_SIM_EVENT_TYPES];
+	int64_t packetStart[DAVIS_SIM_EVENT_TYPES];
+	int32_t containerEvents;
+	int64_t containerStart;
+	int64_t containerEnd;
+	int32_t tsOverflow;
+	int64_t timeOffset; // From recorded to simulated timestamps.
+	bool timeOffsetValid; // Else the next event is at time zero.
+	double polarityCredit;
+	bool pacingValid;
+	struct timespec pacingStart;
+	int64_t pacingStartTimestamp;
+	// Statistics, posted to SSHS from the mainloop.
+	atomic_uint_fast64_t droppedContainers;
+	atomic_uint_fast64_t suppressedEvents;
+	uint64_t postedDroppedContainers;
+	uint64_t postedSuppressedEvents;
+};
+
+typedef struct davis_sim_state *davisSimState;
+
+static bool caerInputDAVISSimInit(caerModuleData moduleData);
+static void caerInputDAVISSimRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+// CONFIG: Nothing to do here in the main thread!
+// Like for a device, the data thread picks up configuration changes.
+static void caerInputDAVISSimExit(caerModuleData moduleData);
+static bool simOpenRecording(caerModuleData moduleData);
+static bool simParseHeader(caerModuleData moduleData);
+static void simParseSourceInfo(davisSimState state, char *sourceInfo);
+static void simDefaultInfo(struct caer_davis_info *devInfo);
+static void simPutSourceInfo(caerModuleData moduleData, struct caer_davis_info *devInfo);
+static caerEventPacketHeader simReadPacket(caerModuleData moduleData);
+static void simSettingsUpdate(davisSimState state);
+static double simPolarityRate(davisSimState state);
+static double simCoarseFineCurrent(int32_t coarseValue, int32_t fineValue);
+static int simDataThread(void *ptr);
+static void simReplayPacket(caerModuleData moduleData, caerEventPacketHeader packet);
+static void simReplayEvent(caerModuleData moduleData, caerEventPacketHeader packet, void *event, int16_t type);
+static bool simAppendEvent(caerModuleData moduleData, caerEventPacketHeader packet, void *event, int16_t type,
+	int64_t timestamp);
+static int64_t simTimestamp(davisSimState state, int64_t recordedTimestamp);
+static void simSetTimestamps(void *event, caerEventPacketHeaderConst packet, int16_t type, int64_t shift);
+static void simSpecialEvent(caerModuleData moduleData, enum caer_special_event_types type);
+static void simTimestampReset(caerModuleData moduleData);
+static void simCommit(caerModuleData moduleData);
+static void simPace(davisSimState state, int64_t timestamp);
+static void simStagedFree(davisSimState state);
+static void simStatisticsUpdate(caerModuleData moduleData);
+static void simMuxConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+
+static struct caer_module_functions caerInputDAVISSimFunctions = { .moduleInit = &caerInputDAVISSimInit, .moduleRun =
+	&caerInputDAVISSimRun, .moduleConfig = NULL, .moduleExit = &caerInputDAVISSimExit };
+
+caerEventPacketContainer caerInputDAVISSim(uint16_t moduleID) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "DAVISSim");
+
+	caerEventPacketContainer result = NULL;
+
+	caerModuleSM(&caerInputDAVISSimFunctions, moduleData, sizeof(struct davis_sim_state), 1, &result);
+
+	return (result);
+}
+
+static bool caerInputDAVISSimInit(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Initializing module ...");
+
+	// Recording to replay, and whether to start over at its end.
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "directory", ".");
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "filename", "davis.aedat");
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "Loop", true);
+
+	// Deliver data at the pace it was recorded at. Else it comes as fast as
+	// the mainloop takes it, and a full ring-buffer is waited on.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "RealTime", true);
+
+	// Statistics, read-only.
+	sshsNodePutLong(moduleData->moduleNode, "DroppedContainers", 0);
+	sshsNodePutLong(moduleData->moduleNode, "SuppressedEvents", 0);
+
+	if (!simOpenRecording(moduleData)) {
+		return (false);
+	}
+
+	if (caerStrEquals(caerInputDAVISChipName(state->devInfo.chipID), "Unknown/")) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Recording is of unknown chip %" PRIi16 ".",
+			state->devInfo.chipID);
+		close(state->fileDescriptor);
+
+		return (false);
+	}
+
+	// Present as a device would.
+	snprintf(state->deviceString, sizeof(state->deviceString), "DAVIS Simulator ID-%" PRIu16, moduleData->moduleID);
+	state->devInfo.deviceID = moduleData->moduleID;
+	state->devInfo.deviceString = state->deviceString;
+
+	simPutSourceInfo(moduleData, &state->devInfo);
+
+	caerModuleSetSubSystemString(moduleData, state->deviceString);
+
+	// Same settings as the real device, so configurations carry over.
+	caerInputDAVISCreateConfiguration(moduleData, &state->devInfo);
+
+	state->moduleNode = moduleData->moduleNode;
+	state->deviceConfigNode = sshsGetRelativeNode(moduleData->moduleNode,
+		caerInputDAVISChipName(state->devInfo.chipID));
+	state->sysNode = sshsGetRelativeNode(moduleData->moduleNode, "system/");
+	state->refractoryNode = sshsGetRelativeNode(state->deviceConfigNode, "bias/RefrBp/");
+
+	state->dataExchange = ringBufferInit((size_t) sshsNodeGetInt(state->sysNode, "DataExchangeBufferSize"));
+	if (state->dataExchange == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to initialize data exchange buffer (size must be a power of two).");
+		close(state->fileDescriptor);
+
+		return (false);
+	}
+
+	state->dataNotifyUserPtr = caerMainloopGetReference();
+
+	for (size_t i = 0; i < DAVIS_SIM_EVENT_TYPES; i++) {
+		state->packets[i] = NULL;
+	}
+	state->containerEvents = 0;
+	state->tsOverflow = 0;
+	state->timeOffsetValid = false;
+	state->polarityCredit = 0;
+	state->pacingValid = false;
+
+	atomic_store(&state->timestampReset, false);
+	atomic_store(&state->droppedContainers, 0);
+	atomic_store(&state->suppressedEvents, 0);
+	state->postedDroppedContainers = 0;
+	state->postedSuppressedEvents = 0;
+
+	atomic_store(&state->running, true);
+
+	if (thrd_create(&state->dataThread, &simDataThread, moduleData) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to start data thread.");
+		ringBufferFree(state->dataExchange);
+		close(state->fileDescriptor);
+
+		return (false);
+	}
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNode muxNode = sshsGetRelativeNode(state->deviceConfigNode, "multiplexer/");
+	sshsNodeAddAttributeListener(muxNode, moduleData, &simMuxConfigListener);
+
+	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "Replaying %s recording.",
+		caerInputDAVISChipName(state->devInfo.chipID));
+
+	return (true);
+}
+
+static void caerInputDAVISSimRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	UNUSED_ARGUMENT(argsNumber);
+	davisSimState state = moduleData->moduleState;
+
+	// Interpret variable arguments (same as above in main function).
+	caerEventPacketContainer *container = va_arg(args, caerEventPacketContainer *);
+
+	*container = ringBufferGet(state->dataExchange);
+
+	if (*container != NULL) {
+		mainloopDataNotifyDecrease(state->dataNotifyUserPtr);
+		caerMainloopFreeAfterLoop((void (*)(void *)) &caerEventPacketContainerFree, *container);
+	}
+
+	simStatisticsUpdate(moduleData);
+}
+
+static void caerInputDAVISSimExit(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNode muxNode = sshsGetRelativeNode(state->deviceConfigNode, "multiplexer/");
+	sshsNodeRemoveAttributeListener(muxNode, moduleData, &simMuxConfigListener);
+
+	atomic_store(&state->running, false);
+
+	if (thrd_join(state->dataThread, NULL) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to join data thread.");
+	}
+
+	// Drop what the mainloop didn't get to.
+	caerEventPacketContainer container;
+	while ((container = ringBufferGet(state->dataExchange)) != NULL) {
+		mainloopDataNotifyDecrease(state->dataNotifyUserPtr);
+		caerEventPacketContainerFree(container);
+	}
+
+	ringBufferFree(state->dataExchange);
+
+	close(state->fileDescriptor);
+
+	simStatisticsUpdate(moduleData);
+}
+
+static bool simOpenRecording(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+	char *fileName = sshsNodeGetString(moduleData->moduleNode, "filename");
+
+	size_t filePathLength = strlen(directory) + strlen(fileName) + 2; // 1 for the separating slash.
+	char filePath[filePathLength];
+	snprintf(filePath, filePathLength, "%s/%s", directory, fileName);
+
+	free(directory);
+	free(fileName);
+
+	state->fileDescriptor = open(filePath, O_RDONLY);
+	if (state->fileDescriptor < 0) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Could not open recording '%s' for reading. Error: %d.", filePath, errno);
+
+		return (false);
+	}
+
+	if (!simParseHeader(moduleData)) {
+		close(state->fileDescriptor);
+
+		return (false);
+	}
+
+	state->dataOffset = lseek(state->fileDescriptor, 0, SEEK_CUR);
+
+	return (true);
+}
+
+// Parse the AEDAT 3.x text header, like the file input does, leaving the
+// file at the first packet. The source information of the first source
+// describes the simulated device.
+static bool simParseHeader(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	state->compressed = false;
+	state->checksum = false;
+	state->checksumFailures = 0;
+	state->recordedSource = -1;
+
+	simDefaultInfo(&state->devInfo);
+
+	char line[1024];
+
+	while (true) {
+		off_t lineStart = lseek(state->fileDescriptor, 0, SEEK_CUR);
+
+		char c;
+		if (read(state->fileDescriptor, &c, 1) != 1) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Recording is empty.");
+			return (false);
+		}
+
+		if (c != '#') {
+			lseek(state->fileDescriptor, lineStart, SEEK_SET);
+			return (true);
+		}
+
+		size_t lineLength = 0;
+		line[lineLength++] = c;
+
+		while (read(state->fileDescriptor, &c, 1) == 1 && c != '\n') {
+			if (lineLength < (sizeof(line) - 1)) {
+				line[lineLength++] = c;
+			}
+		}
+
+		if (lineLength > 0 && line[lineLength - 1] == '\r') {
+			lineLength--;
+		}
+		line[lineLength] = '\0';
+
+		if (caerStrEquals(line, "#!END-HEADER")) {
+			return (true);
+		}
+
+		if (strncmp(line, "#SourceInfo ", 12) == 0) {
+			simParseSourceInfo(state, line + 12);
+		}
+
+		if (strncmp(line, "#Format: ", 9) == 0) {
+			if (caerStrEquals(line + 9, CAERDELTA_FORMAT_NAME)) {
+				state->compressed = true;
+			}
+			else if (!caerStrEquals(line + 9, "RAW")) {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Unsupported recording format '%s'.",
+					line + 9);
+				return (false);
+			}
+		}
+
+		if (strncmp(line, "#Checksum: ", 11) == 0) {
+			if (caerStrEquals(line + 11, "CRC32C")) {
+				state->checksum = true;
+			}
+			else {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Unsupported recording checksum '%s'.",
+					line + 11);
+				return (false);
+			}
+		}
+	}
+}
+
+// Lines are '<sourceID>: <type> <key> <value>'.
+static void simParseSourceInfo(davisSimState state, char *sourceInfo) {
+	char *type;
+	long sourceID = strtol(sourceInfo, &type, 10);
+	if (type == sourceInfo || type[0] != ':' || type[1] != ' ' || sourceID < 0 || sourceID > INT16_MAX) {
+		return;
+	}
+	type += 2;
+
+	char *key = strchr(type, ' ');
+	if (key == NULL) {
+		return;
+	}
+	key++;
+
+	char *value = strchr(key, ' ');
+	if (value == NULL) {
+		return;
+	}
+	*value++ = '\0';
+
+	if (state->recordedSource < 0) {
+		state->recordedSource = I16T(sourceID);
+	}
+
+	if (sourceID != state->recordedSource) {
+		return;
+	}
+
+	struct caer_davis_info *devInfo = &state->devInfo;
+	bool boolValue = caerStrEquals(value, "true");
+	int16_t shortValue = I16T(strtol(value, NULL, 10));
+
+	if (caerStrEquals(key, "chipID")) {
+		devInfo->chipID = shortValue;
+	}
+	else if (caerStrEquals(key, "logicVersion")) {
+		devInfo->logicVersion = shortValue;
+	}
+	else if (caerStrEquals(key, "deviceIsMaster")) {
+		devInfo->deviceIsMaster = boolValue;
+	}
+	else if (caerStrEquals(key, "dvsSizeX")) {
+		devInfo->dvsSizeX = shortValue;
+	}
+	else if (caerStrEquals(key, "dvsSizeY")) {
+		devInfo->dvsSizeY = shortValue;
+	}
+	else if (caerStrEquals(key, "dvsHasPixelFilter")) {
+		devInfo->dvsHasPixelFilter = boolValue;
+	}
+	else if (caerStrEquals(key, "dvsHasBackgroundActivityFilter")) {
+		devInfo->dvsHasBackgroundActivityFilter = boolValue;
+	}
+	else if (caerStrEquals(key, "dvsHasTestEventGenerator")) {
+		devInfo->dvsHasTestEventGenerator = boolValue;
+	}
+	else if (caerStrEquals(key, "apsSizeX")) {
+		devInfo->apsSizeX = shortValue;
+	}
+	else if (caerStrEquals(key, "apsSizeY")) {
+		devInfo->apsSizeY = shortValue;
+	}
+	else if (caerStrEquals(key, "apsColorFilter")) {
+		devInfo->apsColorFilter = U8T(shortValue);
+	}
+	else if (caerStrEquals(key, "apsHasGlobalShutter")) {
+		devInfo->apsHasGlobalShutter = boolValue;
+	}
+	else if (caerStrEquals(key, "apsHasQuadROI")) {
+		devInfo->apsHasQuadROI = boolValue;
+	}
+	else if (caerStrEquals(key, "apsHasExternalADC")) {
+		devInfo->apsHasExternalADC = boolValue;
+	}
+	else if (caerStrEquals(key, "apsHasInternalADC")) {
+		devInfo->apsHasInternalADC = boolValue;
+	}
+	else if (caerStrEquals(key, "extInputHasGenerator")) {
+		devInfo->extInputHasGenerator = boolValue;
+	}
+	else if (caerStrEquals(key, "extInputHasExtraDetectors")) {
+		devInfo->extInputHasExtraDetectors = boolValue;
+	}
+}
+
+// Without source information in the recording, it's taken to be from a
+// DAVIS240C. Clocks aren't recorded, they only scale timing defaults.
+static void simDefaultInfo(struct caer_davis_info *devInfo) {
+	memset(devInfo, 0, sizeof(struct caer_davis_info));
+
+	devInfo->deviceIsMaster = true;
+	devInfo->logicClock = 80;
+	devInfo->adcClock = 30;
+	devInfo->chipID = 2;
+	devInfo->dvsSizeX = 240;
+	devInfo->dvsSizeY = 180;
+	devInfo->apsSizeX = 240;
+	devInfo->apsSizeY = 180;
+	devInfo->apsHasGlobalShutter = true;
+	devInfo->apsHasExternalADC = true;
+}
+
+static void simPutSourceInfo(caerModuleData moduleData, struct caer_davis_info *devInfo) {
+	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
+
+	sshsNodePutShort(sourceInfoNode, "logicVersion", devInfo->logicVersion);
+	sshsNodePutBool(sourceInfoNode, "deviceIsMaster", devInfo->deviceIsMaster);
+	sshsNodePutShort(sourceInfoNode, "chipID", devInfo->chipID);
+
+	sshsNodePutShort(sourceInfoNode, "dvsSizeX", devInfo->dvsSizeX);
+	sshsNodePutShort(sourceInfoNode, "dvsSizeY", devInfo->dvsSizeY);
+	sshsNodePutBool(sourceInfoNode, "dvsHasPixelFilter", devInfo->dvsHasPixelFilter);
+	sshsNodePutBool(sourceInfoNode, "dvsHasBackgroundActivityFilter", devInfo->dvsHasBackgroundActivityFilter);
+	sshsNodePutBool(sourceInfoNode, "dvsHasTestEventGenerator", devInfo->dvsHasTestEventGenerator);
+
+	sshsNodePutShort(sourceInfoNode, "apsSizeX", devInfo->apsSizeX);
+	sshsNodePutShort(sourceInfoNode, "apsSizeY", devInfo->apsSizeY);
+	sshsNodePutByte(sourceInfoNode, "apsColorFilter", I8T(devInfo->apsColorFilter));
+	sshsNodePutBool(sourceInfoNode, "apsHasGlobalShutter", devInfo->apsHasGlobalShutter);
+	sshsNodePutBool(sourceInfoNode, "apsHasQuadROI", devInfo->apsHasQuadROI);
+	sshsNodePutBool(sourceInfoNode, "apsHasExternalADC", devInfo->apsHasExternalADC);
+	sshsNodePutBool(sourceInfoNode, "apsHasInternalADC", devInfo->apsHasInternalADC);
+
+	sshsNodePutBool(sourceInfoNode, "extInputHasGenerator", devInfo->extInputHasGenerator);
+	sshsNodePutBool(sourceInfoNode, "extInputHasExtraDetectors", devInfo->extInputHasExtraDetectors);
+}
+
+// Next packet of the recorded source with events a DAVIS makes, or NULL at
+// the end of the data. The packet index, if present, marks that end.
+static caerEventPacketHeader simReadPacket(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	while (true) {
+		caerEventPacketHeader packet;
+
+		if (state->checksum) {
+			packet = caerInputCommonReadCheckedPacket(moduleData->moduleSubSystemString, state->fileDescriptor,
+				state->compressed, CAER_INPUT_CHECKSUM_DROP, &state->checksumFailures);
+		}
+		else if (state->compressed) {
+			packet = caerInputCommonReadDeltaPacket(state->fileDescriptor, NULL);
+		}
+		else {
+			packet = caerInputCommonReadPacket(state->fileDescriptor, NULL);
+		}
+
+		if (packet == NULL) {
+			return (NULL);
+		}
+
+		int16_t type = caerEventPacketHeaderGetEventType(packet);
+
+		if (type == CAER_FILE_INDEX_EVENT_TYPE) {
+			free(packet);
+			return (NULL);
+		}
+
+		if (state->recordedSource < 0) {
+			state->recordedSource = caerEventPacketHeaderGetEventSource(packet);
+		}
+
+		if (type >= 0 && type < DAVIS_SIM_EVENT_TYPES
+			&& caerEventPacketHeaderGetEventSource(packet) == state->recordedSource) {
+			return (packet);
+		}
+
+		free(packet);
+	}
+}
+
+static void simSettingsUpdate(davisSimState state) {
+	struct davis_sim_settings *settings = &state->settings;
+
+	settings->muxRun = sshsNodeGetBool(sshsGetRelativeNode(state->deviceConfigNode, "multiplexer/"), "Run");
+	settings->dvsRun = sshsNodeGetBool(sshsGetRelativeNode(state->deviceConfigNode, "dvs/"), "Run");
+	settings->apsRun = sshsNodeGetBool(sshsGetRelativeNode(state->deviceConfigNode, "aps/"), "Run");
+	settings->imuRun = sshsNodeGetBool(sshsGetRelativeNode(state->deviceConfigNode, "imu/"), "Run");
+
+	settings->polarityRate = simPolarityRate(state);
+
+	settings->containerMaxSize = sshsNodeGetInt(state->sysNode, "PacketContainerMaxSize");
+	settings->containerMaxInterval = sshsNodeGetInt(state->sysNode, "PacketContainerMaxInterval");
+	settings->packetMaxSize[SPECIAL_EVENT] = sshsNodeGetInt(state->sysNode, "SpecialPacketMaxSize");
+	settings->packetMaxInterval[SPECIAL_EVENT] = sshsNodeGetInt(state->sysNode, "SpecialPacketMaxInterval");
+	settings->packetMaxSize[POLARITY_EVENT] = sshsNodeGetInt(state->sysNode, "PolarityPacketMaxSize");
+	settings->packetMaxInterval[POLARITY_EVENT] = sshsNodeGetInt(state->sysNode, "PolarityPacketMaxInterval");
+	settings->packetMaxSize[FRAME_EVENT] = sshsNodeGetInt(state->sysNode, "FramePacketMaxSize");
+	settings->packetMaxInterval[FRAME_EVENT] = sshsNodeGetInt(state->sysNode, "FramePacketMaxInterval");
+	settings->packetMaxSize[IMU6_EVENT] = sshsNodeGetInt(state->sysNode, "IMU6PacketMaxSize");
+	settings->packetMaxInterval[IMU6_EVENT] = sshsNodeGetInt(state->sysNode, "IMU6PacketMaxInterval");
+
+	// Zero or less would never commit, or commit forever.
+	for (size_t i = 0; i < DAVIS_SIM_EVENT_TYPES; i++) {
+		if (settings->packetMaxSize[i] < 1) {
+			settings->packetMaxSize[i] = 1;
+		}
+	}
+	if (settings->containerMaxSize < 1) {
+		settings->containerMaxSize = 1;
+	}
+
+	settings->realTime = sshsNodeGetBool(state->moduleNode, "RealTime");
+	settings->loop = sshsNodeGetBool(state->moduleNode, "Loop");
+}
+
+// The refractory current sets how fast a pixel can fire again, and with that
+// the event rate of busy pixels. Relative to the default bias, which the
+// recording is taken to be made with.
+static double simPolarityRate(davisSimState state) {
+	if (!sshsNodeGetBool(state->refractoryNode, "enabled")) {
+		// Pixels never recover.
+		return (0);
+	}
+
+	double current = simCoarseFineCurrent(sshsNodeGetByte(state->refractoryNode, "coarseValue"),
+		sshsNodeGetShort(state->refractoryNode, "fineValue"));
+	double defaultCurrent = (IS_DAVISRGB(state->devInfo.chipID)) ? (simCoarseFineCurrent(2, 62)) :
+		(simCoarseFineCurrent(4, 25));
+
+	double rate = current / defaultCurrent;
+
+	return ((rate > 1) ? (1) : (rate));
+}
+
+// In arbitrary units, only ratios are meaningful: the fine value scales the
+// coarse current linearly, and each coarse step is a factor of eight.
+static double simCoarseFineCurrent(int32_t coarseValue, int32_t fineValue) {
+	return (pow(8, coarseValue & 0x07) * (fineValue & 0xFF));
+}
+
+static int simDataThread(void *ptr) {
+	caerModuleData moduleData = ptr;
+	davisSimState state = moduleData->moduleState;
+
+	// A recording without events would otherwise be looped over forever.
+	bool replayed = false;
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		simSettingsUpdate(state);
+
+		if (atomic_exchange(&state->timestampReset, false)) {
+			simTimestampReset(moduleData);
+		}
+
+		caerEventPacketHeader packet = simReadPacket(moduleData);
+
+		if (packet == NULL) {
+			simCommit(moduleData);
+
+			if (!state->settings.loop || !replayed) {
+				caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "End of recording reached.");
+				break;
+			}
+
+			lseek(state->fileDescriptor, state->dataOffset, SEEK_SET);
+			replayed = false;
+
+			// Time starts over with the recording.
+			simTimestampReset(moduleData);
+			continue;
+		}
+
+		if (caerEventPacketHeaderGetEventNumber(packet) > 0) {
+			replayed = true;
+		}
+
+		simReplayPacket(moduleData, packet);
+		free(packet);
+	}
+
+	simStagedFree(state);
+
+	return (thrd_success);
+}
+
+static void simReplayPacket(caerModuleData moduleData, caerEventPacketHeader packet) {
+	davisSimState state = moduleData->moduleState;
+
+	int16_t type = caerEventPacketHeaderGetEventType(packet);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	bool run = state->settings.muxRun && (type != POLARITY_EVENT || state->settings.dvsRun)
+		&& (type != FRAME_EVENT || state->settings.apsRun) && (type != IMU6_EVENT || state->settings.imuRun);
+
+	if (!run) {
+		// Time goes on without the data.
+		if (eventNumber > 0) {
+			void *lastEvent = caerGenericEventGetEvent(packet, eventNumber - 1);
+			simPace(state, simTimestamp(state, caerGenericEventGetTimestamp64(lastEvent, packet)));
+
+			atomic_fetch_add_explicit(&state->suppressedEvents, U64T(eventNumber), memory_order_relaxed);
+		}
+
+		return;
+	}
+
+	for (int32_t i = 0; i < eventNumber; i++) {
+		void *event = caerGenericEventGetEvent(packet, i);
+
+		if (caerGenericEventIsValid(event)) {
+			simReplayEvent(moduleData, packet, event, type);
+		}
+	}
+}
+
+static void simReplayEvent(caerModuleData moduleData, caerEventPacketHeader packet, void *event, int16_t type) {
+	davisSimState state = moduleData->moduleState;
+
+	if (type == SPECIAL_EVENT) {
+		uint8_t specialType = caerSpecialEventGetType(event);
+
+		// Wraps are made anew for the new timestamps, recorded resets are
+		// replayed like requested ones.
+		if (specialType == TIMESTAMP_WRAP) {
+			return;
+		}
+
+		if (specialType == TIMESTAMP_RESET) {
+			simTimestampReset(moduleData);
+			return;
+		}
+	}
+
+	if (type == POLARITY_EVENT) {
+		// Keep an even share of the events.
+		state->polarityCredit += state->settings.polarityRate;
+
+		if (state->polarityCredit < 1) {
+			atomic_fetch_add_explicit(&state->suppressedEvents, 1, memory_order_relaxed);
+			return;
+		}
+
+		state->polarityCredit -= 1;
+	}
+
+	int64_t timestamp = simTimestamp(state, caerGenericEventGetTimestamp64(event, packet));
+
+	int32_t tsOverflow = I32T(timestamp >> TS_OVERFLOW_SHIFT);
+
+	if (tsOverflow > state->tsOverflow) {
+		simSpecialEvent(moduleData, TIMESTAMP_WRAP);
+		simCommit(moduleData);
+
+		state->tsOverflow = tsOverflow;
+	}
+	else if (tsOverflow < state->tsOverflow) {
+		// Frames start before the events around them, don't go back over a wrap.
+		timestamp = I64T(state->tsOverflow) << TS_OVERFLOW_SHIFT;
+	}
+
+	// Commit on time before adding, and on size after, like the device.
+	if ((state->containerEvents > 0 && (timestamp - state->containerStart) >= state->settings.containerMaxInterval)
+		|| (state->packets[type] != NULL
+			&& (timestamp - state->packetStart[type]) >= state->settings.packetMaxInterval[type])) {
+		simCommit(moduleData);
+	}
+
+	if (!simAppendEvent(moduleData, packet, event, type, timestamp)) {
+		return;
+	}
+
+	int32_t packetEvents = caerEventPacketHeaderGetEventNumber(state->packets[type]);
+
+	if (state->containerEvents >= state->settings.containerMaxSize
+		|| packetEvents >= state->settings.packetMaxSize[type]
+		|| packetEvents >= caerEventPacketHeaderGetEventCapacity(state->packets[type])) {
+		simCommit(moduleData);
+	}
+}
+
+static bool simAppendEvent(caerModuleData moduleData, caerEventPacketHeader packet, void *event, int16_t type,
+	int64_t timestamp) {
+	davisSimState state = moduleData->moduleState;
+
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
+
+	// Frames of another size need a packet of their own.
+	if (state->packets[type] != NULL && caerEventPacketHeaderGetEventSize(state->packets[type]) != eventSize) {
+		simCommit(moduleData);
+	}
+
+	if (state->packets[type] == NULL) {
+		int32_t capacity = state->settings.packetMaxSize[type];
+
+		caerEventPacketHeader newPacket = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t) (capacity * eventSize));
+		if (newPacket == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for event packet.");
+			return (false);
+		}
+
+		// Same layout as the recorded packet, but from this device.
+		memcpy(newPacket, packet, CAER_EVENT_PACKET_HEADER_SIZE);
+		caerEventPacketHeaderSetEventSource(newPacket, I16T(moduleData->moduleID));
+		caerEventPacketHeaderSetEventTSOverflow(newPacket, state->tsOverflow);
+		caerEventPacketHeaderSetEventCapacity(newPacket, capacity);
+		caerEventPacketHeaderSetEventNumber(newPacket, 0);
+		caerEventPacketHeaderSetEventValid(newPacket, 0);
+
+		state->packets[type] = newPacket;
+		state->packetStart[type] = timestamp;
+	}
+
+	caerEventPacketHeader stagedPacket = state->packets[type];
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(stagedPacket);
+
+	void *stagedEvent = caerGenericEventGetEvent(stagedPacket, eventNumber);
+	memcpy(stagedEvent, event, (size_t) eventSize);
+	simSetTimestamps(stagedEvent, packet, type, timestamp - caerGenericEventGetTimestamp64(event, packet));
+
+	caerEventPacketHeaderSetEventNumber(stagedPacket, eventNumber + 1);
+	caerEventPacketHeaderSetEventValid(stagedPacket, caerEventPacketHeaderGetEventValid(stagedPacket) + 1);
+
+	if (state->containerEvents == 0) {
+		state->containerStart = timestamp;
+		state->containerEnd = timestamp;
+	}
+	else if (timestamp > state->containerEnd) {
+		state->containerEnd = timestamp;
+	}
+
+	state->containerEvents++;
+
+	return (true);
+}
+
+// Moves all timestamps of an event, copied from the recorded packet, by shift.
+static void simSetTimestamps(void *event, caerEventPacketHeaderConst packet, int16_t type, int64_t shift) {
+	int64_t tsOverflow = I64T(caerEventPacketHeaderGetEventTSOverflow(packet)) << TS_OVERFLOW_SHIFT;
+
+	if (type == FRAME_EVENT) {
+		// Frames carry the times of their readout and of their exposure.
+		caerFrameEvent frame = event;
+
+		caerFrameEventSetTSStartOfFrame(frame,
+			I32T((tsOverflow + caerFrameEventGetTSStartOfFrame(frame) + shift) & INT32_MAX));
+		caerFrameEventSetTSEndOfFrame(frame,
+			I32T((tsOverflow + caerFrameEventGetTSEndOfFrame(frame) + shift) & INT32_MAX));
+		caerFrameEventSetTSStartOfExposure(frame,
+			I32T((tsOverflow + caerFrameEventGetTSStartOfExposure(frame) + shift) & INT32_MAX));
+		caerFrameEventSetTSEndOfExposure(frame,
+			I32T((tsOverflow + caerFrameEventGetTSEndOfExposure(frame) + shift) & INT32_MAX));
+
+		return;
+	}
+
+	uint32_t timestamp = htole32(
+		U32T((tsOverflow + caerGenericEventGetTimestamp(event, packet) + shift) & INT32_MAX));
+	memcpy((uint8_t *) event + caerEventPacketHeaderGetEventTSOffset(packet), &timestamp, sizeof(uint32_t));
+}
+
+// Simulated time starts at zero with the first event after a reset.
+static int64_t simTimestamp(davisSimState state, int64_t recordedTimestamp) {
+	if (!state->timeOffsetValid) {
+		state->timeOffset = -recordedTimestamp;
+		state->timeOffsetValid = true;
+	}
+
+	return (recordedTimestamp + state->timeOffset);
+}
+
+// Special events the device makes itself end the current time base, so they
+// are at its very end, like libcaer puts them.
+static void simSpecialEvent(caerModuleData moduleData, enum caer_special_event_types type) {
+	davisSimState state = moduleData->moduleState;
+
+	caerSpecialEventPacket special = (caerSpecialEventPacket) state->packets[SPECIAL_EVENT];
+
+	if (special != NULL
+		&& caerEventPacketHeaderGetEventNumber(&special->packetHeader)
+			>= caerEventPacketHeaderGetEventCapacity(&special->packetHeader)) {
+		simCommit(moduleData);
+		special = NULL;
+	}
+
+	if (special == NULL) {
+		special = caerSpecialEventPacketAllocate(state->settings.packetMaxSize[SPECIAL_EVENT],
+			I16T(moduleData->moduleID), state->tsOverflow);
+		if (special == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate special event packet.");
+			return;
+		}
+
+		state->packets[SPECIAL_EVENT] = (caerEventPacketHeader) special;
+		state->packetStart[SPECIAL_EVENT] = (I64T(state->tsOverflow) << TS_OVERFLOW_SHIFT) | INT32_MAX;
+	}
+
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(&special->packetHeader);
+	caerSpecialEvent event = caerSpecialEventPacketGetEvent(special, eventNumber);
+
+	caerSpecialEventSetTimestamp(event, INT32_MAX);
+	caerSpecialEventSetType(event, type);
+	caerSpecialEventValidate(event, special);
+
+	caerEventPacketHeaderSetEventNumber(&special->packetHeader, eventNumber + 1);
+
+	// Not a time to pace to.
+	if (state->containerEvents == 0) {
+		state->containerStart = state->containerEnd;
+	}
+
+	state->containerEvents++;
+}
+
+static void simTimestampReset(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	simSpecialEvent(moduleData, TIMESTAMP_RESET);
+	simCommit(moduleData);
+
+	state->tsOverflow = 0;
+	state->timeOffsetValid = false;
+	state->pacingValid = false;
+}
+
+static void simCommit(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	if (state->containerEvents == 0) {
+		return;
+	}
+
+	caerEventPacketContainer container = caerEventPacketContainerAllocate(DAVIS_SIM_EVENT_TYPES);
+	if (container == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate event packet container.");
+		simStagedFree(state);
+		return;
+	}
+
+	for (int32_t i = 0; i < DAVIS_SIM_EVENT_TYPES; i++) {
+		caerEventPacketContainerSetEventPacket(container, i, state->packets[i]);
+		state->packets[i] = NULL;
+	}
+
+	state->containerEvents = 0;
+
+	simPace(state, state->containerEnd);
+
+	while (!ringBufferPut(state->dataExchange, container)) {
+		if (state->settings.realTime || !atomic_load_explicit(&state->running, memory_order_relaxed)) {
+			// Like the device, drop what there's no room for.
+			caerEventPacketContainerFree(container);
+			atomic_fetch_add_explicit(&state->droppedContainers, 1, memory_order_relaxed);
+			return;
+		}
+
+		struct timespec waitTime = { .tv_sec = 0, .tv_nsec = 1000000 };
+		thrd_sleep(&waitTime, NULL);
+	}
+
+	mainloopDataNotifyIncrease(state->dataNotifyUserPtr);
+}
+
+// Wait until as much time passed since pacing started as in the recording.
+static void simPace(davisSimState state, int64_t timestamp) {
+	if (!state->settings.realTime) {
+		state->pacingValid = false;
+		return;
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	if (!state->pacingValid) {
+		state->pacingStart = now;
+		state->pacingStartTimestamp = timestamp;
+		state->pacingValid = true;
+		return;
+	}
+
+	int64_t due = timestamp - state->pacingStartTimestamp;
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		int64_t elapsed = I64T(now.tv_sec - state->pacingStart.tv_sec) * 1000000LL
+			+ I64T(now.tv_nsec - state->pacingStart.tv_nsec) / 1000;
+
+		int64_t remaining = (due - elapsed) * 1000; // In ns.
+		if (remaining <= 0) {
+			break;
+		}
+
+		struct timespec waitTime = { .tv_sec = 0, .tv_nsec = (remaining < DAVIS_SIM_SLEEP_MAX) ? (remaining) :
+			(DAVIS_SIM_SLEEP_MAX) };
+		thrd_sleep(&waitTime, NULL);
+
+		portable_clock_gettime_monotonic(&now);
+	}
+}
+
+static void simStagedFree(davisSimState state) {
+	for (size_t i = 0; i < DAVIS_SIM_EVENT_TYPES; i++) {
+		free(state->packets[i]);
+		state->packets[i] = NULL;
+	}
+
+	state->containerEvents = 0;
+}
+
+static void simStatisticsUpdate(caerModuleData moduleData) {
+	davisSimState state = moduleData->moduleState;
+
+	uint64_t droppedContainers = atomic_load_explicit(&state->droppedContainers, memory_order_relaxed);
+	if (droppedContainers != state->postedDroppedContainers) {
+		sshsNodePutLong(moduleData->moduleNode, "DroppedContainers", I64T(droppedContainers));
+		state->postedDroppedContainers = droppedContainers;
+	}
+
+	uint64_t suppressedEvents = atomic_load_explicit(&state->suppressedEvents, memory_order_relaxed);
+	if (suppressedEvents != state->postedSuppressedEvents) {
+		sshsNodePutLong(moduleData->moduleNode, "SuppressedEvents", I64T(suppressedEvents));
+		state->postedSuppressedEvents = suppressedEvents;
+	}
+}
+
+static void simMuxConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+
+	caerModuleData moduleData = userData;
+	davisSimState state = moduleData->moduleState;
+
+	// Picked up by the data thread, the rest of the multiplexer settings
+	// are read there directly.
+	if (event == ATTRIBUTE_MODIFIED && changeType == BOOL && caerStrEquals(changeKey, "TimestampReset")
+		&& changeValue.boolean) {
+		atomic_store(&state->timestampReset, true);
+	}
+}
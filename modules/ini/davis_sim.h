@@ -0,0 +1,21 @@
+/*
+ * davis_sim.h
+ *
+ *  A simulated DAVIS camera: replays a recording the way a device delivers
+ *  data, behind the same configuration as the real DAVIS inputs.
+ */
+
+#ifndef DAVIS_SIM_H_
+#define DAVIS_SIM_H_
+
+#include "main.h"
+
+#include <libcaer/events/packetContainer.h>
+#include <libcaer/events/special.h>
+#include <libcaer/events/polarity.h>
+#include <libcaer/events/frame.h>
+#include <libcaer/events/imu6.h>
+
+caerEventPacketContainer caerInputDAVISSim(uint16_t moduleID);
+
+#endif /* DAVIS_SIM_H_ */
@@ -0,0 +1,750 @@
+/*
+ * davis_sync.c
+ *
+ *  Combines the data of several DAVIS cameras into time-aligned containers.
+ *  The cameras themselves are regular DAVIS input modules, whose packets are
+ *  taken over and held until every camera has moved past the current window.
+ *
+ *  With sync cables, one camera is the timestamp master and resets the
+ *  timestamps of all others, so they run from the same zero on the same
+ *  clock. A reset of the master is done at start and whenever the cameras
+ *  get out of step: after a reset seen by only some of them, or when their
+ *  offset, measured against host arrival time, goes above tolerance. An
+ *  offset that resets don't fix (no cable) is corrected in software, by
+ *  shifting which window a camera's events go into.
+ */
+
+#include "davis_sync.h"
+#include "davis_common.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "ext/portable_time.h"
+#include "ext/uthash/utarray.h"
+
+#include <libcaer/devices/davis.h>
+
+// A packet taken from a camera, waiting for its window. Events before
+// firstEvent have already been sent on.
+struct davis_sync_held {
+	caerEventPacketHeader packet;
+	int32_t firstEvent;
+};
+
+static const UT_icd ut_davisSyncHeld_icd = { sizeof(struct davis_sync_held), NULL, NULL, NULL };
+
+struct davis_sync_camera {
+	int16_t sourceID; // -1 until the camera's first packet.
+	bool isMaster;
+	sshsNode cameraNode;
+	UT_array *held[DAVIS_SYNC_EVENT_TYPES];
+	int64_t lastTimestamp; // Newest event time seen, in camera time.
+	bool lastTimestampValid;
+	// Offset to the master, from the smallest difference between host arrival
+	// time and camera time in each period: USB only ever adds delay.
+	int64_t minDelay;
+	bool minDelayValid;
+	int64_t offset; // Camera time minus master time, in µs.
+	int64_t appliedOffset; // Offset corrected in software.
+	bool resyncTried;
+	bool resetSeen;
+};
+
+struct davis_sync_state {
+	size_t camerasNumber;
+	struct davis_sync_camera cameras[DAVIS_SYNC_MAX_CAMERAS];
+	size_t master; // Reference camera for offsets.
+	bool hasMaster;
+	bool configured;
+	// Settings.
+	int32_t window;
+	int32_t maxSkew;
+	int32_t tolerance;
+	int32_t measurePeriod;
+	int32_t resyncTimeout;
+	bool autoResync;
+	// Start of the next window, in master time.
+	int64_t windowStart;
+	bool windowStartValid;
+	// While cameras reset their timestamps, everything is passed on as it
+	// comes, until all of them have.
+	bool resyncing;
+	bool resyncRequested;
+	struct timespec resyncStart;
+	struct timespec periodStart;
+	// Statistics.
+	int64_t resets;
+	int64_t resyncs;
+	int64_t latePackets;
+};
+
+typedef struct davis_sync_state *DAVISSyncState;
+
+static bool caerInputDAVISSyncInit(caerModuleData moduleData);
+static void caerInputDAVISSyncRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerInputDAVISSyncConfig(caerModuleData moduleData);
+static void caerInputDAVISSyncExit(caerModuleData moduleData);
+static void camerasInitialize(caerModuleData moduleData, DAVISSyncState state, size_t camerasNumber);
+static bool camerasTakePackets(DAVISSyncState state, size_t cameraIndex, caerEventPacketContainer container,
+	int64_t hostTime);
+static void camerasConfigure(caerModuleData moduleData, DAVISSyncState state);
+static void camerasMeasure(caerModuleData moduleData, DAVISSyncState state, double elapsed);
+static void resyncRequest(caerModuleData moduleData, DAVISSyncState state);
+static void resyncCheck(caerModuleData moduleData, DAVISSyncState state, const struct timespec *now);
+static caerEventPacketContainer windowsEmit(DAVISSyncState state);
+static caerEventPacketContainer containerEmit(DAVISSyncState state, int64_t end);
+static caerEventPacketHeader heldTakeEvents(DAVISSyncState state, struct davis_sync_camera *camera, int16_t eventType,
+	int64_t end);
+static int32_t heldFindSplit(caerEventPacketHeader packet, int32_t firstEvent, int64_t limit);
+
+static struct caer_module_functions caerInputDAVISSyncFunctions = { .moduleInit = &caerInputDAVISSyncInit, .moduleRun =
+	&caerInputDAVISSyncRun, .moduleConfig = &caerInputDAVISSyncConfig, .moduleExit = &caerInputDAVISSyncExit };
+
+caerEventPacketContainer caerInputDAVISSync(uint16_t moduleID, size_t camerasNumber, ...) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "DAVISSync");
+
+	caerEventPacketContainer cameras[DAVIS_SYNC_MAX_CAMERAS] = { NULL };
+
+	va_list args;
+	va_start(args, camerasNumber);
+	for (size_t i = 0; i < camerasNumber; i++) {
+		caerEventPacketContainer container = va_arg(args, caerEventPacketContainer);
+
+		if (i < DAVIS_SYNC_MAX_CAMERAS) {
+			cameras[i] = container;
+		}
+	}
+	va_end(args);
+
+	caerEventPacketContainer result = NULL;
+
+	caerModuleSM(&caerInputDAVISSyncFunctions, moduleData, sizeof(struct davis_sync_state), 3, camerasNumber, cameras,
+		&result);
+
+	return (result);
+}
+
+static bool caerInputDAVISSyncInit(caerModuleData moduleData) {
+	// Length of one window of master time, in µs. Containers hold one or more.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "window", 5000);
+	// Cameras further behind than this (in µs) are considered stalled, and
+	// not waited for anymore.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxSkew", 50000);
+	// Offsets to the master up to this (in µs) are considered in sync.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "tolerance", 1000);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "measurePeriod", 1000); // In ms.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "resyncTimeout", 500); // In ms.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "autoResync", true);
+
+	// Statistics, read-only.
+	sshsNodePutLong(moduleData->moduleNode, "resets", 0);
+	sshsNodePutLong(moduleData->moduleNode, "resyncs", 0);
+	sshsNodePutLong(moduleData->moduleNode, "latePackets", 0);
+
+	DAVISSyncState state = moduleData->moduleState;
+
+	caerInputDAVISSyncConfig(moduleData);
+
+	portable_clock_gettime_monotonic(&state->periodStart);
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	// Cameras are set up on the first run, when it's known how many there are.
+	return (true);
+}
+
+static void caerInputDAVISSyncRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	UNUSED_ARGUMENT(argsNumber);
+
+	// Interpret variable arguments (same as above in main function).
+	size_t camerasNumber = va_arg(args, size_t);
+	caerEventPacketContainer *cameras = va_arg(args, caerEventPacketContainer *);
+	caerEventPacketContainer *result = va_arg(args, caerEventPacketContainer *);
+
+	DAVISSyncState state = moduleData->moduleState;
+
+	if (state->camerasNumber == 0) {
+		camerasInitialize(moduleData, state, camerasNumber);
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	int64_t hostTime = I64T(now.tv_sec) * 1000000LL + I64T(now.tv_nsec / 1000);
+
+	bool resetSeen = false;
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		if (camerasTakePackets(state, i, cameras[i], hostTime)) {
+			resetSeen = true;
+		}
+	}
+
+	if (!state->configured) {
+		camerasConfigure(moduleData, state);
+	}
+
+	if (resetSeen && !state->resyncing) {
+		state->resyncing = true;
+		state->resyncRequested = false;
+		state->resyncStart = now;
+
+		state->resets++;
+		sshsNodePutLong(moduleData->moduleNode, "resets", state->resets);
+	}
+
+	if (state->resyncing) {
+		// Data from before and after the reset can't be put into common
+		// windows, so it goes on as it is.
+		*result = containerEmit(state, INT64_MAX);
+
+		resyncCheck(moduleData, state, &now);
+	}
+	else {
+		double elapsed = (double) (now.tv_sec - state->periodStart.tv_sec)
+			+ ((double) (now.tv_nsec - state->periodStart.tv_nsec) / 1000000000);
+
+		if (elapsed >= ((double) state->measurePeriod / 1000)) {
+			camerasMeasure(moduleData, state, elapsed);
+			state->periodStart = now;
+		}
+
+		int64_t latePackets = state->latePackets;
+
+		*result = windowsEmit(state);
+
+		if (state->latePackets != latePackets) {
+			sshsNodePutLong(moduleData->moduleNode, "latePackets", state->latePackets);
+		}
+	}
+
+	if (*result != NULL) {
+		caerMainloopFreeAfterLoop((void (*)(void *)) &caerEventPacketContainerFree, *result);
+	}
+}
+
+static void caerInputDAVISSyncConfig(caerModuleData moduleData) {
+	caerModuleConfigUpdateReset(moduleData);
+
+	DAVISSyncState state = moduleData->moduleState;
+
+	state->window = sshsNodeGetInt(moduleData->moduleNode, "window");
+	if (state->window < 1) {
+		state->window = 1;
+	}
+
+	state->maxSkew = sshsNodeGetInt(moduleData->moduleNode, "maxSkew");
+	state->tolerance = sshsNodeGetInt(moduleData->moduleNode, "tolerance");
+	state->measurePeriod = sshsNodeGetInt(moduleData->moduleNode, "measurePeriod");
+	state->resyncTimeout = sshsNodeGetInt(moduleData->moduleNode, "resyncTimeout");
+	state->autoResync = sshsNodeGetBool(moduleData->moduleNode, "autoResync");
+}
+
+static void caerInputDAVISSyncExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	DAVISSyncState state = moduleData->moduleState;
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		for (size_t t = 0; t < DAVIS_SYNC_EVENT_TYPES; t++) {
+			struct davis_sync_held *held = NULL;
+			while ((held = (struct davis_sync_held *) utarray_next(state->cameras[i].held[t], held)) != NULL) {
+				free(held->packet);
+			}
+
+			utarray_free(state->cameras[i].held[t]);
+		}
+	}
+
+	state->camerasNumber = 0;
+}
+
+static void camerasInitialize(caerModuleData moduleData, DAVISSyncState state, size_t camerasNumber) {
+	if (camerasNumber > DAVIS_SYNC_MAX_CAMERAS) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Only up to %d cameras are supported, ignoring the other %zu.", DAVIS_SYNC_MAX_CAMERAS,
+			camerasNumber - DAVIS_SYNC_MAX_CAMERAS);
+
+		camerasNumber = DAVIS_SYNC_MAX_CAMERAS;
+	}
+
+	for (size_t i = 0; i < camerasNumber; i++) {
+		struct davis_sync_camera *camera = &state->cameras[i];
+
+		camera->sourceID = -1;
+
+		for (size_t t = 0; t < DAVIS_SYNC_EVENT_TYPES; t++) {
+			utarray_new(camera->held[t], &ut_davisSyncHeld_icd);
+		}
+
+		// Per-camera statistics, read-only.
+		char cameraNodeName[16];
+		snprintf(cameraNodeName, 16, "camera%zu/", i);
+
+		camera->cameraNode = sshsGetRelativeNode(moduleData->moduleNode, cameraNodeName);
+
+		sshsNodePutShort(camera->cameraNode, "sourceID", -1);
+		sshsNodePutBool(camera->cameraNode, "master", false);
+		sshsNodePutLong(camera->cameraNode, "offset", 0);
+		sshsNodePutInt(camera->cameraNode, "drift", 0);
+	}
+
+	state->camerasNumber = camerasNumber;
+}
+
+static bool camerasTakePackets(DAVISSyncState state, size_t cameraIndex, caerEventPacketContainer container,
+	int64_t hostTime) {
+	if (container == NULL) {
+		return (false);
+	}
+
+	struct davis_sync_camera *camera = &state->cameras[cameraIndex];
+
+	bool resetSeen = false;
+	int64_t newestTimestamp = -1;
+
+	for (int32_t i = 0; i < caerEventPacketContainerGetEventPacketsNumber(container); i++) {
+		caerEventPacketHeader packet = caerEventPacketContainerGetEventPacket(container, i);
+		if (packet == NULL || caerEventPacketHeaderGetEventNumber(packet) == 0) {
+			continue;
+		}
+
+		// Other event types are left where they are.
+		int16_t eventType = caerEventPacketHeaderGetEventType(packet);
+		if (eventType < 0 || eventType >= DAVIS_SYNC_EVENT_TYPES) {
+			continue;
+		}
+
+		if (camera->sourceID < 0) {
+			camera->sourceID = caerEventPacketHeaderGetEventSource(packet);
+			sshsNodePutShort(camera->cameraNode, "sourceID", camera->sourceID);
+		}
+
+		if (eventType == SPECIAL_EVENT) {
+			CAER_SPECIAL_ITERATOR_VALID_START((caerSpecialEventPacket) packet)
+				if (caerSpecialEventGetType(caerSpecialIteratorElement) == TIMESTAMP_RESET) {
+					resetSeen = true;
+				}
+			CAER_SPECIAL_ITERATOR_VALID_END
+		}
+
+		void *lastEvent = caerGenericEventGetEvent(packet, caerEventPacketHeaderGetEventNumber(packet) - 1);
+		int64_t lastTimestamp = caerGenericEventGetTimestamp64(lastEvent, packet);
+
+		if (lastTimestamp > newestTimestamp) {
+			newestTimestamp = lastTimestamp;
+		}
+
+		// Take over the packet, its container is freed without it.
+		caerEventPacketContainerSetEventPacket(container, i, NULL);
+
+		struct davis_sync_held held = { .packet = packet, .firstEvent = 0 };
+		utarray_push_back(camera->held[eventType], &held);
+	}
+
+	if (newestTimestamp >= 0) {
+		if (!camera->lastTimestampValid || newestTimestamp > camera->lastTimestamp) {
+			camera->lastTimestamp = newestTimestamp;
+			camera->lastTimestampValid = true;
+		}
+
+		int64_t delay = hostTime - newestTimestamp;
+
+		if (!camera->minDelayValid || delay < camera->minDelay) {
+			camera->minDelay = delay;
+			camera->minDelayValid = true;
+		}
+	}
+
+	if (resetSeen) {
+		// libcaer commits containers on a reset, so what comes next starts
+		// from zero again.
+		camera->resetSeen = true;
+		camera->lastTimestampValid = false;
+		camera->minDelayValid = false;
+	}
+
+	return (resetSeen);
+}
+
+static void camerasConfigure(caerModuleData moduleData, DAVISSyncState state) {
+	// Wait until all cameras are known.
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		if (state->cameras[i].sourceID < 0) {
+			return;
+		}
+	}
+
+	size_t masters = 0;
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		struct davis_sync_camera *camera = &state->cameras[i];
+
+		sshsNode sourceInfoNode = caerMainloopGetSourceInfo(U16T(camera->sourceID));
+
+		if (!sshsNodeAttributeExists(sourceInfoNode, "deviceIsMaster", BOOL)) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Camera %zu (source %" PRIi16 ") is not a DAVIS camera, it can only be aligned in software.", i,
+				camera->sourceID);
+			continue;
+		}
+
+		camera->isMaster = sshsNodeGetBool(sourceInfoNode, "deviceIsMaster");
+		sshsNodePutBool(camera->cameraNode, "master", camera->isMaster);
+
+		if (camera->isMaster) {
+			if (masters == 0) {
+				state->master = i;
+			}
+
+			masters++;
+		}
+	}
+
+	state->hasMaster = (masters == 1);
+	state->configured = true;
+
+	if (masters == 0) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"No camera is timestamp master, check the sync cables. Aligning to camera 0 in software.");
+	}
+	else if (masters > 1) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"%zu cameras are timestamp master, check the sync cables. Aligning to camera %zu in software.", masters,
+			state->master);
+	}
+	else {
+		caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString,
+			"Camera %zu (source %" PRIi16 ") is timestamp master, resetting timestamps of all cameras.", state->master,
+			state->cameras[state->master].sourceID);
+
+		// Start all cameras from the same zero.
+		resyncRequest(moduleData, state);
+	}
+}
+
+static void camerasMeasure(caerModuleData moduleData, DAVISSyncState state, double elapsed) {
+	struct davis_sync_camera *reference = &state->cameras[state->master];
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		struct davis_sync_camera *camera = &state->cameras[i];
+
+		if (i == state->master || !camera->minDelayValid || !reference->minDelayValid) {
+			continue;
+		}
+
+		int64_t offset = reference->minDelay - camera->minDelay;
+		double drift = (double) (offset - camera->offset) / elapsed;
+
+		camera->offset = offset;
+
+		sshsNodePutLong(camera->cameraNode, "offset", offset);
+		sshsNodePutInt(camera->cameraNode, "drift", I32T(drift));
+
+		if (llabs(offset) > state->tolerance) {
+			if (camera->appliedOffset == 0) {
+				caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+					"Camera %zu is %" PRIi64 " µs off camera %zu, aligning it.", i, offset, state->master);
+			}
+
+			camera->appliedOffset = offset;
+
+			// Try to get it back in sync once, if that doesn't work (no sync
+			// cable), it stays aligned in software.
+			if (state->autoResync && state->hasMaster && !camera->resyncTried) {
+				camera->resyncTried = true;
+				resyncRequest(moduleData, state);
+			}
+		}
+		else {
+			camera->appliedOffset = 0;
+			camera->resyncTried = false;
+		}
+	}
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		state->cameras[i].minDelayValid = false;
+	}
+}
+
+static void resyncRequest(caerModuleData moduleData, DAVISSyncState state) {
+	// The master resets all cameras connected to it through the sync cable.
+	caerDeviceHandle masterHandle = caerMainloopGetSourceState(U16T(state->cameras[state->master].sourceID));
+
+	if (!caerInputDAVISConfigSet(masterHandle, DAVIS_CONFIG_MUX, DAVIS_CONFIG_MUX_TIMESTAMP_RESET, true)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to reset master timestamps.");
+		return;
+	}
+
+	state->resyncs++;
+	sshsNodePutLong(moduleData->moduleNode, "resyncs", state->resyncs);
+}
+
+static void resyncCheck(caerModuleData moduleData, DAVISSyncState state, const struct timespec *now) {
+	bool allReset = true;
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		if (!state->cameras[i].resetSeen) {
+			allReset = false;
+			break;
+		}
+	}
+
+	if (!allReset) {
+		double elapsed = (double) (now->tv_sec - state->resyncStart.tv_sec)
+			+ ((double) (now->tv_nsec - state->resyncStart.tv_nsec) / 1000000000);
+
+		if (elapsed < ((double) state->resyncTimeout / 1000)) {
+			return;
+		}
+
+		if (state->autoResync && state->hasMaster && !state->resyncRequested) {
+			// Only some cameras reset (one was replugged, for example): reset
+			// all of them together, and wait again.
+			caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+				"Not all cameras reset their timestamps, resetting them all.");
+
+			resyncRequest(moduleData, state);
+
+			state->resyncRequested = true;
+			state->resyncStart = *now;
+			return;
+		}
+
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Not all cameras reset their timestamps, aligning them in software.");
+	}
+
+	// Everything restarts from zero. Offsets are measured again.
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		state->cameras[i].resetSeen = false;
+		state->cameras[i].appliedOffset = 0;
+		state->cameras[i].offset = 0;
+		state->cameras[i].minDelayValid = false;
+	}
+
+	state->resyncing = false;
+	state->windowStart = 0;
+	state->windowStartValid = allReset;
+	portable_clock_gettime_monotonic(&state->periodStart);
+}
+
+static caerEventPacketContainer windowsEmit(DAVISSyncState state) {
+	// How far each camera has got, in master time. Cameras without data wait
+	// at the start of the current window.
+	int64_t progress[DAVIS_SYNC_MAX_CAMERAS];
+	int64_t newest = INT64_MIN;
+	int64_t oldest = INT64_MAX;
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		struct davis_sync_camera *camera = &state->cameras[i];
+
+		if (camera->lastTimestampValid) {
+			progress[i] = camera->lastTimestamp - camera->appliedOffset;
+
+			if (progress[i] < oldest) {
+				oldest = progress[i];
+			}
+		}
+		else {
+			progress[i] = (state->windowStartValid) ? (state->windowStart) : (INT64_MIN);
+		}
+
+		if (progress[i] > newest) {
+			newest = progress[i];
+		}
+	}
+
+	if (newest == INT64_MIN) {
+		return (NULL);
+	}
+
+	if (!state->windowStartValid) {
+		// Windows are aligned to multiples of their length.
+		state->windowStart = oldest - (((oldest % state->window) + state->window) % state->window);
+		state->windowStartValid = true;
+	}
+
+	// Whole windows that all cameras, except stalled ones, are past.
+	int64_t cutoff = newest;
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		if (progress[i] >= (newest - state->maxSkew) && progress[i] < cutoff) {
+			cutoff = progress[i];
+		}
+	}
+
+	if (cutoff < (state->windowStart + state->window)) {
+		return (NULL);
+	}
+
+	int64_t windowEnd = state->windowStart + (((cutoff - state->windowStart) / state->window) * state->window);
+
+	caerEventPacketContainer container = containerEmit(state, windowEnd);
+
+	state->windowStart = windowEnd;
+
+	return (container);
+}
+
+static caerEventPacketContainer containerEmit(DAVISSyncState state, int64_t end) {
+	caerEventPacketContainer container = NULL;
+
+	for (size_t i = 0; i < state->camerasNumber; i++) {
+		for (int16_t t = 0; t < DAVIS_SYNC_EVENT_TYPES; t++) {
+			caerEventPacketHeader packet = heldTakeEvents(state, &state->cameras[i], t, end);
+			if (packet == NULL) {
+				continue;
+			}
+
+			if (container == NULL) {
+				container = caerEventPacketContainerAllocate(I32T(state->camerasNumber * DAVIS_SYNC_EVENT_TYPES));
+				if (container == NULL) {
+					free(packet);
+					return (NULL);
+				}
+			}
+
+			caerEventPacketContainerSetEventPacket(container, I32T(i * DAVIS_SYNC_EVENT_TYPES) + t, packet);
+		}
+	}
+
+	return (container);
+}
+
+static caerEventPacketHeader heldTakeEvents(DAVISSyncState state, struct davis_sync_camera *camera, int16_t eventType,
+	int64_t end) {
+	UT_array *heldPackets = camera->held[eventType];
+
+	if (utarray_len(heldPackets) == 0) {
+		return (NULL);
+	}
+
+	struct davis_sync_held *first = (struct davis_sync_held *) utarray_front(heldPackets);
+
+	// Events in master time before end, in camera time before limit.
+	int64_t limit = (end == INT64_MAX) ? (INT64_MAX) : (end + camera->appliedOffset);
+
+	// One packet can only have one timestamp overflow, so packets after a
+	// change wait for the next container.
+	int32_t tsOverflow = caerEventPacketHeaderGetEventTSOverflow(first->packet);
+
+	size_t fullPackets = 0;
+	int32_t partialEvents = 0;
+	int32_t totalEvents = 0;
+
+	for (size_t h = 0; h < utarray_len(heldPackets); h++) {
+		struct davis_sync_held *held = (struct davis_sync_held *) utarray_eltptr(heldPackets, h);
+
+		if (caerEventPacketHeaderGetEventTSOverflow(held->packet) != tsOverflow) {
+			break;
+		}
+
+		int32_t eventNumber = caerEventPacketHeaderGetEventNumber(held->packet);
+		int32_t split = heldFindSplit(held->packet, held->firstEvent, limit);
+
+		totalEvents += split - held->firstEvent;
+
+		if (split < eventNumber) {
+			partialEvents = split - held->firstEvent;
+			break;
+		}
+
+		fullPackets++;
+	}
+
+	if (totalEvents == 0) {
+		return (NULL);
+	}
+
+	if (state->windowStartValid && !state->resyncing) {
+		int64_t firstTimestamp = caerGenericEventGetTimestamp64(
+			caerGenericEventGetEvent(first->packet, first->firstEvent), first->packet);
+
+		if ((firstTimestamp - camera->appliedOffset) < state->windowStart) {
+			state->latePackets++;
+		}
+	}
+
+	if (fullPackets == 1 && partialEvents == 0 && first->firstEvent == 0) {
+		// The whole packet goes out as it is.
+		caerEventPacketHeader packet = first->packet;
+
+		utarray_erase(heldPackets, 0, 1);
+
+		return (packet);
+	}
+
+	// Otherwise the events are copied together into a new packet.
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(first->packet);
+
+	caerEventPacketHeader packet = malloc(CAER_EVENT_PACKET_HEADER_SIZE + ((size_t) totalEvents * (size_t) eventSize));
+	if (packet == NULL) {
+		// Stays held, and is tried again next time.
+		return (NULL);
+	}
+
+	memcpy(packet, first->packet, CAER_EVENT_PACKET_HEADER_SIZE);
+	caerEventPacketHeaderSetEventCapacity(packet, totalEvents);
+	caerEventPacketHeaderSetEventNumber(packet, totalEvents);
+
+	size_t usedPackets = fullPackets + ((partialEvents > 0) ? (1) : (0));
+	int32_t outEvents = 0;
+	int32_t validEvents = 0;
+
+	for (size_t h = 0; h < usedPackets; h++) {
+		struct davis_sync_held *held = (struct davis_sync_held *) utarray_eltptr(heldPackets, h);
+
+		int32_t events =
+			(h < fullPackets) ? (caerEventPacketHeaderGetEventNumber(held->packet) - held->firstEvent) : (partialEvents);
+
+		memcpy(caerGenericEventGetEvent(packet, outEvents), caerGenericEventGetEvent(held->packet, held->firstEvent),
+			(size_t) events * (size_t) eventSize);
+
+		for (int32_t e = outEvents; e < (outEvents + events); e++) {
+			if (caerGenericEventIsValid(caerGenericEventGetEvent(packet, e))) {
+				validEvents++;
+			}
+		}
+
+		outEvents += events;
+		held->firstEvent += events;
+	}
+
+	caerEventPacketHeaderSetEventValid(packet, validEvents);
+
+	for (size_t h = 0; h < fullPackets; h++) {
+		free(((struct davis_sync_held *) utarray_eltptr(heldPackets, h))->packet);
+	}
+
+	if (fullPackets > 0) {
+		utarray_erase(heldPackets, 0, fullPackets);
+	}
+
+	return (packet);
+}
+
+// First event at or after firstEvent with a timestamp not before limit.
+// Events in a packet are ordered by time.
+static int32_t heldFindSplit(caerEventPacketHeader packet, int32_t firstEvent, int64_t limit) {
+	int32_t low = firstEvent;
+	int32_t high = caerEventPacketHeaderGetEventNumber(packet);
+
+	if (limit == INT64_MAX) {
+		return (high);
+	}
+
+	while (low < high) {
+		int32_t middle = low + ((high - low) / 2);
+
+		if (caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packet, middle), packet) < limit) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+
+	return (low);
+}
@@ -0,0 +1,45 @@
+/*
+ * davis_sync.h
+ *
+ *  Combines several DAVIS cameras, connected by sync cables, into containers
+ *  that hold the packets of all cameras for the same time window.
+ */
+
+#ifndef DAVIS_SYNC_H_
+#define DAVIS_SYNC_H_
+
+#include "main.h"
+
+#include <libcaer/events/packetContainer.h>
+#include <libcaer/events/special.h>
+#include <libcaer/events/polarity.h>
+#include <libcaer/events/frame.h>
+#include <libcaer/events/imu6.h>
+
+// Packet slots per camera in the output containers: the packet of event type
+// T from the camera passed at position C is at (C * DAVIS_SYNC_EVENT_TYPES) + T.
+// So the first camera's packets are where a single DAVIS input has them.
+#define DAVIS_SYNC_EVENT_TYPES (IMU6_EVENT + 1)
+
+#define DAVIS_SYNC_MAX_CAMERAS 8
+
+// Takes the containers of camerasNumber DAVIS input modules (caerEventPacketContainer),
+// and takes ownership of their packets.
+caerEventPacketContainer caerInputDAVISSync(uint16_t moduleID, size_t camerasNumber, ...);
+
+static inline caerEventPacketHeader caerInputDAVISSyncGetEventPacket(caerEventPacketContainer container, size_t camera,
+	int16_t eventType) {
+	if (container == NULL || eventType < 0 || eventType >= DAVIS_SYNC_EVENT_TYPES) {
+		return (NULL);
+	}
+
+	int32_t slot = (int32_t) (camera * DAVIS_SYNC_EVENT_TYPES) + eventType;
+
+	if (slot >= caerEventPacketContainerGetEventPacketsNumber(container)) {
+		return (NULL);
+	}
+
+	return (caerEventPacketContainerGetEventPacket(container, slot));
+}
+
+#endif /* DAVIS_SYNC_H_ */
@@ -0,0 +1,999 @@
+/*
+ * merge.c
+ *
+ *  K-way merge of the events of several sources by timestamp. Events are
+ *  held per source and event type, and sent on once every source has moved
+ *  past them (the watermark). Sources that fall more than reorderWindow of
+ *  event time behind the newest one, or don't deliver anything for
+ *  stallTimeout, aren't waited for, so a stalled source never blocks the
+ *  others. Their events are still merged in when they arrive, but too late
+ *  to be in order; those are counted in lateEvents.
+ *
+ *  Runs are merged with a heap, taking as many events as possible from the
+ *  oldest run at a time. The common case of two polarity runs is merged
+ *  without branches, or four events at a time with a bitonic merge network
+ *  on AVX2 (x86-64, selected at run-time).
+ */
+
+#include "merge.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "ext/portable_time.h"
+
+#include <libcaer/events/polarity.h>
+#include <endian.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+	#include <immintrin.h>
+	#define MERGE_AVX2 1
+#endif
+
+// Event types from 0 up to this are merged, others are ignored.
+#define MERGE_MAX_EVENT_TYPES 16
+
+// Statistics are updated at most this often, in milliseconds.
+#define MERGE_STATS_INTERVAL 100
+
+// Events of one type from one source, waiting to be merged. They all have
+// the same timestamp overflow, and are kept contiguous so they can be merged
+// as one run.
+struct merge_run {
+	uint8_t *events;
+	int32_t capacity; // In events.
+	int32_t start; // First event not yet sent on.
+	int32_t end;
+	int32_t tsOverflow;
+};
+
+struct merge_source {
+	int16_t sourceID;
+	bool sourceInfoMerged;
+	sshsNode sourceNode;
+	// Current run per event type, and the next one when timestamps overflow.
+	struct merge_run runs[MERGE_MAX_EVENT_TYPES][2];
+	int64_t watermark; // Newest timestamp delivered.
+	bool watermarkValid;
+	struct timespec lastArrival;
+};
+
+// Position in a run during a merge.
+struct merge_cursor {
+	const uint8_t *event;
+	const uint8_t *end;
+	int32_t timestamp;
+};
+
+struct merge_state {
+	// Sources to merge, from the sourceIDs setting. Empty means all.
+	int16_t *sourceIDs;
+	size_t sourceIDsLength;
+	struct merge_source *sources;
+	size_t sourcesLength;
+	struct merge_cursor *cursors;
+	// Layout of each event type, from the first packet of that type.
+	int32_t eventSizes[MERGE_MAX_EVENT_TYPES];
+	int32_t eventTSOffsets[MERGE_MAX_EVENT_TYPES];
+	int16_t eventTypesNumber;
+	// Settings.
+	int64_t reorderWindow;
+	double stallTimeout;
+	// Progress, as 64 bit timestamps.
+	int64_t firstTimestamp;
+	int64_t maxTimestamp;
+	int64_t released;
+	bool releasedValid;
+	// Output of the last run, handed out by caerMerge().
+	caerEventPacketContainer result;
+	// Statistics.
+	struct timespec statsTime;
+	int64_t lateEvents;
+	int64_t droppedEvents;
+};
+
+typedef struct merge_state *mergeState;
+
+static bool caerMergeInit(caerModuleData moduleData);
+static void caerMergeRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerMergeConfig(caerModuleData moduleData);
+static void caerMergeExit(caerModuleData moduleData);
+static bool parseSourceIDs(caerModuleData moduleData);
+static struct merge_source *sourceFind(caerModuleData moduleData, int16_t sourceID, const struct timespec *now);
+static void sourceMergeInfo(caerModuleData moduleData, struct merge_source *source);
+static void takePacket(caerModuleData moduleData, caerEventPacketHeader packet, const struct timespec *now);
+static bool runReserve(struct merge_run *run, int32_t eventSize, int32_t events);
+static int64_t computeWatermark(mergeState state, const struct timespec *now);
+static caerEventPacketHeader mergeEventType(caerModuleData moduleData, int16_t eventType, int64_t watermark);
+static int32_t runEligibleEvents(const struct merge_run *run, int32_t eventSize, int32_t tsOffset, int64_t watermark);
+static uint8_t *mergeHeap(struct merge_cursor *heap, size_t heapLength, int32_t eventSize, int32_t tsOffset,
+	uint8_t *out);
+static void heapSiftDown(struct merge_cursor *heap, size_t heapLength, size_t position);
+static uint8_t *mergePolarityScalar(const uint8_t *a, const uint8_t *aEnd, const uint8_t *b, const uint8_t *bEnd,
+	uint8_t *out);
+#if defined(MERGE_AVX2)
+static uint8_t *mergePolarityAVX2(const uint8_t *a, const uint8_t *aEnd, const uint8_t *b, const uint8_t *bEnd,
+	uint8_t *out);
+#endif
+static void updateStatistics(caerModuleData moduleData, const struct timespec *now);
+
+static inline int32_t eventTimestamp(const uint8_t *event, int32_t tsOffset) {
+	uint32_t timestamp;
+	memcpy(&timestamp, event + tsOffset, sizeof(uint32_t));
+
+	return (I32T(le32toh(timestamp)));
+}
+
+static inline int64_t eventTimestamp64(const uint8_t *event, int32_t tsOffset, int32_t tsOverflow) {
+	return (I64T((U64T(tsOverflow) << TS_OVERFLOW_SHIFT) | U64T(eventTimestamp(event, tsOffset))));
+}
+
+// Polarity events are a 32 bit data word followed by a 32 bit timestamp,
+// both little-endian, so the whole event read as a little-endian 64 bit
+// value orders them by timestamp. Timestamps are never negative.
+static inline uint64_t polarityKey(const uint8_t *event) {
+	uint64_t key;
+	memcpy(&key, event, sizeof(uint64_t));
+
+	return (le64toh(key));
+}
+
+static struct caer_module_functions caerMergeFunctions = { .moduleInit = &caerMergeInit, .moduleRun = &caerMergeRun,
+	.moduleConfig = &caerMergeConfig, .moduleExit = &caerMergeExit };
+
+caerEventPacketContainer caerMerge(uint16_t moduleID, size_t inputsNumber, ...) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "Merge");
+
+	va_list args;
+	va_start(args, inputsNumber);
+	caerModuleSMv(&caerMergeFunctions, moduleData, sizeof(struct merge_state), inputsNumber, args);
+	va_end(args);
+
+	// Not running, or just started.
+	mergeState state = moduleData->moduleState;
+	if (state == NULL) {
+		return (NULL);
+	}
+
+	caerEventPacketContainer result = state->result;
+	state->result = NULL;
+
+	return (result);
+}
+
+static bool caerMergeInit(caerModuleData moduleData) {
+	// Comma-separated list of the source IDs to merge, all if empty. Listed
+	// sources are waited for even before they deliver anything.
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "sourceIDs", "");
+	// How far (in µs of event time) sources can fall behind the newest one
+	// and still be waited for.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "reorderWindow", 10000);
+	// Sources that deliver nothing for this long (in ms) aren't waited for.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "stallTimeout", 100);
+
+	// Statistics, read-only. Kept in their own sub-node, so that updating them
+	// doesn't trigger the config listener on the module node.
+	sshsNode statisticsNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/");
+	sshsNodePutLong(statisticsNode, "lateEvents", 0);
+	sshsNodePutLong(statisticsNode, "droppedEvents", 0);
+
+	mergeState state = moduleData->moduleState;
+
+	state->firstTimestamp = -1;
+	state->maxTimestamp = INT64_MIN;
+
+	caerMergeConfig(moduleData);
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	return (true);
+}
+
+static void caerMergeRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	mergeState state = moduleData->moduleState;
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	// Interpret variable arguments (same as above in main function).
+	for (size_t i = 0; i < argsNumber; i++) {
+		caerEventPacketHeader packet = va_arg(args, caerEventPacketHeader);
+
+		if (packet != NULL) {
+			takePacket(moduleData, packet, &now);
+		}
+	}
+
+	caerEventPacketContainer *result = &state->result;
+
+	int64_t watermark = computeWatermark(state, &now);
+
+	if (watermark != INT64_MIN) {
+		for (int16_t t = 0; t < state->eventTypesNumber; t++) {
+			caerEventPacketHeader packet = mergeEventType(moduleData, t, watermark);
+			if (packet == NULL) {
+				continue;
+			}
+
+			if (*result == NULL) {
+				*result = caerEventPacketContainerAllocate(state->eventTypesNumber);
+				if (*result == NULL) {
+					caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+						"Failed to allocate event packet container, dropping merged events.");
+					free(packet);
+					break;
+				}
+
+				caerMainloopFreeAfterLoop((void (*)(void *)) &caerEventPacketContainerFree, *result);
+			}
+
+			caerEventPacketContainerSetEventPacket(*result, t, packet);
+		}
+
+		if (watermark > state->released || !state->releasedValid) {
+			state->released = watermark;
+			state->releasedValid = true;
+		}
+	}
+
+	updateStatistics(moduleData, &now);
+}
+
+static void caerMergeConfig(caerModuleData moduleData) {
+	caerModuleConfigUpdateReset(moduleData);
+
+	mergeState state = moduleData->moduleState;
+
+	state->reorderWindow = I64T(sshsNodeGetInt(moduleData->moduleNode, "reorderWindow"));
+
+	int32_t stallTimeout = sshsNodeGetInt(moduleData->moduleNode, "stallTimeout");
+	state->stallTimeout = (double) stallTimeout / 1000;
+
+	if (!parseSourceIDs(moduleData)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to allocate memory for source IDs, merging all sources.");
+	}
+}
+
+static void caerMergeExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	mergeState state = moduleData->moduleState;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		for (size_t t = 0; t < MERGE_MAX_EVENT_TYPES; t++) {
+			free(state->sources[i].runs[t][0].events);
+			free(state->sources[i].runs[t][1].events);
+		}
+	}
+
+	free(state->sources);
+	state->sources = NULL;
+	state->sourcesLength = 0;
+
+	free(state->cursors);
+	state->cursors = NULL;
+
+	free(state->sourceIDs);
+	state->sourceIDs = NULL;
+	state->sourceIDsLength = 0;
+}
+
+static bool parseSourceIDs(caerModuleData moduleData) {
+	mergeState state = moduleData->moduleState;
+
+	free(state->sourceIDs);
+	state->sourceIDs = NULL;
+	state->sourceIDsLength = 0;
+
+	char *sourceIDs = sshsNodeGetString(moduleData->moduleNode, "sourceIDs");
+
+	// At most one ID per character.
+	size_t maxLength = strlen(sourceIDs);
+	if (maxLength == 0) {
+		free(sourceIDs);
+		return (true);
+	}
+
+	state->sourceIDs = calloc(maxLength, sizeof(int16_t));
+	if (state->sourceIDs == NULL) {
+		free(sourceIDs);
+		return (false);
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	char *position = sourceIDs;
+
+	while (*position != '\0') {
+		char *next;
+		long sourceID = strtol(position, &next, 10);
+
+		if (next == position || sourceID < 0 || sourceID > INT16_MAX) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Ignoring invalid source ID in '%s'.",
+				sourceIDs);
+
+			// Skip to the next one.
+			next = strchr(position, ',');
+			if (next == NULL) {
+				break;
+			}
+		}
+		else {
+			state->sourceIDs[state->sourceIDsLength++] = I16T(sourceID);
+
+			// Listed sources are waited for from now on.
+			sourceFind(moduleData, I16T(sourceID), &now);
+		}
+
+		position = next;
+		while (*position == ',' || *position == ' ') {
+			position++;
+		}
+	}
+
+	free(sourceIDs);
+
+	return (true);
+}
+
+static struct merge_source *sourceFind(caerModuleData moduleData, int16_t sourceID, const struct timespec *now) {
+	mergeState state = moduleData->moduleState;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		if (state->sources[i].sourceID == sourceID) {
+			return (&state->sources[i]);
+		}
+	}
+
+	struct merge_source *newSources = realloc(state->sources, (state->sourcesLength + 1) * sizeof(struct merge_source));
+	if (newSources == NULL) {
+		return (NULL);
+	}
+
+	state->sources = newSources;
+
+	struct merge_cursor *newCursors = realloc(state->cursors, (state->sourcesLength + 1) * sizeof(struct merge_cursor));
+	if (newCursors == NULL) {
+		return (NULL);
+	}
+
+	state->cursors = newCursors;
+
+	struct merge_source *source = &state->sources[state->sourcesLength++];
+	memset(source, 0, sizeof(struct merge_source));
+
+	source->sourceID = sourceID;
+	source->lastArrival = *now;
+
+	// Per-source statistics, read-only.
+	char sourceNodeName[16];
+	snprintf(sourceNodeName, 16, "source%" PRIi16 "/", sourceID);
+
+	source->sourceNode = sshsGetRelativeNode(moduleData->moduleNode, sourceNodeName);
+
+	sshsNodePutLong(source->sourceNode, "lag", 0);
+	sshsNodePutInt(source->sourceNode, "heldEvents", 0);
+	sshsNodePutBool(source->sourceNode, "stalled", false);
+
+	return (source);
+}
+
+// Merged events can come from any source, so the merged sourceInfo/ has
+// sizes big enough for all of them.
+static void sourceMergeInfo(caerModuleData moduleData, struct merge_source *source) {
+	static const char *sizeKeys[] = { "dvsSizeX", "dvsSizeY", "apsSizeX", "apsSizeY" };
+
+	sshsNode sourceInfoNode = caerMainloopGetSourceInfo(U16T(source->sourceID));
+	sshsNode mergedInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
+
+	for (size_t i = 0; i < (sizeof(sizeKeys) / sizeof(sizeKeys[0])); i++) {
+		if (!sshsNodeAttributeExists(sourceInfoNode, sizeKeys[i], SHORT)) {
+			continue;
+		}
+
+		int16_t size = sshsNodeGetShort(sourceInfoNode, sizeKeys[i]);
+
+		if (!sshsNodeAttributeExists(mergedInfoNode, sizeKeys[i], SHORT)
+			|| size > sshsNodeGetShort(mergedInfoNode, sizeKeys[i])) {
+			sshsNodePutShort(mergedInfoNode, sizeKeys[i], size);
+		}
+	}
+
+	source->sourceInfoMerged = true;
+}
+
+static void takePacket(caerModuleData moduleData, caerEventPacketHeader packet, const struct timespec *now) {
+	mergeState state = moduleData->moduleState;
+
+	int32_t eventValid = caerEventPacketHeaderGetEventValid(packet);
+	if (eventValid == 0) {
+		return;
+	}
+
+	int16_t eventType = caerEventPacketHeaderGetEventType(packet);
+	if (eventType < 0 || eventType >= MERGE_MAX_EVENT_TYPES) {
+		return;
+	}
+
+	int16_t sourceID = caerEventPacketHeaderGetEventSource(packet);
+
+	if (state->sourceIDsLength > 0) {
+		bool listed = false;
+
+		for (size_t i = 0; i < state->sourceIDsLength; i++) {
+			if (state->sourceIDs[i] == sourceID) {
+				listed = true;
+				break;
+			}
+		}
+
+		if (!listed) {
+			return;
+		}
+	}
+
+	struct merge_source *source = sourceFind(moduleData, sourceID, now);
+	if (source == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to track new source %" PRIi16 ", dropping packet.", sourceID);
+		state->droppedEvents += eventValid;
+		return;
+	}
+
+	if (!source->sourceInfoMerged) {
+		sourceMergeInfo(moduleData, source);
+	}
+
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
+	int32_t tsOffset = caerEventPacketHeaderGetEventTSOffset(packet);
+	int32_t tsOverflow = caerEventPacketHeaderGetEventTSOverflow(packet);
+
+	// Events of one type must all look the same to go into one packet. This
+	// isn't the case for frames from cameras of different resolution.
+	if (state->eventSizes[eventType] == 0) {
+		state->eventSizes[eventType] = eventSize;
+		state->eventTSOffsets[eventType] = tsOffset;
+
+		if (eventType >= state->eventTypesNumber) {
+			state->eventTypesNumber = I16T(eventType + 1);
+		}
+	}
+	else if (state->eventSizes[eventType] != eventSize || state->eventTSOffsets[eventType] != tsOffset) {
+		if (state->droppedEvents == 0) {
+			caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+				"Events of type %" PRIi16 " from source %" PRIi16 " differ in size from those of other sources, "
+				"dropping them. Further ones are counted in droppedEvents.", eventType, sourceID);
+		}
+
+		state->droppedEvents += eventValid;
+		return;
+	}
+
+	// Events with a new timestamp overflow go into the second run, until the
+	// first one is done.
+	struct merge_run *run = &source->runs[eventType][0];
+
+	if (run->start != run->end && run->tsOverflow != tsOverflow) {
+		run = &source->runs[eventType][1];
+
+		if (run->start != run->end && run->tsOverflow != tsOverflow) {
+			state->droppedEvents += eventValid;
+			return;
+		}
+	}
+
+	if (run->start == run->end) {
+		run->start = run->end = 0;
+		run->tsOverflow = tsOverflow;
+	}
+
+	if (!runReserve(run, eventSize, eventValid)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to allocate memory for events of source %" PRIi16 ", dropping packet.", sourceID);
+		state->droppedEvents += eventValid;
+		return;
+	}
+
+	uint8_t *events = run->events + ((size_t) run->end * (size_t) eventSize);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	if (eventValid == eventNumber) {
+		memcpy(events, caerGenericEventGetEvent(packet, 0), (size_t) eventNumber * (size_t) eventSize);
+	}
+	else {
+		uint8_t *event = events;
+
+		for (int32_t i = 0; i < eventNumber; i++) {
+			const void *inEvent = caerGenericEventGetEvent(packet, i);
+
+			if (caerGenericEventIsValid(inEvent)) {
+				memcpy(event, inEvent, (size_t) eventSize);
+				event += eventSize;
+			}
+		}
+	}
+
+	int64_t firstTimestamp = eventTimestamp64(events, tsOffset, tsOverflow);
+	int64_t lastTimestamp = eventTimestamp64(events + ((size_t) (eventValid - 1) * (size_t) eventSize), tsOffset,
+		tsOverflow);
+
+	// Events older than what was already sent on can't be put in order anymore.
+	if (state->releasedValid && firstTimestamp <= state->released) {
+		for (int32_t i = 0; i < eventValid; i++) {
+			if (eventTimestamp64(events + ((size_t) i * (size_t) eventSize), tsOffset, tsOverflow)
+				> state->released) {
+				break;
+			}
+
+			state->lateEvents++;
+		}
+	}
+
+	run->end += eventValid;
+
+	if (!source->watermarkValid || lastTimestamp > source->watermark) {
+		source->watermark = lastTimestamp;
+		source->watermarkValid = true;
+	}
+
+	if (lastTimestamp > state->maxTimestamp) {
+		state->maxTimestamp = lastTimestamp;
+	}
+
+	if (state->firstTimestamp < 0) {
+		state->firstTimestamp = firstTimestamp;
+	}
+
+	source->lastArrival = *now;
+}
+
+// Make space for events more events at the end of the run.
+static bool runReserve(struct merge_run *run, int32_t eventSize, int32_t events) {
+	if ((run->end + events) <= run->capacity) {
+		return (true);
+	}
+
+	// Drop what was sent on already first.
+	if (run->start > 0) {
+		memmove(run->events, run->events + ((size_t) run->start * (size_t) eventSize),
+			(size_t) (run->end - run->start) * (size_t) eventSize);
+		run->end -= run->start;
+		run->start = 0;
+
+		if ((run->end + events) <= run->capacity) {
+			return (true);
+		}
+	}
+
+	int32_t newCapacity = (run->capacity == 0) ? (1024) : (run->capacity * 2);
+	if (newCapacity < (run->end + events)) {
+		newCapacity = run->end + events;
+	}
+
+	uint8_t *newEvents = realloc(run->events, (size_t) newCapacity * (size_t) eventSize);
+	if (newEvents == NULL) {
+		return (false);
+	}
+
+	run->events = newEvents;
+	run->capacity = newCapacity;
+
+	return (true);
+}
+
+// Up to where all sources have delivered their events, or INT64_MIN if
+// nothing can go out yet.
+static int64_t computeWatermark(mergeState state, const struct timespec *now) {
+	if (state->firstTimestamp < 0) {
+		return (INT64_MIN);
+	}
+
+	int64_t watermark = INT64_MAX;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		struct merge_source *source = &state->sources[i];
+
+		double silence = (double) (now->tv_sec - source->lastArrival.tv_sec)
+			+ ((double) (now->tv_nsec - source->lastArrival.tv_nsec) / 1000000000);
+
+		if (silence > state->stallTimeout) {
+			continue;
+		}
+
+		int64_t sourceWatermark = (source->watermarkValid) ? (source->watermark) : (INT64_MIN);
+
+		if (sourceWatermark < watermark) {
+			watermark = sourceWatermark;
+		}
+	}
+
+	if (watermark == INT64_MAX) {
+		// Nothing arrives anymore: send on everything.
+		return (state->maxTimestamp);
+	}
+
+	// At the start, wait one reorder window, so all sources get to be seen.
+	if (!state->releasedValid && (state->maxTimestamp - state->firstTimestamp) < state->reorderWindow) {
+		return (INT64_MIN);
+	}
+
+	// Sources that fall too far behind don't hold back the others.
+	if ((state->maxTimestamp - state->reorderWindow) > watermark) {
+		watermark = state->maxTimestamp - state->reorderWindow;
+	}
+
+	return (watermark);
+}
+
+static caerEventPacketHeader mergeEventType(caerModuleData moduleData, int16_t eventType, int64_t watermark) {
+	mergeState state = moduleData->moduleState;
+
+	int32_t eventSize = state->eventSizes[eventType];
+	int32_t tsOffset = state->eventTSOffsets[eventType];
+
+	if (eventSize == 0) {
+		return (NULL);
+	}
+
+	// Only runs with the oldest timestamp overflow go into one packet. Newer
+	// ones are after all of their events anyway.
+	int32_t tsOverflow = INT32_MAX;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		struct merge_run *runs = state->sources[i].runs[eventType];
+
+		if (runs[0].start == runs[0].end && runs[1].start != runs[1].end) {
+			struct merge_run swap = runs[0];
+			runs[0] = runs[1];
+			runs[1] = swap;
+		}
+
+		if (runs[0].start != runs[0].end && runs[0].tsOverflow < tsOverflow) {
+			tsOverflow = runs[0].tsOverflow;
+		}
+	}
+
+	if (tsOverflow == INT32_MAX) {
+		return (NULL);
+	}
+
+	size_t cursorsLength = 0;
+	int32_t totalEvents = 0;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		struct merge_run *run = &state->sources[i].runs[eventType][0];
+
+		if (run->start == run->end || run->tsOverflow != tsOverflow) {
+			continue;
+		}
+
+		int32_t events = runEligibleEvents(run, eventSize, tsOffset, watermark);
+		if (events == 0) {
+			continue;
+		}
+
+		struct merge_cursor *cursor = &state->cursors[cursorsLength];
+		cursor->event = run->events + ((size_t) run->start * (size_t) eventSize);
+		cursor->end = cursor->event + ((size_t) events * (size_t) eventSize);
+		cursor->timestamp = eventTimestamp(cursor->event, tsOffset);
+
+		cursorsLength++;
+		totalEvents += events;
+
+		run->start += events;
+	}
+
+	if (totalEvents == 0) {
+		return (NULL);
+	}
+
+	caerEventPacketHeader packet = malloc(CAER_EVENT_PACKET_HEADER_SIZE + ((size_t) totalEvents * (size_t) eventSize));
+	if (packet == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to allocate memory for merged event packet, dropping %" PRIi32 " events.", totalEvents);
+		state->droppedEvents += totalEvents;
+		return (NULL);
+	}
+
+	caerEventPacketHeaderSetEventType(packet, eventType);
+	caerEventPacketHeaderSetEventSource(packet, I16T(moduleData->moduleID));
+	caerEventPacketHeaderSetEventSize(packet, eventSize);
+	caerEventPacketHeaderSetEventTSOffset(packet, tsOffset);
+	caerEventPacketHeaderSetEventTSOverflow(packet, tsOverflow);
+	caerEventPacketHeaderSetEventCapacity(packet, totalEvents);
+	caerEventPacketHeaderSetEventNumber(packet, totalEvents);
+	caerEventPacketHeaderSetEventValid(packet, totalEvents);
+
+	uint8_t *out = caerGenericEventGetEvent(packet, 0);
+
+	if (cursorsLength == 1) {
+		memcpy(out, state->cursors[0].event, (size_t) totalEvents * (size_t) eventSize);
+	}
+	else if (cursorsLength == 2 && eventType == POLARITY_EVENT && eventSize == 8 && tsOffset == 4) {
+		const uint8_t *a = state->cursors[0].event;
+		const uint8_t *aEnd = state->cursors[0].end;
+		const uint8_t *b = state->cursors[1].event;
+		const uint8_t *bEnd = state->cursors[1].end;
+
+#if defined(MERGE_AVX2)
+		if (__builtin_cpu_supports("avx2")) {
+			mergePolarityAVX2(a, aEnd, b, bEnd, out);
+		}
+		else {
+			mergePolarityScalar(a, aEnd, b, bEnd, out);
+		}
+#else
+		mergePolarityScalar(a, aEnd, b, bEnd, out);
+#endif
+	}
+	else {
+		mergeHeap(state->cursors, cursorsLength, eventSize, tsOffset, out);
+	}
+
+	return (packet);
+}
+
+// Number of events at the start of the run not newer than the watermark.
+// Events in a run are ordered by time.
+static int32_t runEligibleEvents(const struct merge_run *run, int32_t eventSize, int32_t tsOffset, int64_t watermark) {
+	int64_t overflowStart = I64T(U64T(run->tsOverflow) << TS_OVERFLOW_SHIFT);
+
+	if (watermark < overflowStart) {
+		return (0);
+	}
+
+	if (watermark >= (overflowStart + (1LL << TS_OVERFLOW_SHIFT))) {
+		return (run->end - run->start);
+	}
+
+	int32_t limit = I32T(watermark - overflowStart);
+
+	int32_t low = run->start;
+	int32_t high = run->end;
+
+	while (low < high) {
+		int32_t middle = low + ((high - low) / 2);
+
+		if (eventTimestamp(run->events + ((size_t) middle * (size_t) eventSize), tsOffset) <= limit) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+
+	return (low - run->start);
+}
+
+static uint8_t *mergeHeap(struct merge_cursor *heap, size_t heapLength, int32_t eventSize, int32_t tsOffset,
+	uint8_t *out) {
+	for (size_t i = heapLength / 2; i > 0; i--) {
+		heapSiftDown(heap, heapLength, i - 1);
+	}
+
+	while (heapLength > 0) {
+		struct merge_cursor *oldest = &heap[0];
+
+		// Events of the oldest run go out until another run has older ones.
+		int32_t limit = INT32_MAX;
+		if (heapLength > 1) {
+			limit = heap[1].timestamp;
+		}
+		if (heapLength > 2 && heap[2].timestamp < limit) {
+			limit = heap[2].timestamp;
+		}
+
+		do {
+			memcpy(out, oldest->event, (size_t) eventSize);
+			out += eventSize;
+			oldest->event += eventSize;
+		}
+		while (oldest->event < oldest->end && (oldest->timestamp = eventTimestamp(oldest->event, tsOffset)) <= limit);
+
+		if (oldest->event == oldest->end) {
+			heap[0] = heap[--heapLength];
+		}
+
+		heapSiftDown(heap, heapLength, 0);
+	}
+
+	return (out);
+}
+
+static void heapSiftDown(struct merge_cursor *heap, size_t heapLength, size_t position) {
+	for (;;) {
+		size_t oldest = position;
+		size_t left = (2 * position) + 1;
+		size_t right = left + 1;
+
+		if (left < heapLength && heap[left].timestamp < heap[oldest].timestamp) {
+			oldest = left;
+		}
+		if (right < heapLength && heap[right].timestamp < heap[oldest].timestamp) {
+			oldest = right;
+		}
+
+		if (oldest == position) {
+			return;
+		}
+
+		struct merge_cursor swap = heap[position];
+		heap[position] = heap[oldest];
+		heap[oldest] = swap;
+
+		position = oldest;
+	}
+}
+
+static uint8_t *mergePolarityScalar(const uint8_t *a, const uint8_t *aEnd, const uint8_t *b, const uint8_t *bEnd,
+	uint8_t *out) {
+	// Without branches on the comparison, which is unpredictable.
+	while (a < aEnd && b < bEnd) {
+		bool takeB = (polarityKey(b) < polarityKey(a));
+
+		memcpy(out, (takeB) ? (b) : (a), 8);
+		out += 8;
+
+		a += (takeB) ? (0) : (8);
+		b += (takeB) ? (8) : (0);
+	}
+
+	if (a < aEnd) {
+		memcpy(out, a, (size_t) (aEnd - a));
+		out += aEnd - a;
+	}
+
+	if (b < bEnd) {
+		memcpy(out, b, (size_t) (bEnd - b));
+		out += bEnd - b;
+	}
+
+	return (out);
+}
+
+#if defined(MERGE_AVX2)
+
+// Sorted minimum and maximum of each 64 bit lane. Keys are below 2^63, so
+// the signed comparison works.
+#define MERGE_AVX2_MINMAX(a, b, min, max) \
+	do { \
+		__m256i greater = _mm256_cmpgt_epi64(a, b); \
+		min = _mm256_blendv_epi8(a, b, greater); \
+		max = _mm256_blendv_epi8(b, a, greater); \
+	} while (0)
+
+// Sort a bitonic sequence of four, comparing lanes two and then one apart.
+__attribute__((target("avx2")))
+static inline __m256i mergeAVX2Bitonic4(__m256i v) {
+	__m256i min, max;
+
+	__m256i swapped = _mm256_permute4x64_epi64(v, 0x4E);
+	MERGE_AVX2_MINMAX(v, swapped, min, max);
+	v = _mm256_blend_epi32(min, max, 0xF0);
+
+	swapped = _mm256_permute4x64_epi64(v, 0xB1);
+	MERGE_AVX2_MINMAX(v, swapped, min, max);
+	return (_mm256_blend_epi32(min, max, 0xCC));
+}
+
+// Merge two sorted vectors of four into the lower and upper four.
+__attribute__((target("avx2")))
+static inline void mergeAVX2Network(__m256i *low, __m256i *high) {
+	// Reversing the second makes the eight a bitonic sequence.
+	__m256i reversed = _mm256_permute4x64_epi64(*high, 0x1B);
+	__m256i min, max;
+	MERGE_AVX2_MINMAX(*low, reversed, min, max);
+
+	*low = mergeAVX2Bitonic4(min);
+	*high = mergeAVX2Bitonic4(max);
+}
+
+__attribute__((target("avx2")))
+static uint8_t *mergePolarityAVX2(const uint8_t *a, const uint8_t *aEnd, const uint8_t *b, const uint8_t *bEnd,
+	uint8_t *out) {
+	if ((aEnd - a) < 32 || (bEnd - b) < 32) {
+		return (mergePolarityScalar(a, aEnd, b, bEnd, out));
+	}
+
+	// x86-64 is little-endian, so events load as their keys.
+	__m256i low = _mm256_loadu_si256((const __m256i *) (const void *) a);
+	__m256i high = _mm256_loadu_si256((const __m256i *) (const void *) b);
+	a += 32;
+	b += 32;
+
+	for (;;) {
+		mergeAVX2Network(&low, &high);
+
+		_mm256_storeu_si256((__m256i *) (void *) out, low);
+		out += 32;
+
+		// The next four come from the run with the older next event. The
+		// upper four stay, they are newer than everything sent so far.
+		const uint8_t **next;
+
+		if (a < aEnd && (b == bEnd || polarityKey(a) <= polarityKey(b))) {
+			next = &a;
+		}
+		else if (b < bEnd) {
+			next = &b;
+		}
+		else {
+			break;
+		}
+
+		const uint8_t *nextEnd = (next == &a) ? (aEnd) : (bEnd);
+		if ((nextEnd - *next) < 32) {
+			break;
+		}
+
+		low = _mm256_loadu_si256((const __m256i *) (const void *) *next);
+		*next += 32;
+	}
+
+	// Merge the four left over with what remains of both runs.
+	uint8_t rest[32];
+	_mm256_storeu_si256((__m256i *) (void *) rest, high);
+
+	const uint8_t *r = rest;
+	const uint8_t *rEnd = rest + 32;
+
+	while (r < rEnd) {
+		const uint8_t **oldest = &r;
+
+		if (a < aEnd && polarityKey(a) < polarityKey(*oldest)) {
+			oldest = &a;
+		}
+		if (b < bEnd && polarityKey(b) < polarityKey(*oldest)) {
+			oldest = &b;
+		}
+
+		memcpy(out, *oldest, 8);
+		out += 8;
+		*oldest += 8;
+	}
+
+	return (mergePolarityScalar(a, aEnd, b, bEnd, out));
+}
+
+#endif
+
+static void updateStatistics(caerModuleData moduleData, const struct timespec *now) {
+	mergeState state = moduleData->moduleState;
+
+	double elapsed = (double) (now->tv_sec - state->statsTime.tv_sec)
+		+ ((double) (now->tv_nsec - state->statsTime.tv_nsec) / 1000000000);
+
+	if ((elapsed * 1000) < MERGE_STATS_INTERVAL) {
+		return;
+	}
+
+	state->statsTime = *now;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		struct merge_source *source = &state->sources[i];
+
+		int32_t heldEvents = 0;
+
+		for (size_t t = 0; t < MERGE_MAX_EVENT_TYPES; t++) {
+			heldEvents += source->runs[t][0].end - source->runs[t][0].start;
+			heldEvents += source->runs[t][1].end - source->runs[t][1].start;
+		}
+
+		// How far behind the newest source, in µs of event time.
+		int64_t lag = (source->watermarkValid) ? (state->maxTimestamp - source->watermark) : (-1);
+
+		double silence = (double) (now->tv_sec - source->lastArrival.tv_sec)
+			+ ((double) (now->tv_nsec - source->lastArrival.tv_nsec) / 1000000000);
+
+		sshsNodePutLong(source->sourceNode, "lag", lag);
+		sshsNodePutInt(source->sourceNode, "heldEvents", heldEvents);
+		sshsNodePutBool(source->sourceNode, "stalled",
+			(silence > state->stallTimeout) || !source->watermarkValid || (lag > state->reorderWindow));
+	}
+
+	sshsNode statisticsNode = sshsGetRelativeNode(moduleData->moduleNode, "statistics/");
+	sshsNodePutLong(statisticsNode, "lateEvents", state->lateEvents);
+	sshsNodePutLong(statisticsNode, "droppedEvents", state->droppedEvents);
+}
@@ -0,0 +1,19 @@
+/*
+ * merge.h
+ *
+ *  Merges the events of several sources into one time-ordered stream.
+ */
+
+#ifndef MERGE_H_
+#define MERGE_H_
+
+#include "main.h"
+
+#include <libcaer/events/packetContainer.h>
+
+// Takes any number of event packets (caerEventPacketHeader) from any sources,
+// and returns a container with one packet per event type, at the index of
+// that type, holding the events of all sources ordered by timestamp.
+caerEventPacketContainer caerMerge(uint16_t moduleID, size_t inputsNumber, ...);
+
+#endif /* MERGE_H_ */
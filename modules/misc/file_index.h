@@ -0,0 +1,213 @@
+/*
+ * file_index.h
+ *
+ *  Definitions for the packet index that the file output module can append
+ *  to AEDAT 3.x files, and that the file input module can use for seeking.
+ *
+ *  The index is stored as a trailing block: a regular event packet header
+ *  of a reserved event type, followed by one index entry per indexed packet,
+ *  and a fixed-size footer at the very end of the file, which points back to
+ *  the index packet. Readers that don't know about the index see it as an
+ *  event packet of an unknown type, and can skip it like any other.
+ *
+ *  The writer can index every packet, or only the first packet of each time
+ *  bucket, to keep the index small for long recordings. Either way, entries
+ *  are in file order, and their timestamps are assumed to be non-decreasing,
+ *  which holds within packet granularity for data from a single source.
+ */
+
+#ifndef FILE_INDEX_H_
+#define FILE_INDEX_H_
+
+#include "main.h"
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <libcaer/events/common.h>
+
+// Event type for the index packet, outside of any type libcaer uses.
+#define CAER_FILE_INDEX_EVENT_TYPE 0x7FFF
+
+// Footer magic, exactly 8 bytes, no terminating NUL byte written.
+#define CAER_FILE_INDEX_FOOTER_MAGIC "CAER-IDX"
+#define CAER_FILE_INDEX_FOOTER_MAGIC_LENGTH 8
+
+#define CAER_FILE_INDEX_INFO_TYPE_SHIFT 1
+#define CAER_FILE_INDEX_INFO_TYPE_MASK 0x00007FFF
+#define CAER_FILE_INDEX_INFO_SOURCE_SHIFT 16
+#define CAER_FILE_INDEX_INFO_SOURCE_MASK 0x0000FFFF
+
+/*
+ * One entry per indexed event packet. All values are little-endian.
+ * The layout mirrors a generic event (valid mark in bit 0 of the first
+ * 32 bits, timestamp at offset 4), so the index packet stays well-formed
+ * for generic readers.
+ */
+struct caer_file_index_entry {
+	uint32_t info; // Valid mark (bit 0), event type (bits 1-15), event source (bits 16-31).
+	int32_t timestamp; // Timestamp of the first event in the packet.
+	int32_t tsOverflow; // Timestamp overflow counter of the packet.
+	int32_t eventNumber; // Number of events written for the packet.
+	uint64_t fileOffset; // Offset of the packet header from the start of the file.
+}__attribute__((__packed__));
+
+typedef struct caer_file_index_entry *caerFileIndexEntry;
+
+struct caer_file_index_footer {
+	uint64_t indexOffset; // Offset of the index packet header from the start of the file.
+	char magic[CAER_FILE_INDEX_FOOTER_MAGIC_LENGTH];
+}__attribute__((__packed__));
+
+static inline void caerFileIndexEntrySet(caerFileIndexEntry entry, int16_t type, int16_t source, int64_t timestamp,
+	int32_t eventNumber, uint64_t fileOffset) {
+	uint32_t info = 0x01; // Always valid.
+	info |= U32T((U16T(type) & CAER_FILE_INDEX_INFO_TYPE_MASK) << CAER_FILE_INDEX_INFO_TYPE_SHIFT);
+	info |= U32T((U16T(source) & CAER_FILE_INDEX_INFO_SOURCE_MASK) << CAER_FILE_INDEX_INFO_SOURCE_SHIFT);
+
+	entry->info = htole32(info);
+	entry->timestamp = I32T(htole32(U32T(timestamp & INT32_MAX)));
+	entry->tsOverflow = I32T(htole32(U32T(timestamp >> 31)));
+	entry->eventNumber = I32T(htole32(U32T(eventNumber)));
+	entry->fileOffset = htole64(fileOffset);
+}
+
+static inline int16_t caerFileIndexEntryGetType(caerFileIndexEntry entry) {
+	return (I16T((le32toh(entry->info) >> CAER_FILE_INDEX_INFO_TYPE_SHIFT) & CAER_FILE_INDEX_INFO_TYPE_MASK));
+}
+
+static inline int16_t caerFileIndexEntryGetSource(caerFileIndexEntry entry) {
+	return (I16T((le32toh(entry->info) >> CAER_FILE_INDEX_INFO_SOURCE_SHIFT) & CAER_FILE_INDEX_INFO_SOURCE_MASK));
+}
+
+static inline int64_t caerFileIndexEntryGetTimestamp64(caerFileIndexEntry entry) {
+	return (I64T(
+		(U64T(le32toh(U32T(entry->tsOverflow))) << 31) | U64T(le32toh(U32T(entry->timestamp)) & INT32_MAX)));
+}
+
+static inline int32_t caerFileIndexEntryGetEventNumber(caerFileIndexEntry entry) {
+	return (I32T(le32toh(U32T(entry->eventNumber))));
+}
+
+static inline uint64_t caerFileIndexEntryGetFileOffset(caerFileIndexEntry entry) {
+	return (le64toh(entry->fileOffset));
+}
+
+/*
+ * Reader side: the index of an open file, mapped into memory. Only the
+ * footer and the index packet header are actually read when loading, the
+ * entries themselves are paged in on access, so even the index of a very
+ * large file is available right away.
+ */
+struct caer_file_index {
+	caerFileIndexEntry entries;
+	size_t length;
+	uint64_t indexOffset; // Where the data ends and the index starts.
+	void *mapping;
+	size_t mappingLength;
+};
+
+typedef struct caer_file_index *caerFileIndex;
+
+// Load the index of the given file, if it has one. Returns false if there
+// is no (valid) index, in which case the file has to be scanned instead.
+// trailerSize is what follows each packet, such as its checksum.
+static inline bool caerFileIndexLoad(caerFileIndex index, int fileDescriptor, size_t trailerSize) {
+	memset(index, 0, sizeof(struct caer_file_index));
+
+	// Don't move the file position, reading goes on from where it is.
+	struct stat fileStat;
+	if (fstat(fileDescriptor, &fileStat) != 0) {
+		return (false);
+	}
+
+	off_t fileSize = fileStat.st_size;
+	if (fileSize < (off_t) (sizeof(struct caer_file_index_footer) + CAER_EVENT_PACKET_HEADER_SIZE)) {
+		return (false);
+	}
+
+	struct caer_file_index_footer indexFooter;
+	if (pread(fileDescriptor, &indexFooter, sizeof(struct caer_file_index_footer),
+		fileSize - (off_t) sizeof(struct caer_file_index_footer)) != (ssize_t) sizeof(struct caer_file_index_footer)
+		|| memcmp(indexFooter.magic, CAER_FILE_INDEX_FOOTER_MAGIC, CAER_FILE_INDEX_FOOTER_MAGIC_LENGTH) != 0) {
+		return (false);
+	}
+
+	uint64_t indexOffset = le64toh(indexFooter.indexOffset);
+	if (indexOffset > ((uint64_t) fileSize - sizeof(struct caer_file_index_footer) - CAER_EVENT_PACKET_HEADER_SIZE)) {
+		return (false);
+	}
+
+	struct caer_event_packet_header indexHeader;
+	if (pread(fileDescriptor, &indexHeader, CAER_EVENT_PACKET_HEADER_SIZE, (off_t) indexOffset)
+		!= (ssize_t) CAER_EVENT_PACKET_HEADER_SIZE
+		|| caerEventPacketHeaderGetEventType(&indexHeader) != CAER_FILE_INDEX_EVENT_TYPE
+		|| caerEventPacketHeaderGetEventSize(&indexHeader) != sizeof(struct caer_file_index_entry)
+		|| caerEventPacketHeaderGetEventNumber(&indexHeader) < 0) {
+		return (false);
+	}
+
+	size_t length = (size_t) caerEventPacketHeaderGetEventNumber(&indexHeader);
+	uint64_t entriesOffset = indexOffset + CAER_EVENT_PACKET_HEADER_SIZE;
+
+	// Index and footer must end exactly at the end of the file.
+	if ((entriesOffset + (length * sizeof(struct caer_file_index_entry)) + trailerSize
+		+ sizeof(struct caer_file_index_footer)) != (uint64_t) fileSize) {
+		return (false);
+	}
+
+	index->indexOffset = indexOffset;
+
+	if (length == 0) {
+		return (true);
+	}
+
+	// Mappings have to start on a page boundary.
+	uint64_t pageSize = (uint64_t) sysconf(_SC_PAGESIZE);
+	uint64_t mappingOffset = entriesOffset - (entriesOffset % pageSize);
+	size_t mappingLength = (size_t) (entriesOffset - mappingOffset) + (length * sizeof(struct caer_file_index_entry));
+
+	void *mapping = mmap(NULL, mappingLength, PROT_READ, MAP_SHARED, fileDescriptor, (off_t) mappingOffset);
+	if (mapping == MAP_FAILED) {
+		return (false);
+	}
+
+	index->entries = (caerFileIndexEntry) ((uint8_t *) mapping + (entriesOffset - mappingOffset));
+	index->length = length;
+	index->mapping = mapping;
+	index->mappingLength = mappingLength;
+
+	return (true);
+}
+
+static inline void caerFileIndexUnload(caerFileIndex index) {
+	if (index->mapping != NULL) {
+		munmap(index->mapping, index->mappingLength);
+	}
+
+	memset(index, 0, sizeof(struct caer_file_index));
+}
+
+// Find the entry to start reading from, to get all data from the given
+// timestamp on: the last one with a timestamp not after it, or the first
+// one if the timestamp is before the start of the recording. The index
+// must not be empty.
+static inline size_t caerFileIndexFind(caerFileIndex index, int64_t timestamp) {
+	size_t low = 0;
+	size_t high = index->length;
+
+	// Find the first entry with a timestamp after the wanted one.
+	while (low < high) {
+		size_t middle = low + ((high - low) / 2);
+
+		if (caerFileIndexEntryGetTimestamp64(&index->entries[middle]) <= timestamp) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+
+	return ((low == 0) ? (0) : (low - 1));
+}
+
+#endif /* FILE_INDEX_H_ */
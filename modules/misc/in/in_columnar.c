@@ -0,0 +1,515 @@
+/*
+ * in_columnar.c
+ *
+ *  Reads polarity events from a columnar format file. Each block becomes one
+ *  polarity packet. Only the columns listed in the 'columns' setting are
+ *  decoded, the others are left at zero in the events, and blocks outside
+ *  the [startTimestamp, endTimestamp] range are skipped without reading
+ *  their columns at all.
+ */
+
+#include "in_columnar.h"
+#include "base/module.h"
+#include "ext/caercolumnar/caercolumnar.h"
+#include "ext/ringbuffer/ringbuffer.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <unistd.h>
+#include <libcaer/events/polarity.h>
+#include <libcaer/events/packetContainer.h>
+
+struct input_columnar_state {
+	int fileDescriptor;
+	off_t firstBlock;
+	// What to read, only changed while the input thread is stopped.
+	bool readColumn[CAER_COLUMNAR_COLUMNS];
+	int64_t startTimestamp; // In µs, -1 = from the start.
+	int64_t endTimestamp; // In µs, -1 = up to the end.
+	// Decoded columns of the current block, reused across blocks.
+	int64_t *timestamps;
+	uint16_t *xAddresses;
+	uint16_t *yAddresses;
+	uint8_t *polarities;
+	size_t columnsCapacity;
+	// Ringbuffer to the mainloop, and the thread filling it.
+	RingBuffer rBuf;
+	atomic_bool stop;
+	thrd_t inputReadThread;
+	bool inputReadThreadActive;
+	void (*dataNotifyIncrease)(void *ptr);
+	void (*dataNotifyDecrease)(void *ptr);
+	void *dataNotifyUserPtr;
+};
+
+typedef struct input_columnar_state *inputColumnarState;
+
+static bool caerInputColumnarInit(caerModuleData moduleData);
+static void caerInputColumnarRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerInputColumnarConfig(caerModuleData moduleData);
+static void caerInputColumnarExit(caerModuleData moduleData);
+
+static struct caer_module_functions caerInputColumnarFunctions = { .moduleInit = &caerInputColumnarInit, .moduleRun =
+	&caerInputColumnarRun, .moduleConfig = &caerInputColumnarConfig, .moduleExit = &caerInputColumnarExit };
+
+caerEventPacketContainer caerInputColumnar(uint16_t moduleID) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "InputColumnar");
+
+	caerEventPacketContainer result = NULL;
+
+	caerModuleSM(&caerInputColumnarFunctions, moduleData, sizeof(struct input_columnar_state), 1, &result);
+
+	return (result);
+}
+
+static char *getUserHomeDirectory(const char *subSystemString);
+static bool openInputFile(caerModuleData moduleData);
+static void updateReadSettings(caerModuleData moduleData);
+static bool stopInputThread(caerModuleData moduleData);
+static bool startInputThread(caerModuleData moduleData);
+static int inputColumnarThread(void *ptr);
+static caerEventPacketContainer blockToContainer(caerModuleData moduleData, caerColumnarBlockHeader header,
+	off_t blockOffset);
+static bool ensureColumnsCapacity(inputColumnarState state, size_t capacity);
+static void caerInputColumnarConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+
+// Remember to free strings returned by this.
+static char *getUserHomeDirectory(const char *subSystemString) {
+	// First check the environment for $HOME.
+	char *homeVar = getenv("HOME");
+
+	if (homeVar != NULL) {
+		char *retVar = strdup(homeVar);
+		if (retVar == NULL) {
+			caerLog(CAER_LOG_CRITICAL, subSystemString, "Unable to allocate memory for user home directory path.");
+			return (NULL);
+		}
+
+		return (retVar);
+	}
+
+	// Else try to get it from the user data storage.
+	struct passwd userPasswd;
+	struct passwd *userPasswdPtr;
+	char userPasswdBuf[2048];
+
+	if (getpwuid_r(getuid(), &userPasswd, userPasswdBuf, sizeof(userPasswdBuf), &userPasswdPtr) == 0) {
+		// Success!
+		char *retVar = strdup(userPasswd.pw_dir);
+		if (retVar == NULL) {
+			caerLog(CAER_LOG_CRITICAL, subSystemString, "Unable to allocate memory for user home directory path.");
+			return (NULL);
+		}
+
+		return (retVar);
+	}
+
+	// Else just return /tmp as a place to read from.
+	char *retVar = strdup("/tmp");
+	if (retVar == NULL) {
+		caerLog(CAER_LOG_CRITICAL, subSystemString, "Unable to allocate memory for user home directory path.");
+		return (NULL);
+	}
+
+	return (retVar);
+}
+
+// Open the file named by the settings and check its header, replacing the
+// currently open one on success.
+static bool openInputFile(caerModuleData moduleData) {
+	inputColumnarState state = moduleData->moduleState;
+
+	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+	char *fileName = sshsNodeGetString(moduleData->moduleNode, "filename");
+
+	size_t filePathLength = strlen(directory) + strlen(fileName) + 2;
+	// 1 for the directory/fileName separating slash, 1 for terminating NUL byte = +2.
+	char filePath[filePathLength];
+	snprintf(filePath, filePathLength, "%s/%s", directory, fileName);
+
+	free(directory);
+	free(fileName);
+
+	int newFileDescriptor = open(filePath, O_RDONLY);
+	if (newFileDescriptor < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not open input file '%s' for reading. Error: %d.", filePath, errno);
+		return (false);
+	}
+
+	off_t firstBlock;
+	if (!caerColumnarReadFileHeader(newFileDescriptor, &firstBlock)) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Input file '%s' is not in the " CAER_COLUMNAR_FORMAT_NAME " format.", filePath);
+		close(newFileDescriptor);
+		return (false);
+	}
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Opened input file '%s' successfully for reading.",
+		filePath);
+
+	if (state->fileDescriptor >= 0) {
+		close(state->fileDescriptor);
+	}
+
+	state->fileDescriptor = newFileDescriptor;
+	state->firstBlock = firstBlock;
+
+	return (true);
+}
+
+static void updateReadSettings(caerModuleData moduleData) {
+	inputColumnarState state = moduleData->moduleState;
+
+	state->startTimestamp = sshsNodeGetLong(moduleData->moduleNode, "startTimestamp");
+	state->endTimestamp = sshsNodeGetLong(moduleData->moduleNode, "endTimestamp");
+
+	char *columns = sshsNodeGetString(moduleData->moduleNode, "columns");
+
+	state->readColumn[CAER_COLUMNAR_TIMESTAMP] = (strchr(columns, 't') != NULL);
+	state->readColumn[CAER_COLUMNAR_X] = (strchr(columns, 'x') != NULL);
+	state->readColumn[CAER_COLUMNAR_Y] = (strchr(columns, 'y') != NULL);
+	state->readColumn[CAER_COLUMNAR_POLARITY] = (strchr(columns, 'p') != NULL);
+
+	free(columns);
+}
+
+// Stop the input thread and throw away what it already read.
+static bool stopInputThread(caerModuleData moduleData) {
+	inputColumnarState state = moduleData->moduleState;
+
+	if (state->inputReadThreadActive) {
+		atomic_store(&state->stop, true);
+
+		int res;
+		if ((errno = thrd_join(state->inputReadThread, &res)) != thrd_success) {
+			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+				"Failed to join data acquisition thread. Error: %d.", errno);
+			return (false);
+		}
+
+		state->inputReadThreadActive = false;
+	}
+
+	caerEventPacketContainer container;
+	while ((container = ringBufferGet(state->rBuf)) != NULL) {
+		state->dataNotifyDecrease(state->dataNotifyUserPtr);
+		caerEventPacketContainerFree(container);
+	}
+
+	atomic_store(&state->stop, false);
+
+	return (true);
+}
+
+static bool startInputThread(caerModuleData moduleData) {
+	inputColumnarState state = moduleData->moduleState;
+
+	if ((errno = thrd_create(&state->inputReadThread, &inputColumnarThread, moduleData)) != thrd_success) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Failed to start data acquisition thread. Error: %d.", errno);
+		return (false);
+	}
+
+	state->inputReadThreadActive = true;
+
+	return (true);
+}
+
+static int inputColumnarThread(void *ptr) {
+	caerModuleData moduleData = ptr;
+	inputColumnarState state = moduleData->moduleState;
+
+	struct caer_columnar_block_header header;
+	off_t blockOffset = state->firstBlock;
+	size_t blocksRead = 0, blocksSkipped = 0;
+
+	while (!atomic_load(&state->stop)
+		&& caerColumnarReadBlockHeader(state->fileDescriptor, blockOffset, &header)) {
+		off_t currentBlock = blockOffset;
+		blockOffset = caerColumnarBlockNext(&header, blockOffset);
+
+		// Skip blocks entirely outside the time range, based on their header.
+		// Blocks are not guaranteed to be in order across sources, so the
+		// whole file is always looked at.
+		if ((state->startTimestamp >= 0 && header.timestampMax < state->startTimestamp)
+			|| (state->endTimestamp >= 0 && header.timestampMin > state->endTimestamp)) {
+			blocksSkipped++;
+			continue;
+		}
+
+		caerEventPacketContainer container = blockToContainer(moduleData, &header, currentBlock);
+		if (container == NULL) {
+			continue;
+		}
+
+		blocksRead++;
+
+		while (!ringBufferPut(state->rBuf, container)) {
+			if (atomic_load(&state->stop)) {
+				caerEventPacketContainerFree(container);
+				return (thrd_success);
+			}
+
+			thrd_yield();
+		}
+
+		state->dataNotifyIncrease(state->dataNotifyUserPtr);
+	}
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Input done, %zu blocks read, %zu skipped.", blocksRead,
+		blocksSkipped);
+
+	return (thrd_success);
+}
+
+static bool ensureColumnsCapacity(inputColumnarState state, size_t capacity) {
+	if (capacity <= state->columnsCapacity) {
+		return (true);
+	}
+
+	int64_t *newTimestamps = realloc(state->timestamps, capacity * sizeof(int64_t));
+	if (newTimestamps == NULL) {
+		return (false);
+	}
+	state->timestamps = newTimestamps;
+
+	uint16_t *newXAddresses = realloc(state->xAddresses, capacity * sizeof(uint16_t));
+	if (newXAddresses == NULL) {
+		return (false);
+	}
+	state->xAddresses = newXAddresses;
+
+	uint16_t *newYAddresses = realloc(state->yAddresses, capacity * sizeof(uint16_t));
+	if (newYAddresses == NULL) {
+		return (false);
+	}
+	state->yAddresses = newYAddresses;
+
+	uint8_t *newPolarities = realloc(state->polarities, capacity * sizeof(uint8_t));
+	if (newPolarities == NULL) {
+		return (false);
+	}
+	state->polarities = newPolarities;
+
+	state->columnsCapacity = capacity;
+
+	return (true);
+}
+
+static caerEventPacketContainer blockToContainer(caerModuleData moduleData, caerColumnarBlockHeader header,
+	off_t blockOffset) {
+	inputColumnarState state = moduleData->moduleState;
+
+	size_t eventCount = header->eventCount;
+
+	if (!ensureColumnsCapacity(state, eventCount)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for block columns.");
+		return (NULL);
+	}
+
+	// Timestamps are also needed to cut blocks at the edges of the time range.
+	bool partialBlock = (state->startTimestamp >= 0 && header->timestampMin < state->startTimestamp)
+		|| (state->endTimestamp >= 0 && header->timestampMax > state->endTimestamp);
+
+	bool decodeColumn[CAER_COLUMNAR_COLUMNS];
+	memcpy(decodeColumn, state->readColumn, sizeof(decodeColumn));
+	decodeColumn[CAER_COLUMNAR_TIMESTAMP] = decodeColumn[CAER_COLUMNAR_TIMESTAMP] || partialBlock;
+
+	void *columnValues[CAER_COLUMNAR_COLUMNS] = { state->timestamps, state->xAddresses, state->yAddresses,
+		state->polarities };
+
+	for (size_t c = 0; c < CAER_COLUMNAR_COLUMNS; c++) {
+		if (decodeColumn[c]
+			&& !caerColumnarReadColumn(state->fileDescriptor, blockOffset, header, (enum caer_columnar_columns) c,
+				columnValues[c])) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to decode block at offset %jd, skipping it.", (intmax_t) blockOffset);
+			return (NULL);
+		}
+	}
+
+	// Blocks never span a timestamp overflow, so it's the same for all events.
+	int32_t tsOverflow = I32T(header->timestampMin >> TS_OVERFLOW_SHIFT);
+
+	caerPolarityEventPacket packet = caerPolarityEventPacketAllocate(I32T(eventCount), I16T(moduleData->moduleID),
+		tsOverflow);
+	if (packet == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate polarity event packet.");
+		return (NULL);
+	}
+
+	int32_t outIndex = 0;
+
+	for (size_t i = 0; i < eventCount; i++) {
+		if (partialBlock
+			&& ((state->startTimestamp >= 0 && state->timestamps[i] < state->startTimestamp)
+				|| (state->endTimestamp >= 0 && state->timestamps[i] > state->endTimestamp))) {
+			continue;
+		}
+
+		caerPolarityEvent event = caerPolarityEventPacketGetEvent(packet, outIndex++);
+
+		if (state->readColumn[CAER_COLUMNAR_TIMESTAMP]) {
+			caerPolarityEventSetTimestamp(event, I32T(state->timestamps[i] & INT32_MAX));
+		}
+		if (state->readColumn[CAER_COLUMNAR_X]) {
+			caerPolarityEventSetX(event, state->xAddresses[i]);
+		}
+		if (state->readColumn[CAER_COLUMNAR_Y]) {
+			caerPolarityEventSetY(event, state->yAddresses[i]);
+		}
+		if (state->readColumn[CAER_COLUMNAR_POLARITY]) {
+			caerPolarityEventSetPolarity(event, state->polarities[i]);
+		}
+
+		caerPolarityEventValidate(event, packet);
+	}
+
+	caerEventPacketHeaderSetEventNumber(&packet->packetHeader, outIndex);
+
+	caerEventPacketContainer container = caerEventPacketContainerAllocate(POLARITY_EVENT + 1);
+	if (container == NULL) {
+		free(packet);
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate event packet container.");
+		return (NULL);
+	}
+
+	caerEventPacketContainerSetEventPacket(container, POLARITY_EVENT, (caerEventPacketHeader) packet);
+
+	return (container);
+}
+
+static bool caerInputColumnarInit(caerModuleData moduleData) {
+	inputColumnarState state = moduleData->moduleState;
+
+	char *userHomeDir = getUserHomeDirectory(moduleData->moduleSubSystemString);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "directory", userHomeDir);
+	free(userHomeDir);
+
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "filename", "caer_out-YYYY-MM-DD_hh:mm:ss.caercol");
+
+	// Which columns to read, any of the letters t (timestamp), x, y, p
+	// (polarity). Columns not listed are not decoded, and left at zero.
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "columns", "txyp");
+
+	// Time range to read, in µs, -1 means no limit.
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "startTimestamp", -1);
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "endTimestamp", -1);
+
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "RingBufferSize", 128);
+
+	// So the file can be used with the visualization module.
+	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
+	sshsNodePutShortIfAbsent(sourceInfoNode, "dvsSizeX", 240);
+	sshsNodePutShortIfAbsent(sourceInfoNode, "dvsSizeY", 180);
+
+	updateReadSettings(moduleData);
+
+	state->fileDescriptor = -1;
+
+	if (!openInputFile(moduleData)) {
+		return (false);
+	}
+
+	state->rBuf = ringBufferInit((size_t) sshsNodeGetShort(moduleData->moduleNode, "RingBufferSize"));
+	if (state->rBuf == NULL) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Failed to allocate ring-buffer.");
+		close(state->fileDescriptor);
+		return (false);
+	}
+
+	state->dataNotifyIncrease = &mainloopDataNotifyIncrease;
+	state->dataNotifyDecrease = &mainloopDataNotifyDecrease;
+	state->dataNotifyUserPtr = caerMainloopGetReference();
+
+	if (!startInputThread(moduleData)) {
+		ringBufferFree(state->rBuf);
+		close(state->fileDescriptor);
+		return (false);
+	}
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerInputColumnarConfigListener);
+
+	return (true);
+}
+
+static void caerInputColumnarRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	UNUSED_ARGUMENT(argsNumber);
+
+	inputColumnarState state = moduleData->moduleState;
+
+	caerEventPacketContainer *container = va_arg(args, caerEventPacketContainer *);
+
+	*container = ringBufferGet(state->rBuf);
+
+	if (*container != NULL) {
+		state->dataNotifyDecrease(state->dataNotifyUserPtr);
+		caerMainloopFreeAfterLoop((void (*)(void *)) &caerEventPacketContainerFree, *container);
+	}
+}
+
+static void caerInputColumnarConfig(caerModuleData moduleData) {
+	uintptr_t configUpdate = atomic_exchange(&moduleData->configUpdate, 0);
+
+	if (configUpdate == 0) {
+		return;
+	}
+
+	// Any change restarts reading from the beginning of the file.
+	if (!stopInputThread(moduleData)) {
+		return;
+	}
+
+	if (configUpdate & (0x01 << 0)) {
+		// File changed. On failure, continue with the old one.
+		openInputFile(moduleData);
+	}
+
+	if (configUpdate & (0x01 << 1)) {
+		// Columns or time range changed.
+		updateReadSettings(moduleData);
+	}
+
+	startInputThread(moduleData);
+}
+
+static void caerInputColumnarExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerInputColumnarConfigListener);
+
+	inputColumnarState state = moduleData->moduleState;
+
+	stopInputThread(moduleData);
+	ringBufferFree(state->rBuf);
+
+	close(state->fileDescriptor);
+
+	free(state->timestamps);
+	free(state->xAddresses);
+	free(state->yAddresses);
+	free(state->polarities);
+}
+
+static void caerInputColumnarConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+	UNUSED_ARGUMENT(changeValue);
+
+	caerModuleData data = userData;
+
+	if (event == ATTRIBUTE_MODIFIED) {
+		if (changeType == STRING && (caerStrEquals(changeKey, "directory") || caerStrEquals(changeKey, "filename"))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 0));
+		}
+
+		if ((changeType == STRING && caerStrEquals(changeKey, "columns"))
+			|| (changeType == LONG
+				&& (caerStrEquals(changeKey, "startTimestamp") || caerStrEquals(changeKey, "endTimestamp")))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 1));
+		}
+	}
+}
@@ -0,0 +1,16 @@
+/*
+ * in_columnar.h
+ *
+ *  Input for files in the columnar format (see ext/caercolumnar), reading
+ *  only the requested columns and time range.
+ */
+
+#ifndef COLUMNAR_INPUT_H_
+#define COLUMNAR_INPUT_H_
+
+#include "in_common.h"
+#include <libcaer/events/packetContainer.h>
+
+caerEventPacketContainer caerInputColumnar(uint16_t moduleID);
+
+#endif /* COLUMNAR_INPUT_H_ */
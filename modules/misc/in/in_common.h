@@ -14,11 +14,20 @@
 
 #include <libcaer/events/common.h>
 #include "base/mainloop.h" // For caerMainloopData definition.
+#include "ext/caerdelta/caerdelta.h"
+#include "ext/crc32c/crc32c.h"
+
+// What to do with packets whose checksum doesn't match: drop them, pass them
+// on anyway (only counting them), or stop reading.
+enum caer_input_checksum_policy {
+	CAER_INPUT_CHECKSUM_DROP, CAER_INPUT_CHECKSUM_PASS, CAER_INPUT_CHECKSUM_STOP,
+};
 
 /*
- *  Reads a single packets - remember to free the packet
+ *  Reads a single packets - remember to free the packet. If checksum is not
+ *  NULL, the CRC-32C of the packet's bytes is stored there.
  */
-static inline caerEventPacketHeader caerInputCommonReadPacket(int fileDescriptor) {
+static inline caerEventPacketHeader caerInputCommonReadPacket(int fileDescriptor, uint32_t *checksum) {
 	caerLog(CAER_LOG_DEBUG, "caerInputCommonReadPacket", "Inside reading function (FileDescriptor: %d)",
 		fileDescriptor);
 
@@ -59,10 +68,171 @@ static inline caerEventPacketHeader caerInputCommonReadPacket(int fileDescriptor
 		return (NULL);
 	}
 
+	if (checksum != NULL) {
+		*checksum = caerCrc32c(0, header, (size_t) (CAER_EVENT_PACKET_HEADER_SIZE + total_size_events));
+	}
+
+	// Remeber to free it later on!
+	return (header);
+}
+
+/*
+ *  Read exactly length bytes, or fail - works for both files and sockets
+ */
+static inline bool caerInputCommonReadFull(int fileDescriptor, void *buffer, size_t length) {
+	uint8_t *dataBuffer = buffer;
+	size_t bytesDone = 0;
+
+	while (bytesDone < length) {
+		ssize_t bytesRead = read(fileDescriptor, dataBuffer + bytesDone, length - bytesDone);
+		if (bytesRead <= 0) {
+			return (false);
+		}
+
+		bytesDone += (size_t) bytesRead;
+	}
+
+	return (true);
+}
+
+/*
+ *  Reads a single packet in CAERDELTA format and decompresses it - remember
+ *  to free the packet. Each packet is: header, 32 bit payload length and the
+ *  compressed payload (cf. "misc/out/out_common.h"). If checksum is not NULL,
+ *  the CRC-32C of those bytes, as read, is stored there.
+ */
+static inline caerEventPacketHeader caerInputCommonReadDeltaPacket(int fileDescriptor, uint32_t *checksum) {
+	// if for some reason, the fileDescriptor is not valid, return NULL
+	if (fileDescriptor < 0) {
+		return (NULL);
+	}
+
+	struct caer_event_packet_header headerOnly;
+	uint32_t payloadLength;
+
+	if (!caerInputCommonReadFull(fileDescriptor, &headerOnly, CAER_EVENT_PACKET_HEADER_SIZE)
+		|| !caerInputCommonReadFull(fileDescriptor, &payloadLength, sizeof(uint32_t))) {
+		caerLog(CAER_LOG_WARNING, "caerInputCommonReadDeltaPacket", "Error while reading packet header.");
+
+		return (NULL);
+	}
+
+	if (checksum != NULL) {
+		*checksum = caerCrc32c(0, &headerOnly, CAER_EVENT_PACKET_HEADER_SIZE);
+		*checksum = caerCrc32c(*checksum, &payloadLength, sizeof(uint32_t));
+	}
+
+	payloadLength = le32toh(payloadLength);
+
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(&headerOnly);
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(&headerOnly);
+
+	if (eventNumber < 0 || eventSize <= 0
+		|| payloadLength > caerDeltaMaxPayloadSize(eventSize, eventNumber)) {
+		caerLog(CAER_LOG_WARNING, "caerInputCommonReadDeltaPacket", "Invalid packet header.");
+
+		return (NULL);
+	}
+
+	uint8_t *payload = malloc(payloadLength);
+	caerEventPacketHeader header = malloc(CAER_EVENT_PACKET_HEADER_SIZE + (size_t) (eventNumber * eventSize));
+
+	if (payload == NULL || header == NULL) {
+		caerLog(CAER_LOG_ERROR, "caerInputCommonReadDeltaPacket", "Failed to allocate memory for packet.");
+		free(payload);
+		free(header);
+
+		return (NULL);
+	}
+
+	memcpy(header, &headerOnly, CAER_EVENT_PACKET_HEADER_SIZE);
+
+	bool payloadRead = caerInputCommonReadFull(fileDescriptor, payload, payloadLength);
+
+	if (payloadRead && checksum != NULL) {
+		*checksum = caerCrc32c(*checksum, payload, payloadLength);
+	}
+
+	if (!payloadRead
+		|| !caerDeltaDecode(payload, payloadLength, ((uint8_t *) header) + CAER_EVENT_PACKET_HEADER_SIZE, eventSize,
+			eventNumber)) {
+		caerLog(CAER_LOG_WARNING, "caerInputCommonReadDeltaPacket", "Error while reading or decoding packet.");
+		free(payload);
+		free(header);
+
+		return (NULL);
+	}
+
+	free(payload);
+
 	// Remeber to free it later on!
 	return (header);
 }
 
+static inline enum caer_input_checksum_policy caerInputCommonChecksumPolicy(const char *subSystemString,
+	sshsNode moduleNode) {
+	char *policy = sshsNodeGetString(moduleNode, "checksumPolicy");
+	enum caer_input_checksum_policy checksumPolicy = CAER_INPUT_CHECKSUM_DROP;
+
+	if (caerStrEquals(policy, "pass")) {
+		checksumPolicy = CAER_INPUT_CHECKSUM_PASS;
+	}
+	else if (caerStrEquals(policy, "stop")) {
+		checksumPolicy = CAER_INPUT_CHECKSUM_STOP;
+	}
+	else if (!caerStrEquals(policy, "drop")) {
+		caerLog(CAER_LOG_ERROR, subSystemString, "Unknown checksum policy '%s', dropping bad packets.", policy);
+	}
+
+	free(policy);
+
+	return (checksumPolicy);
+}
+
+/*
+ *  Reads a single packet (RAW or CAERDELTA) followed by its CRC-32C trailer,
+ *  and checks it. Packets that fail are handled according to the policy, and
+ *  counted in checksumFailures. Returns NULL at the end of data, on errors,
+ *  or when stopping because of a bad packet.
+ */
+static inline caerEventPacketHeader caerInputCommonReadCheckedPacket(const char *subSystemString, int fileDescriptor,
+	bool compressed, enum caer_input_checksum_policy checksumPolicy, uint64_t *checksumFailures) {
+	while (true) {
+		uint32_t checksum = 0;
+		caerEventPacketHeader packet = (compressed) ? (caerInputCommonReadDeltaPacket(fileDescriptor, &checksum)) :
+			(caerInputCommonReadPacket(fileDescriptor, &checksum));
+
+		uint32_t trailer;
+		if (packet == NULL || !caerInputCommonReadFull(fileDescriptor, &trailer, sizeof(uint32_t))) {
+			// A decoding error in compressed data is also a checksum failure,
+			// but the packet is gone either way.
+			free(packet);
+			return (NULL);
+		}
+
+		if (le32toh(trailer) == checksum) {
+			return (packet);
+		}
+
+		(*checksumFailures)++;
+
+		caerLog(CAER_LOG_WARNING, subSystemString,
+			"Checksum mismatch on packet of type %" PRIi16 " with %" PRIi32 " events (%" PRIu64 " so far).",
+			caerEventPacketHeaderGetEventType(packet), caerEventPacketHeaderGetEventNumber(packet), *checksumFailures);
+
+		if (checksumPolicy == CAER_INPUT_CHECKSUM_PASS) {
+			return (packet);
+		}
+
+		free(packet);
+
+		if (checksumPolicy == CAER_INPUT_CHECKSUM_STOP) {
+			caerLog(CAER_LOG_ERROR, subSystemString, "Stopping input because of a corrupted packet.");
+			return (NULL);
+		}
+	}
+}
+
 static inline void mainloopDataNotifyIncrease(void *p) {
 	caerMainloopData mainloopData = p;
 
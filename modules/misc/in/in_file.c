@@ -7,6 +7,7 @@
 
 #include "in_file.h"
 #include "base/module.h"
+#include "modules/misc/file_index.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
@@ -23,6 +24,16 @@ static int inputFromFileThread(void* ptr);
 struct input_file_state {
 	// io params
 	int fileDescriptor;
+	bool compressed; // packets in CAERDELTA format, from file header
+	bool checksum; // packets followed by a CRC-32C trailer, from file header
+	enum caer_input_checksum_policy checksumPolicy;
+	uint64_t checksumFailures;
+	off_t dataOffset; // where the first packet starts, right after the header
+	// packet index at the end of the file, if present, for seeking
+	struct caer_file_index index;
+	bool indexLoaded;
+	// only pass on packets from this source, for files holding several, -1 = all
+	int16_t sourceFilter;
 	// playback params
 	atomic_bool play;
 	atomic_bool stop; // equivalent to: pause (i.e. play = false) and reset (close and reopen the file)
@@ -31,6 +42,7 @@ struct input_file_state {
 	size_t rBufSize; // used only at initializazion, i.e. no dynamic reallocation of the ringbuffer
 	// input thread variables
 	thrd_t inputReadThread;
+	bool inputReadThreadActive;
 	void (*dataNotifyIncrease)(void *ptr);
 	void (*dataNotifyDecrease)(void *ptr);
 	void *dataNotifyUserPtr;
@@ -60,6 +72,15 @@ caerEventPacketContainer caerInputFile(uint16_t moduleID) {
 
 static char *getUserHomeDirectory(const char *subSystemString);
 static char *getFullFilePath(const char * subSystemString, const char *directory, const char *fileName);
+static bool parseFileHeader(caerModuleData moduleData, int fileDescriptor);
+static void parseSourceInfoLine(caerModuleData moduleData, char *sourceInfo, int16_t *firstSource);
+static caerEventPacketHeader readFilePacket(caerModuleData moduleData, int fileDescriptor);
+static caerEventPacketHeader readSourcePacket(caerModuleData moduleData, int fileDescriptor);
+static void loadFileIndex(caerModuleData moduleData);
+static bool stopInputThread(caerModuleData moduleData);
+static bool startInputThread(caerModuleData moduleData);
+static void seekToTimestamp(caerModuleData moduleData, int64_t timestamp);
+static bool scanToTimestamp(caerModuleData moduleData, int64_t timestamp, off_t *offset);
 static void caerInputFileConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 
@@ -122,6 +143,296 @@ static char *getFullFilePath(const char * subSystemString, const char *directory
 	return (filePath);
 }
 
+// Parse the AEDAT 3.x text header, leaving the file positioned at the first
+// packet. Remembers which format the packets are stored in, and restores the
+// source information of the selected source, if the file describes it.
+static bool parseFileHeader(caerModuleData moduleData, int fileDescriptor) {
+	inputFileState state = moduleData->moduleState;
+
+	state->compressed = false;
+	state->checksum = false;
+	state->checksumPolicy = caerInputCommonChecksumPolicy(moduleData->moduleSubSystemString, moduleData->moduleNode);
+	state->checksumFailures = 0;
+	sshsNodePutLong(moduleData->moduleNode, "checksumFailures", 0);
+	state->sourceFilter = I16T(sshsNodeGetInt(moduleData->moduleNode, "sourceID"));
+
+	int16_t firstSource = -1;
+	char line[1024];
+
+	while (true) {
+		off_t lineStart = lseek(fileDescriptor, 0, SEEK_CUR);
+
+		// header lines all start with '#', anything else is already data
+		char c;
+		if (read(fileDescriptor, &c, 1) != 1) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Input file is empty.");
+			return (false);
+		}
+
+		if (c != '#') {
+			lseek(fileDescriptor, lineStart, SEEK_SET);
+			return (true);
+		}
+
+		// the header is tiny, so just read it byte by byte
+		size_t lineLength = 0;
+		line[lineLength++] = c;
+
+		while (read(fileDescriptor, &c, 1) == 1 && c != '\n') {
+			if (lineLength < (sizeof(line) - 1)) {
+				line[lineLength++] = c;
+			}
+		}
+
+		if (lineLength > 0 && line[lineLength - 1] == '\r') {
+			lineLength--;
+		}
+		line[lineLength] = '\0';
+
+		if (caerStrEquals(line, "#!END-HEADER")) {
+			return (true);
+		}
+
+		if (strncmp(line, "#SourceInfo ", 12) == 0) {
+			parseSourceInfoLine(moduleData, line + 12, &firstSource);
+		}
+
+		if (strncmp(line, "#Format: ", 9) == 0) {
+			if (caerStrEquals(line + 9, CAERDELTA_FORMAT_NAME)) {
+				state->compressed = true;
+			}
+			else if (!caerStrEquals(line + 9, "RAW")) {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Unsupported input file format '%s'.",
+					line + 9);
+				return (false);
+			}
+		}
+
+		if (strncmp(line, "#Checksum: ", 11) == 0) {
+			if (caerStrEquals(line + 11, "CRC32C")) {
+				state->checksum = true;
+			}
+			else {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Unsupported input file checksum '%s'.",
+					line + 11);
+				return (false);
+			}
+		}
+	}
+}
+
+// Lines are '<sourceID>: <type> <key> <value>'. Without a source selected,
+// the information of the first source in the file is used.
+static void parseSourceInfoLine(caerModuleData moduleData, char *sourceInfo, int16_t *firstSource) {
+	inputFileState state = moduleData->moduleState;
+
+	char *type;
+	long sourceID = strtol(sourceInfo, &type, 10);
+	if (type == sourceInfo || type[0] != ':' || type[1] != ' ' || sourceID < 0 || sourceID > INT16_MAX) {
+		return;
+	}
+	type += 2;
+
+	char *key = strchr(type, ' ');
+	if (key == NULL) {
+		return;
+	}
+	*key++ = '\0';
+
+	char *value = strchr(key, ' ');
+	if (value == NULL) {
+		return;
+	}
+	*value++ = '\0';
+
+	if (*firstSource < 0) {
+		*firstSource = I16T(sourceID);
+	}
+
+	if ((state->sourceFilter >= 0 && sourceID != state->sourceFilter)
+		|| (state->sourceFilter < 0 && sourceID != *firstSource)) {
+		return;
+	}
+
+	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
+
+	if (!sshsNodeStringToNodeConverter(sourceInfoNode, key, type, value)) {
+		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Ignoring invalid source information for '%s'.",
+			key);
+	}
+}
+
+static caerEventPacketHeader readFilePacket(caerModuleData moduleData, int fileDescriptor) {
+	inputFileState state = moduleData->moduleState;
+
+	if (state->checksum) {
+		uint64_t checksumFailures = state->checksumFailures;
+
+		caerEventPacketHeader packet = caerInputCommonReadCheckedPacket(moduleData->moduleSubSystemString,
+			fileDescriptor, state->compressed, state->checksumPolicy, &state->checksumFailures);
+
+		if (state->checksumFailures != checksumFailures) {
+			sshsNodePutLong(moduleData->moduleNode, "checksumFailures", I64T(state->checksumFailures));
+		}
+
+		return (packet);
+	}
+
+	if (state->compressed) {
+		return (caerInputCommonReadDeltaPacket(fileDescriptor, NULL));
+	}
+
+	return (caerInputCommonReadPacket(fileDescriptor, NULL));
+}
+
+// Read the next packet of the selected source, skipping those of others.
+// The packet index is always passed on, it marks the end of the data.
+static caerEventPacketHeader readSourcePacket(caerModuleData moduleData, int fileDescriptor) {
+	inputFileState state = moduleData->moduleState;
+
+	while (true) {
+		caerEventPacketHeader packet = readFilePacket(moduleData, fileDescriptor);
+
+		if (packet == NULL || state->sourceFilter < 0
+			|| caerEventPacketHeaderGetEventType(packet) == CAER_FILE_INDEX_EVENT_TYPE
+			|| caerEventPacketHeaderGetEventSource(packet) == state->sourceFilter) {
+			return (packet);
+		}
+
+		free(packet);
+	}
+}
+
+// Remember where the data starts, and map the packet index, if the file has
+// one. Must be called right after parseFileHeader().
+static void loadFileIndex(caerModuleData moduleData) {
+	inputFileState state = moduleData->moduleState;
+
+	state->dataOffset = lseek(state->fileDescriptor, 0, SEEK_CUR);
+
+	if (state->indexLoaded) {
+		caerFileIndexUnload(&state->index);
+	}
+
+	state->indexLoaded = caerFileIndexLoad(&state->index, state->fileDescriptor,
+		(state->checksum) ? (sizeof(uint32_t)) : (0));
+
+	if (state->indexLoaded) {
+		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Input file has a packet index with %zu entries.",
+			state->index.length);
+	}
+
+	sshsNodePutBool(moduleData->moduleNode, "hasIndex", state->indexLoaded);
+	sshsNodePutLong(moduleData->moduleNode, "indexEntries", (state->indexLoaded) ? (I64T(state->index.length)) : (0));
+}
+
+// Stop the input thread and throw away what it already read.
+static bool stopInputThread(caerModuleData moduleData) {
+	inputFileState state = moduleData->moduleState;
+
+	if (state->inputReadThreadActive) {
+		atomic_store(&state->stop, true);
+
+		int res;
+		if ((errno = thrd_join(state->inputReadThread, &res)) != thrd_success) {
+			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+				"Failed to join data acquisition thread. Error: %d.", errno);
+			return (false);
+		}
+
+		state->inputReadThreadActive = false;
+	}
+
+	resetBuffer(moduleData);
+	atomic_store(&state->stop, false);
+
+	return (true);
+}
+
+static bool startInputThread(caerModuleData moduleData) {
+	inputFileState state = moduleData->moduleState;
+
+	if ((errno = thrd_create(&state->inputReadThread, &inputFromFileThread, moduleData)) != thrd_success) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Failed to start data acquisition thread. Error: %d.", errno);
+		return (false);
+	}
+
+	state->inputReadThreadActive = true;
+
+	return (true);
+}
+
+// Continue playback from the given timestamp on. With an index this is a
+// binary search in memory and a single lseek(), without one the file has to
+// be read from the start up to there.
+static void seekToTimestamp(caerModuleData moduleData, int64_t timestamp) {
+	inputFileState state = moduleData->moduleState;
+
+	if (!stopInputThread(moduleData)) {
+		return;
+	}
+
+	off_t offset = state->dataOffset;
+
+	if (state->indexLoaded) {
+		if (state->index.length > 0) {
+			offset = (off_t) caerFileIndexEntryGetFileOffset(
+				&state->index.entries[caerFileIndexFind(&state->index, timestamp)]);
+		}
+	}
+	else {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Input file has no packet index, scanning it to seek.");
+
+		if (!scanToTimestamp(moduleData, timestamp, &offset)) {
+			offset = state->dataOffset;
+		}
+	}
+
+	if (lseek(state->fileDescriptor, offset, SEEK_SET) < 0) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to seek in input file. Error: %d.", errno);
+		return;
+	}
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Seeked to timestamp %" PRIi64 " (offset %jd).",
+		timestamp, (intmax_t) offset);
+
+	startInputThread(moduleData);
+}
+
+// Find the offset of the first packet that starts at or after the given
+// timestamp, by reading through the whole file.
+static bool scanToTimestamp(caerModuleData moduleData, int64_t timestamp, off_t *offset) {
+	inputFileState state = moduleData->moduleState;
+
+	if (lseek(state->fileDescriptor, state->dataOffset, SEEK_SET) < 0) {
+		return (false);
+	}
+
+	while (true) {
+		off_t packetStart = lseek(state->fileDescriptor, 0, SEEK_CUR);
+
+		caerEventPacketHeader packet = readFilePacket(moduleData, state->fileDescriptor);
+		if (packet == NULL) {
+			// Timestamp is past the end, continue from the end.
+			*offset = packetStart;
+			return (true);
+		}
+
+		bool found = (caerEventPacketHeaderGetEventType(packet) == CAER_FILE_INDEX_EVENT_TYPE)
+			|| (caerEventPacketHeaderGetEventNumber(packet) > 0
+				&& caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packet, 0), packet) >= timestamp);
+
+		free(packet);
+
+		if (found) {
+			*offset = packetStart;
+			return (true);
+		}
+	}
+}
+
 static bool caerInputFileInit(caerModuleData moduleData) {
 	inputFileState state = moduleData->moduleState;
 
@@ -143,6 +454,13 @@ static bool caerInputFileInit(caerModuleData moduleData) {
 	sshsNodePutShortIfAbsent(moduleData->moduleNode, "RingBufferSize", 128);
 	// -- process_all flag (not modifiable at runtime)
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "ProcessAll", false);
+	// -- seek to a timestamp (in µs), takes effect when set, reset to -1 after
+	sshsNodePutLong(moduleData->moduleNode, "seekTimestamp", -1);
+	// -- for files recorded from several sources, only play back this one (-1 = all)
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "sourceID", -1);
+	// -- for files with checksums, what to do with corrupted packets: drop, pass or stop
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "checksumPolicy", "drop");
+	sshsNodePutLong(moduleData->moduleNode, "checksumFailures", 0);
 	// -- if relative node "sourceInfo/" does not exist, add it (so file can be used with the visualization module)
 	sshsNode sourceInfoNode = sshsGetRelativeNode(moduleData->moduleNode, "sourceInfo/");
 	// -- -- array(frame) size of the original device (added so it works with the visualizer module)
@@ -175,6 +493,15 @@ static bool caerInputFileInit(caerModuleData moduleData) {
 		filePath);
 	free(filePath);
 
+	// skip the header, data follows right after
+	if (!parseFileHeader(moduleData, state->fileDescriptor)) {
+		close(state->fileDescriptor);
+
+		return (false);
+	}
+
+	loadFileIndex(moduleData);
+
 	// initialize ringbuffer
 	state->rBuf = ringBufferInit((size_t) sshsNodeGetShort(moduleData->moduleNode, "RingBufferSize"));
 	// set notifier
@@ -182,11 +509,10 @@ static bool caerInputFileInit(caerModuleData moduleData) {
 	state->dataNotifyIncrease = &mainloopDataNotifyIncrease;
 	state->dataNotifyUserPtr = caerMainloopGetReference();
 	// start thread
-	if ((errno = thrd_create(&state->inputReadThread, &inputFromFileThread, moduleData)) != thrd_success) {
+	if (!startInputThread(moduleData)) {
 		ringBufferFree(state->rBuf);
-		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-			"Failed to start data acquisition thread. Error: %d.",
-			errno);
+		caerFileIndexUnload(&state->index);
+		close(state->fileDescriptor);
 		return (false);
 	}
 
@@ -224,13 +550,11 @@ static void caerInputFileExit(caerModuleData moduleData) {
 	inputFileState state = moduleData->moduleState;
 
 	// Tell the input thread to stop. Main thread waits until it stopped
-	atomic_store(&state->stop, true);
-	int* res = malloc(sizeof(int));
-	thrd_join(state->inputReadThread, res);
-	// Reset and Free RingBuffer
-	resetBuffer(moduleData);
+	stopInputThread(moduleData);
+	// Free RingBuffer
 	ringBufferFree(state->rBuf);
-	// Close file.
+	// Unmap index and close file.
+	caerFileIndexUnload(&state->index);
 	close(state->fileDescriptor);
 }
 
@@ -247,15 +571,10 @@ static void caerInputFileConfig(caerModuleData moduleData) {
 	}
 
 	if (configUpdate & (0x01 << 1)) {
-		// wait for the thread to correctly exit
-		int* res = malloc(sizeof(int));
-		thrd_join(state->inputReadThread, res);
-		if ((*res) > thrd_success) {
-			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-				"Something bad happened while waiting for the input thread. Error: %d.", *res);
+		// wait for the thread to correctly exit, and reset buffer
+		if (!stopInputThread(moduleData)) {
+			return;
 		}
-		// reset buffer
-		resetBuffer(moduleData);
 		// set everything to false
 		sshsNodePutBool(node, "StopPlayback", false);
 		sshsNodePutBool(node, "StartPlayback", false);
@@ -280,20 +599,34 @@ static void caerInputFileConfig(caerModuleData moduleData) {
 			filePath);
 		free(filePath);
 
+		// skip the header, data follows right after
+		if (!parseFileHeader(moduleData, newFileDescriptor)) {
+			close(newFileDescriptor);
+
+			return;
+		}
+
 		// New fd ready and opened, close old and set new.
 		close(state->fileDescriptor);
 		state->fileDescriptor = newFileDescriptor;
 
-		// start a new thread
-		if ((errno = thrd_create(&state->inputReadThread, &inputFromFileThread, moduleData)) != thrd_success) {
-			ringBufferFree(state->rBuf);
-			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-				"Failed to start data acquisition thread. Error: %d.",
-				errno);
+		loadFileIndex(moduleData);
 
+		// start a new thread
+		if (!startInputThread(moduleData)) {
 			return;
 		}
 	}
+
+	if (configUpdate & (0x01 << 2)) {
+		int64_t seekTimestamp = sshsNodeGetLong(node, "seekTimestamp");
+
+		if (seekTimestamp >= 0) {
+			seekToTimestamp(moduleData, seekTimestamp);
+
+			sshsNodePutLong(node, "seekTimestamp", -1);
+		}
+	}
 }
 
 static void caerInputFileConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -306,7 +639,10 @@ static void caerInputFileConfigListener(sshsNode node, void *userData, enum sshs
 	// Distinguish changes to the validOnly flag or to the filename, by setting
 	// configUpdate appropriately like a bit-field.
 	if (event == ATTRIBUTE_MODIFIED) {
-		if (changeType == STRING && (caerStrEquals(changeKey, "directory") || caerStrEquals(changeKey, "filename"))) {
+		if ((changeType == STRING
+			&& (caerStrEquals(changeKey, "directory") || caerStrEquals(changeKey, "filename")
+				|| caerStrEquals(changeKey, "checksumPolicy")))
+			|| (changeType == INT && caerStrEquals(changeKey, "sourceID"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 0));
 		}
 		if (changeType == BOOL && caerStrEquals(changeKey, "StartPlayback")) {
@@ -320,6 +656,9 @@ static void caerInputFileConfigListener(sshsNode node, void *userData, enum sshs
 				atomic_fetch_or(&data->configUpdate, (0x01 << 1));
 			}
 		}
+		if (changeType == LONG && caerStrEquals(changeKey, "seekTimestamp")) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 2));
+		}
 	}
 
 }
@@ -331,7 +670,7 @@ static caerEventPacketContainer packetsFromFileToContainer(caerModuleData module
 	caerEventPacketContainer newContainer = caerEventPacketContainerAllocate(1);
 
 	for (int i = 0; i < 1; ++i) {
-		caerEventPacketHeader packet = caerInputCommonReadPacket(state->fileDescriptor);
+		caerEventPacketHeader packet = readFilePacket(moduleData, state->fileDescriptor);
 		if (packet == NULL) {
 			caerEventPacketContainerFree(newContainer);
 			return NULL;
@@ -353,9 +692,14 @@ static int inputFromFileThread(void* ptr) {
 	// create local copy of the file descriptor
 	int fid = state->fileDescriptor;
 	// remainder packet, used to identify the moment to send a container. Read in first packet.
-	caerEventPacketHeader packetHeader = caerInputCommonReadPacket(fid);
+	caerEventPacketHeader packetHeader = readSourcePacket(data, fid);
 	if (packetHeader == NULL)
 		thrd_exit(thrd_success);
+	// the packet index at the end of a file is not data, stop there
+	if (caerEventPacketHeaderGetEventType(packetHeader) == CAER_FILE_INDEX_EVENT_TYPE) {
+		free(packetHeader);
+		thrd_exit(thrd_success);
+	}
 	caerEventPacketHeaderSetEventSource(packetHeader, IDSource);
 	// keep track of the greatest event_type to appropriately allocate the container
 	int16_t maxSizeContainer = I16T(caerEventPacketHeaderGetEventType(packetHeader) + 1);
@@ -398,9 +742,13 @@ static int inputFromFileThread(void* ptr) {
 			caerEventPacketContainerSetEventPacket(container, currType, packetHeader);
 		}
 		// read next packet
-		packetHeader = caerInputCommonReadPacket(fid);
+		packetHeader = readSourcePacket(data, fid);
 		if (packetHeader == NULL)
 			thrd_exit(thrd_success);
+		if (caerEventPacketHeaderGetEventType(packetHeader) == CAER_FILE_INDEX_EVENT_TYPE) {
+			free(packetHeader);
+			thrd_exit(thrd_success);
+		}
 		caerEventPacketHeaderSetEventSource(packetHeader, IDSource);
 	}
 
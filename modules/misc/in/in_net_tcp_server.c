@@ -28,6 +28,7 @@ struct in_netTCP_state {
 	void (*dataNotifyDecrease)(void *ptr);
 	void *dataNotifyUserPtr;
 	caerEventPacketContainer currentContainer;
+	uint64_t checksumFailures;
 };
 
 typedef struct in_netTCP_state *netTCPState;
@@ -95,6 +96,11 @@ static bool caerInputNetTCPServerInit(caerModuleData moduleData) {
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "notifyMainLoop", true);
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "keepLatestContainer", false);
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "waitForFullContainer", false);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "format", "RAW");
+	// packets followed by a CRC-32C trailer, must match the sender like the format
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "checksum", false);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "checksumPolicy", "drop");
+	sshsNodePutLong(moduleData->moduleNode, "checksumFailures", 0);
 
 	state->stop = false;
 	state->connected = false;
@@ -252,6 +258,13 @@ static int inputFromSocketThread(void* ptr) {
 		state->connected = checkTcpInputConnections(moduleData);
 	}
 	caerLog(CAER_LOG_INFO, "caerInputNetTCPServerThread", "Connected ... waiting for data");
+	// a stream has no header, so the format (RAW or CAERDELTA) must be configured to match the sender
+	char *format = sshsNodeGetString(moduleData->moduleNode, "format");
+	bool compressed = caerStrEquals(format, CAERDELTA_FORMAT_NAME);
+	free(format);
+	bool checksum = sshsNodeGetBool(moduleData->moduleNode, "checksum");
+	enum caer_input_checksum_policy checksumPolicy = caerInputCommonChecksumPolicy(moduleData->moduleSubSystemString,
+		moduleData->moduleNode);
 	// remainder packet, used to identify the moment to send a container. Read in first packet.
 	caerEventPacketHeader packetHeader = NULL;
 	int16_t maxSizeContainer = 5;
@@ -273,7 +286,18 @@ static int inputFromSocketThread(void* ptr) {
 			thrd_exit(thrd_success);
 		}
 		int fid = state->clientDescriptor->fd;
-		packetHeader = caerInputCommonReadPacket(fid);
+		if (checksum) {
+			uint64_t checksumFailures = state->checksumFailures;
+			packetHeader = caerInputCommonReadCheckedPacket(moduleData->moduleSubSystemString, fid, compressed,
+				checksumPolicy, &state->checksumFailures);
+			if (state->checksumFailures != checksumFailures) {
+				sshsNodePutLong(moduleData->moduleNode, "checksumFailures", I64T(state->checksumFailures));
+			}
+		}
+		else {
+			packetHeader =
+				(compressed) ? (caerInputCommonReadDeltaPacket(fid, NULL)) : (caerInputCommonReadPacket(fid, NULL));
+		}
 		if (packetHeader == NULL) {
 			//connection broken -> kill thread and restart from run
 			state->connected = false;
@@ -0,0 +1,497 @@
+/*
+ * in_net_udp.c
+ *
+ *  UDP input, the receiving side of NetUDPOutput. Every datagram must hold
+ *  a complete event packet (header and whole events), which is what the
+ *  UDP output sends with stream headers enabled, or with maxBytesPerPacket
+ *  set and excludeHeader disabled.
+ */
+
+#include "in_net_udp.h"
+#include "base/module.h"
+#include "ext/nets.h"
+#include "ext/portable_time.h"
+#include "ext/ringbuffer/ringbuffer.h"
+#include "ext/udpstream.h"
+#include <poll.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+// How long to wait for new datagrams before checking for shutdown and
+// committing partially filled containers, in milliseconds.
+#define UDP_INPUT_POLL_TIMEOUT 100
+
+// Datagram statistics are published to the configuration this often.
+#define UDP_INPUT_STATISTICS_INTERVAL 1
+
+struct in_netUDP_state {
+	int netUDPDescriptor;
+	bool streamHeader;
+	atomic_bool running;
+	thrd_t inputReadThread;
+	RingBuffer dataTransfer;
+	void (*dataNotifyIncrease)(void *ptr);
+	void (*dataNotifyDecrease)(void *ptr);
+	void *dataNotifyUserPtr;
+	// Only accessed by the input thread.
+	uint8_t *datagram;
+	caerEventPacketContainer currentContainer;
+	int16_t currentContainerSize;
+	struct caer_udp_stream_stats stats;
+	caerUDPStreamFEC fec;
+	uint64_t invalidDatagrams;
+	time_t statisticsLastUpdate;
+};
+
+typedef struct in_netUDP_state *netUDPState;
+
+static bool caerInputNetUDPInit(caerModuleData moduleData);
+static void caerInputNetUDPRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerInputNetUDPConfig(caerModuleData moduleData);
+static void caerInputNetUDPExit(caerModuleData moduleData);
+static int openUDPSocket(caerModuleData moduleData);
+static bool startInputThread(caerModuleData moduleData);
+static void stopInputThread(caerModuleData moduleData);
+static int inputFromUDPThread(void *ptr);
+static void handleDatagram(caerModuleData moduleData, uint8_t *datagram, size_t datagramLength);
+static void handlePacket(caerModuleData moduleData, const uint8_t *payload, size_t payloadLength);
+static void commitContainer(caerModuleData moduleData);
+static void updateStatistics(caerModuleData moduleData, bool force);
+
+static struct caer_module_functions caerInputNetUDPFunctions = { .moduleInit = &caerInputNetUDPInit, .moduleRun =
+	&caerInputNetUDPRun, .moduleConfig = &caerInputNetUDPConfig, .moduleExit = &caerInputNetUDPExit };
+
+caerEventPacketContainer caerInputNetUDP(uint16_t moduleID) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "NetUDPInput");
+
+	caerEventPacketContainer result = NULL;
+
+	caerModuleSM(&caerInputNetUDPFunctions, moduleData, sizeof(struct in_netUDP_state), 1, &result);
+
+	return (result);
+}
+
+static void caerInputNetUDPConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+	UNUSED_ARGUMENT(changeValue);
+
+	caerModuleData data = userData;
+
+	if (event == ATTRIBUTE_MODIFIED) {
+		if ((changeType == STRING && caerStrEquals(changeKey, "ipAddress"))
+			|| (changeType == SHORT && caerStrEquals(changeKey, "portNumber"))
+			|| (changeType == STRING && caerStrEquals(changeKey, "multicastInterface"))
+			|| (changeType == BOOL && caerStrEquals(changeKey, "streamHeader"))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 0));
+		}
+	}
+}
+
+static bool caerInputNetUDPInit(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "ipAddress", "127.0.0.1"); // Local address or multicast group.
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "portNumber", 8888);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "multicastInterface", "");
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "streamHeader", true);
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "ringBufferSize", 64);
+
+	state->datagram = malloc(CAER_UDP_STREAM_MAX_DATAGRAM);
+	state->fec = calloc(1, sizeof(struct caer_udp_stream_fec));
+	if (state->datagram == NULL || state->fec == NULL) {
+		free(state->datagram);
+		free(state->fec);
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Failed to allocate datagram memory.");
+		return (false);
+	}
+
+	state->dataTransfer = ringBufferInit((size_t) sshsNodeGetShort(moduleData->moduleNode, "ringBufferSize"));
+	if (state->dataTransfer == NULL) {
+		free(state->datagram);
+		free(state->fec);
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Failed to allocate transfer ring-buffer.");
+		return (false);
+	}
+
+	// Set notifier.
+	state->dataNotifyDecrease = &mainloopDataNotifyDecrease;
+	state->dataNotifyIncrease = &mainloopDataNotifyIncrease;
+	state->dataNotifyUserPtr = caerMainloopGetReference();
+
+	if (!startInputThread(moduleData)) {
+		ringBufferFree(state->dataTransfer);
+		free(state->datagram);
+		free(state->fec);
+		return (false);
+	}
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerInputNetUDPConfigListener);
+
+	return (true);
+}
+
+static void caerInputNetUDPRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	UNUSED_ARGUMENT(argsNumber);
+
+	netUDPState state = moduleData->moduleState;
+
+	// Interpret variable arguments (same as above in main function).
+	caerEventPacketContainer *container = va_arg(args, caerEventPacketContainer *);
+
+	*container = ringBufferGet(state->dataTransfer);
+
+	if (*container != NULL) {
+		state->dataNotifyDecrease(state->dataNotifyUserPtr);
+		caerMainloopFreeAfterLoop((void (*)(void *)) &caerEventPacketContainerFree, *container);
+	}
+}
+
+static void caerInputNetUDPConfig(caerModuleData moduleData) {
+	// Get the current value to examine by atomic exchange, since we don't
+	// want there to be any possible store between a load/store pair.
+	uintptr_t configUpdate = atomic_exchange(&moduleData->configUpdate, 0);
+
+	if (configUpdate & (0x01 << 0)) {
+		// Address related changes: restart reception on a new socket.
+		stopInputThread(moduleData);
+		startInputThread(moduleData);
+	}
+}
+
+static void caerInputNetUDPExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerInputNetUDPConfigListener);
+
+	netUDPState state = moduleData->moduleState;
+
+	stopInputThread(moduleData);
+
+	// Empty ring-buffer of any left-over containers.
+	caerEventPacketContainer container;
+	while ((container = ringBufferGet(state->dataTransfer)) != NULL) {
+		state->dataNotifyDecrease(state->dataNotifyUserPtr);
+		caerEventPacketContainerFree(container);
+	}
+
+	ringBufferFree(state->dataTransfer);
+
+	free(state->datagram);
+	free(state->fec);
+}
+
+// Open a UDP socket listening on the configured address. For multicast
+// groups, bind to the port on all addresses and join the group.
+static int openUDPSocket(caerModuleData moduleData) {
+	int udpDescriptor = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (udpDescriptor < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create UDP socket. Error: %d.", errno);
+		return (-1);
+	}
+
+	// Several receivers on the same machine can listen to the same group.
+	if (!socketReuseAddr(udpDescriptor, true)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Could not set UDP socket to reusable.");
+	}
+
+	// Bigger receive buffer, to better absorb bursts.
+	int receiveBufferSize = 4 * 1024 * 1024;
+	setsockopt(udpDescriptor, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(int));
+
+	struct sockaddr_in udpAddress;
+	memset(&udpAddress, 0, sizeof(struct sockaddr_in));
+
+	udpAddress.sin_family = AF_INET;
+	udpAddress.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
+	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
+	inet_aton(ipAddress, &udpAddress.sin_addr); // htonl() is implicit here.
+	free(ipAddress);
+
+	struct in_addr multicastGroup = udpAddress.sin_addr;
+	bool multicast = IN_MULTICAST(ntohl(multicastGroup.s_addr));
+
+	if (multicast) {
+		udpAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+	}
+
+	if (bind(udpDescriptor, (struct sockaddr *) &udpAddress, sizeof(struct sockaddr_in)) < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not bind UDP socket. Error: %d.", errno);
+		close(udpDescriptor);
+		return (-1);
+	}
+
+	if (multicast) {
+		struct ip_mreq membership;
+		membership.imr_multiaddr = multicastGroup;
+		membership.imr_interface.s_addr = htonl(INADDR_ANY);
+
+		char *interfaceAddress = sshsNodeGetString(moduleData->moduleNode, "multicastInterface");
+
+		if (!caerStrEquals(interfaceAddress, "") && inet_aton(interfaceAddress, &membership.imr_interface) == 0) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Invalid multicast interface '%s', using default.", interfaceAddress);
+			membership.imr_interface.s_addr = htonl(INADDR_ANY);
+		}
+
+		free(interfaceAddress);
+
+		if (setsockopt(udpDescriptor, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(struct ip_mreq)) != 0) {
+			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+				"Could not join multicast group %s. Error: %d.", inet_ntoa(multicastGroup), errno);
+			close(udpDescriptor);
+			return (-1);
+		}
+	}
+
+	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "UDP socket listening on %s %s:%" PRIu16 ".",
+		(multicast) ? ("multicast group") : ("address"), inet_ntoa(multicastGroup), ntohs(udpAddress.sin_port));
+
+	return (udpDescriptor);
+}
+
+static bool startInputThread(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	state->netUDPDescriptor = openUDPSocket(moduleData);
+	if (state->netUDPDescriptor < 0) {
+		return (false);
+	}
+
+	state->streamHeader = sshsNodeGetBool(moduleData->moduleNode, "streamHeader");
+
+	// Fresh statistics for the new stream.
+	memset(&state->stats, 0, sizeof(struct caer_udp_stream_stats));
+	state->fec->active = false;
+	state->invalidDatagrams = 0;
+	state->statisticsLastUpdate = 0;
+
+	atomic_store(&state->running, true);
+
+	if ((errno = thrd_create(&state->inputReadThread, &inputFromUDPThread, moduleData)) != thrd_success) {
+		atomic_store(&state->running, false);
+		close(state->netUDPDescriptor);
+		state->netUDPDescriptor = -1;
+
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Failed to start input thread. Error: %d.",
+		errno);
+		return (false);
+	}
+
+	return (true);
+}
+
+static void stopInputThread(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	if (!atomic_load(&state->running)) {
+		return;
+	}
+
+	atomic_store(&state->running, false);
+
+	if ((errno = thrd_join(state->inputReadThread, NULL)) != thrd_success) {
+		// This should never happen!
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Failed to join input thread. Error: %d.",
+		errno);
+	}
+
+	close(state->netUDPDescriptor);
+	state->netUDPDescriptor = -1;
+}
+
+static int inputFromUDPThread(void *ptr) {
+	caerModuleData moduleData = ptr;
+	netUDPState state = moduleData->moduleState;
+
+	struct pollfd pollDescriptor = { .fd = state->netUDPDescriptor, .events = POLLIN, .revents = 0 };
+
+	while (atomic_load_explicit(&state->running, memory_order_relaxed)) {
+		int pollResult = poll(&pollDescriptor, 1, UDP_INPUT_POLL_TIMEOUT);
+
+		if (pollResult <= 0) {
+			// Nothing new arrived for a while, don't keep what we have back.
+			commitContainer(moduleData);
+			updateStatistics(moduleData, false);
+			continue;
+		}
+
+		ssize_t result = recv(state->netUDPDescriptor, state->datagram, CAER_UDP_STREAM_MAX_DATAGRAM, 0);
+		if (result <= 0) {
+			continue;
+		}
+
+		handleDatagram(moduleData, state->datagram, (size_t) result);
+
+		updateStatistics(moduleData, false);
+	}
+
+	commitContainer(moduleData);
+	updateStatistics(moduleData, true);
+
+	return (thrd_success);
+}
+
+static void handleDatagram(caerModuleData moduleData, uint8_t *datagram, size_t datagramLength) {
+	netUDPState state = moduleData->moduleState;
+
+	if (!state->streamHeader) {
+		handlePacket(moduleData, datagram, datagramLength);
+		return;
+	}
+
+	caerUDPStreamHeader streamHeader = (caerUDPStreamHeader) datagram;
+	if (!caerUDPStreamHeaderParse(streamHeader, datagramLength)) {
+		state->invalidDatagrams++;
+		return;
+	}
+
+	uint8_t *payload = datagram + CAER_UDP_STREAM_HEADER_SIZE;
+	size_t payloadLength = datagramLength - CAER_UDP_STREAM_HEADER_SIZE;
+
+	if (streamHeader->flags & CAER_UDP_STREAM_FLAG_PARITY) {
+		state->stats.parityReceived++;
+
+		uint16_t recoveredLength = 0;
+		uint32_t recoveredSequenceNumber = 0;
+
+		uint8_t *recovered = caerUDPStreamFECRecover(state->fec, streamHeader, payload, payloadLength,
+			&recoveredLength, &recoveredSequenceNumber);
+
+		if (recovered != NULL) {
+			caerUDPStreamStatsRecovered(&state->stats, recoveredSequenceNumber);
+			handlePacket(moduleData, recovered, recoveredLength);
+		}
+
+		return;
+	}
+
+	struct timespec currentTime;
+	portable_clock_gettime_realtime(&currentTime);
+
+	caerUDPStreamStatsUpdate(&state->stats, streamHeader->sequenceNumber);
+	caerUDPStreamStatsLatency(&state->stats, streamHeader->sourceTimestamp,
+		(uint64_t) currentTime.tv_sec * 1000000 + (uint64_t) currentTime.tv_nsec / 1000);
+
+	caerUDPStreamFECAddData(state->fec, streamHeader, payload);
+
+	handlePacket(moduleData, payload, payloadLength);
+}
+
+static void handlePacket(caerModuleData moduleData, const uint8_t *payload, size_t payloadLength) {
+	netUDPState state = moduleData->moduleState;
+
+	// Must be a complete event packet.
+	if (payloadLength < CAER_EVENT_PACKET_HEADER_SIZE) {
+		state->invalidDatagrams++;
+		return;
+	}
+
+	caerEventPacketHeaderConst header = (caerEventPacketHeaderConst) payload;
+
+	int16_t eventType = caerEventPacketHeaderGetEventType(header);
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(header);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(header);
+
+	if (eventType < 0 || eventSize <= 0 || eventNumber < 0
+		|| (CAER_EVENT_PACKET_HEADER_SIZE + ((size_t) eventSize * (size_t) eventNumber)) != payloadLength) {
+		state->invalidDatagrams++;
+		return;
+	}
+
+	caerEventPacketHeader packet = malloc(payloadLength);
+	if (packet == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for event packet.");
+		return;
+	}
+
+	memcpy(packet, payload, payloadLength);
+
+	caerEventPacketHeaderSetEventCapacity(packet, eventNumber);
+	caerEventPacketHeaderSetEventSource(packet, I16T(moduleData->moduleID));
+
+	// Containers hold one packet per type, so commit the current container
+	// once a type repeats, like the file input does.
+	if (state->currentContainer != NULL && eventType < state->currentContainerSize
+		&& caerEventPacketContainerGetEventPacket(state->currentContainer, eventType) != NULL) {
+		commitContainer(moduleData);
+	}
+
+	if (state->currentContainer == NULL || eventType >= state->currentContainerSize) {
+		int16_t newContainerSize = (state->currentContainerSize > (eventType + 1)) ?
+			(state->currentContainerSize) : (I16T(eventType + 1));
+
+		caerEventPacketContainer newContainer = caerEventPacketContainerAllocate(newContainerSize);
+		if (newContainer == NULL) {
+			free(packet);
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate event packet container.");
+			return;
+		}
+
+		// Move over already received packets, if any.
+		if (state->currentContainer != NULL) {
+			for (int16_t i = 0; i < state->currentContainerSize; i++) {
+				caerEventPacketContainerSetEventPacket(newContainer, i,
+					caerEventPacketContainerGetEventPacket(state->currentContainer, i));
+			}
+
+			free(state->currentContainer);
+		}
+
+		state->currentContainer = newContainer;
+		state->currentContainerSize = newContainerSize;
+	}
+
+	caerEventPacketContainerSetEventPacket(state->currentContainer, eventType, packet);
+}
+
+static void commitContainer(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	if (state->currentContainer == NULL) {
+		return;
+	}
+
+	// Never block the reception of datagrams: if the mainloop doesn't keep
+	// up, drop data here, as the network would do anyway.
+	if (!ringBufferPut(state->dataTransfer, state->currentContainer)) {
+		caerEventPacketContainerFree(state->currentContainer);
+
+		caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString,
+			"Failed to move event packet container to ring-buffer (full).");
+	}
+	else {
+		state->dataNotifyIncrease(state->dataNotifyUserPtr);
+	}
+
+	state->currentContainer = NULL;
+}
+
+// Publish the datagram statistics to the configuration, once per interval.
+static void updateStatistics(caerModuleData moduleData, bool force) {
+	netUDPState state = moduleData->moduleState;
+
+	if (!state->streamHeader) {
+		return;
+	}
+
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	if (!force && (currentTime.tv_sec - state->statisticsLastUpdate) < UDP_INPUT_STATISTICS_INTERVAL) {
+		return;
+	}
+
+	state->statisticsLastUpdate = currentTime.tv_sec;
+
+	sshsNodePutLong(moduleData->moduleNode, "datagramsReceived", I64T(state->stats.received));
+	sshsNodePutLong(moduleData->moduleNode, "datagramsLost", I64T(state->stats.lost));
+	sshsNodePutLong(moduleData->moduleNode, "datagramsReordered", I64T(state->stats.reordered));
+	sshsNodePutLong(moduleData->moduleNode, "datagramsRecovered", I64T(state->stats.recovered));
+	sshsNodePutLong(moduleData->moduleNode, "datagramsInvalid", I64T(state->invalidDatagrams));
+	sshsNodePutLong(moduleData->moduleNode, "averageLatency",
+		(state->stats.latencyCount == 0) ? (0) : (I64T(state->stats.latencySum / state->stats.latencyCount)));
+}
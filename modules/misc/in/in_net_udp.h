@@ -0,0 +1,18 @@
+/*
+ * in_net_udp.h
+ *
+ *  Receives event packets sent by the UDP output (NetUDPOutput), from a
+ *  unicast address or a multicast group. With stream headers enabled, it
+ *  also tracks loss, reordering and latency, and rebuilds lost datagrams
+ *  from FEC parity.
+ */
+
+#ifndef IN_NET_UDP_H_
+#define IN_NET_UDP_H_
+
+#include "in_common.h"
+#include <libcaer/events/packetContainer.h>
+
+caerEventPacketContainer caerInputNetUDP(uint16_t moduleID);
+
+#endif /* IN_NET_UDP_H_ */
@@ -1,20 +1,131 @@
 #include "file.h"
 #include "base/mainloop.h"
 #include "base/module.h"
+#include "modules/misc/file_index.h"
+#include "ext/caercolumnar/caercolumnar.h"
+#include "ext/portable_time.h"
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <pwd.h>
 #include <time.h>
+#include <libcaer/events/special.h>
 
 #define USE_OLD_AEDAT_FORMAT_HACK false
 
+// Files are written under this suffix, and only renamed once complete.
+#define PARTIAL_FILE_SUFFIX ".partial"
+#define NEXT_FILE_TEMPLATE ".caer_next-XXXXXX"
+
+// Window over which the event rate is measured for the rate trigger, in ms.
+#define TRIGGER_RATE_WINDOW 100
+
+// Upper bound on the events in one block of the columnar format, so a block
+// can't grow without limits when the event rate is very high.
+#define COLUMNAR_BLOCK_MAX_EVENTS (256 * 1024)
+
+// Upper bound on the packets held back for interleaving sources. Past it,
+// the oldest are written out, even if that could break the order.
+#define INTERLEAVE_MAX_PACKETS 4096
+
+// Copy of a packet waiting in the pre-trigger buffer, with its arrival time.
+struct file_trigger_packet {
+	caerEventPacketHeader packet;
+	struct timespec arrivalTime;
+	size_t size;
+};
+
+// Copy of a packet held back for interleaving, with its first timestamp.
+struct file_interleave_packet {
+	caerEventPacketHeader packet;
+	int64_t timestamp;
+};
+
+// Source seen by the interleaving, with the newest timestamp it delivered.
+struct file_source {
+	int16_t sourceID;
+	int64_t lastTimestamp;
+};
+
+struct file_next {
+	char *directory;
+	int64_t preallocateSize;
+	int fileDescriptor;
+	char *tempPath;
+};
+
 struct file_state {
 	int fileDescriptor;
 	bool validOnly;
 	bool excludeHeader;
 	size_t maxBytesPerPacket;
+	// Packets followed by a CRC-32C trailer, declared in the file header.
+	bool checksum;
 	struct iovec *sgioMemory;
+	caerValidCompactBuffer compactBuffer;
+	caerDeltaBuffer deltaBuffer;
+	// Only set when writing the columnar format, which replaces the AEDAT
+	// file structure completely.
+	caerColumnarWriter columnarWriter;
+	caerOutputCommonRateLimiter rateLimiter;
+	struct caer_output_old_aer oldAER;
+	// Currently open file, written to under its '.partial' name.
+	char *filePath;
+	uint64_t fileBytes;
+	struct timespec fileOpenTime;
+	size_t filePart;
+	// File rotation settings.
+	int64_t rotateMaxBytes;
+	int32_t rotateMaxInterval;
+	// Packet index, appended to the file when finalizing it. Either every
+	// packet is indexed, or only the first of each indexInterval µs.
+	bool writeIndex;
+	int64_t indexInterval;
+	int64_t indexLastTimestamp;
+	struct caer_file_index_entry *index;
+	size_t indexLength;
+	size_t indexCapacity;
+	// Next file, pre-opened and pre-allocated in the background.
+	struct file_next nextFile;
+	thrd_t nextFileThread;
+	bool nextFileThreadActive;
+	// Triggered recording: packets are only kept for a while in the pre-trigger
+	// buffer (a circular buffer, oldest first), and written out once a trigger
+	// fires, followed by everything up to when the scene is idle again.
+	bool triggeredRecording;
+	bool triggerActive;
+	double preTriggerTime; // In s.
+	uint64_t preTriggerMaxSize; // In bytes.
+	double postTriggerTime; // In s.
+	int32_t triggerEventRate; // In events/s, 0 = disabled.
+	bool triggerExternalInput;
+	bool triggerManual;
+	struct file_trigger_packet *preTriggerBuffer;
+	size_t preTriggerBufferHead;
+	size_t preTriggerBufferLength;
+	size_t preTriggerBufferCapacity;
+	uint64_t preTriggerBufferBytes;
+	struct timespec lastTriggerTime;
+	uint64_t rateWindowEvents;
+	struct timespec rateWindowStart;
+	uint64_t triggerCount;
+	// Multi-source interleaving: packets from all sources are held back and
+	// written ordered by timestamp, once every source has moved past them,
+	// or they are more than skewWindow µs behind the newest data.
+	bool interleaveSources;
+	int64_t skewWindow;
+	struct file_interleave_packet *interleaveBuffer; // Sorted by timestamp.
+	size_t interleaveBufferLength;
+	size_t interleaveBufferCapacity;
+	struct file_source *sources;
+	size_t sourcesLength;
+	int64_t interleaveFirstTimestamp;
+	int64_t interleaveMaxTimestamp;
+	int64_t interleaveLastWritten;
+	uint64_t interleaveLatePackets;
+	// The header lists the sources, so it's only written with the first
+	// packet, once they are known.
+	bool headerPending;
 };
 
 typedef struct file_state *fileState;
@@ -37,7 +148,37 @@ void caerOutputFile(uint16_t moduleID, size_t outputTypesNumber, ...) {
 }
 
 static char *getUserHomeDirectory(const char *subSystemString);
-static char *getFullFilePath(const char *subSystemString, const char *directory, const char *prefix);
+static char *getFullFilePath(const char *subSystemString, const char *directory, const char *prefix, size_t part,
+	const char *extension);
+static size_t writeFileHeader(int fileDescriptor, bool compressed, bool checksum, const struct file_source *sources,
+	size_t sourcesLength);
+static size_t writeSourceInfoHeader(int fileDescriptor, int16_t sourceID);
+static void writePendingHeader(caerModuleData moduleData);
+static caerColumnarWriter updateColumnarFormat(caerModuleData moduleData);
+static bool openOutputFile(caerModuleData moduleData);
+static void finalizeOutputFile(caerModuleData moduleData);
+static bool fileRotationNeeded(fileState state);
+static void addIndexEntry(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly,
+	uint64_t fileOffset);
+static void writeIndexFooter(caerModuleData moduleData);
+static void updateWriteIndex(caerModuleData moduleData);
+static int prepareNextFileThread(void *nextFileArg);
+static void startNextFilePreparation(caerModuleData moduleData);
+static int takeNextFile(fileState state, const char *partialPath);
+static void discardNextFile(fileState state);
+static void dispatchPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly,
+	const struct timespec *now);
+static void writePacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly);
+static void interleaveBufferPut(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly);
+static void interleaveBufferRelease(caerModuleData moduleData, bool all, const struct timespec *now);
+static void interleaveBufferClear(fileState state);
+static void updateTriggerSettings(caerModuleData moduleData);
+static bool triggerCheck(caerModuleData moduleData, size_t argsNumber, va_list args, const struct timespec *now);
+static void preTriggerBufferPut(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly,
+	const struct timespec *now);
+static void preTriggerBufferEvict(fileState state, const struct timespec *now);
+static void preTriggerBufferFlush(caerModuleData moduleData);
+static void preTriggerBufferClear(fileState state);
 static void caerOutputFileConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 
@@ -82,7 +223,8 @@ static char *getUserHomeDirectory(const char *subSystemString) {
 	return (retVar);
 }
 
-static char *getFullFilePath(const char *subSystemString, const char *directory, const char *prefix) {
+static char *getFullFilePath(const char *subSystemString, const char *directory, const char *prefix, size_t part,
+	const char *extension) {
 	// First get time suffix string.
 	time_t currentTimeEpoch = time(NULL);
 
@@ -106,10 +248,18 @@ static char *getFullFilePath(const char *subSystemString, const char *directory,
 		prefix = DEFAULT_PREFIX;
 	}
 
-	// Assemble together: directory/prefix-time.aedat
-	size_t filePathLength = strlen(directory) + strlen(prefix) + currentTimeStringLength + 9;
-	// 1 for the directory/prefix separating slash, 1 for prefix-time separating
-	// dash, 6 for file extension, 1 for terminating NUL byte = +9.
+	// Assemble together: directory/prefix-time.extension
+	// When rotating files, several can be started within the same second,
+	// so a part number is added: directory/prefix-time_part.extension
+	size_t filePathLength;
+	if (part == 0) {
+		filePathLength = (size_t) snprintf(NULL, 0, "%s/%s-%s.%s", directory, prefix, currentTimeString, extension)
+			+ 1;
+	}
+	else {
+		filePathLength = (size_t) snprintf(NULL, 0, "%s/%s-%s_%04zu.%s", directory, prefix, currentTimeString, part,
+			extension) + 1;
+	}
 
 	char *filePath = malloc(filePathLength);
 	if (filePath == NULL) {
@@ -117,11 +267,545 @@ static char *getFullFilePath(const char *subSystemString, const char *directory,
 		return (NULL);
 	}
 
-	snprintf(filePath, filePathLength, "%s/%s-%s.aedat", directory, prefix, currentTimeString);
+	if (part == 0) {
+		snprintf(filePath, filePathLength, "%s/%s-%s.%s", directory, prefix, currentTimeString, extension);
+	}
+	else {
+		snprintf(filePath, filePathLength, "%s/%s-%s_%04zu.%s", directory, prefix, currentTimeString, part,
+			extension);
+	}
 
 	return (filePath);
 }
 
+static size_t writeFileHeader(int fileDescriptor, bool compressed, bool checksum, const struct file_source *sources,
+	size_t sourcesLength) {
+	if (USE_OLD_AEDAT_FORMAT_HACK) {
+		// Write AEDAT 2.0 header.
+		write(fileDescriptor, "#!AER-DAT2.0\r\n", 14);
+
+		return (14);
+	}
+
+	size_t headerBytes = 0;
+
+	if (compressed) {
+		// Write AEDAT 3.1 header (CAERDELTA format).
+		write(fileDescriptor, "#!AER-DAT3.1\r\n", 14);
+		write(fileDescriptor, "#Format: " CAERDELTA_FORMAT_NAME "\r\n", 20);
+
+		headerBytes += 34;
+	}
+	else {
+		// Write AEDAT 3.1 header (RAW format).
+		write(fileDescriptor, "#!AER-DAT3.1\r\n", 14);
+		write(fileDescriptor, "#Format: RAW\r\n", 14);
+
+		headerBytes += 28;
+	}
+
+	if (checksum) {
+		write(fileDescriptor, "#Checksum: CRC32C\r\n", 19);
+
+		headerBytes += 19;
+	}
+
+	// Describe each source, when recording several into one file.
+	for (size_t i = 0; i < sourcesLength; i++) {
+		headerBytes += writeSourceInfoHeader(fileDescriptor, sources[i].sourceID);
+	}
+
+	write(fileDescriptor, "#!END-HEADER\r\n", 14);
+
+	return (headerBytes + 14);
+}
+
+// Write the source's 'sourceInfo/' node as header lines of the form
+// '#SourceInfo <sourceID>: <type> <key> <value>', so readers can restore it.
+static size_t writeSourceInfoHeader(int fileDescriptor, int16_t sourceID) {
+	sshsNode sourceInfoNode = caerMainloopGetSourceInfo(U16T(sourceID));
+
+	size_t numKeys;
+	const char **keys = sshsNodeGetAttributeKeys(sourceInfoNode, &numKeys);
+
+	size_t headerBytes = 0;
+
+	for (size_t i = 0; i < numKeys; i++) {
+		size_t numTypes;
+		enum sshs_node_attr_value_type *types = sshsNodeGetAttributeTypes(sourceInfoNode, keys[i], &numTypes);
+
+		for (size_t t = 0; t < numTypes; t++) {
+			union sshs_node_attr_value value = sshsNodeGetAttribute(sourceInfoNode, keys[i], types[t]);
+			char *valueString = sshsHelperValueToStringConverter(types[t], value);
+
+			if (types[t] == STRING) {
+				free(value.string);
+			}
+
+			if (valueString == NULL) {
+				continue;
+			}
+
+			char line[1024];
+			int lineLength = snprintf(line, sizeof(line), "#SourceInfo %" PRIi16 ": %s %s %s\r\n", sourceID,
+				sshsHelperTypeToStringConverter(types[t]), keys[i], valueString);
+
+			free(valueString);
+
+			// Values too long for one header line are left out.
+			if (lineLength > 0 && (size_t) lineLength < sizeof(line)) {
+				write(fileDescriptor, line, (size_t) lineLength);
+				headerBytes += (size_t) lineLength;
+			}
+		}
+
+		free(types);
+	}
+
+	free(keys);
+
+	return (headerBytes);
+}
+
+static void writePendingHeader(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	state->fileBytes += writeFileHeader(state->fileDescriptor, (state->deltaBuffer != NULL), state->checksum,
+		state->sources, state->sourcesLength);
+	state->headerPending = false;
+}
+
+// Returns the writer for the next file if it is to be written in the
+// columnar format: the current one, or a new one. NULL if the AEDAT format
+// is to be used, also if the writer can't be allocated. The current file
+// keeps its own format until finalized, so nothing is changed here.
+static caerColumnarWriter updateColumnarFormat(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	char *format = sshsNodeGetString(moduleData->moduleNode, "format");
+	bool columnar = caerStrEquals(format, CAER_COLUMNAR_FORMAT_NAME);
+	free(format);
+
+	if (!columnar) {
+		return (NULL);
+	}
+
+	if (state->columnarWriter != NULL) {
+		return (state->columnarWriter);
+	}
+
+	caerColumnarWriter columnarWriter = caerColumnarWriterInit(
+		I64T(sshsNodeGetInt(moduleData->moduleNode, "columnarBlockTime")) * 1000, COLUMNAR_BLOCK_MAX_EVENTS);
+	if (columnarWriter == NULL) {
+		caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+			"Impossible to allocate memory for columnar format, using RAW format.");
+		return (NULL);
+	}
+
+	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString,
+		"Using " CAER_COLUMNAR_FORMAT_NAME " columnar format, only polarity events are recorded.");
+
+	return (columnarWriter);
+}
+
+static bool openOutputFile(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	bool rotationEnabled = (state->rotateMaxBytes > 0 || state->rotateMaxInterval > 0);
+
+	// The format can only change together with the file, as it's declared
+	// in the file header, and decides the file extension.
+	caerColumnarWriter columnarWriter = updateColumnarFormat(moduleData);
+	bool columnar = (columnarWriter != NULL);
+
+	// Generate current file name and open it.
+	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+	char *prefix = sshsNodeGetString(moduleData->moduleNode, "prefix");
+	char *filePath = getFullFilePath(moduleData->moduleSubSystemString, directory, prefix,
+		(rotationEnabled) ? (state->filePart + 1) : (0), (columnar) ? (CAER_COLUMNAR_FILE_EXTENSION) : ("aedat"));
+	free(directory);
+	free(prefix);
+
+	if (filePath == NULL) {
+		if (columnarWriter != state->columnarWriter) {
+			caerColumnarWriterFree(columnarWriter);
+		}
+
+		return (false);
+	}
+
+	size_t partialPathLength = strlen(filePath) + strlen(PARTIAL_FILE_SUFFIX) + 1;
+	char partialPath[partialPathLength];
+	snprintf(partialPath, partialPathLength, "%s%s", filePath, PARTIAL_FILE_SUFFIX);
+
+	// Use the file prepared in the background, if any, else open one now.
+	int newFileDescriptor = takeNextFile(state, partialPath);
+
+	if (newFileDescriptor < 0) {
+		newFileDescriptor = open(partialPath, O_WRONLY | O_CREAT | O_TRUNC, S_IWUSR | S_IRUSR | S_IRGRP);
+	}
+
+	if (newFileDescriptor < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not create or open output file '%s' for writing. Error: %d.", partialPath, errno);
+		free(filePath);
+
+		if (columnarWriter != state->columnarWriter) {
+			caerColumnarWriterFree(columnarWriter);
+		}
+
+		return (false);
+	}
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Opened output file '%s' successfully for writing.",
+		partialPath);
+
+	// New fd ready and opened, finalize old and set new. This always happens
+	// in between two writes, so nothing is lost at the file boundary.
+	if (state->fileDescriptor >= 0) {
+		finalizeOutputFile(moduleData);
+	}
+
+	// The old file's last columnar block was written out when finalizing it.
+	if (columnarWriter != state->columnarWriter) {
+		caerColumnarWriterFree(state->columnarWriter);
+		state->columnarWriter = columnarWriter;
+	}
+
+	size_t headerBytes;
+
+	// Only now, the old file was finalized with the compression and
+	// checksum settings its header declares.
+	if (columnar) {
+		caerDeltaBufferFree(state->deltaBuffer);
+		state->deltaBuffer = NULL;
+
+		headerBytes = caerColumnarWriteFileHeader(newFileDescriptor);
+	}
+	else {
+		caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
+		state->checksum = sshsNodeGetBool(moduleData->moduleNode, "checksum") && !USE_OLD_AEDAT_FORMAT_HACK;
+
+		if (state->interleaveSources) {
+			// Written with the first packet, once all sources are known.
+			headerBytes = 0;
+		}
+		else {
+			headerBytes = writeFileHeader(newFileDescriptor, (state->deltaBuffer != NULL), state->checksum, NULL, 0);
+		}
+	}
+
+	state->fileDescriptor = newFileDescriptor;
+	state->filePath = filePath;
+	state->fileBytes = headerBytes;
+	state->headerPending = (!columnar && state->interleaveSources);
+	state->indexLength = 0;
+	portable_clock_gettime_monotonic(&state->fileOpenTime);
+
+	if (rotationEnabled) {
+		state->filePart++;
+
+		// Get the next file ready while this one is filling up.
+		startNextFilePreparation(moduleData);
+	}
+
+	return (true);
+}
+
+static void finalizeOutputFile(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	if (state->columnarWriter != NULL) {
+		// Write out the last, incomplete block. Columnar files have no packet
+		// index, the block headers serve that purpose already.
+		uint64_t blockBytes = caerColumnarWriterBytesWritten(state->columnarWriter);
+
+		if (!caerColumnarWriterFlush(state->columnarWriter, state->fileDescriptor)) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Could not write last columnar block to output file. Error: %d.", errno);
+		}
+
+		state->fileBytes += caerColumnarWriterBytesWritten(state->columnarWriter) - blockBytes;
+	}
+	else {
+		// Nothing was written, still make it a valid file.
+		if (state->headerPending) {
+			writePendingHeader(moduleData);
+		}
+
+		if (state->writeIndex && !USE_OLD_AEDAT_FORMAT_HACK) {
+			writeIndexFooter(moduleData);
+		}
+	}
+
+	// Give back any pre-allocated space that wasn't used.
+	if (ftruncate(state->fileDescriptor, (off_t) state->fileBytes) != 0) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Could not truncate output file to its real size. Error: %d.", errno);
+	}
+
+	close(state->fileDescriptor);
+	state->fileDescriptor = -1;
+
+	// Atomically move the complete file to its final name.
+	size_t partialPathLength = strlen(state->filePath) + strlen(PARTIAL_FILE_SUFFIX) + 1;
+	char partialPath[partialPathLength];
+	snprintf(partialPath, partialPathLength, "%s%s", state->filePath, PARTIAL_FILE_SUFFIX);
+
+	if (rename(partialPath, state->filePath) != 0) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Could not rename output file '%s' to its final name. Error: %d.", partialPath, errno);
+	}
+	else {
+		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Finalized output file '%s'.", state->filePath);
+	}
+
+	free(state->filePath);
+	state->filePath = NULL;
+}
+
+static bool fileRotationNeeded(fileState state) {
+	if (state->rotateMaxBytes > 0 && state->fileBytes >= (uint64_t) state->rotateMaxBytes) {
+		return (true);
+	}
+
+	if (state->rotateMaxInterval > 0) {
+		struct timespec currentTime;
+		portable_clock_gettime_monotonic(&currentTime);
+
+		if ((currentTime.tv_sec - state->fileOpenTime.tv_sec) >= state->rotateMaxInterval) {
+			return (true);
+		}
+	}
+
+	return (false);
+}
+
+static void addIndexEntry(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly,
+	uint64_t fileOffset) {
+	fileState state = moduleData->moduleState;
+
+	// The first event written decides where the packet starts in time.
+	int32_t firstEvent = 0;
+
+	if (validOnly) {
+		while (firstEvent < caerEventPacketHeaderGetEventNumber(packetHeader)
+			&& !caerGenericEventIsValid(caerGenericEventGetEvent(packetHeader, firstEvent))) {
+			firstEvent++;
+		}
+
+		if (firstEvent == caerEventPacketHeaderGetEventNumber(packetHeader)) {
+			return;
+		}
+	}
+
+	int64_t timestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packetHeader, firstEvent),
+		packetHeader);
+
+	// With time buckets, only the first packet of each one is indexed. That's
+	// enough to seek, and keeps the index of long recordings small.
+	if (state->indexInterval > 0 && state->indexLength > 0
+		&& timestamp < (state->indexLastTimestamp + state->indexInterval)) {
+		return;
+	}
+
+	// Grow index memory as needed.
+	if (state->indexLength == state->indexCapacity) {
+		size_t newCapacity = (state->indexCapacity == 0) ? (1024) : (state->indexCapacity * 2);
+
+		struct caer_file_index_entry *newIndex = realloc(state->index,
+			newCapacity * sizeof(struct caer_file_index_entry));
+		if (newIndex == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to allocate memory for packet index, disabling it.");
+			state->writeIndex = false;
+			return;
+		}
+
+		state->index = newIndex;
+		state->indexCapacity = newCapacity;
+	}
+
+	int32_t eventNumber =
+		(validOnly) ?
+			(caerEventPacketHeaderGetEventValid(packetHeader)) : (caerEventPacketHeaderGetEventNumber(packetHeader));
+
+	caerFileIndexEntrySet(&state->index[state->indexLength], caerEventPacketHeaderGetEventType(packetHeader),
+		caerEventPacketHeaderGetEventSource(packetHeader), timestamp, eventNumber, fileOffset);
+
+	state->indexLength++;
+	state->indexLastTimestamp = timestamp;
+}
+
+// The index points at packets by their header, so it is useless (and can't
+// be read back) if the packets are written without one.
+static void updateWriteIndex(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	state->writeIndex = sshsNodeGetBool(moduleData->moduleNode, "writeIndex");
+
+	if (state->writeIndex && state->excludeHeader) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Packet index can't be written together with excludeHeader, disabling it.");
+		state->writeIndex = false;
+	}
+}
+
+static void writeIndexFooter(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	// The index itself is a regular event packet of a reserved type.
+	struct caer_event_packet_header indexHeader;
+	memset(&indexHeader, 0, sizeof(struct caer_event_packet_header));
+
+	caerEventPacketHeaderSetEventType(&indexHeader, CAER_FILE_INDEX_EVENT_TYPE);
+	caerEventPacketHeaderSetEventSource(&indexHeader, I16T(moduleData->moduleID));
+	caerEventPacketHeaderSetEventSize(&indexHeader, sizeof(struct caer_file_index_entry));
+	caerEventPacketHeaderSetEventTSOffset(&indexHeader, offsetof(struct caer_file_index_entry, timestamp));
+	caerEventPacketHeaderSetEventTSOverflow(&indexHeader, 0);
+	caerEventPacketHeaderSetEventCapacity(&indexHeader, I32T(state->indexLength));
+	caerEventPacketHeaderSetEventNumber(&indexHeader, I32T(state->indexLength));
+	caerEventPacketHeaderSetEventValid(&indexHeader, I32T(state->indexLength));
+
+	struct caer_file_index_footer indexFooter;
+	indexFooter.indexOffset = htole64(state->fileBytes);
+	memcpy(indexFooter.magic, CAER_FILE_INDEX_FOOTER_MAGIC, CAER_FILE_INDEX_FOOTER_MAGIC_LENGTH);
+
+	struct iovec indexIO[4];
+	size_t indexIOLength = 0;
+
+	indexIO[indexIOLength].iov_base = &indexHeader;
+	indexIO[indexIOLength++].iov_len = sizeof(struct caer_event_packet_header);
+	indexIO[indexIOLength].iov_base = state->index;
+	indexIO[indexIOLength++].iov_len = state->indexLength * sizeof(struct caer_file_index_entry);
+
+	// Like any other packet, the index is followed by its checksum.
+	uint32_t checksumLE = 0;
+
+	if (state->checksum) {
+		uint32_t checksum = caerCrc32c(0, indexIO[0].iov_base, indexIO[0].iov_len);
+		checksum = caerCrc32c(checksum, indexIO[1].iov_base, indexIO[1].iov_len);
+		checksumLE = htole32(checksum);
+
+		indexIO[indexIOLength].iov_base = &checksumLE;
+		indexIO[indexIOLength++].iov_len = CHECKSUM_TRAILER_SIZE;
+	}
+
+	indexIO[indexIOLength].iov_base = &indexFooter;
+	indexIO[indexIOLength++].iov_len = sizeof(struct caer_file_index_footer);
+
+	ssize_t written = writev(state->fileDescriptor, indexIO, (int) indexIOLength);
+	if (written > 0) {
+		state->fileBytes += (uint64_t) written;
+	}
+
+	state->indexLength = 0;
+}
+
+static int prepareNextFileThread(void *nextFileArg) {
+	struct file_next *nextFile = nextFileArg;
+
+	size_t tempPathLength = strlen(nextFile->directory) + strlen(NEXT_FILE_TEMPLATE) + 2;
+	// 1 for the directory/template separating slash, 1 for terminating NUL byte = +2.
+
+	char *tempPath = malloc(tempPathLength);
+	if (tempPath == NULL) {
+		return (thrd_nomem);
+	}
+
+	snprintf(tempPath, tempPathLength, "%s/%s", nextFile->directory, NEXT_FILE_TEMPLATE);
+
+	int tempFileDescriptor = mkstemp(tempPath);
+	if (tempFileDescriptor < 0) {
+		free(tempPath);
+		return (thrd_error);
+	}
+
+	fchmod(tempFileDescriptor, S_IWUSR | S_IRUSR | S_IRGRP);
+
+	// Reserve the space up-front, so writing never has to wait on block
+	// allocation. Not all file-systems support this, which is fine, the
+	// file is simply not pre-allocated then.
+	if (nextFile->preallocateSize > 0) {
+		posix_fallocate(tempFileDescriptor, 0, (off_t) nextFile->preallocateSize);
+	}
+
+	nextFile->tempPath = tempPath;
+	nextFile->fileDescriptor = tempFileDescriptor;
+
+	return (thrd_success);
+}
+
+static void startNextFilePreparation(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	if (state->nextFileThreadActive || state->nextFile.fileDescriptor >= 0) {
+		// Already in progress or done.
+		return;
+	}
+
+	state->nextFile.directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+	state->nextFile.preallocateSize = state->rotateMaxBytes;
+	state->nextFile.fileDescriptor = -1;
+	state->nextFile.tempPath = NULL;
+
+	if (thrd_create(&state->nextFileThread, &prepareNextFileThread, &state->nextFile) != thrd_success) {
+		// Not fatal, the next file will just be opened when rotating.
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Failed to start thread to prepare next output file.");
+
+		free(state->nextFile.directory);
+		state->nextFile.directory = NULL;
+
+		return;
+	}
+
+	state->nextFileThreadActive = true;
+}
+
+static int takeNextFile(fileState state, const char *partialPath) {
+	if (state->nextFileThreadActive) {
+		thrd_join(state->nextFileThread, NULL);
+		state->nextFileThreadActive = false;
+	}
+
+	int nextFileDescriptor = state->nextFile.fileDescriptor;
+
+	// Move the prepared file to its real name. If that fails, just drop it.
+	if (nextFileDescriptor >= 0 && rename(state->nextFile.tempPath, partialPath) != 0) {
+		close(nextFileDescriptor);
+		unlink(state->nextFile.tempPath);
+
+		nextFileDescriptor = -1;
+	}
+
+	free(state->nextFile.directory);
+	state->nextFile.directory = NULL;
+	free(state->nextFile.tempPath);
+	state->nextFile.tempPath = NULL;
+	state->nextFile.fileDescriptor = -1;
+
+	return (nextFileDescriptor);
+}
+
+static void discardNextFile(fileState state) {
+	if (state->nextFileThreadActive) {
+		thrd_join(state->nextFileThread, NULL);
+		state->nextFileThreadActive = false;
+	}
+
+	if (state->nextFile.fileDescriptor >= 0) {
+		close(state->nextFile.fileDescriptor);
+		unlink(state->nextFile.tempPath);
+	}
+
+	free(state->nextFile.directory);
+	state->nextFile.directory = NULL;
+	free(state->nextFile.tempPath);
+	state->nextFile.tempPath = NULL;
+	state->nextFile.fileDescriptor = -1;
+}
+
 static bool caerOutputFileInit(caerModuleData moduleData) {
 	fileState state = moduleData->moduleState;
 
@@ -132,35 +816,83 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 	free(userHomeDir);
 
 	sshsNodePutStringIfAbsent(moduleData->moduleNode, "prefix", DEFAULT_PREFIX);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "format", "RAW");
+
+	// Follow each packet with a CRC-32C, so corruption on storage is detected
+	// when reading the file back. Changing it starts a new file.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "checksum", false);
+
+	// Time span of one block in the columnar format, in ms of event time.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "columnarBlockTime", 100);
+	caerOutputCommonRateLimitDefaults(moduleData->moduleNode);
 
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "validEventsOnly", false);
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "excludeHeader", false);
 	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxBytesPerPacket", 0);
 
-	// Generate current file name and open it.
-	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
-	char *prefix = sshsNodeGetString(moduleData->moduleNode, "prefix");
-	char *filePath = getFullFilePath(moduleData->moduleSubSystemString, directory, prefix);
-	free(directory);
-	free(prefix);
+	// Start a new file once the current one reaches a certain size (in bytes)
+	// or age (in seconds). Zero disables the respective limit.
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "rotateMaxBytes", 0);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "rotateMaxInterval", 0);
 
-	state->fileDescriptor = open(filePath, O_WRONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP);
-	if (state->fileDescriptor < 0) {
-		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-			"Could not create or open output file '%s' for writing. Error: %d.", filePath, errno);
-		free(filePath);
+	// Append an index of the packets to each file, for fast seeking. Readers
+	// that don't know about it just see an extra packet at the end. With
+	// indexInterval (in ms of event time) set, only one packet per interval
+	// is indexed.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "writeIndex", false);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "indexInterval", 0);
 
+	// Triggered recording: keep the last preTriggerTime ms in memory, and only
+	// record once a trigger fires (event rate above triggerEventRate, an
+	// external input special event, or setting 'trigger'), until postTriggerTime
+	// ms have passed without any trigger.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "triggeredRecording", false);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "preTriggerTime", 5000);
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "preTriggerMaxSize", 64 * 1024 * 1024);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "postTriggerTime", 5000);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "triggerEventRate", 0);
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "triggerExternalInput", true);
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "trigger", false);
+
+	// Record packets from several sources into one file, ordered by time,
+	// holding them back at most skewWindow ms of event time. The file header
+	// then also describes each source.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "interleaveSources", false);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "skewWindow", 100);
+
+	updateTriggerSettings(moduleData);
+
+	state->interleaveSources = sshsNodeGetBool(moduleData->moduleNode, "interleaveSources");
+	state->skewWindow = I64T(sshsNodeGetInt(moduleData->moduleNode, "skewWindow")) * 1000;
+	state->interleaveFirstTimestamp = -1;
+	state->interleaveLastWritten = -1;
+
+	sshsNodePutLong(moduleData->moduleNode, "interleaveLatePackets", 0);
+
+	sshsNodePutBool(moduleData->moduleNode, "triggerActive", false);
+	sshsNodePutLong(moduleData->moduleNode, "triggerCount", 0);
+
+	state->rotateMaxBytes = sshsNodeGetLong(moduleData->moduleNode, "rotateMaxBytes");
+	state->rotateMaxInterval = sshsNodeGetInt(moduleData->moduleNode, "rotateMaxInterval");
+	state->indexInterval = I64T(sshsNodeGetInt(moduleData->moduleNode, "indexInterval")) * 1000;
+
+	state->fileDescriptor = -1;
+	state->nextFile.fileDescriptor = -1;
+
+	if (!openOutputFile(moduleData)) {
+		discardNextFile(state);
+		caerDeltaBufferFree(state->deltaBuffer);
+		state->deltaBuffer = NULL;
+		caerColumnarWriterFree(state->columnarWriter);
+		state->columnarWriter = NULL;
 		return (false);
 	}
 
-	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Opened output file '%s' successfully for writing.",
-		filePath);
-	free(filePath);
-
 	// Set valid events flag, and allocate memory for scatter/gather IO for it.
 	state->validOnly = sshsNodeGetBool(moduleData->moduleNode, "validEventsOnly");
 	state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 	state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+	updateWriteIndex(moduleData);
 
 	if (state->validOnly) {
 		state->sgioMemory = calloc(IOVEC_SIZE, sizeof(struct iovec));
@@ -177,17 +909,17 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 		state->sgioMemory = NULL;
 	}
 
-	if (USE_OLD_AEDAT_FORMAT_HACK) {
-		// Write AEDAT 2.0 header.
-		write(state->fileDescriptor, "#!AER-DAT2.0\r\n", 14);
-	}
-	else {
-		// Write AEDAT 3.1 header (RAW format).
-		write(state->fileDescriptor, "#!AER-DAT3.1\r\n", 14);
-		write(state->fileDescriptor, "#Format: RAW\r\n", 14);
-		write(state->fileDescriptor, "#!END-HEADER\r\n", 14);
+	// Reusable memory for compacting valid events, when they can't be sent
+	// using scatter/gather IO. Without it, temporary memory is used instead.
+	state->compactBuffer = caerValidCompactBufferInit();
+	if (state->compactBuffer == NULL) {
+		caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+			"Impossible to allocate memory for valid event compaction, using temporary memory.");
 	}
 
+	// Rate limits, if any are set.
+	caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputFileConfigListener);
 
@@ -197,6 +929,51 @@ static bool caerOutputFileInit(caerModuleData moduleData) {
 static void caerOutputFileRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
 	fileState state = moduleData->moduleState;
 
+	// Rotate only in between runs, so all packets of one container always
+	// go to the same file, and no packet is ever split or dropped.
+	if (fileRotationNeeded(state)) {
+		openOutputFile(moduleData);
+	}
+
+	struct timespec now;
+
+	if (state->triggeredRecording) {
+		portable_clock_gettime_monotonic(&now);
+
+		// Look for triggers first, so that the packets they arrived with are
+		// already recorded, and not just buffered.
+		va_list triggerArgs;
+		va_copy(triggerArgs, args);
+		bool triggered = triggerCheck(moduleData, argsNumber, triggerArgs, &now);
+		va_end(triggerArgs);
+
+		if (triggered) {
+			state->lastTriggerTime = now;
+
+			if (!state->triggerActive) {
+				state->triggerActive = true;
+				state->triggerCount++;
+
+				caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString,
+					"Recording triggered, writing %zu buffered packets.", state->preTriggerBufferLength);
+
+				// Context from before the trigger goes first.
+				preTriggerBufferFlush(moduleData);
+
+				sshsNodePutBool(moduleData->moduleNode, "triggerActive", true);
+				sshsNodePutLong(moduleData->moduleNode, "triggerCount", (int64_t) state->triggerCount);
+			}
+		}
+		else if (state->triggerActive
+			&& caerOutputCommonElapsed(&state->lastTriggerTime, &now) >= state->postTriggerTime) {
+			state->triggerActive = false;
+
+			caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "Scene idle, recording stopped.");
+
+			sshsNodePutBool(moduleData->moduleNode, "triggerActive", false);
+		}
+	}
+
 	// For each output argument, write it to the file.
 	// Each type has a header first thing, that gives us the length, so we can
 	// cast it to that and use this information to correctly interpret it.
@@ -207,12 +984,447 @@ static void caerOutputFileRun(caerModuleData moduleData, size_t argsNumber, va_l
 		if (packetHeader != NULL) {
 			if ((state->validOnly && caerEventPacketHeaderGetEventValid(packetHeader) > 0)
 				|| (!state->validOnly && caerEventPacketHeaderGetEventNumber(packetHeader) > 0)) {
-				caerOutputCommonSend(moduleData->moduleSubSystemString, packetHeader, state->fileDescriptor,
-					state->sgioMemory, state->validOnly, state->excludeHeader, state->maxBytesPerPacket,
-					USE_OLD_AEDAT_FORMAT_HACK);
+				// Apply rate limits, this may drop or subsample the packet.
+				caerEventPacketHeader sendPacket = packetHeader;
+				bool validOnly = state->validOnly;
+
+				if (state->rateLimiter != NULL) {
+					sendPacket = caerOutputCommonRateLimit(state->rateLimiter, packetHeader, &validOnly);
+					if (sendPacket == NULL) {
+						continue;
+					}
+				}
+
+				if (state->interleaveSources) {
+					interleaveBufferPut(moduleData, sendPacket, validOnly);
+				}
+				else {
+					dispatchPacket(moduleData, sendPacket, validOnly, &now);
+				}
+			}
+		}
+	}
+
+	if (state->interleaveSources) {
+		interleaveBufferRelease(moduleData, false, &now);
+	}
+}
+
+// Record the packet, or keep it for later if waiting on a trigger.
+static void dispatchPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly,
+	const struct timespec *now) {
+	fileState state = moduleData->moduleState;
+
+	if (state->triggeredRecording && !state->triggerActive) {
+		preTriggerBufferPut(moduleData, packetHeader, validOnly, now);
+	}
+	else {
+		writePacket(moduleData, packetHeader, validOnly);
+	}
+}
+
+static void writePacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly) {
+	fileState state = moduleData->moduleState;
+
+	if (state->columnarWriter != NULL) {
+		// Only polarity events have a columnar layout, everything else is not
+		// recorded in this format.
+		if (caerEventPacketHeaderGetEventType(packetHeader) != POLARITY_EVENT) {
+			return;
+		}
+
+		uint64_t blockBytes = caerColumnarWriterBytesWritten(state->columnarWriter);
+
+		if (!caerColumnarWriterAddPolarity(state->columnarWriter, state->fileDescriptor,
+			caerGenericEventGetEvent(packetHeader, 0), caerEventPacketHeaderGetEventSize(packetHeader),
+			caerEventPacketHeaderGetEventNumber(packetHeader), caerEventPacketHeaderGetEventTSOverflow(packetHeader),
+			caerEventPacketHeaderGetEventSource(packetHeader))) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Could not write columnar block to output file. Error: %d.", errno);
+		}
+
+		// Keep track of the file size, for rotation.
+		state->fileBytes += caerColumnarWriterBytesWritten(state->columnarWriter) - blockBytes;
+
+		return;
+	}
+
+	if (state->headerPending) {
+		writePendingHeader(moduleData);
+	}
+
+	uint64_t packetOffset = state->fileBytes;
+
+	// Keep track of the file size, for rotation and the index.
+	if (state->checksum) {
+		state->fileBytes += caerOutputCommonSendChecksum(moduleData->moduleSubSystemString, packetHeader,
+			state->fileDescriptor, state->compactBuffer, state->deltaBuffer, validOnly);
+	}
+	else {
+		state->fileBytes += caerOutputCommonSend(moduleData->moduleSubSystemString, packetHeader,
+			state->fileDescriptor, state->sgioMemory, state->compactBuffer, state->deltaBuffer, validOnly,
+			state->excludeHeader, state->maxBytesPerPacket, (USE_OLD_AEDAT_FORMAT_HACK) ? (&state->oldAER) : (NULL));
+	}
+
+	if (state->writeIndex) {
+		addIndexEntry(moduleData, packetHeader, validOnly, packetOffset);
+	}
+}
+
+static void interleaveBufferPut(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly) {
+	fileState state = moduleData->moduleState;
+
+	// Packets only live until the end of the mainloop run, so keep a copy,
+	// with only the events that would be written.
+	caerEventPacketHeader packetCopy =
+		(validOnly) ? (caerCopyEventPacketOnlyValidEvents(packetHeader)) : (caerCopyEventPacketOnlyEvents(packetHeader));
+	if (packetCopy == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to copy packet for interleaving, dropping it.");
+		return;
+	}
+
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packetCopy);
+	if (eventNumber == 0) {
+		free(packetCopy);
+		return;
+	}
+
+	int64_t firstTimestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packetCopy, 0), packetCopy);
+	int64_t lastTimestamp = caerGenericEventGetTimestamp64(caerGenericEventGetEvent(packetCopy, eventNumber - 1),
+		packetCopy);
+
+	// Track how far each source got.
+	int16_t sourceID = caerEventPacketHeaderGetEventSource(packetCopy);
+	struct file_source *source = NULL;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		if (state->sources[i].sourceID == sourceID) {
+			source = &state->sources[i];
+			break;
+		}
+	}
+
+	if (source == NULL) {
+		struct file_source *newSources = realloc(state->sources,
+			(state->sourcesLength + 1) * sizeof(struct file_source));
+		if (newSources == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to track new source %" PRIi16 ", dropping packet.", sourceID);
+			free(packetCopy);
+			return;
+		}
+
+		state->sources = newSources;
+		source = &state->sources[state->sourcesLength++];
+		source->sourceID = sourceID;
+		source->lastTimestamp = INT64_MIN;
+
+		if (!state->headerPending) {
+			caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+				"Source %" PRIi16 " appeared after the file header was written, it's recorded without description.",
+				sourceID);
+		}
+	}
+
+	if (lastTimestamp > source->lastTimestamp) {
+		source->lastTimestamp = lastTimestamp;
+	}
+
+	if (state->interleaveFirstTimestamp < 0) {
+		state->interleaveFirstTimestamp = firstTimestamp;
+	}
+
+	if (lastTimestamp > state->interleaveMaxTimestamp) {
+		state->interleaveMaxTimestamp = lastTimestamp;
+	}
+
+	if (state->interleaveBufferLength == state->interleaveBufferCapacity) {
+		size_t newCapacity = (state->interleaveBufferCapacity == 0) ? (64) : (state->interleaveBufferCapacity * 2);
+
+		struct file_interleave_packet *newBuffer = realloc(state->interleaveBuffer,
+			newCapacity * sizeof(struct file_interleave_packet));
+		if (newBuffer == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to grow interleaving buffer, dropping packet.");
+			free(packetCopy);
+			return;
+		}
+
+		state->interleaveBuffer = newBuffer;
+		state->interleaveBufferCapacity = newCapacity;
+	}
+
+	// Insertion sort from the back: packets mostly arrive in order already.
+	// Equal timestamps keep their arrival order.
+	size_t position = state->interleaveBufferLength;
+
+	while (position > 0 && state->interleaveBuffer[position - 1].timestamp > firstTimestamp) {
+		state->interleaveBuffer[position] = state->interleaveBuffer[position - 1];
+		position--;
+	}
+
+	state->interleaveBuffer[position].packet = packetCopy;
+	state->interleaveBuffer[position].timestamp = firstTimestamp;
+	state->interleaveBufferLength++;
+}
+
+// Write out all packets no source can precede anymore. Right at the start,
+// everything waits for a full skew window, so all sources get to be seen.
+static void interleaveBufferRelease(caerModuleData moduleData, bool all, const struct timespec *now) {
+	fileState state = moduleData->moduleState;
+
+	if (state->interleaveBufferLength == 0) {
+		return;
+	}
+
+	int64_t watermark = INT64_MAX;
+
+	for (size_t i = 0; i < state->sourcesLength; i++) {
+		if (state->sources[i].lastTimestamp < watermark) {
+			watermark = state->sources[i].lastTimestamp;
+		}
+	}
+
+	// Sources that fall too far behind don't hold back the others.
+	if ((state->interleaveMaxTimestamp - state->skewWindow) > watermark) {
+		watermark = state->interleaveMaxTimestamp - state->skewWindow;
+	}
+
+	if (state->headerPending && (state->interleaveMaxTimestamp - state->interleaveFirstTimestamp) < state->skewWindow) {
+		watermark = INT64_MIN;
+	}
+
+	size_t released = 0;
+
+	while (released < state->interleaveBufferLength
+		&& (all || state->interleaveBuffer[released].timestamp <= watermark
+			|| (state->interleaveBufferLength - released) > INTERLEAVE_MAX_PACKETS)) {
+		struct file_interleave_packet *entry = &state->interleaveBuffer[released];
+
+		if (entry->timestamp < state->interleaveLastWritten) {
+			state->interleaveLatePackets++;
+		}
+		else {
+			state->interleaveLastWritten = entry->timestamp;
+		}
+
+		// Copies only hold the events that are to be written.
+		dispatchPacket(moduleData, entry->packet, false, now);
+		free(entry->packet);
+
+		released++;
+	}
+
+	if (released > 0) {
+		memmove(state->interleaveBuffer, state->interleaveBuffer + released,
+			(state->interleaveBufferLength - released) * sizeof(struct file_interleave_packet));
+		state->interleaveBufferLength -= released;
+
+		sshsNodePutLong(moduleData->moduleNode, "interleaveLatePackets", (int64_t) state->interleaveLatePackets);
+	}
+}
+
+static void interleaveBufferClear(fileState state) {
+	for (size_t i = 0; i < state->interleaveBufferLength; i++) {
+		free(state->interleaveBuffer[i].packet);
+	}
+
+	free(state->interleaveBuffer);
+	state->interleaveBuffer = NULL;
+	state->interleaveBufferLength = 0;
+	state->interleaveBufferCapacity = 0;
+
+	free(state->sources);
+	state->sources = NULL;
+	state->sourcesLength = 0;
+}
+
+static void updateTriggerSettings(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	bool triggeredRecording = sshsNodeGetBool(moduleData->moduleNode, "triggeredRecording");
+
+	if (state->triggeredRecording && !triggeredRecording) {
+		// Back to continuous recording. What's buffered is from before now,
+		// so it can still go out in order.
+		preTriggerBufferFlush(moduleData);
+	}
+	else if (!state->triggeredRecording && triggeredRecording) {
+		state->triggerActive = false;
+		state->rateWindowEvents = 0;
+		portable_clock_gettime_monotonic(&state->rateWindowStart);
+	}
+
+	state->triggeredRecording = triggeredRecording;
+
+	int32_t preTriggerTime = sshsNodeGetInt(moduleData->moduleNode, "preTriggerTime");
+	state->preTriggerTime = (double) preTriggerTime / 1000;
+	int64_t preTriggerMaxSize = sshsNodeGetLong(moduleData->moduleNode, "preTriggerMaxSize");
+	state->preTriggerMaxSize = (preTriggerMaxSize > 0) ? ((uint64_t) preTriggerMaxSize) : (0);
+	int32_t postTriggerTime = sshsNodeGetInt(moduleData->moduleNode, "postTriggerTime");
+	state->postTriggerTime = (double) postTriggerTime / 1000;
+	state->triggerEventRate = sshsNodeGetInt(moduleData->moduleNode, "triggerEventRate");
+	state->triggerExternalInput = sshsNodeGetBool(moduleData->moduleNode, "triggerExternalInput");
+}
+
+// Check all trigger sources, with the packets of the current run.
+static bool triggerCheck(caerModuleData moduleData, size_t argsNumber, va_list args, const struct timespec *now) {
+	fileState state = moduleData->moduleState;
+
+	bool triggered = false;
+
+	// Manual trigger, from the 'trigger' setting.
+	if (state->triggerManual) {
+		state->triggerManual = false;
+		triggered = true;
+	}
+
+	for (size_t i = 0; i < argsNumber; i++) {
+		caerEventPacketHeader packetHeader = va_arg(args, caerEventPacketHeader);
+
+		if (packetHeader == NULL) {
+			continue;
+		}
+
+		if (caerEventPacketHeaderGetEventType(packetHeader) == SPECIAL_EVENT) {
+			if (!state->triggerExternalInput) {
+				continue;
 			}
+
+			// External input signal, from a device's sync/trigger connector.
+			CAER_SPECIAL_ITERATOR_VALID_START((caerSpecialEventPacket) packetHeader)
+				uint8_t specialType = caerSpecialEventGetType(caerSpecialIteratorElement);
+
+				if (specialType == EXTERNAL_INPUT_RISING_EDGE || specialType == EXTERNAL_INPUT_PULSE) {
+					triggered = true;
+				}
+			CAER_SPECIAL_ITERATOR_VALID_END
+		}
+		else {
+			state->rateWindowEvents += (uint64_t) caerEventPacketHeaderGetEventValid(packetHeader);
+		}
+	}
+
+	// Event rate, measured over a short window.
+	double rateWindow = caerOutputCommonElapsed(&state->rateWindowStart, now);
+
+	if ((rateWindow * 1000) >= TRIGGER_RATE_WINDOW) {
+		if (state->triggerEventRate > 0
+			&& ((double) state->rateWindowEvents / rateWindow) >= (double) state->triggerEventRate) {
+			triggered = true;
 		}
+
+		state->rateWindowEvents = 0;
+		state->rateWindowStart = *now;
 	}
+
+	return (triggered);
+}
+
+static void preTriggerBufferPut(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly,
+	const struct timespec *now) {
+	fileState state = moduleData->moduleState;
+
+	// Packets only live until the end of the mainloop run, so keep a copy,
+	// with only the events that would be written.
+	caerEventPacketHeader packetCopy =
+		(validOnly) ? (caerCopyEventPacketOnlyValidEvents(packetHeader)) : (caerCopyEventPacketOnlyEvents(packetHeader));
+	if (packetCopy == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to copy packet into pre-trigger buffer, dropping it.");
+		return;
+	}
+
+	size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE
+		+ ((size_t) caerEventPacketHeaderGetEventCapacity(packetCopy)
+			* (size_t) caerEventPacketHeaderGetEventSize(packetCopy));
+
+	// Grow the circular buffer as needed, unwrapping it in the process.
+	if (state->preTriggerBufferLength == state->preTriggerBufferCapacity) {
+		size_t newCapacity = (state->preTriggerBufferCapacity == 0) ? (256) : (state->preTriggerBufferCapacity * 2);
+
+		struct file_trigger_packet *newBuffer = malloc(newCapacity * sizeof(struct file_trigger_packet));
+		if (newBuffer == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to grow pre-trigger buffer, dropping packet.");
+			free(packetCopy);
+			return;
+		}
+
+		for (size_t i = 0; i < state->preTriggerBufferLength; i++) {
+			newBuffer[i] = state->preTriggerBuffer[(state->preTriggerBufferHead + i)
+				% state->preTriggerBufferCapacity];
+		}
+
+		free(state->preTriggerBuffer);
+		state->preTriggerBuffer = newBuffer;
+		state->preTriggerBufferCapacity = newCapacity;
+		state->preTriggerBufferHead = 0;
+	}
+
+	struct file_trigger_packet *entry = &state->preTriggerBuffer[(state->preTriggerBufferHead
+		+ state->preTriggerBufferLength) % state->preTriggerBufferCapacity];
+
+	entry->packet = packetCopy;
+	entry->arrivalTime = *now;
+	entry->size = packetSize;
+
+	state->preTriggerBufferLength++;
+	state->preTriggerBufferBytes += packetSize;
+
+	preTriggerBufferEvict(state, now);
+}
+
+// Drop the oldest packets, until all are recent enough and fit in memory.
+static void preTriggerBufferEvict(fileState state, const struct timespec *now) {
+	while (state->preTriggerBufferLength > 0) {
+		struct file_trigger_packet *oldest = &state->preTriggerBuffer[state->preTriggerBufferHead];
+
+		if (caerOutputCommonElapsed(&oldest->arrivalTime, now) <= state->preTriggerTime
+			&& state->preTriggerBufferBytes <= state->preTriggerMaxSize) {
+			break;
+		}
+
+		state->preTriggerBufferBytes -= oldest->size;
+		free(oldest->packet);
+
+		state->preTriggerBufferHead = (state->preTriggerBufferHead + 1) % state->preTriggerBufferCapacity;
+		state->preTriggerBufferLength--;
+	}
+}
+
+// Write out all buffered packets, oldest first, and empty the buffer.
+static void preTriggerBufferFlush(caerModuleData moduleData) {
+	fileState state = moduleData->moduleState;
+
+	while (state->preTriggerBufferLength > 0) {
+		struct file_trigger_packet *oldest = &state->preTriggerBuffer[state->preTriggerBufferHead];
+
+		// Copies only hold the events that are to be written.
+		writePacket(moduleData, oldest->packet, false);
+
+		state->preTriggerBufferBytes -= oldest->size;
+		free(oldest->packet);
+
+		state->preTriggerBufferHead = (state->preTriggerBufferHead + 1) % state->preTriggerBufferCapacity;
+		state->preTriggerBufferLength--;
+	}
+}
+
+static void preTriggerBufferClear(fileState state) {
+	while (state->preTriggerBufferLength > 0) {
+		free(state->preTriggerBuffer[state->preTriggerBufferHead].packet);
+
+		state->preTriggerBufferHead = (state->preTriggerBufferHead + 1) % state->preTriggerBufferCapacity;
+		state->preTriggerBufferLength--;
+	}
+
+	free(state->preTriggerBuffer);
+	state->preTriggerBuffer = NULL;
+	state->preTriggerBufferCapacity = 0;
+	state->preTriggerBufferHead = 0;
+	state->preTriggerBufferBytes = 0;
 }
 
 static void caerOutputFileConfig(caerModuleData moduleData) {
@@ -255,33 +1467,73 @@ static void caerOutputFileConfig(caerModuleData moduleData) {
 	if (configUpdate & (0x01 << 2)) {
 		state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 		state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+		updateWriteIndex(moduleData);
 	}
 
-	if (configUpdate & (0x01 << 1)) {
-		// Filename related settings changed.
-		// Generate new file name and open it.
-		char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
-		char *prefix = sshsNodeGetString(moduleData->moduleNode, "prefix");
-		char *filePath = getFullFilePath(moduleData->moduleSubSystemString, directory, prefix);
-		free(directory);
-		free(prefix);
-
-		int newFileDescriptor = open(filePath, O_WRONLY | O_CREAT, S_IWUSR | S_IRUSR | S_IRGRP);
-		if (newFileDescriptor < 0) {
-			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-				"Could not create or open output file '%s' for writing. Error: %d.", filePath, errno);
-			free(filePath);
+	if (configUpdate & (0x01 << 3)) {
+		// File rotation settings changed.
+		state->rotateMaxBytes = sshsNodeGetLong(moduleData->moduleNode, "rotateMaxBytes");
+		state->rotateMaxInterval = sshsNodeGetInt(moduleData->moduleNode, "rotateMaxInterval");
+		updateWriteIndex(moduleData);
+		state->indexInterval = I64T(sshsNodeGetInt(moduleData->moduleNode, "indexInterval")) * 1000;
 
-			return;
+		// A file prepared already was pre-allocated for the old size.
+		discardNextFile(state);
+
+		if (state->rotateMaxBytes > 0 || state->rotateMaxInterval > 0) {
+			startNextFilePreparation(moduleData);
 		}
+	}
 
-		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Opened output file '%s' successfully for writing.",
-			filePath);
-		free(filePath);
+	if (configUpdate & (0x01 << 4)) {
+		// Rate limiter settings changed.
+		caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
+	}
+
+	if (configUpdate & (0x01 << 5)) {
+		// Triggered recording settings changed.
+		updateTriggerSettings(moduleData);
+	}
+
+	if (configUpdate & (0x01 << 6)) {
+		// Manual trigger: fire once, then reset the setting, so it works like
+		// a button.
+		if (sshsNodeGetBool(moduleData->moduleNode, "trigger")) {
+			state->triggerManual = true;
+			sshsNodePutBool(moduleData->moduleNode, "trigger", false);
+		}
+	}
+
+	if (configUpdate & (0x01 << 8)) {
+		// Interleaving settings changed. Per-source headers start with the
+		// next file.
+		bool interleaveSources = sshsNodeGetBool(moduleData->moduleNode, "interleaveSources");
+		state->skewWindow = I64T(sshsNodeGetInt(moduleData->moduleNode, "skewWindow")) * 1000;
+
+		if (state->interleaveSources && !interleaveSources) {
+			struct timespec now;
+			portable_clock_gettime_monotonic(&now);
 
-		// New fd ready and opened, close old and set new.
-		close(state->fileDescriptor);
-		state->fileDescriptor = newFileDescriptor;
+			interleaveBufferRelease(moduleData, true, &now);
+		}
+
+		state->interleaveSources = interleaveSources;
+	}
+
+	if ((configUpdate & (0x01 << 7)) && state->columnarWriter != NULL) {
+		// Columnar block size changed, applies from the next block on.
+		caerColumnarWriterSetBlock(state->columnarWriter,
+			I64T(sshsNodeGetInt(moduleData->moduleNode, "columnarBlockTime")) * 1000, COLUMNAR_BLOCK_MAX_EVENTS);
+	}
+
+	if (configUpdate & (0x01 << 1)) {
+		// Filename or format related settings changed.
+		// Drop the file prepared for the old location, then generate new
+		// file name and open it. This also finalizes the old file.
+		discardNextFile(state);
+		state->filePart = 0;
+
+		openOutputFile(moduleData);
 	}
 }
 
@@ -291,12 +1543,45 @@ static void caerOutputFileExit(caerModuleData moduleData) {
 
 	fileState state = moduleData->moduleState;
 
-	// Close open file.
-	close(state->fileDescriptor);
+	// Write out what is held back for interleaving, then clear whatever is
+	// still in the pre-trigger buffer, it never got triggered.
+	if (state->interleaveSources) {
+		struct timespec now;
+		portable_clock_gettime_monotonic(&now);
+
+		interleaveBufferRelease(moduleData, true, &now);
+	}
+
+	interleaveBufferClear(state);
+	preTriggerBufferClear(state);
 
-	// Make sure to free scatter/gather IO memory.
+	// Finalize open file, and remove the one prepared for rotation.
+	finalizeOutputFile(moduleData);
+	discardNextFile(state);
+
+	// Free packet index memory.
+	free(state->index);
+	state->index = NULL;
+	state->indexCapacity = 0;
+
+	// Make sure to free scatter/gather IO and compression memory.
 	free(state->sgioMemory);
 	state->sgioMemory = NULL;
+
+	caerDeltaBufferFree(state->deltaBuffer);
+	state->deltaBuffer = NULL;
+
+	caerColumnarWriterFree(state->columnarWriter);
+	state->columnarWriter = NULL;
+
+	caerOutputCommonRateLimitFree(&state->rateLimiter);
+
+	caerValidCompactBufferFree(state->compactBuffer);
+	state->compactBuffer = NULL;
+
+	free(state->oldAER.buffer);
+	state->oldAER.buffer = NULL;
+	state->oldAER.bufferSize = 0;
 }
 
 static void caerOutputFileConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -313,7 +1598,10 @@ static void caerOutputFileConfigListener(sshsNode node, void *userData, enum ssh
 			atomic_fetch_or(&data->configUpdate, (0x01 << 0));
 		}
 
-		if (changeType == STRING && (caerStrEquals(changeKey, "directory") || caerStrEquals(changeKey, "prefix"))) {
+		if ((changeType == STRING
+			&& (caerStrEquals(changeKey, "directory") || caerStrEquals(changeKey, "prefix")
+				|| caerStrEquals(changeKey, "format")))
+			|| (changeType == BOOL && caerStrEquals(changeKey, "checksum"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 1));
 		}
 
@@ -321,5 +1609,38 @@ static void caerOutputFileConfigListener(sshsNode node, void *userData, enum ssh
 			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 2));
 		}
+
+		if ((changeType == LONG && caerStrEquals(changeKey, "rotateMaxBytes"))
+			|| (changeType == INT && caerStrEquals(changeKey, "rotateMaxInterval"))
+			|| (changeType == BOOL && caerStrEquals(changeKey, "writeIndex"))
+			|| (changeType == INT && caerStrEquals(changeKey, "indexInterval"))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 3));
+		}
+
+		if (caerOutputCommonRateLimitSetting(changeKey, changeType)) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 4));
+		}
+
+		if ((changeType == BOOL
+			&& (caerStrEquals(changeKey, "triggeredRecording") || caerStrEquals(changeKey, "triggerExternalInput")))
+			|| (changeType == INT
+				&& (caerStrEquals(changeKey, "preTriggerTime") || caerStrEquals(changeKey, "postTriggerTime")
+					|| caerStrEquals(changeKey, "triggerEventRate")))
+			|| (changeType == LONG && caerStrEquals(changeKey, "preTriggerMaxSize"))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 5));
+		}
+
+		if (changeType == BOOL && caerStrEquals(changeKey, "trigger")) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 6));
+		}
+
+		if (changeType == INT && caerStrEquals(changeKey, "columnarBlockTime")) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 7));
+		}
+
+		if ((changeType == BOOL && caerStrEquals(changeKey, "interleaveSources"))
+			|| (changeType == INT && caerStrEquals(changeKey, "skewWindow"))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 8));
+		}
 	}
 }
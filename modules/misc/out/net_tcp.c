@@ -1,16 +1,103 @@
 #include "net_tcp.h"
 #include "base/mainloop.h"
 #include "base/module.h"
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include "ext/nets.h"
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+	#include <sys/mman.h>
+#endif
+
+#if defined(MSG_NOSIGNAL)
+	#define SEND_FLAGS MSG_NOSIGNAL
+#else
+	#define SEND_FLAGS 0
+#endif
+
+// Bytes read from the spool and sent per send() call.
+#define DRAIN_BUFFER_SIZE (64 * 1024)
+
+// Number of segments each spool (memory and disk) is split into. Fully sent
+// segments are freed right away (the last one reused), so the spool never
+// has to be compacted.
+#define SPOOL_SEGMENTS 8
+
+#define SPOOL_DISK_TEMPLATE "caer-spool-XXXXXX"
+
+enum netTCP_connection_states {
+	DISCONNECTED, CONNECTING, CONNECTED,
+};
+
+// Part of the spool: a file (in memory or on disk) holding complete packets
+// exactly as they are to be sent, and where each of them ends, so that a
+// connection lost mid-packet can be resumed at the start of that packet.
+struct netTCP_spool_segment {
+	int fileDescriptor;
+	bool onDisk;
+	uint64_t writeOffset;
+	uint64_t readOffset;
+	uint64_t *packetEnds;
+	size_t packetEndsLength;
+	size_t packetEndsCapacity;
+	size_t packetEndsSent;
+	// Data before this offset is the tail of a packet whose start went out
+	// directly: never resend it, the remote's connection it belonged to is gone.
+	uint64_t rewindFloor;
+	struct netTCP_spool_segment *next;
+};
+
+typedef struct netTCP_spool_segment *netTCPSpoolSegment;
 
 struct netTCP_state {
 	int netTCPDescriptor;
+	enum netTCP_connection_states connectionState;
+	struct sockaddr_in remoteAddress;
+	struct timespec connectStart;
+	struct timespec nextConnectAttempt;
+	int32_t reconnectDelay; // In ms, doubles on every failure.
+	int32_t reconnectMinDelay;
+	int32_t reconnectMaxDelay;
+	int32_t connectTimeout;
+	// Output goes straight to the socket while connected and nothing is
+	// waiting; everything else (backlog, or what the socket didn't take right
+	// away) goes through the spool: a FIFO of segments, drained to the socket
+	// without ever blocking.
+	netTCPSpoolSegment spoolHead;
+	netTCPSpoolSegment spoolTail;
+	uint64_t spoolMemoryBytes;
+	uint64_t spoolDiskBytes;
+	uint64_t memorySpoolSize;
+	bool diskSpool;
+	char *diskSpoolDirectory;
+	uint64_t diskSpoolSize;
+	uint8_t *drainBuffer;
+	// Catch-up rate limiting of the backlog after a reconnect.
+	bool catchingUp;
+	double catchUpRate; // In bytes/s, 0 = unlimited.
+	double catchUpTokens;
+	struct timespec catchUpLastRefill;
+	bool dropping;
+	// Health counters.
+	uint64_t connectAttempts;
+	uint64_t connections;
+	uint64_t disconnections;
+	uint64_t bytesSent;
+	uint64_t droppedPackets;
+	uint64_t droppedBytes;
+	struct timespec lastStatistics;
 	bool validOnly;
 	bool excludeHeader;
 	size_t maxBytesPerPacket;
+	bool checksum;
 	struct iovec *sgioMemory;
+	caerValidCompactBuffer compactBuffer;
+	caerDeltaBuffer deltaBuffer;
+	caerOutputCommonRateLimiter rateLimiter;
 };
 
 typedef struct netTCP_state *netTCPState;
@@ -32,6 +119,21 @@ void caerOutputNetTCP(uint16_t moduleID, size_t outputTypesNumber, ...) {
 	va_end(args);
 }
 
+static void updateRemoteAddress(caerModuleData moduleData);
+static void updateSpoolSettings(caerModuleData moduleData);
+static void connectionHandler(caerModuleData moduleData);
+static void startConnect(caerModuleData moduleData);
+static void connectionFailed(caerModuleData moduleData, bool wasConnected, int error);
+static bool directSendPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly);
+static void spoolPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly);
+static bool spoolRemainder(caerModuleData moduleData, struct iovec *packetIO, size_t packetIOLength, size_t skip);
+static netTCPSpoolSegment spoolReserve(caerModuleData moduleData, uint64_t packetSize);
+static bool spoolEmpty(netTCPState state);
+static netTCPSpoolSegment spoolNewSegment(caerModuleData moduleData, bool onDisk);
+static void spoolFreeSegment(netTCPSpoolSegment segment);
+static void spoolDrain(caerModuleData moduleData);
+static void spoolRewind(netTCPState state);
+static void publishStatistics(caerModuleData moduleData, bool force);
 static void caerOutputNetTCPConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 
@@ -45,35 +147,46 @@ static bool caerOutputNetTCPInit(caerModuleData moduleData) {
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "validEventsOnly", false);
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "excludeHeader", false);
 	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxBytesPerPacket", 0);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "format", "RAW");
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "checksum", false);
+	caerOutputCommonRateLimitDefaults(moduleData->moduleNode);
 
-	// Open a TCP socket to the remote client, to which we'll send data packets.
-	state->netTCPDescriptor = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (state->netTCPDescriptor < 0) {
-		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create TCP socket. Error: %d.", errno);
+	// Reconnection and spooling, for when the remote is unreachable or slow.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "reconnectMinDelay", 100); // In ms.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "reconnectMaxDelay", 10000); // In ms.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "connectTimeout", 5000); // In ms.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "memorySpoolSize", 16 * 1024 * 1024); // In bytes.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "diskSpool", false);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "diskSpoolDirectory", ""); // Empty: $TMPDIR or /tmp.
+	sshsNodePutLongIfAbsent(moduleData->moduleNode, "diskSpoolSize", 1024 * 1024 * 1024); // In bytes.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "catchUpRate", 0); // In bytes/s, 0 = unlimited.
+
+	state->drainBuffer = malloc(DRAIN_BUFFER_SIZE);
+	if (state->drainBuffer == NULL) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not allocate memory for TCP send buffer. Error: %d.", errno);
 		return (false);
 	}
 
-	struct sockaddr_in tcpClient;
-	memset(&tcpClient, 0, sizeof(struct sockaddr_in));
+	updateSpoolSettings(moduleData);
 
-	tcpClient.sin_family = AF_INET;
-	tcpClient.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
-	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
-	inet_aton(ipAddress, &tcpClient.sin_addr); // htonl() is implicit here.
-	free(ipAddress);
+	// The connection is made in the background: the remote doesn't have to
+	// be reachable yet, everything is spooled until it is.
+	state->netTCPDescriptor = -1;
+	state->connectionState = DISCONNECTED;
+	updateRemoteAddress(moduleData);
 
-	if (connect(state->netTCPDescriptor, (struct sockaddr *) &tcpClient, sizeof(struct sockaddr_in)) != 0) {
-		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-			"Could not connect to remote TCP client %s:%" PRIu16 ". Error: %d.", inet_ntoa(tcpClient.sin_addr),
-			ntohs(tcpClient.sin_port), errno);
-		close(state->netTCPDescriptor);
-		return (false);
-	}
+	portable_clock_gettime_monotonic(&state->lastStatistics);
+	state->nextConnectAttempt = state->lastStatistics;
+
+	startConnect(moduleData);
 
 	// Set valid events flag, and allocate memory for scatter/gather IO for it.
 	state->validOnly = sshsNodeGetBool(moduleData->moduleNode, "validEventsOnly");
 	state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 	state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+	state->checksum = sshsNodeGetBool(moduleData->moduleNode, "checksum");
+	caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
 
 	if (state->validOnly) {
 		state->sgioMemory = calloc(IOVEC_SIZE, sizeof(struct iovec));
@@ -90,19 +203,75 @@ static bool caerOutputNetTCPInit(caerModuleData moduleData) {
 		state->sgioMemory = NULL;
 	}
 
+	// Reusable memory for compacting valid events, when they can't be sent
+	// using scatter/gather IO. Without it, temporary memory is used instead.
+	state->compactBuffer = caerValidCompactBufferInit();
+	if (state->compactBuffer == NULL) {
+		caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+			"Impossible to allocate memory for valid event compaction, using temporary memory.");
+	}
+
+	// Rate limits, if any are set.
+	caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputNetTCPConfigListener);
 
-	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "TCP socket connected to %s:%" PRIu16 ".",
-		inet_ntoa(tcpClient.sin_addr), ntohs(tcpClient.sin_port));
-
 	return (true);
 }
 
+static void updateRemoteAddress(caerModuleData moduleData) {
+	netTCPState state = moduleData->moduleState;
+
+	memset(&state->remoteAddress, 0, sizeof(struct sockaddr_in));
+
+	state->remoteAddress.sin_family = AF_INET;
+	state->remoteAddress.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
+	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
+	inet_aton(ipAddress, &state->remoteAddress.sin_addr); // htonl() is implicit here.
+	free(ipAddress);
+}
+
+static void updateSpoolSettings(caerModuleData moduleData) {
+	netTCPState state = moduleData->moduleState;
+
+	state->reconnectMinDelay = sshsNodeGetInt(moduleData->moduleNode, "reconnectMinDelay");
+	if (state->reconnectMinDelay < 1) {
+		state->reconnectMinDelay = 1;
+	}
+
+	state->reconnectMaxDelay = sshsNodeGetInt(moduleData->moduleNode, "reconnectMaxDelay");
+	if (state->reconnectMaxDelay < state->reconnectMinDelay) {
+		state->reconnectMaxDelay = state->reconnectMinDelay;
+	}
+
+	state->reconnectDelay = state->reconnectMinDelay;
+
+	state->connectTimeout = sshsNodeGetInt(moduleData->moduleNode, "connectTimeout");
+
+	int32_t memorySpoolSize = sshsNodeGetInt(moduleData->moduleNode, "memorySpoolSize");
+	state->memorySpoolSize = (memorySpoolSize > 0) ? ((uint64_t) memorySpoolSize) : (0);
+
+	// Segments already on disk stay valid, only new ones use the new settings.
+	state->diskSpool = sshsNodeGetBool(moduleData->moduleNode, "diskSpool");
+
+	free(state->diskSpoolDirectory);
+	state->diskSpoolDirectory = sshsNodeGetString(moduleData->moduleNode, "diskSpoolDirectory");
+
+	int64_t diskSpoolSize = sshsNodeGetLong(moduleData->moduleNode, "diskSpoolSize");
+	state->diskSpoolSize = (diskSpoolSize > 0) ? ((uint64_t) diskSpoolSize) : (0);
+
+	int32_t catchUpRate = sshsNodeGetInt(moduleData->moduleNode, "catchUpRate");
+	state->catchUpRate = (catchUpRate > 0) ? ((double) catchUpRate) : (0);
+}
+
 static void caerOutputNetTCPRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
 	netTCPState state = moduleData->moduleState;
 
-	// For each output argument, write it to the TCP socket.
+	// Advance the connection: finish or retry connecting, detect remote close.
+	connectionHandler(moduleData);
+
+	// For each output argument, send it directly or add it to the spool.
 	// Each type has a header first thing, that gives us the length, so we can
 	// cast it to that and use this information to correctly interpret it.
 	for (size_t i = 0; i < argsNumber; i++) {
@@ -112,11 +281,686 @@ static void caerOutputNetTCPRun(caerModuleData moduleData, size_t argsNumber, va
 		if (packetHeader != NULL) {
 			if ((state->validOnly && caerEventPacketHeaderGetEventValid(packetHeader) > 0)
 				|| (!state->validOnly && caerEventPacketHeaderGetEventNumber(packetHeader) > 0)) {
-				caerOutputCommonSend(moduleData->moduleSubSystemString, packetHeader, state->netTCPDescriptor,
-					state->sgioMemory, state->validOnly, state->excludeHeader, state->maxBytesPerPacket, false);
+				// Apply rate limits, this may drop or subsample the packet.
+				caerEventPacketHeader sendPacket = packetHeader;
+				bool validOnly = state->validOnly;
+
+				if (state->rateLimiter != NULL) {
+					sendPacket = caerOutputCommonRateLimit(state->rateLimiter, packetHeader, &validOnly);
+					if (sendPacket == NULL) {
+						continue;
+					}
+				}
+
+				if (!directSendPacket(moduleData, sendPacket, validOnly)) {
+					spoolPacket(moduleData, sendPacket, validOnly);
+				}
 			}
 		}
 	}
+
+	// Send as much as the socket takes right now, without blocking.
+	if (state->connectionState == CONNECTED) {
+		spoolDrain(moduleData);
+	}
+
+	publishStatistics(moduleData, false);
+}
+
+static void connectionHandler(caerModuleData moduleData) {
+	netTCPState state = moduleData->moduleState;
+
+	if (state->connectionState == DISCONNECTED) {
+		struct timespec now;
+		portable_clock_gettime_monotonic(&now);
+
+		if (caerOutputCommonElapsed(&state->nextConnectAttempt, &now) >= 0) {
+			startConnect(moduleData);
+		}
+	}
+	else if (state->connectionState == CONNECTING) {
+		struct pollfd connectPoll = { .fd = state->netTCPDescriptor, .events = POLLOUT, .revents = 0 };
+
+		if (poll(&connectPoll, 1, 0) > 0) {
+			// Connection attempt finished, see how it went.
+			int connectError = 0;
+			socklen_t connectErrorLength = sizeof(connectError);
+
+			if (getsockopt(state->netTCPDescriptor, SOL_SOCKET, SO_ERROR, &connectError, &connectErrorLength) != 0) {
+				connectError = errno;
+			}
+
+			if (connectError != 0) {
+				connectionFailed(moduleData, false, connectError);
+				return;
+			}
+
+			state->connectionState = CONNECTED;
+			state->connections++;
+			state->reconnectDelay = state->reconnectMinDelay;
+
+			// Anything already spooled is a backlog to catch up on.
+			state->catchingUp = (state->spoolHead != NULL);
+			state->catchUpTokens = 0;
+			portable_clock_gettime_monotonic(&state->catchUpLastRefill);
+
+			caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString,
+				"TCP socket connected to %s:%" PRIu16 ", %" PRIu64 " bytes spooled.",
+				inet_ntoa(state->remoteAddress.sin_addr), ntohs(state->remoteAddress.sin_port),
+				state->spoolMemoryBytes + state->spoolDiskBytes);
+
+			publishStatistics(moduleData, true);
+		}
+		else {
+			struct timespec now;
+			portable_clock_gettime_monotonic(&now);
+
+			if (state->connectTimeout > 0
+				&& caerOutputCommonElapsed(&state->connectStart, &now) >= ((double) state->connectTimeout / 1000)) {
+				connectionFailed(moduleData, false, ETIMEDOUT);
+			}
+		}
+	}
+	else {
+		// The remote never sends anything, so any readable data or hang-up
+		// means the connection is gone.
+		struct pollfd connectedPoll = { .fd = state->netTCPDescriptor, .events = POLLIN, .revents = 0 };
+
+		if (poll(&connectedPoll, 1, 0) > 0) {
+			uint8_t buffer[64];
+			ssize_t recvResult = recv(state->netTCPDescriptor, buffer, sizeof(buffer), 0);
+
+			if (recvResult == 0 || (recvResult < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+				connectionFailed(moduleData, true, (recvResult == 0) ? (ECONNRESET) : (errno));
+			}
+		}
+	}
+}
+
+static void startConnect(caerModuleData moduleData) {
+	netTCPState state = moduleData->moduleState;
+
+	state->connectAttempts++;
+
+	// Open a TCP socket to the remote client, to which we'll send data packets.
+	state->netTCPDescriptor = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (state->netTCPDescriptor < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create TCP socket. Error: %d.", errno);
+		connectionFailed(moduleData, false, errno);
+		return;
+	}
+
+	if (!socketBlockingMode(state->netTCPDescriptor, false)) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not set TCP socket to non-blocking mode.");
+		connectionFailed(moduleData, false, errno);
+		return;
+	}
+
+#if defined(SO_NOSIGPIPE)
+	// No MSG_NOSIGNAL on this platform: avoid SIGPIPE on the socket itself.
+	int noSigPipe = 1;
+	setsockopt(state->netTCPDescriptor, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+	portable_clock_gettime_monotonic(&state->connectStart);
+
+	if (connect(state->netTCPDescriptor, (struct sockaddr *) &state->remoteAddress, sizeof(struct sockaddr_in)) == 0) {
+		// Connected right away (local remote), finish up in the handler.
+		state->connectionState = CONNECTING;
+		return;
+	}
+
+	if (errno != EINPROGRESS) {
+		connectionFailed(moduleData, false, errno);
+		return;
+	}
+
+	state->connectionState = CONNECTING;
+}
+
+static void connectionFailed(caerModuleData moduleData, bool wasConnected, int error) {
+	netTCPState state = moduleData->moduleState;
+
+	if (state->netTCPDescriptor >= 0) {
+		close(state->netTCPDescriptor);
+		state->netTCPDescriptor = -1;
+	}
+
+	state->connectionState = DISCONNECTED;
+
+	if (wasConnected) {
+		state->disconnections++;
+
+		// The remote may have been in the middle of receiving a packet:
+		// resend it whole to the next connection.
+		spoolRewind(state);
+
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Lost connection to remote TCP client %s:%" PRIu16 ", spooling until it's back. Error: %d.",
+			inet_ntoa(state->remoteAddress.sin_addr), ntohs(state->remoteAddress.sin_port), error);
+	}
+	else {
+		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString,
+			"Could not connect to remote TCP client %s:%" PRIu16 ", retrying in %" PRIi32 " ms. Error: %d.",
+			inet_ntoa(state->remoteAddress.sin_addr), ntohs(state->remoteAddress.sin_port), state->reconnectDelay,
+			error);
+	}
+
+	// Retry later, backing off exponentially up to the maximum delay.
+	portable_clock_gettime_monotonic(&state->nextConnectAttempt);
+
+	state->nextConnectAttempt.tv_sec += state->reconnectDelay / 1000;
+	state->nextConnectAttempt.tv_nsec += (state->reconnectDelay % 1000) * 1000000L;
+	if (state->nextConnectAttempt.tv_nsec >= 1000000000L) {
+		state->nextConnectAttempt.tv_sec++;
+		state->nextConnectAttempt.tv_nsec -= 1000000000L;
+	}
+
+	if (!wasConnected) {
+		state->reconnectDelay *= 2;
+		if (state->reconnectDelay > state->reconnectMaxDelay) {
+			state->reconnectDelay = state->reconnectMaxDelay;
+		}
+	}
+
+	publishStatistics(moduleData, true);
+}
+
+// Send a packet straight to the socket, if connected and nothing is waiting in
+// the spool, saving the round-trip through it. Only done for formats where a
+// packet is one contiguous run of bytes (RAW, not split by maxBytesPerPacket).
+// Whatever the socket doesn't take right away is spooled, and drained on the
+// next runs. Returns false if the packet has to be spooled whole instead.
+static bool directSendPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly) {
+	netTCPState state = moduleData->moduleState;
+
+	if (state->connectionState != CONNECTED || !spoolEmpty(state) || state->deltaBuffer != NULL
+		|| state->maxBytesPerPacket != 0) {
+		return (false);
+	}
+
+	int32_t oldCapacity = caerEventPacketHeaderGetEventCapacity(packetHeader);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packetHeader);
+
+	// The same bytes caerOutputCommonSend() and caerOutputCommonSendChecksum()
+	// would write: the packet without its zeroed-out tail, or a compacted copy.
+	uint8_t *packet = (uint8_t *) packetHeader;
+	size_t packetLength;
+
+	if (validOnly && caerEventPacketHeaderGetEventValid(packetHeader) != eventNumber) {
+		if (state->compactBuffer == NULL) {
+			return (false);
+		}
+
+		packet = caerValidCompactBufferReserve(state->compactBuffer, caerValidCompactPacketSize(packetHeader));
+		if (packet == NULL) {
+			return (false);
+		}
+
+		packetLength = caerValidCompactPacket(packet, packetHeader);
+	}
+	else {
+		caerEventPacketHeaderSetEventCapacity(packetHeader, eventNumber);
+
+		packetLength = CAER_EVENT_PACKET_HEADER_SIZE
+			+ ((size_t) eventNumber * (size_t) caerEventPacketHeaderGetEventSize(packetHeader));
+	}
+
+	struct iovec packetIO[2];
+	size_t packetIOLength = 1;
+	uint32_t checksumLE = 0;
+
+	if (state->checksum) {
+		// Always whole and with header, followed by the CRC-32C trailer.
+		packetIO[0].iov_base = packet;
+		packetIO[0].iov_len = packetLength;
+
+		checksumLE = htole32(caerCrc32c(0, packet, packetLength));
+
+		packetIO[1].iov_base = &checksumLE;
+		packetIO[1].iov_len = CHECKSUM_TRAILER_SIZE;
+		packetIOLength = 2;
+	}
+	else {
+		size_t headerSkip = (state->excludeHeader) ? (CAER_EVENT_PACKET_HEADER_SIZE) : (0);
+
+		packetIO[0].iov_base = packet + headerSkip;
+		packetIO[0].iov_len = packetLength - headerSkip;
+	}
+
+	size_t totalLength = 0;
+	for (size_t i = 0; i < packetIOLength; i++) {
+		totalLength += packetIO[i].iov_len;
+	}
+
+	struct msghdr message;
+	memset(&message, 0, sizeof(struct msghdr));
+
+	message.msg_iov = packetIO;
+	message.msg_iovlen = packetIOLength;
+
+	bool sent = true;
+	ssize_t sendResult = sendmsg(state->netTCPDescriptor, &message, SEND_FLAGS);
+
+	if (sendResult < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+			sendResult = 0;
+		}
+		else {
+			// Nothing went out, spool it whole for the next connection.
+			connectionFailed(moduleData, true, errno);
+			sent = false;
+		}
+	}
+
+	if (sent) {
+		state->bytesSent += (uint64_t) sendResult;
+
+		if ((size_t) sendResult < totalLength
+			&& !spoolRemainder(moduleData, packetIO, packetIOLength, (size_t) sendResult)) {
+			// The remote already has the start of the packet, and the rest
+			// can't be sent: start over with a new connection, to keep the
+			// stream in sync.
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Could not spool the rest of a partially sent packet, reconnecting.");
+			connectionFailed(moduleData, true, ENOBUFS);
+		}
+	}
+
+	caerEventPacketHeaderSetEventCapacity(packetHeader, oldCapacity);
+
+	return (sent);
+}
+
+// Nothing waiting to be sent: no segments, or only the kept one, fully sent.
+static bool spoolEmpty(netTCPState state) {
+	return ((state->spoolHead == NULL)
+		|| ((state->spoolHead == state->spoolTail) && (state->spoolHead->readOffset == state->spoolHead->writeOffset)));
+}
+
+static void spoolPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly) {
+	netTCPState state = moduleData->moduleState;
+
+	// Upper bound on the space the packet needs in the spool.
+	uint64_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE + CHECKSUM_TRAILER_SIZE
+		+ ((uint64_t) caerEventPacketHeaderGetEventNumber(packetHeader)
+			* (uint64_t) caerEventPacketHeaderGetEventSize(packetHeader));
+
+	netTCPSpoolSegment segment = spoolReserve(moduleData, packetSize);
+	if (segment == NULL) {
+		return;
+	}
+
+	// Write the packet exactly as it would go out on the socket.
+	size_t written;
+
+	if (state->checksum) {
+		written = caerOutputCommonSendChecksum(moduleData->moduleSubSystemString, packetHeader,
+			segment->fileDescriptor, state->compactBuffer, state->deltaBuffer, validOnly);
+	}
+	else {
+		written = caerOutputCommonSend(moduleData->moduleSubSystemString, packetHeader, segment->fileDescriptor,
+			state->sgioMemory, state->compactBuffer, state->deltaBuffer, validOnly, state->excludeHeader,
+			state->maxBytesPerPacket, NULL);
+	}
+
+	if (written == 0) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to write packet to TCP output spool.");
+		state->droppedPackets++;
+		state->droppedBytes += packetSize;
+		return;
+	}
+
+	if (segment->onDisk) {
+		state->spoolDiskBytes += written;
+	}
+	else {
+		state->spoolMemoryBytes += written;
+	}
+
+	segment->writeOffset += written;
+	segment->packetEnds[segment->packetEndsLength++] = segment->writeOffset;
+}
+
+// Spool what the socket didn't take of a directly sent packet: packetIO minus
+// its first skip bytes. Returns false if it couldn't be spooled.
+static bool spoolRemainder(caerModuleData moduleData, struct iovec *packetIO, size_t packetIOLength, size_t skip) {
+	netTCPState state = moduleData->moduleState;
+
+	struct iovec remainderIO[2];
+	size_t remainderIOLength = 0;
+	uint64_t remainderSize = 0;
+
+	for (size_t i = 0; i < packetIOLength && remainderIOLength < 2; i++) {
+		if (skip >= packetIO[i].iov_len) {
+			skip -= packetIO[i].iov_len;
+			continue;
+		}
+
+		remainderIO[remainderIOLength].iov_base = (uint8_t *) packetIO[i].iov_base + skip;
+		remainderIO[remainderIOLength].iov_len = packetIO[i].iov_len - skip;
+		remainderSize += remainderIO[remainderIOLength].iov_len;
+		remainderIOLength++;
+
+		skip = 0;
+	}
+
+	netTCPSpoolSegment segment = spoolReserve(moduleData, remainderSize);
+	if (segment == NULL) {
+		return (false);
+	}
+
+	ssize_t written = writev(segment->fileDescriptor, remainderIO, (int) remainderIOLength);
+	if (written < 0 || (uint64_t) written != remainderSize) {
+		return (false);
+	}
+
+	if (segment->onDisk) {
+		state->spoolDiskBytes += remainderSize;
+	}
+	else {
+		state->spoolMemoryBytes += remainderSize;
+	}
+
+	segment->writeOffset += remainderSize;
+	segment->packetEnds[segment->packetEndsLength++] = segment->writeOffset;
+	segment->rewindFloor = segment->writeOffset;
+
+	return (true);
+}
+
+// Find space for packetSize bytes at the end of the spool, and for recording
+// where the packet ends. Returns NULL (and counts the packet as dropped) if
+// the spool is full.
+static netTCPSpoolSegment spoolReserve(caerModuleData moduleData, uint64_t packetSize) {
+	netTCPState state = moduleData->moduleState;
+
+	// Memory first, then disk, if enabled. The spool is a FIFO, so the order
+	// of packets is kept even when switching between the two.
+	netTCPSpoolSegment segment = state->spoolTail;
+
+	uint64_t memorySegmentSize = state->memorySpoolSize / SPOOL_SEGMENTS;
+	uint64_t diskSegmentSize = state->diskSpoolSize / SPOOL_SEGMENTS;
+
+	bool fitsTail = (segment != NULL)
+		&& ((segment->onDisk) ?
+			((segment->writeOffset < diskSegmentSize) && ((state->spoolDiskBytes + packetSize) <= state->diskSpoolSize)) :
+			((segment->writeOffset < memorySegmentSize)
+				&& ((state->spoolMemoryBytes + packetSize) <= state->memorySpoolSize)));
+
+	if (!fitsTail) {
+		segment = NULL;
+
+		if ((state->spoolMemoryBytes + packetSize) <= state->memorySpoolSize) {
+			segment = spoolNewSegment(moduleData, false);
+		}
+		else if (state->diskSpool && (state->spoolDiskBytes + packetSize) <= state->diskSpoolSize) {
+			segment = spoolNewSegment(moduleData, true);
+		}
+	}
+
+	if (segment == NULL) {
+		// Spool full or failed, nothing to do but lose the packet.
+		if (!state->dropping) {
+			state->dropping = true;
+
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"TCP output spool full (%" PRIu64 " bytes in memory, %" PRIu64 " on disk), dropping packets.",
+				state->spoolMemoryBytes, state->spoolDiskBytes);
+		}
+
+		state->droppedPackets++;
+		state->droppedBytes += packetSize;
+		return (NULL);
+	}
+
+	if (state->dropping) {
+		state->dropping = false;
+
+		caerLog(CAER_LOG_NOTICE, moduleData->moduleSubSystemString,
+			"TCP output spool has space again, %" PRIu64 " packets dropped so far.", state->droppedPackets);
+	}
+
+	// Remember where the packet ends, for resuming after a lost connection.
+	if (segment->packetEndsLength == segment->packetEndsCapacity) {
+		size_t newCapacity = (segment->packetEndsCapacity == 0) ? (256) : (segment->packetEndsCapacity * 2);
+
+		uint64_t *newPacketEnds = realloc(segment->packetEnds, newCapacity * sizeof(uint64_t));
+		if (newPacketEnds == NULL) {
+			state->droppedPackets++;
+			state->droppedBytes += packetSize;
+			return (NULL);
+		}
+
+		segment->packetEnds = newPacketEnds;
+		segment->packetEndsCapacity = newCapacity;
+	}
+
+	return (segment);
+}
+
+static netTCPSpoolSegment spoolNewSegment(caerModuleData moduleData, bool onDisk) {
+	netTCPState state = moduleData->moduleState;
+
+	netTCPSpoolSegment segment = calloc(1, sizeof(struct netTCP_spool_segment));
+	if (segment == NULL) {
+		return (NULL);
+	}
+
+	segment->fileDescriptor = -1;
+	segment->onDisk = onDisk;
+
+#if defined(MFD_CLOEXEC)
+	if (!onDisk) {
+		// Anonymous memory, that can be written to like a file.
+		segment->fileDescriptor = memfd_create("caer-spool", MFD_CLOEXEC);
+	}
+#endif
+
+	if (segment->fileDescriptor < 0) {
+		// Unlinked temporary file, which goes away on close. Also used for
+		// the memory spool where memfd_create() isn't available.
+		const char *directory = state->diskSpoolDirectory;
+		if (!onDisk || directory == NULL || directory[0] == '\0') {
+			directory = getenv("TMPDIR");
+		}
+		if (directory == NULL || directory[0] == '\0') {
+			directory = "/tmp";
+		}
+
+		size_t tempPathLength = strlen(directory) + strlen(SPOOL_DISK_TEMPLATE) + 2;
+		char *tempPath = malloc(tempPathLength);
+		if (tempPath == NULL) {
+			free(segment);
+			return (NULL);
+		}
+
+		snprintf(tempPath, tempPathLength, "%s/%s", directory, SPOOL_DISK_TEMPLATE);
+
+		segment->fileDescriptor = mkstemp(tempPath);
+		if (segment->fileDescriptor >= 0) {
+			unlink(tempPath);
+		}
+		else {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Could not create TCP output spool file in '%s'. Error: %d.", directory, errno);
+		}
+
+		free(tempPath);
+	}
+
+	if (segment->fileDescriptor < 0) {
+		free(segment);
+		return (NULL);
+	}
+
+	// Append to the FIFO.
+	if (state->spoolTail == NULL) {
+		state->spoolHead = segment;
+	}
+	else {
+		state->spoolTail->next = segment;
+	}
+
+	state->spoolTail = segment;
+
+	return (segment);
+}
+
+static void spoolFreeSegment(netTCPSpoolSegment segment) {
+	close(segment->fileDescriptor);
+	free(segment->packetEnds);
+	free(segment);
+}
+
+static void spoolDrain(caerModuleData moduleData) {
+	netTCPState state = moduleData->moduleState;
+
+	if (state->catchingUp && state->catchUpRate > 0) {
+		struct timespec now;
+		portable_clock_gettime_monotonic(&now);
+
+		// Allow up to a tenth of a second of burst.
+		state->catchUpTokens += caerOutputCommonElapsed(&state->catchUpLastRefill, &now) * state->catchUpRate;
+		if (state->catchUpTokens > (state->catchUpRate / 10)) {
+			state->catchUpTokens = state->catchUpRate / 10;
+		}
+
+		state->catchUpLastRefill = now;
+	}
+
+	while (state->spoolHead != NULL) {
+		netTCPSpoolSegment segment = state->spoolHead;
+
+		if (segment->readOffset == segment->writeOffset) {
+			// Fully sent: give back its space.
+			if (segment->onDisk) {
+				state->spoolDiskBytes -= segment->writeOffset;
+			}
+			else {
+				state->spoolMemoryBytes -= segment->writeOffset;
+			}
+
+			if (segment == state->spoolTail) {
+				// Last one: the backlog is gone. Keep it for the next packets,
+				// which is the common case of a connection that keeps up.
+				state->catchingUp = false;
+
+				if (!segment->onDisk && ftruncate(segment->fileDescriptor, 0) == 0
+					&& lseek(segment->fileDescriptor, 0, SEEK_SET) == 0) {
+					segment->writeOffset = 0;
+					segment->readOffset = 0;
+					segment->packetEndsLength = 0;
+					segment->packetEndsSent = 0;
+					segment->rewindFloor = 0;
+					break;
+				}
+
+				state->spoolHead = state->spoolTail = NULL;
+				spoolFreeSegment(segment);
+				break;
+			}
+
+			state->spoolHead = segment->next;
+			spoolFreeSegment(segment);
+			continue;
+		}
+
+		size_t sendLength = DRAIN_BUFFER_SIZE;
+		if ((segment->writeOffset - segment->readOffset) < sendLength) {
+			sendLength = (size_t) (segment->writeOffset - segment->readOffset);
+		}
+
+		if (state->catchingUp && state->catchUpRate > 0) {
+			if (state->catchUpTokens < 1) {
+				break;
+			}
+
+			if ((double) sendLength > state->catchUpTokens) {
+				sendLength = (size_t) state->catchUpTokens;
+			}
+		}
+
+		ssize_t readResult = pread(segment->fileDescriptor, state->drainBuffer, sendLength,
+			(off_t) segment->readOffset);
+		if (readResult <= 0) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to read from TCP output spool. Error: %d.", errno);
+			break;
+		}
+
+		ssize_t sendResult = send(state->netTCPDescriptor, state->drainBuffer, (size_t) readResult, SEND_FLAGS);
+		if (sendResult < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				connectionFailed(moduleData, true, errno);
+			}
+
+			break;
+		}
+
+		segment->readOffset += (uint64_t) sendResult;
+		state->bytesSent += (uint64_t) sendResult;
+
+		if (state->catchingUp) {
+			state->catchUpTokens -= (double) sendResult;
+		}
+
+		while (segment->packetEndsSent < segment->packetEndsLength
+			&& segment->packetEnds[segment->packetEndsSent] <= segment->readOffset) {
+			segment->packetEndsSent++;
+		}
+
+		if (sendResult < readResult) {
+			// Socket buffer full, try again on the next run.
+			break;
+		}
+	}
+}
+
+static void spoolRewind(netTCPState state) {
+	netTCPSpoolSegment segment = state->spoolHead;
+
+	// Fully sent segments have nothing to resend.
+	while (segment != NULL && segment->readOffset == segment->writeOffset) {
+		segment = segment->next;
+	}
+
+	if (segment == NULL) {
+		return;
+	}
+
+	// Back to the end of the last completely sent packet, but never into the
+	// tail of a directly sent one.
+	segment->readOffset = (segment->packetEndsSent == 0) ? (0) : (segment->packetEnds[segment->packetEndsSent - 1]);
+
+	if (segment->readOffset < segment->rewindFloor) {
+		segment->readOffset = segment->rewindFloor;
+	}
+}
+
+static void publishStatistics(caerModuleData moduleData, bool force) {
+	netTCPState state = moduleData->moduleState;
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	// Publish at most once per second, or right away on connection changes.
+	if (!force && caerOutputCommonElapsed(&state->lastStatistics, &now) < 1) {
+		return;
+	}
+
+	state->lastStatistics = now;
+
+	sshsNodePutBool(moduleData->moduleNode, "connected", (state->connectionState == CONNECTED));
+	sshsNodePutLong(moduleData->moduleNode, "connectAttempts", (int64_t) state->connectAttempts);
+	sshsNodePutLong(moduleData->moduleNode, "connections", (int64_t) state->connections);
+	sshsNodePutLong(moduleData->moduleNode, "disconnections", (int64_t) state->disconnections);
+	sshsNodePutLong(moduleData->moduleNode, "bytesSent", (int64_t) state->bytesSent);
+	sshsNodePutLong(moduleData->moduleNode, "spoolMemoryBytes", (int64_t) state->spoolMemoryBytes);
+	sshsNodePutLong(moduleData->moduleNode, "spoolDiskBytes", (int64_t) state->spoolDiskBytes);
+	sshsNodePutLong(moduleData->moduleNode, "droppedPackets", (int64_t) state->droppedPackets);
+	sshsNodePutLong(moduleData->moduleNode, "droppedBytes", (int64_t) state->droppedBytes);
 }
 
 static void caerOutputNetTCPConfig(caerModuleData moduleData) {
@@ -159,38 +1003,38 @@ static void caerOutputNetTCPConfig(caerModuleData moduleData) {
 	if (configUpdate & (0x01 << 2)) {
 		state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 		state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+		state->checksum = sshsNodeGetBool(moduleData->moduleNode, "checksum");
+		caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
+	}
+
+	if (configUpdate & (0x01 << 3)) {
+		// Rate limiter settings changed.
+		caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
+	}
+
+	if (configUpdate & (0x01 << 4)) {
+		// Reconnection or spool settings changed.
+		updateSpoolSettings(moduleData);
 	}
 
 	if (configUpdate & (0x01 << 1)) {
 		// TCP client address related changes.
-		// Open a TCP socket to the new remote client, to which we'll send data packets.
-		int newNetTCPDescriptor = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-		if (newNetTCPDescriptor < 0) {
-			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create TCP socket. Error: %d.",
-			errno);
-			return;
+		// Drop the current connection, and connect to the new remote client
+		// right away. The spool is kept, and continues there.
+		if (state->netTCPDescriptor >= 0) {
+			close(state->netTCPDescriptor);
+			state->netTCPDescriptor = -1;
 		}
 
-		struct sockaddr_in tcpClient;
-		memset(&tcpClient, 0, sizeof(struct sockaddr_in));
-
-		tcpClient.sin_family = AF_INET;
-		tcpClient.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
-		char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
-		inet_aton(ipAddress, &tcpClient.sin_addr); // htonl() is implicit here.
-		free(ipAddress);
-
-		if (connect(newNetTCPDescriptor, (struct sockaddr *) &tcpClient, sizeof(struct sockaddr_in)) != 0) {
-			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-				"Could not connect to remote TCP client %s:%" PRIu16 ". Error: %d.", inet_ntoa(tcpClient.sin_addr),
-				ntohs(tcpClient.sin_port), errno);
-			close(newNetTCPDescriptor);
-			return;
+		if (state->connectionState == CONNECTED) {
+			spoolRewind(state);
 		}
 
-		// New fd ready and connected, close old and set new.
-		close(state->netTCPDescriptor);
-		state->netTCPDescriptor = newNetTCPDescriptor;
+		state->connectionState = DISCONNECTED;
+		state->reconnectDelay = state->reconnectMinDelay;
+
+		updateRemoteAddress(moduleData);
+		startConnect(moduleData);
 	}
 }
 
@@ -201,11 +1045,43 @@ static void caerOutputNetTCPExit(caerModuleData moduleData) {
 	netTCPState state = moduleData->moduleState;
 
 	// Close open TCP socket.
-	close(state->netTCPDescriptor);
+	if (state->netTCPDescriptor >= 0) {
+		close(state->netTCPDescriptor);
+		state->netTCPDescriptor = -1;
+	}
+
+	// Anything still spooled is lost now.
+	if (state->spoolMemoryBytes != 0 || state->spoolDiskBytes != 0) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"Discarding %" PRIu64 " spooled bytes that were never sent.",
+			state->spoolMemoryBytes + state->spoolDiskBytes);
+	}
+
+	while (state->spoolHead != NULL) {
+		netTCPSpoolSegment segment = state->spoolHead;
+		state->spoolHead = segment->next;
+		spoolFreeSegment(segment);
+	}
 
-	// Make sure to free scatter/gather IO memory.
+	state->spoolTail = NULL;
+
+	free(state->drainBuffer);
+	state->drainBuffer = NULL;
+
+	free(state->diskSpoolDirectory);
+	state->diskSpoolDirectory = NULL;
+
+	// Make sure to free scatter/gather IO and compression memory.
 	free(state->sgioMemory);
 	state->sgioMemory = NULL;
+
+	caerDeltaBufferFree(state->deltaBuffer);
+	state->deltaBuffer = NULL;
+
+	caerOutputCommonRateLimitFree(&state->rateLimiter);
+
+	caerValidCompactBufferFree(state->compactBuffer);
+	state->compactBuffer = NULL;
 }
 
 static void caerOutputNetTCPConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -227,9 +1103,24 @@ static void caerOutputNetTCPConfigListener(sshsNode node, void *userData, enum s
 			atomic_fetch_or(&data->configUpdate, (0x01 << 1));
 		}
 
-		if ((changeType == BOOL && caerStrEquals(changeKey, "excludeHeader"))
-			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))) {
+		if ((changeType == BOOL && (caerStrEquals(changeKey, "excludeHeader") || caerStrEquals(changeKey, "checksum")))
+			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))
+			|| (changeType == STRING && caerStrEquals(changeKey, "format"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 2));
 		}
+
+		if (caerOutputCommonRateLimitSetting(changeKey, changeType)) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 3));
+		}
+
+		if ((changeType == INT
+			&& (caerStrEquals(changeKey, "reconnectMinDelay") || caerStrEquals(changeKey, "reconnectMaxDelay")
+				|| caerStrEquals(changeKey, "connectTimeout") || caerStrEquals(changeKey, "memorySpoolSize")
+				|| caerStrEquals(changeKey, "catchUpRate")))
+			|| (changeType == BOOL && caerStrEquals(changeKey, "diskSpool"))
+			|| (changeType == STRING && caerStrEquals(changeKey, "diskSpoolDirectory"))
+			|| (changeType == LONG && caerStrEquals(changeKey, "diskSpoolSize"))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 4));
+		}
 	}
 }
@@ -6,15 +6,49 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include "ext/nets.h"
+#include "ext/portable_time.h"
+#include "ext/netsubscription.h"
+#include <libcaer/events/polarity.h>
+
+// Clients with identical subscriptions share one group, so the filtering
+// work is done only once per packet for all of them.
+struct netTCP_subscription_group {
+	struct caer_net_subscription subscription;
+	size_t references;
+	// Packet generation this group last filtered, and its result.
+	uint64_t filteredGeneration;
+	caerEventPacketHeader filteredPacket;
+	uint8_t *filterMemory;
+	size_t filterMemorySize;
+	// Position in the event stream, for subsampling across packets.
+	uint32_t subsampleCounter;
+	// Token bucket for maxRate, in events, refilled to one second's worth.
+	double rateTokens;
+	struct timespec rateLastRefill;
+};
+
+typedef struct netTCP_subscription_group *netTCPSubscriptionGroup;
+
+struct netTCP_client {
+	netTCPSubscriptionGroup group; // NULL: no subscription, gets everything.
+	uint8_t messageBuffer[CAER_NET_SUBSCRIPTION_SIZE];
+	size_t messageLength;
+};
 
 struct netTCP_state {
 	int serverDescriptor;
 	size_t clientDescriptorsLength;
 	struct pollfd *clientDescriptors;
+	struct netTCP_client *clients;
+	uint64_t packetGeneration;
 	bool validOnly;
 	bool excludeHeader;
 	size_t maxBytesPerPacket;
+	bool checksum;
 	struct iovec *sgioMemory;
+	caerValidCompactBuffer compactBuffer;
+	caerDeltaBuffer deltaBuffer;
+	caerOutputCommonRateLimiter rateLimiter;
 };
 
 typedef struct netTCP_state *netTCPState;
@@ -38,6 +72,10 @@ void caerOutputNetTCPServer(uint16_t moduleID, size_t outputTypesNumber, ...) {
 }
 
 static void caerOutputNetTCPServerConnectionHandler(caerModuleData moduleData);
+static void caerOutputNetTCPServerReceiveSubscription(caerModuleData moduleData, size_t client);
+static void caerOutputNetTCPServerCloseClient(netTCPState state, size_t client);
+static void subscriptionGroupRelease(netTCPSubscriptionGroup group);
+static caerEventPacketHeader subscriptionGroupFilter(netTCPSubscriptionGroup group, caerEventPacketHeader packetHeader);
 static void caerOutputNetTCPServerConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
 	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
 
@@ -53,6 +91,9 @@ static bool caerOutputNetTCPServerInit(caerModuleData moduleData) {
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "validEventsOnly", false);
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "excludeHeader", false);
 	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxBytesPerPacket", 0);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "format", "RAW");
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "checksum", false);
+	caerOutputCommonRateLimitDefaults(moduleData->moduleNode);
 
 	// Open a TCP server socket for others to connect to.
 	state->serverDescriptor = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
@@ -108,8 +149,19 @@ static bool caerOutputNetTCPServerInit(caerModuleData moduleData) {
 		return (false);
 	}
 
+	// Per-client subscription state, all initially unsubscribed.
+	state->clients = calloc(state->clientDescriptorsLength, sizeof(*(state->clients)));
+	if (state->clients == NULL) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not allocate memory for TCP client subscriptions. Error: %d.", errno);
+		free(state->clientDescriptors);
+		close(state->serverDescriptor);
+		return (false);
+	}
+
 	// Initialize connected clients array to empty.
-	// We only care about checking inbound data to detect close() from the client.
+	// We only care about checking inbound data to detect close() from the
+	// client, or subscription messages.
 	for (size_t c = 0; c < state->clientDescriptorsLength; c++) {
 		state->clientDescriptors[c].fd = -1;
 		state->clientDescriptors[c].events = POLLIN;
@@ -119,6 +171,8 @@ static bool caerOutputNetTCPServerInit(caerModuleData moduleData) {
 	state->validOnly = sshsNodeGetBool(moduleData->moduleNode, "validEventsOnly");
 	state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 	state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+	state->checksum = sshsNodeGetBool(moduleData->moduleNode, "checksum");
+	caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
 
 	if (state->validOnly) {
 		state->sgioMemory = calloc(IOVEC_SIZE, sizeof(struct iovec));
@@ -135,6 +189,17 @@ static bool caerOutputNetTCPServerInit(caerModuleData moduleData) {
 		state->sgioMemory = NULL;
 	}
 
+	// Reusable memory for compacting valid events, when they can't be sent
+	// using scatter/gather IO. Without it, temporary memory is used instead.
+	state->compactBuffer = caerValidCompactBufferInit();
+	if (state->compactBuffer == NULL) {
+		caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+			"Impossible to allocate memory for valid event compaction, using temporary memory.");
+	}
+
+	// Rate limits, if any are set.
+	caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputNetTCPServerConfigListener);
 
@@ -155,27 +220,11 @@ static void caerOutputNetTCPServerConnectionHandler(caerModuleData moduleData) {
 		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "TCP server poll() failed. Error: %d.", errno);
 	}
 
-	// Handle clients that have inbound data (close() calls).
+	// Handle clients that have inbound data (close() calls or subscriptions).
 	if (pollResult > 0) {
 		for (size_t c = 0; c < state->clientDescriptorsLength; c++) {
 			if (state->clientDescriptors[c].fd >= 0 && (state->clientDescriptors[c].revents & POLLIN) != 0) {
-				// Check if this one wants to close(), which should be the only
-				// inbound action to ever happen.
-				uint8_t buffer[1];
-				ssize_t recvResult = recv(state->clientDescriptors[c].fd, buffer, 1, 0);
-
-				if (recvResult <= 0) {
-					// Recv failure or closed connection.
-					close(state->clientDescriptors[c].fd);
-					caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString,
-						"Disconnected TCP client on recv (fd %d).", state->clientDescriptors[c].fd);
-					state->clientDescriptors[c].fd = -1;
-				}
-				else {
-					// Incoming data: what?
-					caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
-						"Incoming data from client on TCP server. Clients should never send data!");
-				}
+				caerOutputNetTCPServerReceiveSubscription(moduleData, c);
 			}
 		}
 	}
@@ -197,6 +246,8 @@ static void caerOutputNetTCPServerConnectionHandler(caerModuleData moduleData) {
 			if (state->clientDescriptors[c].fd == -1) {
 				// Empty place in watch list, add this one.
 				state->clientDescriptors[c].fd = acceptResult;
+				state->clients[c].group = NULL;
+				state->clients[c].messageLength = 0;
 				putInFDList = true;
 				break;
 			}
@@ -215,6 +266,218 @@ static void caerOutputNetTCPServerConnectionHandler(caerModuleData moduleData) {
 	}
 }
 
+static void caerOutputNetTCPServerReceiveSubscription(caerModuleData moduleData, size_t client) {
+	netTCPState state = moduleData->moduleState;
+	struct netTCP_client *clientState = &state->clients[client];
+
+	// Only subscription messages or close() are ever expected from clients.
+	// Messages may arrive in pieces, so collect them until complete.
+	ssize_t recvResult = recv(state->clientDescriptors[client].fd,
+		clientState->messageBuffer + clientState->messageLength,
+		CAER_NET_SUBSCRIPTION_SIZE - clientState->messageLength, 0);
+
+	if (recvResult <= 0) {
+		// Recv failure or closed connection.
+		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Disconnected TCP client on recv (fd %d).",
+			state->clientDescriptors[client].fd);
+		caerOutputNetTCPServerCloseClient(state, client);
+		return;
+	}
+
+	clientState->messageLength += (size_t) recvResult;
+	if (clientState->messageLength < CAER_NET_SUBSCRIPTION_SIZE) {
+		return;
+	}
+
+	clientState->messageLength = 0;
+
+	struct caer_net_subscription subscription;
+	memcpy(&subscription, clientState->messageBuffer, CAER_NET_SUBSCRIPTION_SIZE);
+
+	if (!caerNetSubscriptionParse(&subscription)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Invalid subscription message from TCP client (fd %d), ignoring it.", state->clientDescriptors[client].fd);
+		return;
+	}
+
+	// Leave the old group, and join one with the same subscription, if any
+	// other client already has it, else start a new one.
+	subscriptionGroupRelease(clientState->group);
+	clientState->group = NULL;
+
+	for (size_t c = 0; c < state->clientDescriptorsLength; c++) {
+		if (c != client && state->clientDescriptors[c].fd >= 0 && state->clients[c].group != NULL
+			&& memcmp(&state->clients[c].group->subscription, &subscription, CAER_NET_SUBSCRIPTION_SIZE) == 0) {
+			clientState->group = state->clients[c].group;
+			clientState->group->references++;
+			break;
+		}
+	}
+
+	if (clientState->group == NULL) {
+		clientState->group = calloc(1, sizeof(struct netTCP_subscription_group));
+		if (clientState->group == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Could not allocate memory for TCP client subscription (fd %d), sending everything. Error: %d.",
+				state->clientDescriptors[client].fd, errno);
+			return;
+		}
+
+		clientState->group->subscription = subscription;
+		clientState->group->references = 1;
+		clientState->group->rateTokens = (double) subscription.maxRate;
+		portable_clock_gettime_monotonic(&clientState->group->rateLastRefill);
+	}
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString,
+		"TCP client (fd %d) subscribed: types 0x%" PRIx32 ", ROI %" PRIu16 ",%" PRIu16 "-%" PRIu16 ",%" PRIu16
+		", subsample %" PRIu16 ", max rate %" PRIu32 " events/s.", state->clientDescriptors[client].fd,
+		subscription.typeMask, subscription.roiStartX, subscription.roiStartY, subscription.roiEndX,
+		subscription.roiEndY, subscription.subsample, subscription.maxRate);
+}
+
+static void caerOutputNetTCPServerCloseClient(netTCPState state, size_t client) {
+	close(state->clientDescriptors[client].fd);
+	state->clientDescriptors[client].fd = -1;
+
+	subscriptionGroupRelease(state->clients[client].group);
+	state->clients[client].group = NULL;
+	state->clients[client].messageLength = 0;
+}
+
+static void subscriptionGroupRelease(netTCPSubscriptionGroup group) {
+	if (group == NULL) {
+		return;
+	}
+
+	group->references--;
+
+	if (group->references == 0) {
+		free(group->filterMemory);
+		free(group);
+	}
+}
+
+// Apply a group's subscription to a packet. Returns the packet itself if
+// it can be sent unchanged, a filtered copy (holding only valid events,
+// owned by the group) or NULL if nothing is left to send.
+static caerEventPacketHeader subscriptionGroupFilter(netTCPSubscriptionGroup group, caerEventPacketHeader packetHeader) {
+	caerNetSubscriptionConst subscription = &group->subscription;
+	int16_t eventType = caerEventPacketHeaderGetEventType(packetHeader);
+
+	if (!caerNetSubscriptionWantsType(subscription, eventType)) {
+		return (NULL);
+	}
+
+	// Whole packets: no per-event filters, or special events, which carry
+	// timestamp resets and such and must always get through.
+	if (!caerNetSubscriptionFiltersEvents(subscription) || eventType == SPECIAL_EVENT) {
+		return (packetHeader);
+	}
+
+	size_t eventSize = (size_t) caerEventPacketHeaderGetEventSize(packetHeader);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packetHeader);
+	size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE + (eventSize * (size_t) eventNumber);
+
+	if (packetSize > group->filterMemorySize) {
+		uint8_t *newMemory = realloc(group->filterMemory, packetSize);
+		if (newMemory == NULL) {
+			// Better to send everything than nothing.
+			return (packetHeader);
+		}
+
+		group->filterMemory = newMemory;
+		group->filterMemorySize = packetSize;
+	}
+
+	uint8_t *filteredEvents = group->filterMemory + CAER_EVENT_PACKET_HEADER_SIZE;
+	size_t keptEvents = 0;
+
+	bool checkROI = (eventType == POLARITY_EVENT) && caerNetSubscriptionHasROI(subscription);
+
+	for (int32_t i = 0; i < eventNumber; i++) {
+		const void *event = caerGenericEventGetEvent(packetHeader, i);
+
+		if (!caerGenericEventIsValid(event)) {
+			continue;
+		}
+
+		if (checkROI) {
+			caerPolarityEvent polarity = caerPolarityEventPacketGetEvent((caerPolarityEventPacket) packetHeader, i);
+			uint16_t x = caerPolarityEventGetX(polarity);
+			uint16_t y = caerPolarityEventGetY(polarity);
+
+			if (x < subscription->roiStartX || x > subscription->roiEndX || y < subscription->roiStartY
+				|| y > subscription->roiEndY) {
+				continue;
+			}
+		}
+
+		// Subsample the events that passed the ROI, keeping the stride
+		// across packet boundaries.
+		if (subscription->subsample > 1) {
+			uint32_t position = group->subsampleCounter++;
+			if (group->subsampleCounter == subscription->subsample) {
+				group->subsampleCounter = 0;
+			}
+
+			if (position != 0) {
+				continue;
+			}
+		}
+
+		memcpy(filteredEvents + (keptEvents * eventSize), event, eventSize);
+		keptEvents++;
+	}
+
+	if (subscription->maxRate != 0 && keptEvents > 0) {
+		// Refill the token bucket, holding up to one second of events.
+		struct timespec now;
+		portable_clock_gettime_monotonic(&now);
+
+		double elapsed = (double) (now.tv_sec - group->rateLastRefill.tv_sec)
+			+ ((double) (now.tv_nsec - group->rateLastRefill.tv_nsec) / 1000000000);
+		group->rateLastRefill = now;
+
+		group->rateTokens += elapsed * (double) subscription->maxRate;
+		if (group->rateTokens > (double) subscription->maxRate) {
+			group->rateTokens = (double) subscription->maxRate;
+		}
+
+		size_t allowedEvents = (size_t) group->rateTokens;
+
+		if (allowedEvents < keptEvents) {
+			// Thin out evenly over the whole packet, instead of cutting off
+			// its end, to keep covering all of its time span.
+			size_t outEvents = 0;
+
+			for (size_t i = 0; i < keptEvents; i++) {
+				if ((((i + 1) * allowedEvents) / keptEvents) > ((i * allowedEvents) / keptEvents)) {
+					memmove(filteredEvents + (outEvents * eventSize), filteredEvents + (i * eventSize), eventSize);
+					outEvents++;
+				}
+			}
+
+			keptEvents = outEvents;
+		}
+
+		group->rateTokens -= (double) keptEvents;
+	}
+
+	if (keptEvents == 0) {
+		return (NULL);
+	}
+
+	memcpy(group->filterMemory, packetHeader, CAER_EVENT_PACKET_HEADER_SIZE);
+
+	caerEventPacketHeader filteredHeader = (caerEventPacketHeader) group->filterMemory;
+	caerEventPacketHeaderSetEventCapacity(filteredHeader, (int32_t) keptEvents);
+	caerEventPacketHeaderSetEventNumber(filteredHeader, (int32_t) keptEvents);
+	caerEventPacketHeaderSetEventValid(filteredHeader, (int32_t) keptEvents);
+
+	return (filteredHeader);
+}
+
 static void caerOutputNetTCPServerRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
 	netTCPState state = moduleData->moduleState;
 
@@ -231,12 +494,55 @@ static void caerOutputNetTCPServerRun(caerModuleData moduleData, size_t argsNumb
 		if (packetHeader != NULL) {
 			if ((state->validOnly && caerEventPacketHeaderGetEventValid(packetHeader) > 0)
 				|| (!state->validOnly && caerEventPacketHeaderGetEventNumber(packetHeader) > 0)) {
+				// Apply rate limits, this may drop or subsample the packet.
+				caerEventPacketHeader sendPacket = packetHeader;
+				bool validOnly = state->validOnly;
+
+				if (state->rateLimiter != NULL) {
+					sendPacket = caerOutputCommonRateLimit(state->rateLimiter, packetHeader, &validOnly);
+					if (sendPacket == NULL) {
+						continue;
+					}
+				}
+
+				// New packet: every subscription group has to filter it again.
+				state->packetGeneration++;
+
 				// Send to each connected client.
 				for (size_t c = 0; c < state->clientDescriptorsLength; c++) {
 					if (state->clientDescriptors[c].fd >= 0) {
-						caerOutputCommonSend(moduleData->moduleSubSystemString, packetHeader,
-							state->clientDescriptors[c].fd, state->sgioMemory, state->validOnly, state->excludeHeader,
-							state->maxBytesPerPacket, false);
+						caerEventPacketHeader clientPacket = sendPacket;
+						bool clientValidOnly = validOnly;
+
+						netTCPSubscriptionGroup group = state->clients[c].group;
+						if (group != NULL) {
+							// Filter once per group, the first client of a
+							// group to see this packet does it for all others.
+							if (group->filteredGeneration != state->packetGeneration) {
+								group->filteredGeneration = state->packetGeneration;
+								group->filteredPacket = subscriptionGroupFilter(group, sendPacket);
+							}
+
+							clientPacket = group->filteredPacket;
+							if (clientPacket == NULL) {
+								continue;
+							}
+
+							// Filtered copies only contain valid events.
+							clientValidOnly = (clientPacket == sendPacket) && validOnly;
+						}
+
+						if (state->checksum) {
+							caerOutputCommonSendChecksum(moduleData->moduleSubSystemString, clientPacket,
+								state->clientDescriptors[c].fd, state->compactBuffer, state->deltaBuffer,
+								clientValidOnly);
+						}
+						else {
+							caerOutputCommonSend(moduleData->moduleSubSystemString, clientPacket,
+								state->clientDescriptors[c].fd, state->sgioMemory, state->compactBuffer,
+								state->deltaBuffer, clientValidOnly, state->excludeHeader, state->maxBytesPerPacket,
+								NULL);
+						}
 					}
 				}
 			}
@@ -284,6 +590,13 @@ static void caerOutputNetTCPServerConfig(caerModuleData moduleData) {
 	if (configUpdate & (0x01 << 3)) {
 		state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 		state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+		state->checksum = sshsNodeGetBool(moduleData->moduleNode, "checksum");
+		caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
+	}
+
+	if (configUpdate & (0x01 << 4)) {
+		// Rate limiter settings changed.
+		caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
 	}
 
 	if (configUpdate & (0x01 << 1)) {
@@ -353,32 +666,45 @@ static void caerOutputNetTCPServerConfig(caerModuleData moduleData) {
 			return;
 		}
 
+		struct netTCP_client *newClientsArray = calloc(newConnectionsLimit, sizeof(*newClientsArray));
+		if (newClientsArray == NULL) {
+			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+				"Could not allocate memory for TCP client subscriptions. Error: %d.", errno);
+			free(newConnectionsArray);
+			return;
+		}
+
 		// Initialize connected clients array to empty.
-		// We only care about checking inbound data to detect close() from the client.
+		// We only care about checking inbound data to detect close() from the
+		// client, or subscription messages.
 		for (size_t c = 0; c < newConnectionsLimit; c++) {
 			newConnectionsArray[c].fd = -1;
 			newConnectionsArray[c].events = POLLIN;
 		}
 
 		// Copy over as many already established connections as possible, so as
-		// to not interrupt them. Once the limit is reached, close() any others.
+		// to not interrupt them, together with their subscriptions. Once the
+		// limit is reached, close() any others.
 		for (size_t c = 0, i = 0; c < state->clientDescriptorsLength; c++) {
 			if (state->clientDescriptors[c].fd >= 0) {
 				if (i < newConnectionsLimit) {
+					newClientsArray[i] = state->clients[c];
 					newConnectionsArray[i++].fd = state->clientDescriptors[c].fd;
+
+					state->clientDescriptors[c].fd = -1;
 				}
 				else {
 					// Close any descriptors that have no free slot anymore.
-					close(state->clientDescriptors[c].fd);
+					caerOutputNetTCPServerCloseClient(state, c);
 				}
-
-				state->clientDescriptors[c].fd = -1;
 			}
 		}
 
 		// And now exchange the two connection arrays.
 		free(state->clientDescriptors);
 		state->clientDescriptors = newConnectionsArray;
+		free(state->clients);
+		state->clients = newClientsArray;
 		state->clientDescriptorsLength = newConnectionsLimit;
 	}
 }
@@ -389,25 +715,34 @@ static void caerOutputNetTCPServerExit(caerModuleData moduleData) {
 
 	netTCPState state = moduleData->moduleState;
 
-	// Close all open connections to clients.
+	// Close all open connections to clients, dropping their subscriptions.
 	for (size_t c = 0; c < state->clientDescriptorsLength; c++) {
 		if (state->clientDescriptors[c].fd >= 0) {
-			close(state->clientDescriptors[c].fd);
-			state->clientDescriptors[c].fd = -1;
+			caerOutputNetTCPServerCloseClient(state, c);
 		}
 	}
 
 	// Free memory associated with the client descriptors.
 	free(state->clientDescriptors);
 	state->clientDescriptors = NULL;
+	free(state->clients);
+	state->clients = NULL;
 	state->clientDescriptorsLength = 0;
 
 	// Close open TCP server socket.
 	close(state->serverDescriptor);
 
-	// Make sure to free scatter/gather IO memory.
+	// Make sure to free scatter/gather IO and compression memory.
 	free(state->sgioMemory);
 	state->sgioMemory = NULL;
+
+	caerDeltaBufferFree(state->deltaBuffer);
+	state->deltaBuffer = NULL;
+
+	caerOutputCommonRateLimitFree(&state->rateLimiter);
+
+	caerValidCompactBufferFree(state->compactBuffer);
+	state->compactBuffer = NULL;
 }
 
 static void caerOutputNetTCPServerConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -433,9 +768,14 @@ static void caerOutputNetTCPServerConfigListener(sshsNode node, void *userData,
 			atomic_fetch_or(&data->configUpdate, (0x01 << 2));
 		}
 
-		if ((changeType == BOOL && caerStrEquals(changeKey, "excludeHeader"))
-			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))) {
+		if ((changeType == BOOL && (caerStrEquals(changeKey, "excludeHeader") || caerStrEquals(changeKey, "checksum")))
+			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))
+			|| (changeType == STRING && caerStrEquals(changeKey, "format"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 3));
 		}
+
+		if (caerOutputCommonRateLimitSetting(changeKey, changeType)) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 4));
+		}
 	}
 }
@@ -1,6 +1,10 @@
 #include "net_udp.h"
 #include "base/mainloop.h"
 #include "base/module.h"
+#include "ext/portable_time.h"
+#include "ext/udpstream.h"
+#include "ext/c11threads_posix.h"
+#include "ext/ringbuffer/ringbuffer.h"
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -11,14 +15,69 @@ struct netUDP_state {
 	bool excludeHeader;
 	size_t maxBytesPerPacket;
 	struct iovec *sgioMemory;
+	caerValidCompactBuffer compactBuffer;
+	caerDeltaBuffer deltaBuffer;
+	caerOutputCommonRateLimiter rateLimiter;
+	// Stream framing: sequence numbers, source timestamps and FEC.
+	bool streamHeader;
+	uint32_t sequenceNumber;
+	uint16_t fecGroupSize;
+	uint16_t fecGroupIndex;
+	uint32_t fecGroupStart;
+	uint16_t fecLengthXOR;
+	size_t fecMaxLength;
+	uint8_t *fecParity;
+	// Token-bucket pacing, rate in bytes per second (0 = disabled). Paced
+	// datagrams are queued for a sender thread, so Run never has to wait.
+	double pacingRate;
+	double pacingBurst;
+	double pacingTokens;
+	struct timespec pacingLastRefill;
+	RingBuffer pacingQueue;
+	thrd_t pacingThread;
+	atomic_bool pacingRunning;
+	// Statistics.
+	uint64_t pacingDroppedDatagrams;
+	uint64_t oversizeDatagrams;
+	struct timespec lastStatistics;
 };
 
 typedef struct netUDP_state *netUDPState;
 
+// A datagram waiting in the pacing queue: stream header and payload.
+struct netUDP_paced_datagram {
+	size_t length;
+	uint8_t data[];
+};
+
+// Maximum number of datagrams waiting to be paced out. Once full, new
+// datagrams are dropped (and counted), the same as a full socket buffer.
+#define PACING_QUEUE_SIZE 1024
+
+// How long the sender thread sleeps when it has nothing to send, and at most
+// in one go while waiting for tokens, so it notices being stopped.
+#define PACING_IDLE_SLEEP_NS 500000
+#define PACING_MAX_SLEEP_NS 10000000
+
 static bool caerOutputNetUDPInit(caerModuleData moduleData);
 static void caerOutputNetUDPRun(caerModuleData moduleData, size_t argsNumber, va_list args);
 static void caerOutputNetUDPConfig(caerModuleData moduleData);
 static void caerOutputNetUDPExit(caerModuleData moduleData);
+static int openUDPSocket(caerModuleData moduleData);
+static void updateStreamSettings(caerModuleData moduleData);
+static void streamSendPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly);
+static void streamSendChunks(void *handlerState, struct msghdr *chunks, size_t chunksLength);
+static void streamSendDatagram(netUDPState state, struct caer_udp_stream_header *streamHeader,
+	struct iovec *payload, size_t payloadIOLength);
+static void streamSendParity(netUDPState state);
+static void streamWriteDatagram(int fileDescriptor, struct iovec *datagram, size_t datagramIOLength);
+static void streamExcludeHeaderCheck(caerModuleData moduleData);
+static bool pacingStart(caerModuleData moduleData);
+static void pacingStop(caerModuleData moduleData);
+static void pacingFlush(netUDPState state);
+static int pacingThread(void *stateArg);
+static bool pacingWait(netUDPState state, size_t bytes);
+static void publishStatistics(caerModuleData moduleData, bool force);
 
 static struct caer_module_functions caerOutputNetUDPFunctions = { .moduleInit = &caerOutputNetUDPInit, .moduleRun =
 	&caerOutputNetUDPRun, .moduleConfig = &caerOutputNetUDPConfig, .moduleExit = &caerOutputNetUDPExit };
@@ -45,28 +104,28 @@ static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "validEventsOnly", false);
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "excludeHeader", false);
 	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxBytesPerPacket", 0);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "format", "RAW");
+	caerOutputCommonRateLimitDefaults(moduleData->moduleNode);
 
-	// Open a UDP socket to the remote client, to which we'll send data packets.
-	state->netUDPDescriptor = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-	if (state->netUDPDescriptor < 0) {
-		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create UDP socket. Error: %d.", errno);
-		return (false);
-	}
+	// Multicast destinations (224.0.0.0/4) are detected from ipAddress.
+	sshsNodePutByteIfAbsent(moduleData->moduleNode, "multicastTTL", 1);
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "multicastLoop", true);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "multicastInterface", "");
 
-	struct sockaddr_in udpClient;
-	memset(&udpClient, 0, sizeof(struct sockaddr_in));
+	// Stream framing (needed by NetUDPInput), pacing and FEC.
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "streamHeader", false);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "pacingRate", 0); // In Kbit/s.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "pacingBurst", 65536); // In bytes.
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "fecGroupSize", 0);
 
-	udpClient.sin_family = AF_INET;
-	udpClient.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
-	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
-	inet_aton(ipAddress, &udpClient.sin_addr); // htonl() is implicit here.
-	free(ipAddress);
+	// Statistics.
+	sshsNodePutLong(moduleData->moduleNode, "pacingDroppedDatagrams", 0);
+	sshsNodePutLong(moduleData->moduleNode, "oversizeDatagrams", 0);
+	portable_clock_gettime_monotonic(&state->lastStatistics);
 
-	if (connect(state->netUDPDescriptor, (struct sockaddr *) &udpClient, sizeof(struct sockaddr_in)) != 0) {
-		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-			"Could not connect to remote UDP client %s:%" PRIu16 ". Error: %d.", inet_ntoa(udpClient.sin_addr),
-			ntohs(udpClient.sin_port), errno);
-		close(state->netUDPDescriptor);
+	// Open a UDP socket to the remote client, to which we'll send data packets.
+	state->netUDPDescriptor = openUDPSocket(moduleData);
+	if (state->netUDPDescriptor < 0) {
 		return (false);
 	}
 
@@ -74,6 +133,7 @@ static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 	state->validOnly = sshsNodeGetBool(moduleData->moduleNode, "validEventsOnly");
 	state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 	state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+	caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
 
 	if (state->validOnly) {
 		state->sgioMemory = calloc(IOVEC_SIZE, sizeof(struct iovec));
@@ -90,12 +150,22 @@ static bool caerOutputNetUDPInit(caerModuleData moduleData) {
 		state->sgioMemory = NULL;
 	}
 
+	// Reusable memory for compacting valid events, when they can't be sent
+	// using scatter/gather IO. Without it, temporary memory is used instead.
+	state->compactBuffer = caerValidCompactBufferInit();
+	if (state->compactBuffer == NULL) {
+		caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+			"Impossible to allocate memory for valid event compaction, using temporary memory.");
+	}
+
+	updateStreamSettings(moduleData);
+
+	// Rate limits, if any are set.
+	caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputNetUDPConfigListener);
 
-	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "UDP socket connected to %s:%" PRIu16 ".",
-		inet_ntoa(udpClient.sin_addr), ntohs(udpClient.sin_port));
-
 	return (true);
 }
 
@@ -112,11 +182,30 @@ static void caerOutputNetUDPRun(caerModuleData moduleData, size_t argsNumber, va
 		if (packetHeader != NULL) {
 			if ((state->validOnly && caerEventPacketHeaderGetEventValid(packetHeader) > 0)
 				|| (!state->validOnly && caerEventPacketHeaderGetEventNumber(packetHeader) > 0)) {
-				caerOutputCommonSend(moduleData->moduleSubSystemString, packetHeader, state->netUDPDescriptor,
-					state->sgioMemory, state->validOnly, state->excludeHeader, state->maxBytesPerPacket, false);
+				// Apply rate limits, this may drop or subsample the packet.
+				caerEventPacketHeader sendPacket = packetHeader;
+				bool validOnly = state->validOnly;
+
+				if (state->rateLimiter != NULL) {
+					sendPacket = caerOutputCommonRateLimit(state->rateLimiter, packetHeader, &validOnly);
+					if (sendPacket == NULL) {
+						continue;
+					}
+				}
+
+				if (state->streamHeader) {
+					streamSendPacket(moduleData, sendPacket, validOnly);
+				}
+				else {
+					caerOutputCommonSend(moduleData->moduleSubSystemString, sendPacket, state->netUDPDescriptor,
+						state->sgioMemory, state->compactBuffer, state->deltaBuffer, validOnly,
+						state->excludeHeader, state->maxBytesPerPacket, NULL);
+				}
 			}
 		}
 	}
+
+	publishStatistics(moduleData, false);
 }
 
 static void caerOutputNetUDPConfig(caerModuleData moduleData) {
@@ -159,38 +248,41 @@ static void caerOutputNetUDPConfig(caerModuleData moduleData) {
 	if (configUpdate & (0x01 << 2)) {
 		state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 		state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+		caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
+
+		streamExcludeHeaderCheck(moduleData);
+	}
+
+	if (configUpdate & (0x01 << 3)) {
+		updateStreamSettings(moduleData);
+	}
+
+	if (configUpdate & (0x01 << 4)) {
+		// Rate limiter settings changed.
+		caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
 	}
 
 	if (configUpdate & (0x01 << 1)) {
 		// UDP client address related changes.
 		// Open a UDP socket to the new remote client, to which we'll send data packets.
-		int newNetUDPDescriptor = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		int newNetUDPDescriptor = openUDPSocket(moduleData);
 		if (newNetUDPDescriptor < 0) {
-			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create UDP socket. Error: %d.",
-			errno);
 			return;
 		}
 
-		struct sockaddr_in udpClient;
-		memset(&udpClient, 0, sizeof(struct sockaddr_in));
-
-		udpClient.sin_family = AF_INET;
-		udpClient.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
-		char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
-		inet_aton(ipAddress, &udpClient.sin_addr); // htonl() is implicit here.
-		free(ipAddress);
-
-		if (connect(newNetUDPDescriptor, (struct sockaddr *) &udpClient, sizeof(struct sockaddr_in)) != 0) {
-			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
-				"Could not connect to remote UDP client %s:%" PRIu16 ". Error: %d.", inet_ntoa(udpClient.sin_addr),
-				ntohs(udpClient.sin_port), errno);
-			close(newNetUDPDescriptor);
-			return;
+		// New fd ready and connected, close old and set new. The pacing thread
+		// is paused meanwhile, still queued datagrams go to the new client.
+		bool pacing = atomic_load(&state->pacingRunning);
+		if (pacing) {
+			pacingStop(moduleData);
 		}
 
-		// New fd ready and connected, close old and set new.
 		close(state->netUDPDescriptor);
 		state->netUDPDescriptor = newNetUDPDescriptor;
+
+		if (pacing) {
+			pacingStart(moduleData);
+		}
 	}
 }
 
@@ -200,12 +292,34 @@ static void caerOutputNetUDPExit(caerModuleData moduleData) {
 
 	netUDPState state = moduleData->moduleState;
 
-	// Close open UDP socket.
+	// Finish the current FEC group, send out anything still waiting to be
+	// paced, then close open UDP socket.
+	if (state->streamHeader && state->fecGroupIndex > 0) {
+		streamSendParity(state);
+	}
+
+	pacingStop(moduleData);
+	pacingFlush(state);
+
+	ringBufferFree(state->pacingQueue);
+	state->pacingQueue = NULL;
+
 	close(state->netUDPDescriptor);
 
-	// Make sure to free scatter/gather IO memory.
+	// Make sure to free scatter/gather IO and compression memory.
 	free(state->sgioMemory);
 	state->sgioMemory = NULL;
+
+	caerDeltaBufferFree(state->deltaBuffer);
+	state->deltaBuffer = NULL;
+
+	caerOutputCommonRateLimitFree(&state->rateLimiter);
+
+	caerValidCompactBufferFree(state->compactBuffer);
+	state->compactBuffer = NULL;
+
+	free(state->fecParity);
+	state->fecParity = NULL;
 }
 
 static void caerOutputNetUDPConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -223,13 +337,509 @@ static void caerOutputNetUDPConfigListener(sshsNode node, void *userData, enum s
 		}
 
 		if ((changeType == STRING && caerStrEquals(changeKey, "ipAddress"))
-			|| (changeType == SHORT && caerStrEquals(changeKey, "portNumber"))) {
+			|| (changeType == SHORT && caerStrEquals(changeKey, "portNumber"))
+			|| (changeType == BYTE && caerStrEquals(changeKey, "multicastTTL"))
+			|| (changeType == BOOL && caerStrEquals(changeKey, "multicastLoop"))
+			|| (changeType == STRING && caerStrEquals(changeKey, "multicastInterface"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 1));
 		}
 
 		if ((changeType == BOOL && caerStrEquals(changeKey, "excludeHeader"))
-			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))) {
+			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))
+			|| (changeType == STRING && caerStrEquals(changeKey, "format"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 2));
 		}
+
+		if ((changeType == BOOL && caerStrEquals(changeKey, "streamHeader"))
+			|| (changeType == INT && caerStrEquals(changeKey, "pacingRate"))
+			|| (changeType == INT && caerStrEquals(changeKey, "pacingBurst"))
+			|| (changeType == SHORT && caerStrEquals(changeKey, "fecGroupSize"))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 3));
+		}
+
+		if (caerOutputCommonRateLimitSetting(changeKey, changeType)) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 4));
+		}
+	}
+}
+
+// Open a UDP socket connected to the configured remote client. For multicast
+// groups, also apply the multicast settings. Returns -1 on failure.
+static int openUDPSocket(caerModuleData moduleData) {
+	int udpDescriptor = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (udpDescriptor < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create UDP socket. Error: %d.", errno);
+		return (-1);
+	}
+
+	struct sockaddr_in udpClient;
+	memset(&udpClient, 0, sizeof(struct sockaddr_in));
+
+	udpClient.sin_family = AF_INET;
+	udpClient.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
+	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
+	inet_aton(ipAddress, &udpClient.sin_addr); // htonl() is implicit here.
+	free(ipAddress);
+
+	bool multicast = IN_MULTICAST(ntohl(udpClient.sin_addr.s_addr));
+
+	if (multicast) {
+		// Limit how far the datagrams travel, one hop (the local network) by default.
+		unsigned char ttl = (unsigned char) sshsNodeGetByte(moduleData->moduleNode, "multicastTTL");
+		if (setsockopt(udpDescriptor, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) != 0) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Could not set multicast TTL. Error: %d.",
+			errno);
+		}
+
+		// Deliver to listeners on this same machine too.
+		unsigned char loop = sshsNodeGetBool(moduleData->moduleNode, "multicastLoop");
+		if (setsockopt(udpDescriptor, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) != 0) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Could not set multicast loop. Error: %d.",
+			errno);
+		}
+
+		// Send over a specific interface, identified by its IP address.
+		char *interfaceAddress = sshsNodeGetString(moduleData->moduleNode, "multicastInterface");
+
+		if (!caerStrEquals(interfaceAddress, "")) {
+			struct in_addr multicastInterface;
+
+			if (inet_aton(interfaceAddress, &multicastInterface) == 0
+				|| setsockopt(udpDescriptor, IPPROTO_IP, IP_MULTICAST_IF, &multicastInterface,
+					sizeof(struct in_addr)) != 0) {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+					"Could not set multicast interface '%s', using default. Error: %d.", interfaceAddress, errno);
+			}
+		}
+
+		free(interfaceAddress);
+	}
+
+	if (connect(udpDescriptor, (struct sockaddr *) &udpClient, sizeof(struct sockaddr_in)) != 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not connect to remote UDP client %s:%" PRIu16 ". Error: %d.", inet_ntoa(udpClient.sin_addr),
+			ntohs(udpClient.sin_port), errno);
+		close(udpDescriptor);
+		return (-1);
+	}
+
+	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "UDP socket connected to %s %s:%" PRIu16 ".",
+		(multicast) ? ("multicast group") : ("client"), inet_ntoa(udpClient.sin_addr), ntohs(udpClient.sin_port));
+
+	return (udpDescriptor);
+}
+
+static void updateStreamSettings(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	// Close the current FEC group with what it has, before anything changes.
+	if (state->streamHeader && state->fecGroupIndex > 0) {
+		streamSendParity(state);
+	}
+
+	// The pacing state belongs to the sender thread while it runs.
+	pacingStop(moduleData);
+
+	state->streamHeader = sshsNodeGetBool(moduleData->moduleNode, "streamHeader");
+
+	int16_t fecGroupSize = sshsNodeGetShort(moduleData->moduleNode, "fecGroupSize");
+	if (fecGroupSize < 0) {
+		fecGroupSize = 0;
+	}
+	if (fecGroupSize > CAER_UDP_STREAM_FEC_MAX_GROUP) {
+		fecGroupSize = CAER_UDP_STREAM_FEC_MAX_GROUP;
+	}
+
+	if (fecGroupSize > 0 && state->fecParity == NULL) {
+		state->fecParity = calloc(1, CAER_UDP_STREAM_MAX_PAYLOAD);
+		if (state->fecParity == NULL) {
+			caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+				"Impossible to allocate memory for FEC parity, disabling FEC.");
+			fecGroupSize = 0;
+		}
+	}
+
+	state->fecGroupSize = (uint16_t) fecGroupSize;
+	state->fecGroupIndex = 0;
+
+	int32_t pacingRate = sshsNodeGetInt(moduleData->moduleNode, "pacingRate");
+	int32_t pacingBurst = sshsNodeGetInt(moduleData->moduleNode, "pacingBurst");
+
+	state->pacingRate = (pacingRate > 0) ? ((double) pacingRate * 1000 / 8) : (0);
+	state->pacingBurst = (pacingBurst > CAER_UDP_STREAM_MAX_DATAGRAM) ? (pacingBurst) : (CAER_UDP_STREAM_MAX_DATAGRAM);
+
+	if (state->streamHeader && state->pacingRate > 0) {
+		if (!pacingStart(moduleData)) {
+			state->pacingRate = 0;
+		}
+	}
+
+	// Datagrams queued before pacing was turned off still have to go out.
+	if (state->pacingRate <= 0) {
+		pacingFlush(state);
+	}
+
+	if (state->streamHeader && state->deltaBuffer != NULL) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"CAERDELTA format is not supported with stream headers, sending RAW packets.");
+	}
+
+	streamExcludeHeaderCheck(moduleData);
+}
+
+// NetUDPInput needs the packet header in every datagram to decode it, so
+// excludeHeader can't be used together with stream headers.
+static void streamExcludeHeaderCheck(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	if (state->streamHeader && state->excludeHeader) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"excludeHeader is not supported with stream headers, disabling it.");
+
+		state->excludeHeader = false;
+		sshsNodePutBool(moduleData->moduleNode, "excludeHeader", false);
+	}
+}
+
+static void streamSendPacket(caerModuleData moduleData, caerEventPacketHeader packetHeader, bool validOnly) {
+	netUDPState state = moduleData->moduleState;
+
+	// Each datagram must be a complete packet, so the packet is always split
+	// at event boundaries, up to the maximum size of a datagram.
+	size_t maxDatagram = state->maxBytesPerPacket;
+	if (maxDatagram == 0) {
+		maxDatagram = CAER_UDP_STREAM_DEFAULT_DATAGRAM;
+	}
+	if (maxDatagram > CAER_UDP_STREAM_MAX_DATAGRAM) {
+		maxDatagram = CAER_UDP_STREAM_MAX_DATAGRAM;
+	}
+
+	// Get the events to send in one contiguous block.
+	int32_t oldCapacity = caerEventPacketHeaderGetEventCapacity(packetHeader);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packetHeader);
+
+	caerEventPacketHeader sendPacket = packetHeader;
+	uint8_t *validPacket = NULL;
+
+	if (validOnly && caerEventPacketHeaderGetEventValid(packetHeader) != eventNumber) {
+		if (state->compactBuffer != NULL) {
+			validPacket = caerValidCompactBufferReserve(state->compactBuffer, caerValidCompactPacketSize(packetHeader));
+		}
+		else {
+			validPacket = malloc(caerValidCompactPacketSize(packetHeader) + CAER_VALID_COMPACT_SLACK);
+		}
+
+		if (validPacket == NULL) {
+			caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+				"Failed to allocate memory for valid event copy.");
+			return;
+		}
+
+		caerValidCompactPacket(validPacket, packetHeader);
+		sendPacket = (caerEventPacketHeader) validPacket;
+	}
+	else {
+		// Don't send the zeroed-out tail of the packet.
+		caerEventPacketHeaderSetEventCapacity(packetHeader, eventNumber);
+	}
+
+	struct iovec eventRun;
+	eventRun.iov_base = caerGenericEventGetEvent(sendPacket, 0);
+	eventRun.iov_len = (size_t) caerEventPacketHeaderGetEventNumber(sendPacket)
+		* (size_t) caerEventPacketHeaderGetEventSize(sendPacket);
+
+	caerOutputCommonWriteChunks(state->netUDPDescriptor, &streamSendChunks, moduleData, sendPacket, &eventRun, 1,
+		state->excludeHeader, maxDatagram - CAER_UDP_STREAM_HEADER_SIZE);
+
+	if (sendPacket == packetHeader) {
+		caerEventPacketHeaderSetEventCapacity(packetHeader, oldCapacity);
+	}
+	else if (state->compactBuffer == NULL) {
+		free(validPacket);
 	}
 }
+
+static void streamSendChunks(void *handlerState, struct msghdr *chunks, size_t chunksLength) {
+	caerModuleData moduleData = handlerState;
+	netUDPState state = moduleData->moduleState;
+
+	for (size_t i = 0; i < chunksLength; i++) {
+		size_t payloadLength = 0;
+		for (size_t j = 0; j < chunks[i].msg_iovlen; j++) {
+			payloadLength += chunks[i].msg_iov[j].iov_len;
+		}
+
+		if (payloadLength > CAER_UDP_STREAM_MAX_PAYLOAD) {
+			// Single event bigger than a datagram (frames), can't be sent.
+			if (state->oversizeDatagrams == 0) {
+				caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+					"Events bigger than the maximum datagram payload of %zu bytes can't be sent with stream "
+						"headers, dropping them (see oversizeDatagrams).", (size_t) CAER_UDP_STREAM_MAX_PAYLOAD);
+			}
+
+			state->oversizeDatagrams++;
+			continue;
+		}
+
+		if (state->fecGroupSize > 0) {
+			if (state->fecGroupIndex == 0) {
+				state->fecGroupStart = state->sequenceNumber;
+			}
+
+			// Accumulate parity over the payload.
+			size_t offset = 0;
+			for (size_t j = 0; j < chunks[i].msg_iovlen; j++) {
+				caerUDPStreamXOR(state->fecParity + offset, chunks[i].msg_iov[j].iov_base,
+					chunks[i].msg_iov[j].iov_len);
+				offset += chunks[i].msg_iov[j].iov_len;
+			}
+
+			state->fecLengthXOR ^= (uint16_t) payloadLength;
+			if (payloadLength > state->fecMaxLength) {
+				state->fecMaxLength = payloadLength;
+			}
+		}
+
+		struct caer_udp_stream_header streamHeader;
+		caerUDPStreamHeaderSet(&streamHeader, state->sequenceNumber++, 0, 0, state->fecGroupSize,
+			state->fecGroupIndex, (uint16_t) payloadLength);
+
+		streamSendDatagram(state, &streamHeader, chunks[i].msg_iov, chunks[i].msg_iovlen);
+
+		if (state->fecGroupSize > 0) {
+			state->fecGroupIndex++;
+
+			if (state->fecGroupIndex == state->fecGroupSize) {
+				streamSendParity(state);
+			}
+		}
+	}
+}
+
+// Send one datagram: the stream header followed by the payload. Without
+// pacing, it is written right away. With pacing, it is copied into the queue
+// of the sender thread, or dropped if that is full.
+static void streamSendDatagram(netUDPState state, struct caer_udp_stream_header *streamHeader,
+	struct iovec *payload, size_t payloadIOLength) {
+	struct iovec datagram[1 + IOVEC_SIZE];
+
+	datagram[0].iov_base = streamHeader;
+	datagram[0].iov_len = CAER_UDP_STREAM_HEADER_SIZE;
+
+	size_t datagramIOLength = 1;
+	size_t datagramBytes = CAER_UDP_STREAM_HEADER_SIZE;
+
+	for (size_t i = 0; i < payloadIOLength && i < IOVEC_SIZE; i++) {
+		datagram[datagramIOLength++] = payload[i];
+		datagramBytes += payload[i].iov_len;
+	}
+
+	if (!atomic_load_explicit(&state->pacingRunning, memory_order_relaxed)) {
+		streamWriteDatagram(state->netUDPDescriptor, datagram, datagramIOLength);
+		return;
+	}
+
+	struct netUDP_paced_datagram *pacedDatagram = malloc(sizeof(struct netUDP_paced_datagram) + datagramBytes);
+	if (pacedDatagram == NULL) {
+		state->pacingDroppedDatagrams++;
+		return;
+	}
+
+	pacedDatagram->length = 0;
+
+	for (size_t i = 0; i < datagramIOLength; i++) {
+		memcpy(pacedDatagram->data + pacedDatagram->length, datagram[i].iov_base, datagram[i].iov_len);
+		pacedDatagram->length += datagram[i].iov_len;
+	}
+
+	if (!ringBufferPut(state->pacingQueue, pacedDatagram)) {
+		// Sender thread can't keep up with the pacing rate.
+		free(pacedDatagram);
+		state->pacingDroppedDatagrams++;
+	}
+}
+
+// Write out a datagram, its first element being the stream header. The source
+// timestamp is set here, after any pacing, to reflect the actual send time.
+static void streamWriteDatagram(int fileDescriptor, struct iovec *datagram, size_t datagramIOLength) {
+	struct caer_udp_stream_header *streamHeader = datagram[0].iov_base;
+
+	struct timespec currentTime;
+	portable_clock_gettime_realtime(&currentTime);
+
+	streamHeader->sourceTimestamp = htole64(
+		(uint64_t) currentTime.tv_sec * 1000000 + (uint64_t) currentTime.tv_nsec / 1000);
+
+	writev(fileDescriptor, datagram, (int) datagramIOLength);
+}
+
+// Send the parity datagram for the current FEC group, and start a new one.
+static void streamSendParity(netUDPState state) {
+	struct caer_udp_stream_header streamHeader;
+	caerUDPStreamHeaderSet(&streamHeader, state->fecGroupStart, 0, CAER_UDP_STREAM_FLAG_PARITY, state->fecGroupIndex,
+		0, state->fecLengthXOR);
+
+	struct iovec parity;
+	parity.iov_base = state->fecParity;
+	parity.iov_len = state->fecMaxLength;
+
+	streamSendDatagram(state, &streamHeader, &parity, 1);
+
+	memset(state->fecParity, 0, state->fecMaxLength);
+	state->fecLengthXOR = 0;
+	state->fecMaxLength = 0;
+	state->fecGroupIndex = 0;
+}
+
+// Start the pacing sender thread, with a full token bucket. The queue is kept
+// across restarts, so datagrams still waiting in it aren't lost.
+static bool pacingStart(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	if (state->pacingQueue == NULL) {
+		state->pacingQueue = ringBufferInit(PACING_QUEUE_SIZE);
+		if (state->pacingQueue == NULL) {
+			caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+				"Impossible to allocate memory for the pacing queue, disabling pacing.");
+			return (false);
+		}
+	}
+
+	state->pacingTokens = state->pacingBurst;
+	portable_clock_gettime_monotonic(&state->pacingLastRefill);
+
+	atomic_store(&state->pacingRunning, true);
+
+	if (thrd_create(&state->pacingThread, &pacingThread, state) != thrd_success) {
+		atomic_store(&state->pacingRunning, false);
+
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to start pacing thread, disabling pacing.");
+		return (false);
+	}
+
+	return (true);
+}
+
+static void pacingStop(caerModuleData moduleData) {
+	netUDPState state = moduleData->moduleState;
+
+	if (!atomic_load(&state->pacingRunning)) {
+		return;
+	}
+
+	atomic_store(&state->pacingRunning, false);
+
+	if (thrd_join(state->pacingThread, NULL) != thrd_success) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to join pacing thread.");
+	}
+}
+
+// Write out everything left in the pacing queue, without pacing. Only call
+// while the sender thread is stopped.
+static void pacingFlush(netUDPState state) {
+	if (state->pacingQueue == NULL) {
+		return;
+	}
+
+	struct netUDP_paced_datagram *pacedDatagram;
+	while ((pacedDatagram = ringBufferGet(state->pacingQueue)) != NULL) {
+		struct iovec datagram = { .iov_base = pacedDatagram->data, .iov_len = pacedDatagram->length };
+		streamWriteDatagram(state->netUDPDescriptor, &datagram, 1);
+
+		free(pacedDatagram);
+	}
+}
+
+// Sender thread: takes datagrams from the queue in order, and writes each
+// one out as soon as the token bucket allows it.
+static int pacingThread(void *stateArg) {
+	netUDPState state = stateArg;
+
+	struct netUDP_paced_datagram *pacedDatagram = NULL;
+
+	while (atomic_load_explicit(&state->pacingRunning, memory_order_relaxed)) {
+		if (pacedDatagram == NULL) {
+			pacedDatagram = ringBufferGet(state->pacingQueue);
+
+			if (pacedDatagram == NULL) {
+				struct timespec idleSleep = { .tv_sec = 0, .tv_nsec = PACING_IDLE_SLEEP_NS };
+				thrd_sleep(&idleSleep, NULL);
+				continue;
+			}
+		}
+
+		if (!pacingWait(state, pacedDatagram->length)) {
+			continue; // Stopped while waiting, check again.
+		}
+
+		struct iovec datagram = { .iov_base = pacedDatagram->data, .iov_len = pacedDatagram->length };
+		streamWriteDatagram(state->netUDPDescriptor, &datagram, 1);
+
+		free(pacedDatagram);
+		pacedDatagram = NULL;
+	}
+
+	// Stopped while holding a datagram: send it, so nothing is reordered
+	// with the ones still in the queue.
+	if (pacedDatagram != NULL) {
+		struct iovec datagram = { .iov_base = pacedDatagram->data, .iov_len = pacedDatagram->length };
+		streamWriteDatagram(state->netUDPDescriptor, &datagram, 1);
+
+		free(pacedDatagram);
+	}
+
+	return (thrd_success);
+}
+
+// Token-bucket pacing: tokens (bytes) are refilled at pacingRate, up to
+// pacingBurst. If there aren't enough for the next datagram, wait a bit.
+// This spreads the datagrams of big packets over time, instead of sending
+// them as one burst that may overflow switch buffers. Returns true once the
+// datagram may be sent, false if it has to wait longer.
+static bool pacingWait(netUDPState state, size_t bytes) {
+	struct timespec currentTime;
+	portable_clock_gettime_monotonic(&currentTime);
+
+	double elapsed = caerOutputCommonElapsed(&state->pacingLastRefill, &currentTime);
+
+	state->pacingLastRefill = currentTime;
+
+	state->pacingTokens += elapsed * state->pacingRate;
+	if (state->pacingTokens > state->pacingBurst) {
+		state->pacingTokens = state->pacingBurst;
+	}
+
+	if (state->pacingTokens >= (double) bytes) {
+		state->pacingTokens -= (double) bytes;
+		return (true);
+	}
+
+	// Sleep until enough tokens should be available, but not so long that
+	// being stopped goes unnoticed.
+	double waitTime = ((double) bytes - state->pacingTokens) / state->pacingRate;
+	long waitNs = (waitTime >= ((double) PACING_MAX_SLEEP_NS / 1000000000)) ?
+		(PACING_MAX_SLEEP_NS) : ((long) (waitTime * 1000000000));
+
+	struct timespec waitSleep = { .tv_sec = 0, .tv_nsec = waitNs };
+	thrd_sleep(&waitSleep, NULL);
+
+	return (false);
+}
+
+static void publishStatistics(caerModuleData moduleData, bool force) {
+	netUDPState state = moduleData->moduleState;
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	// Publish at most once per second.
+	if (!force && caerOutputCommonElapsed(&state->lastStatistics, &now) < 1) {
+		return;
+	}
+
+	state->lastStatistics = now;
+
+	sshsNodePutLong(moduleData->moduleNode, "pacingDroppedDatagrams", (int64_t) state->pacingDroppedDatagrams);
+	sshsNodePutLong(moduleData->moduleNode, "oversizeDatagrams", (int64_t) state->oversizeDatagrams);
+}
@@ -10,71 +10,754 @@
 
 #include "main.h"
 #include <unistd.h>
+#include <errno.h>
 #include <sys/uio.h>
+#include <sys/socket.h>
 
 #include <libcaer/events/common.h>
 #include <libcaer/events/polarity.h>
 
+#include "ext/caerdelta/caerdelta.h"
+#include "ext/crc32c/crc32c.h"
+#include "ext/validcompact/validcompact.h"
+#include "ext/portable_time.h"
+#include "base/mainloop.h" // For caerMainloopGetSourceInfo().
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	#include <arm_neon.h>
+	#define OUT_COMMON_NEON 1
+#endif
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+	#define OUT_COMMON_SENDMMSG 1
+#endif
+
 #define IOVEC_SIZE 512
 
-static inline void caerOutputCommonWriteFull(int fileDescriptor, void *startAddress, size_t fullLength,
+// Scatter/gather IO is only used for valid-only output if there are at most
+// this many invalid events, as every one of them can start a new run, and
+// many small runs are slower to build and write than compacting the valid
+// events into a contiguous buffer.
+#define SGIO_MAX_INVALID_EVENTS 16
+
+// Maximum number of chunks (datagrams) that are built up and then sent
+// with a single sendmmsg() call, when splitting by maxBytesPerPacket.
+#define CHUNK_BATCH_SIZE 32
+
+// Every packet in CAERDELTA format is framed by its header, with the number
+// of events updated to what was encoded, followed by the length of the
+// compressed payload (32 bit, little-endian), and then the payload itself.
+#define DELTA_FRAME_HEADER_SIZE (sizeof(struct caer_event_packet_header) + sizeof(uint32_t))
+
+// With checksums enabled, every packet (header, length and payload for
+// compressed ones) is followed by the little-endian CRC-32C of its bytes.
+#define CHECKSUM_TRAILER_SIZE sizeof(uint32_t)
+
+// Read the 'format' setting ("RAW" or "CAERDELTA") and allocate or free the
+// compression buffer to match it. A NULL buffer means RAW output.
+static inline void caerOutputCommonUpdateFormat(const char *subSystemString, sshsNode moduleNode,
+	caerDeltaBuffer *deltaBuffer) {
+	char *format = sshsNodeGetString(moduleNode, "format");
+
+	if (caerStrEquals(format, CAERDELTA_FORMAT_NAME)) {
+		if (*deltaBuffer == NULL) {
+			*deltaBuffer = caerDeltaBufferInit();
+			if (*deltaBuffer == NULL) {
+				caerLog(CAER_LOG_ALERT, subSystemString,
+					"Impossible to allocate memory for compression, using RAW format.");
+			}
+			else {
+				caerLog(CAER_LOG_INFO, subSystemString, "Using CAERDELTA compressed format.");
+			}
+		}
+	}
+	else {
+		if (!caerStrEquals(format, "RAW")) {
+			caerLog(CAER_LOG_WARNING, subSystemString, "Unknown format '%s', using RAW format.", format);
+		}
+
+		caerDeltaBufferFree(*deltaBuffer);
+		*deltaBuffer = NULL;
+	}
+
+	free(format);
+}
+
+/*
+ * Token-bucket rate limiting, in bytes/s and/or events/s, with priority
+ * shedding when over budget: special and IMU packets are always sent (the
+ * buckets can go into debt for them); frames are sent if they fit, or
+ * else at most at a reduced rate; everything else (mostly polarity) is
+ * subsampled down to what fits, or dropped whole. So polarity is the first
+ * to give, as it can only use what's left after the others.
+ */
+struct caer_output_common_rate_limiter {
+	sshsNode moduleNode;
+	double byteRate; // 0 = unlimited.
+	double eventRate; // 0 = unlimited.
+	double burst; // Bucket size, in seconds of rate.
+	double frameInterval; // Minimum time between frames when over budget.
+	bool subsample; // Subsample, or drop whole packets.
+	double byteTokens;
+	double eventTokens;
+	struct timespec lastRefill;
+	struct timespec lastFrame;
+	uint8_t *memory; // Subsampled packet copies.
+	size_t memorySize;
+	uint64_t shedPackets;
+	uint64_t shedEvents;
+	uint64_t shedBytes;
+	uint64_t subsampledPackets;
+	struct timespec lastStatistics;
+};
+
+typedef struct caer_output_common_rate_limiter *caerOutputCommonRateLimiter;
+
+static inline double caerOutputCommonElapsed(const struct timespec *from, const struct timespec *to) {
+	return ((double) (to->tv_sec - from->tv_sec) + ((double) (to->tv_nsec - from->tv_nsec) / 1000000000));
+}
+
+// Create the rate limiter settings, with defaults that leave it disabled.
+static inline void caerOutputCommonRateLimitDefaults(sshsNode moduleNode) {
+	sshsNodePutIntIfAbsent(moduleNode, "rateLimitBytes", 0); // In bytes/s, 0 = unlimited.
+	sshsNodePutIntIfAbsent(moduleNode, "rateLimitEvents", 0); // In events/s, 0 = unlimited.
+	sshsNodePutIntIfAbsent(moduleNode, "rateLimitBurst", 100); // In ms of rate.
+	sshsNodePutFloatIfAbsent(moduleNode, "rateLimitFrameRate", 1.0f); // In frames/s when over budget, 0 = drop.
+	sshsNodePutBoolIfAbsent(moduleNode, "rateLimitSubsample", true);
+}
+
+// For config listeners: whether the changed attribute is a rate limiter one.
+static inline bool caerOutputCommonRateLimitSetting(const char *changeKey, enum sshs_node_attr_value_type changeType) {
+	return ((changeType == INT
+		&& (caerStrEquals(changeKey, "rateLimitBytes") || caerStrEquals(changeKey, "rateLimitEvents")
+			|| caerStrEquals(changeKey, "rateLimitBurst")))
+		|| (changeType == FLOAT && caerStrEquals(changeKey, "rateLimitFrameRate"))
+		|| (changeType == BOOL && caerStrEquals(changeKey, "rateLimitSubsample")));
+}
+
+static inline void caerOutputCommonRateLimitFree(caerOutputCommonRateLimiter *rateLimiter) {
+	if (*rateLimiter != NULL) {
+		free((*rateLimiter)->memory);
+		free(*rateLimiter);
+		*rateLimiter = NULL;
+	}
+}
+
+// Read the rate limiter settings, and allocate or free the rate limiter to
+// match them. A NULL rate limiter means no limits. Shed counts are kept
+// across changes, and published as read-only statistics in moduleNode.
+static inline void caerOutputCommonUpdateRateLimit(const char *subSystemString, sshsNode moduleNode,
+	caerOutputCommonRateLimiter *rateLimiter) {
+	int32_t byteRate = sshsNodeGetInt(moduleNode, "rateLimitBytes");
+	int32_t eventRate = sshsNodeGetInt(moduleNode, "rateLimitEvents");
+
+	if (byteRate <= 0 && eventRate <= 0) {
+		caerOutputCommonRateLimitFree(rateLimiter);
+		return;
+	}
+
+	bool newLimiter = false;
+
+	if (*rateLimiter == NULL) {
+		*rateLimiter = calloc(1, sizeof(struct caer_output_common_rate_limiter));
+		if (*rateLimiter == NULL) {
+			caerLog(CAER_LOG_ALERT, subSystemString, "Impossible to allocate memory for rate limiter, not limiting.");
+			return;
+		}
+
+		portable_clock_gettime_monotonic(&(*rateLimiter)->lastRefill);
+		(*rateLimiter)->lastStatistics = (*rateLimiter)->lastRefill;
+
+		newLimiter = true;
+	}
+
+	caerOutputCommonRateLimiter limiter = *rateLimiter;
+
+	limiter->moduleNode = moduleNode;
+	limiter->byteRate = (byteRate > 0) ? ((double) byteRate) : (0);
+	limiter->eventRate = (eventRate > 0) ? ((double) eventRate) : (0);
+	int32_t burst = sshsNodeGetInt(moduleNode, "rateLimitBurst");
+	limiter->burst = (burst > 0) ? ((double) burst / 1000) : ((double) 1 / 1000);
+
+	float frameRate = sshsNodeGetFloat(moduleNode, "rateLimitFrameRate");
+	limiter->frameInterval = (frameRate > 0) ? (1 / (double) frameRate) : (0);
+	limiter->subsample = sshsNodeGetBool(moduleNode, "rateLimitSubsample");
+
+	// Start with full buckets, and keep any debt across changes.
+	if (newLimiter || limiter->byteTokens > (limiter->byteRate * limiter->burst)) {
+		limiter->byteTokens = limiter->byteRate * limiter->burst;
+	}
+	if (newLimiter || limiter->eventTokens > (limiter->eventRate * limiter->burst)) {
+		limiter->eventTokens = limiter->eventRate * limiter->burst;
+	}
+
+	caerLog(CAER_LOG_INFO, subSystemString, "Rate limiting to %" PRIi32 " bytes/s and %" PRIi32 " events/s.",
+		(byteRate > 0) ? (byteRate) : (0), (eventRate > 0) ? (eventRate) : (0));
+}
+
+static inline void caerOutputCommonRateLimitStatistics(caerOutputCommonRateLimiter limiter,
+	const struct timespec *now) {
+	// Publish at most once per second.
+	if (caerOutputCommonElapsed(&limiter->lastStatistics, now) < 1) {
+		return;
+	}
+
+	limiter->lastStatistics = *now;
+
+	sshsNodePutLong(limiter->moduleNode, "shedPackets", (int64_t) limiter->shedPackets);
+	sshsNodePutLong(limiter->moduleNode, "shedEvents", (int64_t) limiter->shedEvents);
+	sshsNodePutLong(limiter->moduleNode, "shedBytes", (int64_t) limiter->shedBytes);
+	sshsNodePutLong(limiter->moduleNode, "subsampledPackets", (int64_t) limiter->subsampledPackets);
+}
+
+// Copy an even subsample of keepEvents of the valid events of a packet
+// into the rate limiter's memory, as a new packet with only valid events.
+static inline caerEventPacketHeader caerOutputCommonRateLimitSubsample(caerOutputCommonRateLimiter limiter,
+	caerEventPacketHeader packetHeader, size_t validEvents, size_t keepEvents) {
+	size_t eventSize = (size_t) caerEventPacketHeaderGetEventSize(packetHeader);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packetHeader);
+	size_t packetSize = CAER_EVENT_PACKET_HEADER_SIZE + (keepEvents * eventSize);
+
+	if (packetSize > limiter->memorySize) {
+		uint8_t *newMemory = realloc(limiter->memory, packetSize);
+		if (newMemory == NULL) {
+			return (NULL);
+		}
+
+		limiter->memory = newMemory;
+		limiter->memorySize = packetSize;
+	}
+
+	uint8_t *outEvents = limiter->memory + CAER_EVENT_PACKET_HEADER_SIZE;
+	size_t validIndex = 0, outIndex = 0;
+
+	for (int32_t i = 0; i < eventNumber; i++) {
+		const void *event = caerGenericEventGetEvent(packetHeader, i);
+
+		if (!caerGenericEventIsValid(event)) {
+			continue;
+		}
+
+		// Keep the events where the scaled index steps up, evenly spread
+		// over the whole packet and so over its whole time span.
+		if ((((validIndex + 1) * keepEvents) / validEvents) > ((validIndex * keepEvents) / validEvents)) {
+			memcpy(outEvents + (outIndex * eventSize), event, eventSize);
+			outIndex++;
+		}
+
+		validIndex++;
+	}
+
+	memcpy(limiter->memory, packetHeader, CAER_EVENT_PACKET_HEADER_SIZE);
+
+	caerEventPacketHeader outHeader = (caerEventPacketHeader) limiter->memory;
+	caerEventPacketHeaderSetEventCapacity(outHeader, (int32_t) outIndex);
+	caerEventPacketHeaderSetEventNumber(outHeader, (int32_t) outIndex);
+	caerEventPacketHeaderSetEventValid(outHeader, (int32_t) outIndex);
+
+	return (outHeader);
+}
+
+// Apply the rate limits to a packet about to be sent. Returns the packet
+// to send: either the original, or a subsampled copy holding only valid
+// events (validOnly is then cleared, as there's nothing left to filter),
+// valid until the next call; or NULL if the packet is to be dropped.
+static inline caerEventPacketHeader caerOutputCommonRateLimit(caerOutputCommonRateLimiter limiter,
+	caerEventPacketHeader packetHeader, bool *validOnly) {
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	// Refill both buckets for the time since the last packet.
+	double elapsed = caerOutputCommonElapsed(&limiter->lastRefill, &now);
+	limiter->lastRefill = now;
+
+	limiter->byteTokens += elapsed * limiter->byteRate;
+	if (limiter->byteTokens > (limiter->byteRate * limiter->burst)) {
+		limiter->byteTokens = limiter->byteRate * limiter->burst;
+	}
+
+	limiter->eventTokens += elapsed * limiter->eventRate;
+	if (limiter->eventTokens > (limiter->eventRate * limiter->burst)) {
+		limiter->eventTokens = limiter->eventRate * limiter->burst;
+	}
+
+	caerOutputCommonRateLimitStatistics(limiter, &now);
+
+	// Cost of sending the packet as is.
+	size_t eventSize = (size_t) caerEventPacketHeaderGetEventSize(packetHeader);
+	size_t events = (size_t) ((*validOnly) ? (caerEventPacketHeaderGetEventValid(packetHeader)) :
+		(caerEventPacketHeaderGetEventNumber(packetHeader)));
+	size_t bytes = CAER_EVENT_PACKET_HEADER_SIZE + (events * eventSize);
+
+	bool fits = (limiter->byteRate <= 0 || (double) bytes <= limiter->byteTokens)
+		&& (limiter->eventRate <= 0 || (double) events <= limiter->eventTokens);
+
+	int16_t eventType = caerEventPacketHeaderGetEventType(packetHeader);
+	bool send = fits;
+
+	if (eventType == SPECIAL_EVENT || eventType == IMU6_EVENT || eventType == IMU9_EVENT) {
+		// Always sent: small, and needed to make sense of everything else.
+		send = true;
+	}
+	else if (eventType == FRAME_EVENT) {
+		// Frames are all-or-nothing: when over budget, still send them, but
+		// at most at the reduced frame rate.
+		if (!fits && limiter->frameInterval > 0
+			&& caerOutputCommonElapsed(&limiter->lastFrame, &now) >= limiter->frameInterval) {
+			send = true;
+		}
+
+		if (send) {
+			limiter->lastFrame = now;
+		}
+	}
+	else if (!fits && limiter->subsample) {
+		// Subsample down to what's left in the buckets.
+		size_t validEvents = (size_t) caerEventPacketHeaderGetEventValid(packetHeader);
+		size_t keepEvents = validEvents;
+
+		if (limiter->byteRate > 0) {
+			double byteEvents = (limiter->byteTokens - (double) CAER_EVENT_PACKET_HEADER_SIZE) / (double) eventSize;
+			keepEvents = (byteEvents > 0) ? ((size_t) byteEvents) : (0);
+		}
+
+		if (limiter->eventRate > 0 && limiter->eventTokens < (double) keepEvents) {
+			keepEvents = (limiter->eventTokens > 0) ? ((size_t) limiter->eventTokens) : (0);
+		}
+
+		if (keepEvents > validEvents) {
+			keepEvents = validEvents;
+		}
+
+		if (keepEvents > 0) {
+			caerEventPacketHeader subsampledPacket = caerOutputCommonRateLimitSubsample(limiter, packetHeader,
+				validEvents, keepEvents);
+
+			if (subsampledPacket != NULL) {
+				limiter->subsampledPackets++;
+				limiter->shedEvents += (events - keepEvents);
+				limiter->shedBytes += (bytes - (CAER_EVENT_PACKET_HEADER_SIZE + (keepEvents * eventSize)));
+
+				limiter->byteTokens -= (double) (CAER_EVENT_PACKET_HEADER_SIZE + (keepEvents * eventSize));
+				limiter->eventTokens -= (double) keepEvents;
+
+				*validOnly = false;
+				return (subsampledPacket);
+			}
+		}
+	}
+
+	if (!send) {
+		limiter->shedPackets++;
+		limiter->shedEvents += events;
+		limiter->shedBytes += bytes;
+
+		return (NULL);
+	}
+
+	limiter->byteTokens -= (double) bytes;
+	limiter->eventTokens -= (double) events;
+
+	return (packetHeader);
+}
+
+// Receives each batch of chunks built by caerOutputCommonWriteChunks(), for
+// outputs that need to frame or pace the chunks themselves.
+typedef void (*caerOutputCommonChunkHandler)(void *handlerState, struct msghdr *chunks, size_t chunksLength);
+
+// Send all chunks built up so far: each is described by a msghdr pointing
+// to its iovecs. sendmmsg() batches them into one system call, if the
+// descriptor isn't a socket, or it's not available, writev() is used.
+// Returns the number of bytes written.
+static inline size_t caerOutputCommonWriteChunkBatch(int fileDescriptor, struct msghdr *chunks, size_t chunksLength) {
+	size_t chunksDone = 0;
+	size_t bytesWritten = 0;
+
+#if defined(OUT_COMMON_SENDMMSG)
+	if (chunksLength > 1) {
+		struct mmsghdr batch[CHUNK_BATCH_SIZE];
+
+		for (size_t i = 0; i < chunksLength; i++) {
+			batch[i].msg_hdr = chunks[i];
+			batch[i].msg_len = 0;
+		}
+
+		while (chunksDone < chunksLength) {
+			int sent = sendmmsg(fileDescriptor, batch + chunksDone, (unsigned int) (chunksLength - chunksDone), 0);
+
+			if (sent < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				if (errno == ENOTSOCK && chunksDone == 0) {
+					// Not a socket (a file), fall back to plain writes.
+					break;
+				}
+
+				// Any other error, the remaining chunks are lost, like with
+				// a failed write() in the unbatched case.
+				return (bytesWritten);
+			}
+
+			for (size_t i = chunksDone; i < (chunksDone + (size_t) sent); i++) {
+				bytesWritten += batch[i].msg_len;
+			}
+
+			chunksDone += (size_t) sent;
+		}
+	}
+#endif
+
+	for (; chunksDone < chunksLength; chunksDone++) {
+		ssize_t written = writev(fileDescriptor, chunks[chunksDone].msg_iov, (int) chunks[chunksDone].msg_iovlen);
+		if (written > 0) {
+			bytesWritten += (size_t) written;
+		}
+	}
+
+	return (bytesWritten);
+}
+
+// Write out the events described by eventRuns (a list of memory regions,
+// each holding a whole number of events, as given by packetHeader), split
+// into chunks of at most maxBytesPerPacket. Events are never split across
+// chunks, and each chunk gets a copy of the packet header, updated to the
+// chunk's event counts, so that every chunk is a complete event packet by
+// itself (unless excludeHeader is set, in which case only events are sent).
+// Small runs (from the valid-only scatter/gather path) are gathered into
+// the same chunk as far as possible. If chunkHandler is not NULL, batches
+// of chunks are passed to it instead of being written to fileDescriptor.
+// Returns the number of bytes written to fileDescriptor.
+static inline size_t caerOutputCommonWriteChunks(int fileDescriptor, caerOutputCommonChunkHandler chunkHandler,
+	void *chunkHandlerState, caerEventPacketHeader packetHeader, struct iovec *eventRuns, size_t eventRunsLength,
+	bool excludeHeader, size_t maxBytesPerPacket) {
+	size_t eventSize = (size_t) caerEventPacketHeaderGetEventSize(packetHeader);
+	if (eventSize == 0) {
+		return (0);
+	}
+
+	size_t bytesWritten = 0;
+	size_t headerSize = (excludeHeader) ? (0) : (sizeof(struct caer_event_packet_header));
+
+	// At least one event per chunk, even if it doesn't fit; events are never split.
+	size_t eventsPerChunk = 1;
+	if (maxBytesPerPacket > (headerSize + eventSize)) {
+		eventsPerChunk = (maxBytesPerPacket - headerSize) / eventSize;
+	}
+
+	// If all events are valid (valid-only output), we don't need to count.
+	bool allValid = (caerEventPacketHeaderGetEventValid(packetHeader)
+		== caerEventPacketHeaderGetEventNumber(packetHeader));
+
+	struct caer_event_packet_header chunkHeaders[CHUNK_BATCH_SIZE];
+	struct msghdr chunks[CHUNK_BATCH_SIZE];
+	struct iovec chunkIO[IOVEC_SIZE];
+
+	size_t chunksUsed = 0;
+	size_t iovecUsed = 0;
+
+	size_t currRun = 0;
+	size_t currRunOffset = 0;
+
+	for (;;) {
+		// Skip over empty runs (trailing invalid events in scatter/gather).
+		while (currRun < eventRunsLength
+			&& (eventRuns[currRun].iov_base == NULL || currRunOffset >= eventRuns[currRun].iov_len)) {
+			currRun++;
+			currRunOffset = 0;
+		}
+
+		if (currRun == eventRunsLength) {
+			break;
+		}
+
+		// Need space for the header and at least one event run; also flush
+		// full batches.
+		if (chunksUsed == CHUNK_BATCH_SIZE || (iovecUsed + 2) > IOVEC_SIZE) {
+			if (chunkHandler != NULL) {
+				(*chunkHandler)(chunkHandlerState, chunks, chunksUsed);
+			}
+			else {
+				bytesWritten += caerOutputCommonWriteChunkBatch(fileDescriptor, chunks, chunksUsed);
+			}
+
+			chunksUsed = 0;
+			iovecUsed = 0;
+		}
+
+		struct msghdr *chunk = &chunks[chunksUsed];
+		memset(chunk, 0, sizeof(struct msghdr));
+		chunk->msg_iov = &chunkIO[iovecUsed];
+
+		if (!excludeHeader) {
+			chunkIO[iovecUsed].iov_base = &chunkHeaders[chunksUsed];
+			chunkIO[iovecUsed].iov_len = sizeof(struct caer_event_packet_header);
+			iovecUsed++;
+		}
+
+		size_t chunkEvents = 0;
+		int32_t chunkValid = 0;
+
+		// Gather events from the runs, until the chunk is full, there are
+		// no more events, or we're out of iovecs for this batch.
+		while (chunkEvents < eventsPerChunk && currRun < eventRunsLength && iovecUsed < IOVEC_SIZE) {
+			if (eventRuns[currRun].iov_base == NULL || currRunOffset >= eventRuns[currRun].iov_len) {
+				currRun++;
+				currRunOffset = 0;
+				continue;
+			}
+
+			size_t runEvents = (eventRuns[currRun].iov_len - currRunOffset) / eventSize;
+			if (runEvents > (eventsPerChunk - chunkEvents)) {
+				runEvents = eventsPerChunk - chunkEvents;
+			}
+
+			uint8_t *runStart = ((uint8_t *) eventRuns[currRun].iov_base) + currRunOffset;
+
+			if (!allValid) {
+				for (size_t i = 0; i < runEvents; i++) {
+					if (caerGenericEventIsValid(runStart + (i * eventSize))) {
+						chunkValid++;
+					}
+				}
+			}
+
+			chunkIO[iovecUsed].iov_base = runStart;
+			chunkIO[iovecUsed].iov_len = runEvents * eventSize;
+			iovecUsed++;
+
+			chunkEvents += runEvents;
+			currRunOffset += runEvents * eventSize;
+		}
+
+		if (allValid) {
+			chunkValid = (int32_t) chunkEvents;
+		}
+
+		if (!excludeHeader) {
+			memcpy(&chunkHeaders[chunksUsed], packetHeader, sizeof(struct caer_event_packet_header));
+			caerEventPacketHeaderSetEventCapacity(&chunkHeaders[chunksUsed], (int32_t) chunkEvents);
+			caerEventPacketHeaderSetEventNumber(&chunkHeaders[chunksUsed], (int32_t) chunkEvents);
+			caerEventPacketHeaderSetEventValid(&chunkHeaders[chunksUsed], chunkValid);
+		}
+
+		chunk->msg_iovlen = (size_t) (&chunkIO[iovecUsed] - chunk->msg_iov);
+		chunksUsed++;
+	}
+
+	if (chunksUsed > 0) {
+		if (chunkHandler != NULL) {
+			(*chunkHandler)(chunkHandlerState, chunks, chunksUsed);
+		}
+		else {
+			bytesWritten += caerOutputCommonWriteChunkBatch(fileDescriptor, chunks, chunksUsed);
+		}
+	}
+
+	return (bytesWritten);
+}
+
+static inline size_t caerOutputCommonWriteFull(int fileDescriptor, void *startAddress, size_t fullLength,
 bool excludeHeader, size_t maxBytesPerPacket) {
+	if (maxBytesPerPacket != 0) {
+		// Write data out in chunks of specified size, respecting event boundaries.
+		struct iovec eventRun;
+		eventRun.iov_base = ((uint8_t *) startAddress) + sizeof(struct caer_event_packet_header);
+		eventRun.iov_len = fullLength - sizeof(struct caer_event_packet_header);
+
+		return (caerOutputCommonWriteChunks(fileDescriptor, NULL, NULL, startAddress, &eventRun, 1, excludeHeader,
+			maxBytesPerPacket));
+	}
+
 	// Skip header if requested.
 	if (excludeHeader) {
 		startAddress = ((uint8_t *) startAddress) + sizeof(struct caer_event_packet_header);
 		fullLength -= sizeof(struct caer_event_packet_header);
 	}
 
-	if (maxBytesPerPacket == 0) {
-		// Write out everything in one big packet.
-		write(fileDescriptor, startAddress, fullLength);
+	// Write out everything in one big packet.
+	ssize_t written = write(fileDescriptor, startAddress, fullLength);
+
+	return ((written > 0) ? ((size_t) written) : (0));
+}
+
+// State for AEDAT 2.0 (jAER) compatible output: a conversion buffer that
+// is reused across packets, and the X size of the last seen source, used
+// to flip X addresses the way jAER expects them.
+struct caer_output_old_aer {
+	uint8_t *buffer;
+	size_t bufferSize;
+	int16_t sourceID;
+	uint16_t sizeX;
+	bool sizeXKnown; // True once sizeX was resolved for sourceID.
+};
+
+// X size assumed when a source doesn't declare one: the DVS128/DAVIS240
+// width, what AEDAT 2.0 files were originally recorded with.
+#define CAER_OUTPUT_OLD_AER_DEFAULT_SIZE_X 240
+
+typedef struct caer_output_old_aer *caerOutputOldAER;
+
+static inline size_t caerOutputWriteOldAERHack(const char *subSystemString, int fileDescriptor, caerOutputOldAER oldAER,
+	caerEventPacketHeader packetHeader, bool validOnly) {
+	// Check that we're working with polarity events, which are the only support
+	// format for old AER compatibility.
+	if (caerEventPacketHeaderGetEventType(packetHeader) != POLARITY_EVENT) {
+		return (0);
 	}
-	else {
-		// Write data out in chunks of specified size.
-		// TODO: ensure event size boundaries are automatically met.
-		while (fullLength > 0) {
-			size_t bytesToSend = maxBytesPerPacket;
-			if (bytesToSend > fullLength) {
-				bytesToSend = fullLength;
-			}
 
-			write(fileDescriptor, startAddress, bytesToSend);
+	int16_t sourceID = caerEventPacketHeaderGetEventSource(packetHeader);
 
-			startAddress = ((uint8_t *) startAddress) + bytesToSend;
-			fullLength -= bytesToSend;
+	if (!oldAER->sizeXKnown || oldAER->sourceID != sourceID) {
+		sshsNode sourceInfoNode = caerMainloopGetSourceInfo(U16T(sourceID));
+
+		oldAER->sourceID = sourceID;
+		oldAER->sizeXKnown = true;
+
+		if (sourceInfoNode != NULL && sshsNodeAttributeExists(sourceInfoNode, "dvsSizeX", SHORT)
+			&& sshsNodeGetShort(sourceInfoNode, "dvsSizeX") > 0) {
+			oldAER->sizeX = U16T(sshsNodeGetShort(sourceInfoNode, "dvsSizeX"));
+		}
+		else {
+			// Flipping against a zero width would wrap around, use the
+			// historic AEDAT 2.0 width instead. Logged once per source.
+			oldAER->sizeX = CAER_OUTPUT_OLD_AER_DEFAULT_SIZE_X;
+
+			caerLog(CAER_LOG_WARNING, subSystemString,
+				"Source %" PRIi16 " has no DVS X size, assuming %d for AEDAT 2.0 X address flipping.", sourceID,
+				CAER_OUTPUT_OLD_AER_DEFAULT_SIZE_X);
 		}
 	}
-}
 
-static inline void caerOutputWriteOldAERHack(int fileDescriptor, void *startAddress, size_t fullLength) {
-	UNUSED_ARGUMENT(fullLength);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packetHeader);
+	size_t bufferNeeded = (size_t) eventNumber * 8;
 
-	// Check that we're working with polarity events, which are the only support
-	// format for old AER compatibility.
-	caerEventPacketHeader packetHeader = startAddress;
+	if (bufferNeeded > oldAER->bufferSize) {
+		uint8_t *newBuffer = realloc(oldAER->buffer, bufferNeeded);
+		if (newBuffer == NULL) {
+			// Failure to allocate memory, just don't send packet and log this.
+			caerLog(CAER_LOG_ALERT, subSystemString, "Failed to allocate memory for AEDAT 2.0 conversion.");
+			return (0);
+		}
 
-	if (caerEventPacketHeaderGetEventType(packetHeader) != POLARITY_EVENT) {
-		return;
+		oldAER->buffer = newBuffer;
+		oldAER->bufferSize = bufferNeeded;
+	}
+
+	// Convert the events to the old format: 32 bit address (polarity in bit
+	// 11, flipped X in bits 12-21, Y in bits 22-30) and 32 bit timestamp, both
+	// big-endian. The address only depends on bits of the new data word, so it
+	// can be computed with shifts and masks, four events at a time.
+	const uint8_t *events = caerGenericEventGetEvent(packetHeader, 0);
+	uint8_t *out = oldAER->buffer;
+	uint32_t flipX = U32T(oldAER->sizeX - 1);
+	int32_t i = 0;
+
+	if (!validOnly) {
+#if defined(__SSE2__)
+		const __m128i polarityMask = _mm_set1_epi32(0x00000800);
+		const __m128i xMask = _mm_set1_epi32(0x00007FFF);
+		const __m128i flippedXMask = _mm_set1_epi32(0x000003FF);
+		const __m128i yMask = _mm_set1_epi32(0x7FC00000);
+		const __m128i flipXVec = _mm_set1_epi32(I32T(flipX));
+
+		for (; (i + 4) <= eventNumber; i += 4) {
+			__m128 lo = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) (const void *) (events + (i * 8))));
+			__m128 hi = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) (const void *) (events + ((i + 2) * 8))));
+
+			__m128i data = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0)));
+			__m128i ts = _mm_castps_si128(_mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1)));
+
+			__m128i x = _mm_and_si128(_mm_srli_epi32(data, POLARITY_X_ADDR_SHIFT), xMask);
+			x = _mm_and_si128(_mm_sub_epi32(flipXVec, x), flippedXMask);
+
+			__m128i address = _mm_and_si128(_mm_slli_epi32(data, 10), polarityMask);
+			address = _mm_or_si128(address, _mm_slli_epi32(x, 12));
+			address = _mm_or_si128(address, _mm_and_si128(_mm_slli_epi32(data, 20), yMask));
+
+			// Interleave back to address/timestamp pairs and swap to big-endian:
+			// first bytes within each 16 bit half, then the two halves.
+			__m128i pairs[2] = { _mm_unpacklo_epi32(address, ts), _mm_unpackhi_epi32(address, ts) };
+
+			for (size_t p = 0; p < 2; p++) {
+				__m128i swapped = _mm_or_si128(_mm_slli_epi16(pairs[p], 8), _mm_srli_epi16(pairs[p], 8));
+				swapped = _mm_shufflelo_epi16(swapped, _MM_SHUFFLE(2, 3, 0, 1));
+				swapped = _mm_shufflehi_epi16(swapped, _MM_SHUFFLE(2, 3, 0, 1));
+
+				_mm_storeu_si128((__m128i *) (void *) (out + ((size_t) i * 8) + (p * 16)), swapped);
+			}
+		}
+#elif defined(OUT_COMMON_NEON)
+		const uint32x4_t polarityMask = vdupq_n_u32(0x00000800);
+		const uint32x4_t xMask = vdupq_n_u32(0x00007FFF);
+		const uint32x4_t flippedXMask = vdupq_n_u32(0x000003FF);
+		const uint32x4_t yMask = vdupq_n_u32(0x7FC00000);
+		const uint32x4_t flipXVec = vdupq_n_u32(flipX);
+
+		for (; (i + 4) <= eventNumber; i += 4) {
+			uint32x4x2_t split = vld2q_u32((const uint32_t *) (const void *) (events + (i * 8)));
+
+			uint32x4_t x = vandq_u32(vshrq_n_u32(split.val[0], POLARITY_X_ADDR_SHIFT), xMask);
+			x = vandq_u32(vsubq_u32(flipXVec, x), flippedXMask);
+
+			uint32x4_t address = vandq_u32(vshlq_n_u32(split.val[0], 10), polarityMask);
+			address = vorrq_u32(address, vshlq_n_u32(x, 12));
+			address = vorrq_u32(address, vandq_u32(vshlq_n_u32(split.val[0], 20), yMask));
+
+			uint32x4x2_t pairs;
+			pairs.val[0] = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(address)));
+			pairs.val[1] = vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(split.val[1])));
+
+			vst2q_u32((uint32_t *) (void *) (out + ((size_t) i * 8)), pairs);
+		}
+#endif
 	}
 
-	// Convert the events to the old format and write them out.
-	CAER_POLARITY_ITERATOR_ALL_START((caerPolarityEventPacket) packetHeader)
-		uint32_t data = U32T((caerPolarityEventGetPolarity(caerPolarityIteratorElement) & 0x01) << 11);
-		data |= U32T(((239 - caerPolarityEventGetX(caerPolarityIteratorElement)) & 0x3FF) << 12);
-		data |= U32T((caerPolarityEventGetY(caerPolarityIteratorElement) & 0x1FF) << 22);
+	// Remaining events, and valid-only filtering, are done one by one.
+	size_t outEvents = (size_t) i;
+
+	for (; i < eventNumber; i++) {
+		caerPolarityEvent event = caerPolarityEventPacketGetEvent((caerPolarityEventPacket) packetHeader, i);
+
+		if (validOnly && !caerPolarityEventIsValid(event)) {
+			continue;
+		}
+
+		uint32_t data = U32T((caerPolarityEventGetPolarity(event) & 0x01) << 11);
+		data |= U32T(((flipX - caerPolarityEventGetX(event)) & 0x3FF) << 12);
+		data |= U32T((caerPolarityEventGetY(event) & 0x1FF) << 22);
 		data = htobe32(data);
 
-		write(fileDescriptor, &data, 4);
+		uint32_t ts = htobe32(U32T(caerPolarityEventGetTimestamp(event)));
+
+		memcpy(out + (outEvents * 8), &data, 4);
+		memcpy(out + (outEvents * 8) + 4, &ts, 4);
+		outEvents++;
+	}
 
-		int32_t ts = caerPolarityEventGetTimestamp(caerPolarityIteratorElement);
-		ts = I32T(htobe32(U32T(ts)));
+	// Write everything out in one go.
+	ssize_t written = write(fileDescriptor, out, outEvents * 8);
 
-		write(fileDescriptor, &ts, 4);
-	CAER_POLARITY_ITERATOR_ALL_END
+	return ((written > 0) ? ((size_t) written) : (0));
 }
 
-static inline void caerOutputCommonWriteFullSGIO(int fileDescriptor, struct iovec *sgioMemory, size_t sgioLength,
+static inline size_t caerOutputCommonWriteFullSGIO(int fileDescriptor, struct iovec *sgioMemory, size_t sgioLength,
 bool excludeHeader, size_t maxBytesPerPacket) {
+	if (maxBytesPerPacket != 0) {
+		// First IOVEC always starts with the header, possibly followed by
+		// the first run of valid events; all others are runs of valid events.
+		caerEventPacketHeader packetHeader = sgioMemory[0].iov_base;
+
+		sgioMemory[0].iov_base = ((uint8_t *) sgioMemory[0].iov_base) + sizeof(struct caer_event_packet_header);
+		sgioMemory[0].iov_len -= sizeof(struct caer_event_packet_header);
+
+		return (caerOutputCommonWriteChunks(fileDescriptor, NULL, NULL, packetHeader, sgioMemory, sgioLength,
+			excludeHeader, maxBytesPerPacket));
+	}
+
 	// Skip header if requested.
 	if (excludeHeader) {
 		sgioMemory[0].iov_base = ((uint8_t *) sgioMemory[0].iov_base) + sizeof(struct caer_event_packet_header);
@@ -90,18 +773,131 @@ bool excludeHeader, size_t maxBytesPerPacket) {
 		}
 	}
 
-	if (maxBytesPerPacket == 0) {
-		// Write out everything in one big packet.
-		writev(fileDescriptor, sgioMemory, (int) sgioLength);
+	// Write out everything in one big packet.
+	ssize_t written = writev(fileDescriptor, sgioMemory, (int) sgioLength);
+
+	return ((written > 0) ? ((size_t) written) : (0));
+}
+
+static inline size_t caerOutputCommonSendDelta(const char *subSystemString, caerEventPacketHeader packetHeader,
+	int fileDescriptor, caerDeltaBuffer deltaBuffer, bool validOnly, size_t maxBytesPerPacket) {
+	int32_t oldCapacity = caerEventPacketHeaderGetEventCapacity(packetHeader);
+	int32_t oldNumber = caerEventPacketHeaderGetEventNumber(packetHeader);
+	int32_t oldValid = caerEventPacketHeaderGetEventValid(packetHeader);
+
+	int16_t eventType = caerEventPacketHeaderGetEventType(packetHeader);
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packetHeader);
+
+	size_t bytesWritten = 0;
+
+	// Split up the packet so that each compressed part, including its framing,
+	// stays within maxBytesPerPacket. Each part is a complete packet by itself.
+	// Compressed data is never bigger than the original, so counting the
+	// events at their full size guarantees this.
+	int32_t eventsPerPart = oldNumber;
+
+	if (maxBytesPerPacket > 0) {
+		size_t partEvents = 1;
+
+		if (maxBytesPerPacket > (DELTA_FRAME_HEADER_SIZE + 1)) {
+			partEvents = (maxBytesPerPacket - DELTA_FRAME_HEADER_SIZE - 1) / (size_t) eventSize;
+
+			if (partEvents == 0) {
+				partEvents = 1;
+			}
+		}
+
+		if (partEvents < (size_t) oldNumber) {
+			eventsPerPart = (int32_t) partEvents;
+		}
 	}
-	else {
-		// TODO: implement this.
+
+	for (int32_t firstEvent = 0; firstEvent < oldNumber; firstEvent += eventsPerPart) {
+		int32_t partNumber = oldNumber - firstEvent;
+		if (partNumber > eventsPerPart) {
+			partNumber = eventsPerPart;
+		}
+
+		int32_t encodedEvents = 0;
+		size_t payloadLength = 0;
+
+		uint8_t *payload = caerDeltaEncode(deltaBuffer, eventType,
+			caerGenericEventGetEvent(packetHeader, firstEvent), eventSize, partNumber, validOnly, &encodedEvents,
+			&payloadLength);
+		if (payload == NULL) {
+			// Failure to allocate memory, just don't send packet and log this.
+			caerLog(CAER_LOG_ALERT, subSystemString, "Failed to allocate memory for compression.");
+			break;
+		}
+
+		if (encodedEvents == 0) {
+			continue;
+		}
+
+		// The valid count must match what's in this part.
+		int32_t partValid = encodedEvents;
+
+		if (!validOnly) {
+			if (partNumber == oldNumber) {
+				partValid = oldValid;
+			}
+			else {
+				partValid = 0;
+
+				for (int32_t i = firstEvent; i < (firstEvent + partNumber); i++) {
+					if (caerGenericEventIsValid(caerGenericEventGetEvent(packetHeader, i))) {
+						partValid++;
+					}
+				}
+			}
+		}
+
+		caerEventPacketHeaderSetEventCapacity(packetHeader, encodedEvents);
+		caerEventPacketHeaderSetEventNumber(packetHeader, encodedEvents);
+		caerEventPacketHeaderSetEventValid(packetHeader, partValid);
+
+		uint32_t payloadLengthLE = htole32((uint32_t) payloadLength);
+
+		struct iovec deltaIO[3];
+		deltaIO[0].iov_base = packetHeader;
+		deltaIO[0].iov_len = sizeof(struct caer_event_packet_header);
+		deltaIO[1].iov_base = &payloadLengthLE;
+		deltaIO[1].iov_len = sizeof(uint32_t);
+		deltaIO[2].iov_base = payload;
+		deltaIO[2].iov_len = payloadLength;
+
+		ssize_t written = writev(fileDescriptor, deltaIO, 3);
+		if (written > 0) {
+			bytesWritten += (size_t) written;
+		}
 	}
+
+	// Reset to old values.
+	caerEventPacketHeaderSetEventCapacity(packetHeader, oldCapacity);
+	caerEventPacketHeaderSetEventNumber(packetHeader, oldNumber);
+	caerEventPacketHeaderSetEventValid(packetHeader, oldValid);
+
+	return (bytesWritten);
 }
 
-static inline void caerOutputCommonSend(const char *subSystemString, caerEventPacketHeader packetHeader,
-	int fileDescriptor, struct iovec *sgioMemory, bool validOnly, bool excludeHeader, size_t maxBytesPerPacket,
-	bool oldAERFormat) {
+// Returns the number of bytes written, so that callers can keep track of
+// how much went out without asking the kernel.
+static inline size_t caerOutputCommonSend(const char *subSystemString, caerEventPacketHeader packetHeader,
+	int fileDescriptor, struct iovec *sgioMemory, caerValidCompactBuffer compactBuffer, caerDeltaBuffer deltaBuffer,
+	bool validOnly, bool excludeHeader, size_t maxBytesPerPacket, caerOutputOldAER oldAER) {
+	// AEDAT 2.0 format has no packets, only a plain sequence of events.
+	if (oldAER != NULL) {
+		return (caerOutputWriteOldAERHack(subSystemString, fileDescriptor, oldAER, packetHeader, validOnly));
+	}
+
+	// Compressed output always carries the header, as it's needed to decode.
+	if (deltaBuffer != NULL) {
+		return (caerOutputCommonSendDelta(subSystemString, packetHeader, fileDescriptor, deltaBuffer, validOnly,
+			maxBytesPerPacket));
+	}
+
+	size_t bytesWritten = 0;
+
 	// If validOnly is not specified, we can just send the whole packet
 	// in one go directly.
 	if (!validOnly) {
@@ -114,15 +910,9 @@ static inline void caerOutputCommonSend(const char *subSystemString, caerEventPa
 		caerEventPacketHeaderSetEventCapacity(packetHeader, eventNumber);
 
 		// Write the whole packet, up to the last event.
-		if (oldAERFormat) {
-			caerOutputWriteOldAERHack(fileDescriptor, packetHeader,
-				sizeof(*packetHeader) + (size_t) (eventNumber * caerEventPacketHeaderGetEventSize(packetHeader)));
-		}
-		else {
-			caerOutputCommonWriteFull(fileDescriptor, packetHeader,
-				sizeof(*packetHeader) + (size_t) (eventNumber * caerEventPacketHeaderGetEventSize(packetHeader)),
-				excludeHeader, maxBytesPerPacket);
-		}
+		bytesWritten = caerOutputCommonWriteFull(fileDescriptor, packetHeader,
+			sizeof(*packetHeader) + (size_t) (eventNumber * caerEventPacketHeaderGetEventSize(packetHeader)),
+			excludeHeader, maxBytesPerPacket);
 
 		// Reset to old value.
 		caerEventPacketHeaderSetEventCapacity(packetHeader, oldCapacity);
@@ -135,15 +925,12 @@ static inline void caerOutputCommonSend(const char *subSystemString, caerEventPa
 
 		int32_t eventValid = caerEventPacketHeaderGetEventValid(packetHeader);
 
-		// Use scatter/gather IO to write only the valid events out more
-		// efficiently if possible, this is limited by the number of iovec
-		// structs available, and so we have to determine if it's possible
-		// to actually satisfy the request this way, by looking at how many
-		// invalid events there are, each of which could be a split point
-		// in the event packet buffer. +1 for the packet header part.
+		// Use scatter/gather IO to write only the valid events out without
+		// copying them, if there are only very few invalid events, each of
+		// which could be a split point in the event packet buffer.
 		int32_t eventSize = caerEventPacketHeaderGetEventSize(packetHeader);
 
-		if (sgioMemory != NULL && (oldNumber - eventValid + 1) <= IOVEC_SIZE) {
+		if (sgioMemory != NULL && (oldNumber - eventValid) <= SGIO_MAX_INVALID_EVENTS) {
 			size_t iovecUsed = 0;
 
 			// Scan thorough packet and commit valid runs.
@@ -176,39 +963,35 @@ static inline void caerOutputCommonSend(const char *subSystemString, caerEventPa
 			caerEventPacketHeaderSetEventNumber(packetHeader, eventValid);
 
 			// Done, do the call.
-			caerOutputCommonWriteFullSGIO(fileDescriptor, sgioMemory, iovecUsed + 1, excludeHeader, maxBytesPerPacket);
+			bytesWritten = caerOutputCommonWriteFullSGIO(fileDescriptor, sgioMemory, iovecUsed + 1, excludeHeader,
+				maxBytesPerPacket);
 		}
 		else {
-			// Else we use a much slower allocate-copy-free approach.
-			uint8_t *tmpValidEvents = malloc(
-				sizeof(struct caer_event_packet_header) + (size_t) (eventValid * eventSize));
+			// Else compact the valid events into a contiguous copy of the
+			// packet. The compaction buffer is reused across packets, if
+			// there is none, use temporary memory.
+			uint8_t *validPacket = NULL;
+
+			if (compactBuffer != NULL) {
+				validPacket = caerValidCompactBufferReserve(compactBuffer, caerValidCompactPacketSize(packetHeader));
+			}
+			else {
+				validPacket = malloc(caerValidCompactPacketSize(packetHeader) + CAER_VALID_COMPACT_SLACK);
+			}
 
-			if (tmpValidEvents == NULL) {
+			if (validPacket == NULL) {
 				// Failure to allocate memory, just don't send packet and log this.
 				caerLog(CAER_LOG_ALERT, subSystemString, "Failed to allocate memory for valid event copy.");
 			}
 			else {
-				// Go through all valid events and copy them.
-				size_t currOffset = sizeof(struct caer_event_packet_header);
+				size_t validPacketSize = caerValidCompactPacket(validPacket, packetHeader);
 
-				for (int32_t i = 0; i < oldNumber; i++) {
-					void *currEvent = caerGenericEventGetEvent(packetHeader, i);
+				bytesWritten = caerOutputCommonWriteFull(fileDescriptor, validPacket, validPacketSize, excludeHeader,
+					maxBytesPerPacket);
 
-					if (caerGenericEventIsValid(currEvent)) {
-						memcpy(tmpValidEvents + currOffset, currEvent, (size_t) eventSize);
-						currOffset += (size_t) eventSize;
-					}
+				if (compactBuffer == NULL) {
+					free(validPacket);
 				}
-
-				caerEventPacketHeaderSetEventCapacity(packetHeader, eventValid);
-				caerEventPacketHeaderSetEventNumber(packetHeader, eventValid);
-
-				// Last, copy the header, _after_ it's been manipulated/updated.
-				memcpy(tmpValidEvents, packetHeader, sizeof(struct caer_event_packet_header));
-
-				caerOutputCommonWriteFull(fileDescriptor, tmpValidEvents, currOffset, excludeHeader, maxBytesPerPacket);
-
-				free(tmpValidEvents);
 			}
 		}
 
@@ -216,6 +999,110 @@ static inline void caerOutputCommonSend(const char *subSystemString, caerEventPa
 		caerEventPacketHeaderSetEventCapacity(packetHeader, oldCapacity);
 		caerEventPacketHeaderSetEventNumber(packetHeader, oldNumber);
 	}
+
+	return (bytesWritten);
+}
+
+// Write one packet followed by its CRC-32C trailer. The packet is always sent
+// whole and with its header, so that the reader can verify it before use:
+// excludeHeader and maxBytesPerPacket don't apply here. Returns the number of
+// bytes written.
+static inline size_t caerOutputCommonSendChecksum(const char *subSystemString, caerEventPacketHeader packetHeader,
+	int fileDescriptor, caerValidCompactBuffer compactBuffer, caerDeltaBuffer deltaBuffer, bool validOnly) {
+	int32_t oldCapacity = caerEventPacketHeaderGetEventCapacity(packetHeader);
+	int32_t oldNumber = caerEventPacketHeaderGetEventNumber(packetHeader);
+	int32_t oldValid = caerEventPacketHeaderGetEventValid(packetHeader);
+
+	struct iovec checksumIO[4];
+	size_t checksumIOLength = 0;
+
+	uint32_t payloadLengthLE = 0;
+	uint8_t *validPacket = NULL;
+
+	if (deltaBuffer != NULL) {
+		int32_t encodedEvents = 0;
+		size_t payloadLength = 0;
+
+		uint8_t *payload = caerDeltaEncode(deltaBuffer, caerEventPacketHeaderGetEventType(packetHeader),
+			caerGenericEventGetEvent(packetHeader, 0), caerEventPacketHeaderGetEventSize(packetHeader), oldNumber,
+			validOnly, &encodedEvents, &payloadLength);
+		if (payload == NULL) {
+			// Failure to allocate memory, just don't send packet and log this.
+			caerLog(CAER_LOG_ALERT, subSystemString, "Failed to allocate memory for compression.");
+			return (0);
+		}
+
+		if (encodedEvents == 0) {
+			return (0);
+		}
+
+		caerEventPacketHeaderSetEventCapacity(packetHeader, encodedEvents);
+		caerEventPacketHeaderSetEventNumber(packetHeader, encodedEvents);
+		caerEventPacketHeaderSetEventValid(packetHeader, (validOnly) ? (encodedEvents) : (oldValid));
+
+		payloadLengthLE = htole32((uint32_t) payloadLength);
+
+		checksumIO[0].iov_base = packetHeader;
+		checksumIO[0].iov_len = sizeof(struct caer_event_packet_header);
+		checksumIO[1].iov_base = &payloadLengthLE;
+		checksumIO[1].iov_len = sizeof(uint32_t);
+		checksumIO[2].iov_base = payload;
+		checksumIO[2].iov_len = payloadLength;
+		checksumIOLength = 3;
+	}
+	else if (validOnly) {
+		// Compact the valid events into a contiguous copy of the packet.
+		if (compactBuffer != NULL) {
+			validPacket = caerValidCompactBufferReserve(compactBuffer, caerValidCompactPacketSize(packetHeader));
+		}
+		else {
+			validPacket = malloc(caerValidCompactPacketSize(packetHeader) + CAER_VALID_COMPACT_SLACK);
+		}
+
+		if (validPacket == NULL) {
+			// Failure to allocate memory, just don't send packet and log this.
+			caerLog(CAER_LOG_ALERT, subSystemString, "Failed to allocate memory for valid event copy.");
+			return (0);
+		}
+
+		checksumIO[0].iov_base = validPacket;
+		checksumIO[0].iov_len = caerValidCompactPacket(validPacket, packetHeader);
+		checksumIOLength = 1;
+	}
+	else {
+		// Don't send the zeroed-out tail of the packet.
+		caerEventPacketHeaderSetEventCapacity(packetHeader, oldNumber);
+
+		checksumIO[0].iov_base = packetHeader;
+		checksumIO[0].iov_len = sizeof(struct caer_event_packet_header)
+			+ (size_t) (oldNumber * caerEventPacketHeaderGetEventSize(packetHeader));
+		checksumIOLength = 1;
+	}
+
+	uint32_t checksum = 0;
+
+	for (size_t i = 0; i < checksumIOLength; i++) {
+		checksum = caerCrc32c(checksum, checksumIO[i].iov_base, checksumIO[i].iov_len);
+	}
+
+	uint32_t checksumLE = htole32(checksum);
+
+	checksumIO[checksumIOLength].iov_base = &checksumLE;
+	checksumIO[checksumIOLength].iov_len = CHECKSUM_TRAILER_SIZE;
+	checksumIOLength++;
+
+	ssize_t written = writev(fileDescriptor, checksumIO, (int) checksumIOLength);
+
+	if (compactBuffer == NULL) {
+		free(validPacket);
+	}
+
+	// Reset to old values.
+	caerEventPacketHeaderSetEventCapacity(packetHeader, oldCapacity);
+	caerEventPacketHeaderSetEventNumber(packetHeader, oldNumber);
+	caerEventPacketHeaderSetEventValid(packetHeader, oldValid);
+
+	return ((written > 0) ? ((size_t) written) : (0));
 }
 
 #endif /* OUT_COMMON_H_ */
@@ -0,0 +1,977 @@
+/*
+ * replay_server.c
+ *
+ *  Streams a recorded AEDAT 3.x file to any number of TCP clients, paced
+ *  to the packet timestamps (real-time, or a multiple of it). Each client
+ *  gets its own position in the recording, and can choose where to start
+ *  with a start request (see ext/netreplay.h). Packet data goes from the
+ *  file to the sockets with sendfile(), never passing through user-space;
+ *  clients receive exactly what the TCP server output would have sent.
+ *
+ *  Timing comes from the packet index at the end of the file (see
+ *  modules/misc/file_index.h). Files without one are scanned once when
+ *  opened, which only works for RAW files, CAERDELTA ones are sent
+ *  unpaced then.
+ */
+
+#include "replay_server.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "modules/misc/file_index.h"
+#include <poll.h>
+#include <fcntl.h>
+#include <pwd.h>
+#include <sys/socket.h>
+#include <sys/sendfile.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "ext/nets.h"
+#include "ext/netreplay.h"
+#include "ext/portable_time.h"
+#include "ext/caerdelta/caerdelta.h"
+
+// Upper limit on bytes handed to one sendfile() call, so one fast client
+// can't keep the others waiting for long.
+#define SENDFILE_CHUNK_SIZE (1024 * 1024)
+
+// Longest time poll() waits, so that stop requests are noticed quickly.
+#define POLL_MAX_WAIT 100
+
+enum replay_client_phases {
+	REPLAY_CLIENT_FREE, REPLAY_CLIENT_REQUEST, REPLAY_CLIENT_STREAM,
+};
+
+struct replay_client {
+	int fileDescriptor;
+	enum replay_client_phases phase;
+	struct timespec connectTime;
+	uint8_t requestBuffer[CAER_NET_REPLAY_REQUEST_SIZE];
+	size_t requestLength;
+	int64_t startOffset; // In µs from the start of the recording.
+	// Everything before sendEnd may be sent right away, the rest is
+	// released entry by entry, as their timestamps come due.
+	off_t sendOffset;
+	off_t sendEnd;
+	size_t nextEntry;
+	// Pacing reference: this timestamp is due at this time.
+	int64_t paceTimestamp;
+	struct timespec paceTime;
+};
+
+struct replay_state {
+	thrd_t serverThread;
+	atomic_bool running;
+	atomic_bool paceUpdate;
+	int serverDescriptor;
+	int fileDescriptor;
+	// Packet data lies between dataOffset and dataEnd, timing from the index.
+	off_t dataOffset;
+	off_t dataEnd;
+	bool compressed;
+	bool checksum; // Each packet is followed by its CRC-32C.
+	struct caer_file_index index;
+	bool indexScanned; // Built in memory, not mapped from the file.
+	struct replay_client *clients;
+	struct pollfd *pollDescriptors;
+	size_t clientsLength;
+	// Pacing settings, changeable while running.
+	double speed; // 1 = real-time, 0 = as fast as possible.
+	bool loop;
+	int64_t defaultStartOffset;
+	int32_t requestTimeout; // In ms.
+	// Statistics.
+	size_t connectedClients;
+	uint64_t bytesSent;
+	struct timespec lastStatistics;
+};
+
+typedef struct replay_state *replayState;
+
+static bool caerOutputReplayServerInit(caerModuleData moduleData);
+static void caerOutputReplayServerRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerOutputReplayServerConfig(caerModuleData moduleData);
+static void caerOutputReplayServerExit(caerModuleData moduleData);
+
+static struct caer_module_functions caerOutputReplayServerFunctions = { .moduleInit = &caerOutputReplayServerInit,
+	.moduleRun = &caerOutputReplayServerRun, .moduleConfig = &caerOutputReplayServerConfig, .moduleExit =
+		&caerOutputReplayServerExit };
+
+void caerOutputReplayServer(uint16_t moduleID) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "ReplayServer");
+
+	caerModuleSM(&caerOutputReplayServerFunctions, moduleData, sizeof(struct replay_state), 0);
+}
+
+static char *getUserHomeDirectory(const char *subSystemString);
+static bool startServer(caerModuleData moduleData);
+static void stopServer(caerModuleData moduleData);
+static bool openReplayFile(caerModuleData moduleData);
+static bool parseFileHeader(caerModuleData moduleData);
+static bool scanReplayFile(caerModuleData moduleData);
+static void updatePaceSettings(caerModuleData moduleData);
+static int replayServerThread(void *moduleDataPtr);
+static void acceptClient(caerModuleData moduleData);
+static void receiveRequest(caerModuleData moduleData, size_t client);
+static void startClient(caerModuleData moduleData, size_t client, const struct timespec *now);
+static int64_t releaseClient(caerModuleData moduleData, size_t client, const struct timespec *now);
+static void sendClient(caerModuleData moduleData, size_t client);
+static void closeClient(caerModuleData moduleData, size_t client);
+static void publishStatistics(caerModuleData moduleData, bool force);
+static void caerOutputReplayServerConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue);
+
+static bool caerOutputReplayServerInit(caerModuleData moduleData) {
+	// First, always create all needed setting nodes, set their default values
+	// and add their listeners.
+	char *userHomeDir = getUserHomeDirectory(moduleData->moduleSubSystemString);
+	if (userHomeDir == NULL) {
+		// caerLog() with error done in getUserHomeDirectory().
+		return (false);
+	}
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "directory", userHomeDir);
+	free(userHomeDir);
+
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "filename", "caer_out.aedat");
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "ipAddress", "127.0.0.1");
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "portNumber", 7779);
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "backlogSize", 5);
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "concurrentConnections", 10);
+
+	// Pacing: speed is a multiple of real-time (0 = as fast as possible).
+	// Clients start at startOffset (ms from the start of the recording),
+	// unless they send a start request within requestTimeout ms.
+	sshsNodePutFloatIfAbsent(moduleData->moduleNode, "speed", 1.0f);
+	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "loop", false);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "startOffset", 0);
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "requestTimeout", 100);
+
+	if (!startServer(moduleData)) {
+		return (false);
+	}
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputReplayServerConfigListener);
+
+	return (true);
+}
+
+static void caerOutputReplayServerRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	UNUSED_ARGUMENT(moduleData);
+	UNUSED_ARGUMENT(argsNumber);
+	UNUSED_ARGUMENT(args);
+
+	// Nothing to do here, all the work happens in the server thread.
+}
+
+static void caerOutputReplayServerConfig(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	// Get the current value to examine by atomic exchange, since we don't
+	// want there to be any possible store between a load/store pair.
+	uintptr_t configUpdate = atomic_exchange(&moduleData->configUpdate, 0);
+
+	if (configUpdate & (0x01 << 0)) {
+		// File or server settings changed, start over. All clients are
+		// disconnected, they have to reconnect to the new server.
+		stopServer(moduleData);
+
+		if (!startServer(moduleData)) {
+			// Server failed to restart, nothing to replay.
+			return;
+		}
+	}
+
+	if (configUpdate & (0x01 << 1)) {
+		// Pacing settings changed, picked up by the server thread.
+		atomic_store(&state->paceUpdate, true);
+	}
+}
+
+static void caerOutputReplayServerExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerOutputReplayServerConfigListener);
+
+	stopServer(moduleData);
+}
+
+// Remember to free strings returned by this.
+static char *getUserHomeDirectory(const char *subSystemString) {
+	// First check the environment for $HOME.
+	char *homeVar = getenv("HOME");
+
+	if (homeVar != NULL) {
+		char *retVar = strdup(homeVar);
+		if (retVar == NULL) {
+			caerLog(CAER_LOG_CRITICAL, subSystemString, "Unable to allocate memory for user home directory path.");
+			return (NULL);
+		}
+
+		return (retVar);
+	}
+
+	// Else try to get it from the user data storage.
+	struct passwd userPasswd;
+	struct passwd *userPasswdPtr;
+	char userPasswdBuf[2048];
+
+	if (getpwuid_r(getuid(), &userPasswd, userPasswdBuf, sizeof(userPasswdBuf), &userPasswdPtr) == 0) {
+		// Success!
+		char *retVar = strdup(userPasswd.pw_dir);
+		if (retVar == NULL) {
+			caerLog(CAER_LOG_CRITICAL, subSystemString, "Unable to allocate memory for user home directory path.");
+			return (NULL);
+		}
+
+		return (retVar);
+	}
+
+	// Else just return /tmp as a place to read from.
+	char *retVar = strdup("/tmp");
+	if (retVar == NULL) {
+		caerLog(CAER_LOG_CRITICAL, subSystemString, "Unable to allocate memory for user home directory path.");
+		return (NULL);
+	}
+
+	return (retVar);
+}
+
+static bool startServer(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	state->serverDescriptor = -1;
+	state->fileDescriptor = -1;
+
+	if (!openReplayFile(moduleData)) {
+		return (false);
+	}
+
+	// Open a TCP server socket for clients to connect to.
+	state->serverDescriptor = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (state->serverDescriptor < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not create TCP server socket. Error: %d.",
+		errno);
+		stopServer(moduleData);
+		return (false);
+	}
+
+	// Make socket address reusable right away.
+	socketReuseAddr(state->serverDescriptor, true);
+
+	// Set server socket, on which accept() is called, to non-blocking mode.
+	if (!socketBlockingMode(state->serverDescriptor, false)) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not set TCP server socket to non-blocking mode.");
+		stopServer(moduleData);
+		return (false);
+	}
+
+	struct sockaddr_in tcpServer;
+	memset(&tcpServer, 0, sizeof(struct sockaddr_in));
+
+	tcpServer.sin_family = AF_INET;
+	tcpServer.sin_port = htons(sshsNodeGetShort(moduleData->moduleNode, "portNumber"));
+	char *ipAddress = sshsNodeGetString(moduleData->moduleNode, "ipAddress");
+	inet_aton(ipAddress, &tcpServer.sin_addr); // htonl() is implicit here.
+	free(ipAddress);
+
+	// Bind socket to above address.
+	if (bind(state->serverDescriptor, (struct sockaddr *) &tcpServer, sizeof(struct sockaddr_in)) < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Could not bind TCP server socket. Error: %d.",
+		errno);
+		stopServer(moduleData);
+		return (false);
+	}
+
+	// Listen to new connections on the socket.
+	if (listen(state->serverDescriptor, sshsNodeGetShort(moduleData->moduleNode, "backlogSize")) < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not listen on TCP server socket. Error: %d.", errno);
+		stopServer(moduleData);
+		return (false);
+	}
+
+	// Prepare memory for connected clients, plus one poll entry for the
+	// server socket itself.
+	state->clientsLength = (size_t) sshsNodeGetShort(moduleData->moduleNode, "concurrentConnections");
+	state->clients = calloc(state->clientsLength, sizeof(struct replay_client));
+	state->pollDescriptors = calloc(state->clientsLength + 1, sizeof(struct pollfd));
+	if (state->clients == NULL || state->pollDescriptors == NULL) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not allocate memory for TCP clients. Error: %d.", errno);
+		stopServer(moduleData);
+		return (false);
+	}
+
+	for (size_t c = 0; c < state->clientsLength; c++) {
+		state->clients[c].fileDescriptor = -1;
+		state->clients[c].phase = REPLAY_CLIENT_FREE;
+	}
+
+	updatePaceSettings(moduleData);
+	atomic_store(&state->paceUpdate, false);
+
+	state->connectedClients = 0;
+	state->bytesSent = 0;
+	publishStatistics(moduleData, true);
+
+	atomic_store(&state->running, true);
+
+	if ((errno = thrd_create(&state->serverThread, &replayServerThread, moduleData)) != thrd_success) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString, "Failed to start replay server thread. Error: %d.",
+		errno);
+		atomic_store(&state->running, false);
+		stopServer(moduleData);
+		return (false);
+	}
+
+	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "Replay server listening on %s:%" PRIu16 ".",
+		inet_ntoa(tcpServer.sin_addr), ntohs(tcpServer.sin_port));
+
+	return (true);
+}
+
+// Stop the server thread, if it's running, and free everything. Also used
+// to clean up after a partially successful startServer().
+static void stopServer(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	if (atomic_load(&state->running)) {
+		atomic_store(&state->running, false);
+
+		if ((errno = thrd_join(state->serverThread, NULL)) != thrd_success) {
+			caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+				"Failed to join replay server thread. Error: %d.", errno);
+		}
+	}
+
+	if (state->clients != NULL) {
+		for (size_t c = 0; c < state->clientsLength; c++) {
+			if (state->clients[c].fileDescriptor >= 0) {
+				close(state->clients[c].fileDescriptor);
+			}
+		}
+	}
+
+	free(state->clients);
+	state->clients = NULL;
+	free(state->pollDescriptors);
+	state->pollDescriptors = NULL;
+	state->clientsLength = 0;
+
+	if (state->serverDescriptor >= 0) {
+		close(state->serverDescriptor);
+		state->serverDescriptor = -1;
+	}
+
+	if (state->indexScanned) {
+		free(state->index.entries);
+		memset(&state->index, 0, sizeof(struct caer_file_index));
+		state->indexScanned = false;
+	}
+	else {
+		caerFileIndexUnload(&state->index);
+	}
+
+	if (state->fileDescriptor >= 0) {
+		close(state->fileDescriptor);
+		state->fileDescriptor = -1;
+	}
+}
+
+static bool openReplayFile(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	char *directory = sshsNodeGetString(moduleData->moduleNode, "directory");
+	char *fileName = sshsNodeGetString(moduleData->moduleNode, "filename");
+
+	// Assemble together: directory/fileName
+	size_t filePathLength = strlen(directory) + strlen(fileName) + 2;
+	// 1 for the directory/fileName separating slash, 1 for terminating NUL byte = +2.
+
+	char filePath[filePathLength];
+	snprintf(filePath, filePathLength, "%s/%s", directory, fileName);
+
+	free(directory);
+	free(fileName);
+
+	state->fileDescriptor = open(filePath, O_RDONLY);
+	if (state->fileDescriptor < 0) {
+		caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+			"Could not open replay file '%s' for reading. Error: %d.", filePath, errno);
+		return (false);
+	}
+
+	if (!parseFileHeader(moduleData)) {
+		stopServer(moduleData);
+		return (false);
+	}
+
+	// Timing from the packet index, or from reading all packet headers.
+	if (caerFileIndexLoad(&state->index, state->fileDescriptor, (state->checksum) ? (sizeof(uint32_t)) : (0))) {
+		state->dataEnd = (off_t) state->index.indexOffset;
+	}
+	else if (!scanReplayFile(moduleData)) {
+		stopServer(moduleData);
+		return (false);
+	}
+
+	// Tell clients what format to expect, it can't be changed here.
+	sshsNodePutString(moduleData->moduleNode, "format", (state->compressed) ? (CAERDELTA_FORMAT_NAME) : ("RAW"));
+	sshsNodePutBool(moduleData->moduleNode, "checksum", state->checksum);
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString,
+		"Opened replay file '%s' (%zu %s entries, %jd bytes of data).", filePath, state->index.length,
+		(state->indexScanned) ? ("scanned") : ("index"), (intmax_t) (state->dataEnd - state->dataOffset));
+
+	return (true);
+}
+
+// Parse the AEDAT 3.x text header, to find where the packets start and what
+// format they are in.
+static bool parseFileHeader(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	state->compressed = false;
+	state->checksum = false;
+
+	char line[1024];
+
+	while (true) {
+		off_t lineStart = lseek(state->fileDescriptor, 0, SEEK_CUR);
+
+		// Header lines all start with '#', anything else is already data.
+		char c;
+		if (read(state->fileDescriptor, &c, 1) != 1) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Replay file is empty.");
+			return (false);
+		}
+
+		if (c != '#') {
+			state->dataOffset = lineStart;
+			return (true);
+		}
+
+		// The header is tiny, so just read it byte by byte.
+		size_t lineLength = 0;
+		line[lineLength++] = c;
+
+		while (read(state->fileDescriptor, &c, 1) == 1 && c != '\n') {
+			if (lineLength < (sizeof(line) - 1)) {
+				line[lineLength++] = c;
+			}
+		}
+
+		if (lineLength > 0 && line[lineLength - 1] == '\r') {
+			lineLength--;
+		}
+		line[lineLength] = '\0';
+
+		if (caerStrEquals(line, "#!END-HEADER")) {
+			state->dataOffset = lseek(state->fileDescriptor, 0, SEEK_CUR);
+			return (true);
+		}
+
+		if (strncmp(line, "#Format: ", 9) == 0) {
+			if (caerStrEquals(line + 9, CAERDELTA_FORMAT_NAME)) {
+				state->compressed = true;
+			}
+			else if (!caerStrEquals(line + 9, "RAW")) {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Unsupported replay file format '%s'.",
+					line + 9);
+				return (false);
+			}
+		}
+
+		if (strncmp(line, "#Checksum: ", 11) == 0) {
+			if (caerStrEquals(line + 11, "CRC32C")) {
+				state->checksum = true;
+			}
+			else {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Unsupported replay file checksum '%s'.",
+					line + 11);
+				return (false);
+			}
+		}
+	}
+}
+
+// Build the timing information of a file without index, by reading all
+// packet headers (and the timestamp of the first event, for RAW files).
+static bool scanReplayFile(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	memset(&state->index, 0, sizeof(struct caer_file_index));
+	state->indexScanned = true;
+
+	if (state->compressed) {
+		caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+			"CAERDELTA replay file has no packet index, it will be sent without pacing.");
+	}
+
+	size_t capacity = 0;
+	off_t offset = state->dataOffset;
+	int64_t lastTimestamp = 0;
+
+	while (true) {
+		struct caer_event_packet_header header;
+		if (pread(state->fileDescriptor, &header, CAER_EVENT_PACKET_HEADER_SIZE, offset)
+			!= (ssize_t) CAER_EVENT_PACKET_HEADER_SIZE
+			|| caerEventPacketHeaderGetEventType(&header) == CAER_FILE_INDEX_EVENT_TYPE) {
+			break;
+		}
+
+		int32_t eventNumber = caerEventPacketHeaderGetEventNumber(&header);
+		int32_t eventSize = caerEventPacketHeaderGetEventSize(&header);
+
+		if (eventNumber < 0 || eventSize <= 0) {
+			break;
+		}
+
+		off_t packetSize = (off_t) CAER_EVENT_PACKET_HEADER_SIZE;
+		int64_t timestamp = lastTimestamp;
+
+		if (state->compressed) {
+			uint32_t payloadLength;
+			if (pread(state->fileDescriptor, &payloadLength, sizeof(uint32_t), offset + packetSize)
+				!= (ssize_t) sizeof(uint32_t)) {
+				break;
+			}
+
+			packetSize += (off_t) sizeof(uint32_t) + (off_t) le32toh(payloadLength);
+		}
+		else {
+			if (eventNumber > 0) {
+				int32_t eventTimestamp;
+				if (pread(state->fileDescriptor, &eventTimestamp, sizeof(int32_t),
+					offset + packetSize + caerEventPacketHeaderGetEventTSOffset(&header))
+					!= (ssize_t) sizeof(int32_t)) {
+					break;
+				}
+
+				timestamp = I64T(
+					(U64T(caerEventPacketHeaderGetEventTSOverflow(&header)) << 31)
+						| U64T(I32T(le32toh(U32T(eventTimestamp))) & INT32_MAX));
+			}
+
+			packetSize += (off_t) eventNumber * (off_t) eventSize;
+		}
+
+		if (state->checksum) {
+			packetSize += (off_t) sizeof(uint32_t);
+		}
+
+		if (state->index.length == capacity) {
+			size_t newCapacity = (capacity == 0) ? (1024) : (capacity * 2);
+
+			caerFileIndexEntry newEntries = realloc(state->index.entries,
+				newCapacity * sizeof(struct caer_file_index_entry));
+			if (newEntries == NULL) {
+				caerLog(CAER_LOG_CRITICAL, moduleData->moduleSubSystemString,
+					"Failed to allocate memory for replay file packet list.");
+				return (false);
+			}
+
+			state->index.entries = newEntries;
+			capacity = newCapacity;
+		}
+
+		caerFileIndexEntrySet(&state->index.entries[state->index.length], caerEventPacketHeaderGetEventType(&header),
+			caerEventPacketHeaderGetEventSource(&header), timestamp, eventNumber, (uint64_t) offset);
+		state->index.length++;
+
+		lastTimestamp = timestamp;
+		offset += packetSize;
+	}
+
+	// Only complete packets are sent.
+	state->dataEnd = offset;
+
+	return (true);
+}
+
+static void updatePaceSettings(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	float speed = sshsNodeGetFloat(moduleData->moduleNode, "speed");
+	state->speed = (speed > 0) ? ((double) speed) : (0);
+	state->loop = sshsNodeGetBool(moduleData->moduleNode, "loop");
+	int32_t startOffset = sshsNodeGetInt(moduleData->moduleNode, "startOffset");
+	state->defaultStartOffset = I64T(startOffset) * 1000;
+	state->requestTimeout = sshsNodeGetInt(moduleData->moduleNode, "requestTimeout");
+}
+
+static int replayServerThread(void *moduleDataPtr) {
+	caerModuleData moduleData = moduleDataPtr;
+	replayState state = moduleData->moduleState;
+
+	while (atomic_load(&state->running)) {
+		struct timespec now;
+		portable_clock_gettime_monotonic(&now);
+
+		if (atomic_exchange(&state->paceUpdate, false)) {
+			updatePaceSettings(moduleData);
+
+			// Continue from where each client is now, at the new speed.
+			for (size_t c = 0; c < state->clientsLength; c++) {
+				if (state->clients[c].phase == REPLAY_CLIENT_STREAM && state->clients[c].nextEntry > 0) {
+					state->clients[c].paceTimestamp = caerFileIndexEntryGetTimestamp64(
+						&state->index.entries[state->clients[c].nextEntry - 1]);
+					state->clients[c].paceTime = now;
+				}
+			}
+		}
+
+		// Release what's due for every client, and find out how long until
+		// something else is.
+		int64_t waitTime = POLL_MAX_WAIT;
+
+		for (size_t c = 0; c < state->clientsLength; c++) {
+			if (state->clients[c].phase == REPLAY_CLIENT_FREE) {
+				continue;
+			}
+
+			int64_t clientWait = releaseClient(moduleData, c, &now);
+			if (clientWait < waitTime) {
+				waitTime = clientWait;
+			}
+		}
+
+		// Wait for new clients, requests and disconnects, and for clients
+		// with data ready to send to be able to take it.
+		state->pollDescriptors[0].fd = state->serverDescriptor;
+		state->pollDescriptors[0].events = POLLIN;
+		state->pollDescriptors[0].revents = 0;
+
+		for (size_t c = 0; c < state->clientsLength; c++) {
+			struct replay_client *client = &state->clients[c];
+
+			state->pollDescriptors[c + 1].fd = client->fileDescriptor;
+			state->pollDescriptors[c + 1].events = POLLIN;
+			state->pollDescriptors[c + 1].revents = 0;
+
+			if (client->phase == REPLAY_CLIENT_STREAM && client->sendOffset < client->sendEnd) {
+				state->pollDescriptors[c + 1].events |= POLLOUT;
+			}
+		}
+
+		int pollResult = poll(state->pollDescriptors, (nfds_t) (state->clientsLength + 1), (int) waitTime);
+		if (pollResult < 0) {
+			if (errno != EINTR) {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Replay server poll() failed. Error: %d.",
+				errno);
+			}
+
+			continue;
+		}
+
+		for (size_t c = 0; c < state->clientsLength; c++) {
+			short revents = state->pollDescriptors[c + 1].revents;
+
+			if (state->clients[c].fileDescriptor < 0 || revents == 0) {
+				continue;
+			}
+
+			if ((revents & (POLLIN | POLLERR | POLLHUP)) != 0) {
+				receiveRequest(moduleData, c);
+			}
+
+			if (state->clients[c].fileDescriptor >= 0 && (revents & POLLOUT) != 0) {
+				sendClient(moduleData, c);
+			}
+		}
+
+		if ((state->pollDescriptors[0].revents & POLLIN) != 0) {
+			acceptClient(moduleData);
+		}
+
+		publishStatistics(moduleData, false);
+	}
+
+	return (thrd_success);
+}
+
+static void acceptClient(caerModuleData moduleData) {
+	replayState state = moduleData->moduleState;
+
+	int acceptResult = accept(state->serverDescriptor, NULL, NULL);
+	if (acceptResult < 0) {
+		if (errno != EAGAIN && errno != EWOULDBLOCK) {
+			// Accept failure (but not would-block error). Log and then continue.
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "TCP server accept() failed. Error: %d.",
+			errno);
+		}
+
+		return;
+	}
+
+	// Clients never block the server: sendfile() sends what fits.
+	if (!socketBlockingMode(acceptResult, false)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Could not set TCP client socket (fd %d) to non-blocking mode.", acceptResult);
+		close(acceptResult);
+		return;
+	}
+
+	for (size_t c = 0; c < state->clientsLength; c++) {
+		struct replay_client *client = &state->clients[c];
+
+		if (client->phase == REPLAY_CLIENT_FREE) {
+			// Empty place, add this one. It gets a chance to send a start
+			// request before streaming begins.
+			memset(client, 0, sizeof(struct replay_client));
+			client->fileDescriptor = acceptResult;
+			client->phase = REPLAY_CLIENT_REQUEST;
+			client->startOffset = state->defaultStartOffset;
+			portable_clock_gettime_monotonic(&client->connectTime);
+
+			state->connectedClients++;
+
+			caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString,
+				"Accepted new TCP connection from client (fd %d).", acceptResult);
+			return;
+		}
+	}
+
+	// No space for new connection, just close it (client will exit).
+	close(acceptResult);
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Rejected TCP client (fd %d), queue full.",
+		acceptResult);
+}
+
+static void receiveRequest(caerModuleData moduleData, size_t client) {
+	replayState state = moduleData->moduleState;
+	struct replay_client *clientState = &state->clients[client];
+
+	// Only a start request or close() are ever expected from clients.
+	// Requests may arrive in pieces, so collect them until complete. Once
+	// streaming, anything else is just thrown away.
+	uint8_t discardBuffer[CAER_NET_REPLAY_REQUEST_SIZE];
+	uint8_t *recvBuffer = discardBuffer;
+	size_t recvLength = CAER_NET_REPLAY_REQUEST_SIZE;
+
+	if (clientState->phase == REPLAY_CLIENT_REQUEST) {
+		recvBuffer = clientState->requestBuffer + clientState->requestLength;
+		recvLength = CAER_NET_REPLAY_REQUEST_SIZE - clientState->requestLength;
+	}
+
+	ssize_t recvResult = recv(clientState->fileDescriptor, recvBuffer, recvLength, 0);
+
+	if (recvResult <= 0) {
+		if (recvResult < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			return;
+		}
+
+		// Recv failure or closed connection.
+		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Disconnected TCP client on recv (fd %d).",
+			clientState->fileDescriptor);
+		closeClient(moduleData, client);
+		return;
+	}
+
+	if (clientState->phase != REPLAY_CLIENT_REQUEST) {
+		return;
+	}
+
+	clientState->requestLength += (size_t) recvResult;
+	if (clientState->requestLength < CAER_NET_REPLAY_REQUEST_SIZE) {
+		return;
+	}
+
+	struct caer_net_replay_request request;
+	memcpy(&request, clientState->requestBuffer, CAER_NET_REPLAY_REQUEST_SIZE);
+
+	if (!caerNetReplayRequestParse(&request)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Invalid start request from TCP client (fd %d), using default start.", clientState->fileDescriptor);
+	}
+	else if (request.startOffset >= 0) {
+		clientState->startOffset = request.startOffset;
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	startClient(moduleData, client, &now);
+}
+
+// Position a client at its start offset, and begin streaming.
+static void startClient(caerModuleData moduleData, size_t client, const struct timespec *now) {
+	replayState state = moduleData->moduleState;
+	struct replay_client *clientState = &state->clients[client];
+
+	clientState->phase = REPLAY_CLIENT_STREAM;
+	clientState->sendOffset = state->dataOffset;
+	clientState->nextEntry = 0;
+	clientState->paceTimestamp = 0;
+	clientState->paceTime = *now;
+
+	if (state->index.length > 0) {
+		int64_t firstTimestamp = caerFileIndexEntryGetTimestamp64(&state->index.entries[0]);
+
+		if (clientState->startOffset > 0) {
+			clientState->nextEntry = caerFileIndexFind(&state->index, firstTimestamp + clientState->startOffset);
+			clientState->sendOffset = (off_t) caerFileIndexEntryGetFileOffset(
+				&state->index.entries[clientState->nextEntry]);
+		}
+
+		clientState->paceTimestamp = caerFileIndexEntryGetTimestamp64(&state->index.entries[clientState->nextEntry]);
+	}
+
+	clientState->sendEnd = clientState->sendOffset;
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString,
+		"Streaming to TCP client (fd %d) from %" PRIi64 " µs into the recording.", clientState->fileDescriptor,
+		clientState->startOffset);
+}
+
+// Release all data that is due for a client, handling the end of the file
+// and the start request timeout. Returns the time until more data is due,
+// in ms, or POLL_MAX_WAIT if nothing is pending.
+static int64_t releaseClient(caerModuleData moduleData, size_t client, const struct timespec *now) {
+	replayState state = moduleData->moduleState;
+	struct replay_client *clientState = &state->clients[client];
+
+	if (clientState->phase == REPLAY_CLIENT_REQUEST) {
+		double waited = caerOutputCommonElapsed(&clientState->connectTime, now) * 1000;
+
+		if (waited < (double) state->requestTimeout) {
+			return ((int64_t) ((double) state->requestTimeout - waited) + 1);
+		}
+
+		startClient(moduleData, client, now);
+	}
+
+	// Still busy sending what was released before.
+	if (clientState->sendOffset < clientState->sendEnd) {
+		return (POLL_MAX_WAIT);
+	}
+
+	double elapsed = caerOutputCommonElapsed(&clientState->paceTime, now) * 1000;
+
+	while (clientState->nextEntry < state->index.length) {
+		if (state->speed > 0) {
+			int64_t entryTimestamp = caerFileIndexEntryGetTimestamp64(&state->index.entries[clientState->nextEntry]);
+			double due = ((double) (entryTimestamp - clientState->paceTimestamp) / 1000) / state->speed;
+
+			if (due > elapsed) {
+				if (clientState->sendOffset < clientState->sendEnd) {
+					// Send what's already released first.
+					return (POLL_MAX_WAIT);
+				}
+
+				return ((int64_t) (due - elapsed) + 1);
+			}
+		}
+
+		clientState->nextEntry++;
+		clientState->sendEnd =
+			(clientState->nextEntry < state->index.length) ?
+				((off_t) caerFileIndexEntryGetFileOffset(&state->index.entries[clientState->nextEntry])) :
+				(state->dataEnd);
+	}
+
+	if (clientState->nextEntry == state->index.length) {
+		// Without any timing, or past the last entry, the rest goes out as is.
+		clientState->sendEnd = state->dataEnd;
+	}
+
+	if (clientState->sendOffset < clientState->sendEnd) {
+		return (POLL_MAX_WAIT);
+	}
+
+	// All sent: start over, or say goodbye.
+	if (state->loop && state->dataEnd > state->dataOffset) {
+		clientState->startOffset = 0;
+		startClient(moduleData, client, now);
+		return (0);
+	}
+
+	caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Replay to TCP client (fd %d) complete.",
+		clientState->fileDescriptor);
+	closeClient(moduleData, client);
+
+	return (POLL_MAX_WAIT);
+}
+
+static void sendClient(caerModuleData moduleData, size_t client) {
+	replayState state = moduleData->moduleState;
+	struct replay_client *clientState = &state->clients[client];
+
+	off_t toSend = clientState->sendEnd - clientState->sendOffset;
+	if (toSend > SENDFILE_CHUNK_SIZE) {
+		toSend = SENDFILE_CHUNK_SIZE;
+	}
+
+	// The file position is never touched, so all clients share the same
+	// file descriptor; sendfile() updates sendOffset.
+	ssize_t sendResult = sendfile(clientState->fileDescriptor, state->fileDescriptor, &clientState->sendOffset,
+		(size_t) toSend);
+
+	if (sendResult < 0) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			return;
+		}
+
+		caerLog(CAER_LOG_DEBUG, moduleData->moduleSubSystemString, "Disconnected TCP client on send (fd %d).",
+			clientState->fileDescriptor);
+		closeClient(moduleData, client);
+		return;
+	}
+
+	state->bytesSent += (uint64_t) sendResult;
+}
+
+static void closeClient(caerModuleData moduleData, size_t client) {
+	replayState state = moduleData->moduleState;
+
+	close(state->clients[client].fileDescriptor);
+
+	state->clients[client].fileDescriptor = -1;
+	state->clients[client].phase = REPLAY_CLIENT_FREE;
+
+	state->connectedClients--;
+}
+
+static void publishStatistics(caerModuleData moduleData, bool force) {
+	replayState state = moduleData->moduleState;
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	if (!force && caerOutputCommonElapsed(&state->lastStatistics, &now) < 1) {
+		return;
+	}
+
+	state->lastStatistics = now;
+
+	sshsNodePutLong(moduleData->moduleNode, "clients", I64T(state->connectedClients));
+	sshsNodePutLong(moduleData->moduleNode, "bytesSent", I64T(state->bytesSent));
+}
+
+static void caerOutputReplayServerConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
+	const char *changeKey, enum sshs_node_attr_value_type changeType, union sshs_node_attr_value changeValue) {
+	UNUSED_ARGUMENT(node);
+	UNUSED_ARGUMENT(changeValue);
+
+	caerModuleData data = userData;
+
+	// Distinguish changes to the file or server, which need a restart, from
+	// pacing changes, by setting configUpdate appropriately like a bit-field.
+	if (event == ATTRIBUTE_MODIFIED) {
+		if ((changeType == STRING
+			&& (caerStrEquals(changeKey, "directory") || caerStrEquals(changeKey, "filename")
+				|| caerStrEquals(changeKey, "ipAddress")))
+			|| (changeType == SHORT
+				&& (caerStrEquals(changeKey, "portNumber") || caerStrEquals(changeKey, "backlogSize")
+					|| caerStrEquals(changeKey, "concurrentConnections")))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 0));
+		}
+
+		if ((changeType == FLOAT && caerStrEquals(changeKey, "speed"))
+			|| (changeType == BOOL && caerStrEquals(changeKey, "loop"))
+			|| (changeType == INT
+				&& (caerStrEquals(changeKey, "startOffset") || caerStrEquals(changeKey, "requestTimeout")))) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 1));
+		}
+	}
+}
@@ -0,0 +1,8 @@
+#ifndef REPLAY_SERVER_H_
+#define REPLAY_SERVER_H_
+
+#include "out_common.h"
+
+void caerOutputReplayServer(uint16_t moduleID);
+
+#endif /* REPLAY_SERVER_H_ */
@@ -10,6 +10,9 @@ struct unixs_state {
 	bool excludeHeader;
 	size_t maxBytesPerPacket;
 	struct iovec *sgioMemory;
+	caerValidCompactBuffer compactBuffer;
+	caerDeltaBuffer deltaBuffer;
+	caerOutputCommonRateLimiter rateLimiter;
 };
 
 typedef struct unixs_state *unixsState;
@@ -43,6 +46,8 @@ static bool caerOutputUnixSInit(caerModuleData moduleData) {
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "validEventsOnly", false);
 	sshsNodePutBoolIfAbsent(moduleData->moduleNode, "excludeHeader", false);
 	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxBytesPerPacket", 0);
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "format", "RAW");
+	caerOutputCommonRateLimitDefaults(moduleData->moduleNode);
 
 	// Open a Unix local socket on a known path, to be accessed by other processes.
 	state->unixSocketDescriptor = socket(AF_UNIX, SOCK_DGRAM, 0);
@@ -72,6 +77,7 @@ static bool caerOutputUnixSInit(caerModuleData moduleData) {
 	state->validOnly = sshsNodeGetBool(moduleData->moduleNode, "validEventsOnly");
 	state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 	state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+	caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
 
 	if (state->validOnly) {
 		state->sgioMemory = calloc(IOVEC_SIZE, sizeof(struct iovec));
@@ -88,6 +94,17 @@ static bool caerOutputUnixSInit(caerModuleData moduleData) {
 		state->sgioMemory = NULL;
 	}
 
+	// Reusable memory for compacting valid events, when they can't be sent
+	// using scatter/gather IO. Without it, temporary memory is used instead.
+	state->compactBuffer = caerValidCompactBufferInit();
+	if (state->compactBuffer == NULL) {
+		caerLog(CAER_LOG_ALERT, moduleData->moduleSubSystemString,
+			"Impossible to allocate memory for valid event compaction, using temporary memory.");
+	}
+
+	// Rate limits, if any are set.
+	caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
+
 	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
 	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerOutputUnixSConfigListener);
 
@@ -110,8 +127,20 @@ static void caerOutputUnixSRun(caerModuleData moduleData, size_t argsNumber, va_
 		if (packetHeader != NULL) {
 			if ((state->validOnly && caerEventPacketHeaderGetEventValid(packetHeader) > 0)
 				|| (!state->validOnly && caerEventPacketHeaderGetEventNumber(packetHeader) > 0)) {
-				caerOutputCommonSend(moduleData->moduleSubSystemString, packetHeader, state->unixSocketDescriptor,
-					state->sgioMemory, state->validOnly, state->excludeHeader, state->maxBytesPerPacket, false);
+				// Apply rate limits, this may drop or subsample the packet.
+				caerEventPacketHeader sendPacket = packetHeader;
+				bool validOnly = state->validOnly;
+
+				if (state->rateLimiter != NULL) {
+					sendPacket = caerOutputCommonRateLimit(state->rateLimiter, packetHeader, &validOnly);
+					if (sendPacket == NULL) {
+						continue;
+					}
+				}
+
+				caerOutputCommonSend(moduleData->moduleSubSystemString, sendPacket, state->unixSocketDescriptor,
+					state->sgioMemory, state->compactBuffer, state->deltaBuffer, validOnly,
+					state->excludeHeader, state->maxBytesPerPacket, NULL);
 			}
 		}
 	}
@@ -157,6 +186,12 @@ static void caerOutputUnixSConfig(caerModuleData moduleData) {
 	if (configUpdate & (0x01 << 2)) {
 		state->excludeHeader = sshsNodeGetBool(moduleData->moduleNode, "excludeHeader");
 		state->maxBytesPerPacket = (size_t) sshsNodeGetInt(moduleData->moduleNode, "maxBytesPerPacket");
+		caerOutputCommonUpdateFormat(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->deltaBuffer);
+	}
+
+	if (configUpdate & (0x01 << 3)) {
+		// Rate limiter settings changed.
+		caerOutputCommonUpdateRateLimit(moduleData->moduleSubSystemString, moduleData->moduleNode, &state->rateLimiter);
 	}
 
 	if (configUpdate & (0x01 << 1)) {
@@ -200,9 +235,17 @@ static void caerOutputUnixSExit(caerModuleData moduleData) {
 	// Close open local Unix socket.
 	close(state->unixSocketDescriptor);
 
-	// Make sure to free scatter/gather IO memory.
+	// Make sure to free scatter/gather IO and compression memory.
 	free(state->sgioMemory);
 	state->sgioMemory = NULL;
+
+	caerDeltaBufferFree(state->deltaBuffer);
+	state->deltaBuffer = NULL;
+
+	caerOutputCommonRateLimitFree(&state->rateLimiter);
+
+	caerValidCompactBufferFree(state->compactBuffer);
+	state->compactBuffer = NULL;
 }
 
 static void caerOutputUnixSConfigListener(sshsNode node, void *userData, enum sshs_node_attribute_events event,
@@ -224,8 +267,13 @@ static void caerOutputUnixSConfigListener(sshsNode node, void *userData, enum ss
 		}
 
 		if ((changeType == BOOL && caerStrEquals(changeKey, "excludeHeader"))
-			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))) {
+			|| (changeType == INT && caerStrEquals(changeKey, "maxBytesPerPacket"))
+			|| (changeType == STRING && caerStrEquals(changeKey, "format"))) {
 			atomic_fetch_or(&data->configUpdate, (0x01 << 2));
 		}
+
+		if (caerOutputCommonRateLimitSetting(changeKey, changeType)) {
+			atomic_fetch_or(&data->configUpdate, (0x01 << 3));
+		}
 	}
 }
@@ -0,0 +1,750 @@
+/*
+ * motioncompensation.c
+ *
+ *  A rotating camera smears every edge over all the pixels it sweeps during
+ *  a packet. This module integrates the gyro readings of the IMU into the
+ *  camera orientation, and moves every polarity event to where its pixel
+ *  points at the reference time, the timestamp of the last event in the
+ *  packet. Only rotation is compensated, not translation.
+ *  The direction every pixel looks in is computed once, from the intrinsics
+ *  and lens distortion in the file written by the cameracalibration module.
+ *  Events within sliceTime µs of each other share one rotation, and are
+ *  rotated and projected back in batches. Like the undistortion of the
+ *  cameracalibration module, the resulting addresses are undistorted.
+ */
+
+#include "motioncompensation.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "ext/portable_time.h"
+
+#include <math.h>
+#include <mxml.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+	#include <immintrin.h>
+	#define MOTION_AVX 1
+#endif
+
+// Events rotated together, at most.
+#define MOTION_BATCH_SIZE 256
+
+// Gyro samples kept, at most, when no polarity events come to use them up.
+#define MOTION_MAX_SAMPLES 8192
+
+// Iterations to invert the lens distortion, per pixel.
+#define MOTION_UNDISTORT_ITERATIONS 20
+
+// Bearings closer than this to the image plane after rotation, on unit
+// vectors, are considered out of view.
+#define MOTION_MIN_DEPTH 0.01f
+
+// How often the statistics are updated, in seconds.
+#define MOTION_STATS_INTERVAL 1
+
+// Angles below this, in radians, are treated as zero, to not divide by them.
+// The build warns on unsuffixed floating constants, so these are written
+// like in <float.h>, as a long double cast to double.
+#define MOTION_MIN_ANGLE ((double) 1e-9L)
+#define MOTION_PI ((double) 3.14159265358979323846L)
+
+struct motion_sample {
+	int64_t timestamp;
+	// Camera orientation at timestamp, as unit quaternion (w, x, y, z),
+	// relative to the first sample.
+	double orientation[4];
+	// Angular velocity from timestamp on, in rad/s.
+	double angularVelocity[3];
+};
+
+// Events of one slice, as structure of arrays, so the rotation can work on
+// several of them at once.
+struct motion_batch {
+	float bearingX[MOTION_BATCH_SIZE];
+	float bearingY[MOTION_BATCH_SIZE];
+	float bearingZ[MOTION_BATCH_SIZE];
+	int32_t newX[MOTION_BATCH_SIZE];
+	int32_t newY[MOTION_BATCH_SIZE];
+	caerPolarityEvent events[MOTION_BATCH_SIZE];
+	size_t length;
+	int64_t firstTimestamp;
+	int64_t lastTimestamp;
+};
+
+struct motion_state {
+	// Unit bearing vector of every pixel, as three planes (x, y, z) of
+	// sizeX * sizeY each.
+	float *bearings;
+	int16_t sizeX;
+	int16_t sizeY;
+	// Focal lengths and principal point, to project back to pixels.
+	float camera[4];
+	bool calibrationLoaded;
+	bool calibrationFailed;
+	// Gyro samples, oldest first.
+	struct motion_sample *samples;
+	size_t samplesLength;
+	size_t samplesCapacity;
+	struct motion_batch batch;
+	// Settings.
+	char *calibrationFile;
+	int64_t sliceTime;
+	// Statistics.
+	struct timespec statsTime;
+	int64_t compensatedEvents;
+	int64_t invalidatedEvents;
+	int64_t uncompensatedEvents;
+};
+
+typedef struct motion_state *motionState;
+
+static bool caerMotionCompensationInit(caerModuleData moduleData);
+static void caerMotionCompensationRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerMotionCompensationConfig(caerModuleData moduleData);
+static void caerMotionCompensationExit(caerModuleData moduleData);
+static bool loadCalibration(caerModuleData moduleData, int16_t sourceID);
+static size_t xmlReadValues(mxml_node_t *root, const char *name, double *values, size_t valuesLength);
+static void pixelBearing(const double cameraMatrix[9], const double distortion[8], bool fisheye, double x, double y,
+	double bearing[3]);
+static bool gyroIntegrate(motionState state, caerIMU6EventPacket imu);
+static void samplesDrop(motionState state, size_t number);
+static void orientationAdvance(const struct motion_sample *sample, int64_t timestamp, double orientation[4]);
+static void orientationAt(motionState state, int64_t timestamp, double orientation[4]);
+static void quaternionMultiply(const double a[4], const double b[4], double result[4]);
+static void compensatePacket(motionState state, caerPolarityEventPacket polarity);
+static void batchCompensate(motionState state, const double referenceInverse[4], caerPolarityEventPacket polarity);
+static void rotateProjectScalar(struct motion_batch *batch, size_t start, const float rotation[9],
+	const float camera[4]);
+#if defined(MOTION_AVX)
+static void rotateProjectAVX(struct motion_batch *batch, const float rotation[9], const float camera[4]);
+#endif
+static void updateStatistics(caerModuleData moduleData, const struct timespec *now);
+
+static struct caer_module_functions caerMotionCompensationFunctions = { .moduleInit = &caerMotionCompensationInit,
+	.moduleRun = &caerMotionCompensationRun, .moduleConfig = &caerMotionCompensationConfig, .moduleExit =
+		&caerMotionCompensationExit };
+
+void caerMotionCompensation(uint16_t moduleID, caerPolarityEventPacket polarity, caerIMU6EventPacket imu) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "MotionCompensation");
+
+	caerModuleSM(&caerMotionCompensationFunctions, moduleData, sizeof(struct motion_state), 2, polarity, imu);
+}
+
+static bool caerMotionCompensationInit(caerModuleData moduleData) {
+	// Calibration file written by the cameracalibration module.
+	sshsNodePutStringIfAbsent(moduleData->moduleNode, "calibrationFile", "camera_calib.xml");
+	// Events within this many µs share one rotation.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "sliceTime", 500);
+
+	// Statistics, read-only.
+	sshsNodePutLong(moduleData->moduleNode, "compensatedEvents", 0);
+	sshsNodePutLong(moduleData->moduleNode, "invalidatedEvents", 0);
+	sshsNodePutLong(moduleData->moduleNode, "uncompensatedEvents", 0);
+
+	motionState state = moduleData->moduleState;
+
+	caerMotionCompensationConfig(moduleData);
+
+	portable_clock_gettime_monotonic(&state->statsTime);
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	return (true);
+}
+
+static void caerMotionCompensationRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	UNUSED_ARGUMENT(argsNumber);
+
+	// Interpret variable arguments (same as above in main function).
+	caerPolarityEventPacket polarity = va_arg(args, caerPolarityEventPacket);
+	caerIMU6EventPacket imu = va_arg(args, caerIMU6EventPacket);
+
+	motionState state = moduleData->moduleState;
+
+	// Gyro first, so the events of the same time span can use it.
+	if (imu != NULL && !gyroIntegrate(state, imu)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for gyro samples.");
+	}
+
+	if (polarity != NULL && caerEventPacketHeaderGetEventValid(&polarity->packetHeader) > 0) {
+		if (!state->calibrationLoaded && !state->calibrationFailed) {
+			state->calibrationLoaded = loadCalibration(moduleData,
+				caerEventPacketHeaderGetEventSource(&polarity->packetHeader));
+
+			// Don't try again until the file setting changes.
+			state->calibrationFailed = !state->calibrationLoaded;
+		}
+
+		if (state->calibrationLoaded && state->samplesLength > 0) {
+			compensatePacket(state, polarity);
+		}
+		else {
+			state->uncompensatedEvents += caerEventPacketHeaderGetEventValid(&polarity->packetHeader);
+		}
+	}
+
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	updateStatistics(moduleData, &now);
+}
+
+static void caerMotionCompensationConfig(caerModuleData moduleData) {
+	caerModuleConfigUpdateReset(moduleData);
+
+	motionState state = moduleData->moduleState;
+
+	state->sliceTime = I64T(sshsNodeGetInt(moduleData->moduleNode, "sliceTime"));
+
+	// Statistics updates end up here too, so only load the calibration again
+	// if the file actually changed.
+	char *calibrationFile = sshsNodeGetString(moduleData->moduleNode, "calibrationFile");
+
+	if (caerStrEquals(calibrationFile, state->calibrationFile)) {
+		free(calibrationFile);
+	}
+	else {
+		free(state->calibrationFile);
+		state->calibrationFile = calibrationFile;
+
+		state->calibrationLoaded = false;
+		state->calibrationFailed = false;
+	}
+}
+
+static void caerMotionCompensationExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	motionState state = moduleData->moduleState;
+
+	free(state->bearings);
+	state->bearings = NULL;
+
+	free(state->samples);
+	state->samples = NULL;
+	state->samplesLength = 0;
+	state->samplesCapacity = 0;
+
+	free(state->calibrationFile);
+	state->calibrationFile = NULL;
+}
+
+static bool loadCalibration(caerModuleData moduleData, int16_t sourceID) {
+	motionState state = moduleData->moduleState;
+
+	FILE *calibrationFile = fopen(state->calibrationFile, "r");
+	if (calibrationFile == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to open calibration file '%s'.",
+			state->calibrationFile);
+		return (false);
+	}
+
+	mxml_node_t *root = mxmlLoadFile(NULL, calibrationFile, MXML_OPAQUE_CALLBACK);
+
+	fclose(calibrationFile);
+
+	if (root == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to load XML from calibration file '%s'.",
+			state->calibrationFile);
+		return (false);
+	}
+
+	double cameraMatrix[9];
+	double distortion[8] = { 0 };
+	double imageWidth = 0;
+	double imageHeight = 0;
+	double fisheye = 0;
+
+	size_t cameraMatrixLength = xmlReadValues(root, "camera_matrix", cameraMatrix, 9);
+	xmlReadValues(root, "distortion_coefficients", distortion, 8);
+	size_t imageSizeLength = xmlReadValues(root, "image_width", &imageWidth, 1)
+		+ xmlReadValues(root, "image_height", &imageHeight, 1);
+	xmlReadValues(root, "use_fisheye_model", &fisheye, 1);
+
+	mxmlDelete(root);
+
+	if (cameraMatrixLength != 9 || cameraMatrix[0] <= 0 || cameraMatrix[4] <= 0) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "No valid camera_matrix in calibration file '%s'.",
+			state->calibrationFile);
+		return (false);
+	}
+
+	// Get size information from source.
+	sshsNode sourceInfoNode = caerMainloopGetSourceInfo(U16T(sourceID));
+	int16_t sizeX = sshsNodeGetShort(sourceInfoNode, "dvsSizeX");
+	int16_t sizeY = sshsNodeGetShort(sourceInfoNode, "dvsSizeY");
+
+	if (imageSizeLength == 2 && (lrint(imageWidth) != sizeX || lrint(imageHeight) != sizeY)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Calibration file '%s' is for %ldx%ld pixels, but the source has %" PRIi16 "x%" PRIi16 ".",
+			state->calibrationFile, lrint(imageWidth), lrint(imageHeight), sizeX, sizeY);
+		return (false);
+	}
+
+	size_t planeSize = (size_t) sizeX * (size_t) sizeY;
+
+	float *bearings = malloc(3 * planeSize * sizeof(float));
+	if (bearings == NULL) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString, "Failed to allocate memory for bearing table.");
+		return (false);
+	}
+
+	for (int16_t y = 0; y < sizeY; y++) {
+		for (int16_t x = 0; x < sizeX; x++) {
+			double bearing[3];
+			pixelBearing(cameraMatrix, distortion, (lrint(fisheye) != 0), x, y, bearing);
+
+			size_t pixel = ((size_t) y * (size_t) sizeX) + (size_t) x;
+
+			bearings[pixel] = (float) bearing[0];
+			bearings[planeSize + pixel] = (float) bearing[1];
+			bearings[(2 * planeSize) + pixel] = (float) bearing[2];
+		}
+	}
+
+	free(state->bearings);
+	state->bearings = bearings;
+	state->sizeX = sizeX;
+	state->sizeY = sizeY;
+
+	state->camera[0] = (float) cameraMatrix[0];
+	state->camera[1] = (float) cameraMatrix[4];
+	state->camera[2] = (float) cameraMatrix[2];
+	state->camera[3] = (float) cameraMatrix[5];
+
+	caerLog(CAER_LOG_INFO, moduleData->moduleSubSystemString, "Loaded calibration from '%s'.", state->calibrationFile);
+
+	return (true);
+}
+
+// Read up to valuesLength numbers from the named element of an OpenCV
+// storage file, be it a plain value or the data of a matrix.
+static size_t xmlReadValues(mxml_node_t *root, const char *name, double *values, size_t valuesLength) {
+	mxml_node_t *node = mxmlFindElement(root, root, name, NULL, NULL, MXML_DESCEND);
+	if (node == NULL) {
+		return (0);
+	}
+
+	mxml_node_t *data = mxmlFindElement(node, node, "data", NULL, NULL, MXML_DESCEND);
+
+	const char *text = mxmlGetOpaque((data != NULL) ? (data) : (node));
+	if (text == NULL) {
+		return (0);
+	}
+
+	size_t length = 0;
+
+	while (length < valuesLength) {
+		char *end;
+		double value = strtod(text, &end);
+
+		if (end == text) {
+			break;
+		}
+
+		values[length++] = value;
+		text = end;
+	}
+
+	return (length);
+}
+
+// Unit vector, in camera coordinates, along which pixel (x, y) looks.
+// Inverts the lens distortion iteratively, the same way OpenCV does.
+static void pixelBearing(const double cameraMatrix[9], const double distortion[8], bool fisheye, double x, double y,
+	double bearing[3]) {
+	double distortedX = (x - cameraMatrix[2]) / cameraMatrix[0];
+	double distortedY = (y - cameraMatrix[5]) / cameraMatrix[4];
+
+	double undistortedX = distortedX;
+	double undistortedY = distortedY;
+
+	if (fisheye) {
+		// Distortion acts on the angle to the optical axis only.
+		double distortedTheta = sqrt((distortedX * distortedX) + (distortedY * distortedY));
+
+		if (distortedTheta > MOTION_MIN_ANGLE) {
+			distortedTheta = fmin(distortedTheta, MOTION_PI / 2);
+
+			double theta = distortedTheta;
+
+			for (size_t i = 0; i < MOTION_UNDISTORT_ITERATIONS; i++) {
+				double theta2 = theta * theta;
+
+				theta = distortedTheta
+					/ (1
+						+ (theta2
+							* (distortion[0]
+								+ (theta2 * (distortion[1] + (theta2 * (distortion[2] + (theta2 * distortion[3]))))))));
+			}
+
+			double scale = tan(theta) / distortedTheta;
+
+			undistortedX = distortedX * scale;
+			undistortedY = distortedY * scale;
+		}
+	}
+	else {
+		// Coefficients are k1, k2, p1, p2, k3, k4, k5, k6.
+		for (size_t i = 0; i < MOTION_UNDISTORT_ITERATIONS; i++) {
+			double r2 = (undistortedX * undistortedX) + (undistortedY * undistortedY);
+
+			double inverseRadial = (1 + (r2 * (distortion[5] + (r2 * (distortion[6] + (r2 * distortion[7]))))))
+				/ (1 + (r2 * (distortion[0] + (r2 * (distortion[1] + (r2 * distortion[4]))))));
+
+			double tangentialX = (2 * distortion[2] * undistortedX * undistortedY)
+				+ (distortion[3] * (r2 + (2 * undistortedX * undistortedX)));
+			double tangentialY = (distortion[2] * (r2 + (2 * undistortedY * undistortedY)))
+				+ (2 * distortion[3] * undistortedX * undistortedY);
+
+			undistortedX = (distortedX - tangentialX) * inverseRadial;
+			undistortedY = (distortedY - tangentialY) * inverseRadial;
+		}
+	}
+
+	double norm = sqrt((undistortedX * undistortedX) + (undistortedY * undistortedY) + 1);
+
+	bearing[0] = undistortedX / norm;
+	bearing[1] = undistortedY / norm;
+	bearing[2] = 1 / norm;
+}
+
+// Append the gyro samples of the packet, with the orientation integrated up
+// to each of them. The gyro axes are taken to be the camera axes.
+static bool gyroIntegrate(motionState state, caerIMU6EventPacket imu) {
+	CAER_IMU6_ITERATOR_VALID_START(imu)
+		int64_t timestamp = caerIMU6EventGetTimestamp64(caerIMU6IteratorElement, imu);
+
+		if (state->samplesLength > 0) {
+			int64_t lastTimestamp = state->samples[state->samplesLength - 1].timestamp;
+
+			if (timestamp == lastTimestamp) {
+				continue;
+			}
+
+			// Timestamps went back, after a reset: start over.
+			if (timestamp < lastTimestamp) {
+				state->samplesLength = 0;
+			}
+		}
+
+		if (state->samplesLength == MOTION_MAX_SAMPLES) {
+			samplesDrop(state, MOTION_MAX_SAMPLES / 2);
+		}
+
+		if (state->samplesLength == state->samplesCapacity) {
+			size_t newCapacity = (state->samplesCapacity == 0) ? (64) : (state->samplesCapacity * 2);
+
+			struct motion_sample *newSamples = realloc(state->samples, newCapacity * sizeof(struct motion_sample));
+			if (newSamples == NULL) {
+				return (false);
+			}
+
+			state->samples = newSamples;
+			state->samplesCapacity = newCapacity;
+		}
+
+		struct motion_sample *sample = &state->samples[state->samplesLength];
+
+		sample->timestamp = timestamp;
+		sample->angularVelocity[0] = (double) caerIMU6EventGetGyroX(caerIMU6IteratorElement) * (MOTION_PI / 180);
+		sample->angularVelocity[1] = (double) caerIMU6EventGetGyroY(caerIMU6IteratorElement) * (MOTION_PI / 180);
+		sample->angularVelocity[2] = (double) caerIMU6EventGetGyroZ(caerIMU6IteratorElement) * (MOTION_PI / 180);
+
+		if (state->samplesLength == 0) {
+			sample->orientation[0] = 1;
+			sample->orientation[1] = 0;
+			sample->orientation[2] = 0;
+			sample->orientation[3] = 0;
+		}
+		else {
+			orientationAdvance(&state->samples[state->samplesLength - 1], timestamp, sample->orientation);
+		}
+
+		state->samplesLength++;
+	CAER_IMU6_ITERATOR_VALID_END
+
+	return (true);
+}
+
+static void samplesDrop(motionState state, size_t number) {
+	if (number == 0) {
+		return;
+	}
+
+	memmove(state->samples, state->samples + number, (state->samplesLength - number) * sizeof(struct motion_sample));
+	state->samplesLength -= number;
+}
+
+// Orientation at timestamp, turning on from the sample at its angular
+// velocity, or back if timestamp is before it.
+static void orientationAdvance(const struct motion_sample *sample, int64_t timestamp, double orientation[4]) {
+	double elapsed = (double) (timestamp - sample->timestamp) / 1000000;
+
+	double rotationX = sample->angularVelocity[0] * elapsed;
+	double rotationY = sample->angularVelocity[1] * elapsed;
+	double rotationZ = sample->angularVelocity[2] * elapsed;
+
+	double angle = sqrt((rotationX * rotationX) + (rotationY * rotationY) + (rotationZ * rotationZ));
+
+	// Half-angle sine over angle, approaching 1/2 for small angles.
+	double scale = (angle < MOTION_MIN_ANGLE) ? ((double) 1 / 2) : (sin(angle / 2) / angle);
+
+	double delta[4] = { cos(angle / 2), rotationX * scale, rotationY * scale, rotationZ * scale };
+
+	quaternionMultiply(sample->orientation, delta, orientation);
+
+	double norm = sqrt(
+		(orientation[0] * orientation[0]) + (orientation[1] * orientation[1]) + (orientation[2] * orientation[2])
+			+ (orientation[3] * orientation[3]));
+
+	for (size_t i = 0; i < 4; i++) {
+		orientation[i] /= norm;
+	}
+}
+
+static void orientationAt(motionState state, int64_t timestamp, double orientation[4]) {
+	// Last sample at or before timestamp, or the first one if there is none.
+	size_t low = 0;
+	size_t high = state->samplesLength;
+
+	while ((high - low) > 1) {
+		size_t middle = low + ((high - low) / 2);
+
+		if (state->samples[middle].timestamp <= timestamp) {
+			low = middle;
+		}
+		else {
+			high = middle;
+		}
+	}
+
+	orientationAdvance(&state->samples[low], timestamp, orientation);
+}
+
+static void quaternionMultiply(const double a[4], const double b[4], double result[4]) {
+	result[0] = (a[0] * b[0]) - (a[1] * b[1]) - (a[2] * b[2]) - (a[3] * b[3]);
+	result[1] = (a[0] * b[1]) + (a[1] * b[0]) + (a[2] * b[3]) - (a[3] * b[2]);
+	result[2] = (a[0] * b[2]) - (a[1] * b[3]) + (a[2] * b[0]) + (a[3] * b[1]);
+	result[3] = (a[0] * b[3]) + (a[1] * b[2]) - (a[2] * b[1]) + (a[3] * b[0]);
+}
+
+static void compensatePacket(motionState state, caerPolarityEventPacket polarity) {
+	// Reference time is the one of the last valid event.
+	int64_t referenceTimestamp = 0;
+
+	for (int32_t i = caerEventPacketHeaderGetEventNumber(&polarity->packetHeader) - 1; i >= 0; i--) {
+		caerPolarityEvent event = caerPolarityEventPacketGetEvent(polarity, i);
+
+		if (caerPolarityEventIsValid(event)) {
+			referenceTimestamp = caerPolarityEventGetTimestamp64(event, polarity);
+			break;
+		}
+	}
+
+	double referenceInverse[4];
+	orientationAt(state, referenceTimestamp, referenceInverse);
+
+	// Unit quaternion: the inverse is the conjugate.
+	referenceInverse[1] = -referenceInverse[1];
+	referenceInverse[2] = -referenceInverse[2];
+	referenceInverse[3] = -referenceInverse[3];
+
+	struct motion_batch *batch = &state->batch;
+	size_t planeSize = (size_t) state->sizeX * (size_t) state->sizeY;
+
+	batch->length = 0;
+
+	CAER_POLARITY_ITERATOR_VALID_START(polarity)
+		int64_t timestamp = caerPolarityEventGetTimestamp64(caerPolarityIteratorElement, polarity);
+		uint16_t x = caerPolarityEventGetX(caerPolarityIteratorElement);
+		uint16_t y = caerPolarityEventGetY(caerPolarityIteratorElement);
+
+		if (x >= state->sizeX || y >= state->sizeY) {
+			state->uncompensatedEvents++;
+			continue;
+		}
+
+		// Slice complete.
+		if (batch->length == MOTION_BATCH_SIZE
+			|| (batch->length > 0 && timestamp >= (batch->firstTimestamp + state->sliceTime))) {
+			batchCompensate(state, referenceInverse, polarity);
+		}
+
+		if (batch->length == 0) {
+			batch->firstTimestamp = timestamp;
+		}
+
+		size_t pixel = ((size_t) y * (size_t) state->sizeX) + x;
+
+		batch->bearingX[batch->length] = state->bearings[pixel];
+		batch->bearingY[batch->length] = state->bearings[planeSize + pixel];
+		batch->bearingZ[batch->length] = state->bearings[(2 * planeSize) + pixel];
+		batch->events[batch->length] = caerPolarityIteratorElement;
+		batch->lastTimestamp = timestamp;
+		batch->length++;
+	CAER_POLARITY_ITERATOR_VALID_END
+
+	if (batch->length > 0) {
+		batchCompensate(state, referenceInverse, polarity);
+	}
+
+	// Events come in time order, so the samples before the last one at or
+	// before the reference time won't be needed anymore.
+	size_t unneeded = 0;
+
+	while ((unneeded + 1) < state->samplesLength && state->samples[unneeded + 1].timestamp <= referenceTimestamp) {
+		unneeded++;
+	}
+
+	samplesDrop(state, unneeded);
+}
+
+// Rotate all events of the batch by the camera rotation from the middle of
+// the batch to the reference time, and move them to where they land.
+static void batchCompensate(motionState state, const double referenceInverse[4], caerPolarityEventPacket polarity) {
+	struct motion_batch *batch = &state->batch;
+
+	double orientation[4];
+	orientationAt(state, batch->firstTimestamp + ((batch->lastTimestamp - batch->firstTimestamp) / 2), orientation);
+
+	double q[4];
+	quaternionMultiply(referenceInverse, orientation, q);
+
+	// As row-major rotation matrix.
+	float rotation[9];
+	rotation[0] = (float) (1 - (2 * ((q[2] * q[2]) + (q[3] * q[3]))));
+	rotation[1] = (float) (2 * ((q[1] * q[2]) - (q[0] * q[3])));
+	rotation[2] = (float) (2 * ((q[1] * q[3]) + (q[0] * q[2])));
+	rotation[3] = (float) (2 * ((q[1] * q[2]) + (q[0] * q[3])));
+	rotation[4] = (float) (1 - (2 * ((q[1] * q[1]) + (q[3] * q[3]))));
+	rotation[5] = (float) (2 * ((q[2] * q[3]) - (q[0] * q[1])));
+	rotation[6] = (float) (2 * ((q[1] * q[3]) - (q[0] * q[2])));
+	rotation[7] = (float) (2 * ((q[2] * q[3]) + (q[0] * q[1])));
+	rotation[8] = (float) (1 - (2 * ((q[1] * q[1]) + (q[2] * q[2]))));
+
+#if defined(MOTION_AVX)
+	if (__builtin_cpu_supports("avx")) {
+		rotateProjectAVX(batch, rotation, state->camera);
+	}
+	else {
+		rotateProjectScalar(batch, 0, rotation, state->camera);
+	}
+#else
+	rotateProjectScalar(batch, 0, rotation, state->camera);
+#endif
+
+	for (size_t i = 0; i < batch->length; i++) {
+		if (batch->newX[i] < 0 || batch->newX[i] >= state->sizeX || batch->newY[i] < 0
+			|| batch->newY[i] >= state->sizeY) {
+			caerPolarityEventInvalidate(batch->events[i], polarity);
+			state->invalidatedEvents++;
+		}
+		else {
+			caerPolarityEventSetX(batch->events[i], U16T(batch->newX[i]));
+			caerPolarityEventSetY(batch->events[i], U16T(batch->newY[i]));
+			state->compensatedEvents++;
+		}
+	}
+
+	batch->length = 0;
+}
+
+// Rotate the bearings of the batch from start on, and project them back to
+// pixel addresses. Out of view is -1.
+static void rotateProjectScalar(struct motion_batch *batch, size_t start, const float rotation[9],
+	const float camera[4]) {
+	for (size_t i = start; i < batch->length; i++) {
+		float x = (rotation[0] * batch->bearingX[i]) + (rotation[1] * batch->bearingY[i])
+			+ (rotation[2] * batch->bearingZ[i]);
+		float y = (rotation[3] * batch->bearingX[i]) + (rotation[4] * batch->bearingY[i])
+			+ (rotation[5] * batch->bearingZ[i]);
+		float z = (rotation[6] * batch->bearingX[i]) + (rotation[7] * batch->bearingY[i])
+			+ (rotation[8] * batch->bearingZ[i]);
+
+		float u = ((camera[0] * x) / z) + camera[2];
+		float v = ((camera[1] * y) / z) + camera[3];
+
+		// Far outside is out of view too, before the conversion can overflow.
+		if (z <= MOTION_MIN_DEPTH || u <= -1.0f || u >= 32768.0f || v <= -1.0f || v >= 32768.0f) {
+			batch->newX[i] = -1;
+			batch->newY[i] = -1;
+			continue;
+		}
+
+		batch->newX[i] = I32T(lrintf(u));
+		batch->newY[i] = I32T(lrintf(v));
+	}
+}
+
+#if defined(MOTION_AVX)
+
+// Same as rotateProjectScalar(), on eight events at a time.
+__attribute__((target("avx")))
+static void rotateProjectAVX(struct motion_batch *batch, const float rotation[9], const float camera[4]) {
+	__m256 r[9];
+	for (size_t i = 0; i < 9; i++) {
+		r[i] = _mm256_set1_ps(rotation[i]);
+	}
+
+	const __m256 focalX = _mm256_set1_ps(camera[0]);
+	const __m256 focalY = _mm256_set1_ps(camera[1]);
+	const __m256 centerX = _mm256_set1_ps(camera[2]);
+	const __m256 centerY = _mm256_set1_ps(camera[3]);
+	const __m256 minDepth = _mm256_set1_ps(MOTION_MIN_DEPTH);
+	const __m256 outside = _mm256_set1_ps(-1.0f);
+	const __m256 limit = _mm256_set1_ps(32768.0f);
+
+	size_t i = 0;
+
+	for (; (i + 8) <= batch->length; i += 8) {
+		__m256 bx = _mm256_loadu_ps(&batch->bearingX[i]);
+		__m256 by = _mm256_loadu_ps(&batch->bearingY[i]);
+		__m256 bz = _mm256_loadu_ps(&batch->bearingZ[i]);
+
+		__m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], bx), _mm256_mul_ps(r[1], by)),
+			_mm256_mul_ps(r[2], bz));
+		__m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[3], bx), _mm256_mul_ps(r[4], by)),
+			_mm256_mul_ps(r[5], bz));
+		__m256 z = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[6], bx), _mm256_mul_ps(r[7], by)),
+			_mm256_mul_ps(r[8], bz));
+
+		__m256 u = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(focalX, x), z), centerX);
+		__m256 v = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(focalY, y), z), centerY);
+
+		__m256 inView = _mm256_cmp_ps(z, minDepth, _CMP_GT_OQ);
+		inView = _mm256_and_ps(inView, _mm256_cmp_ps(u, outside, _CMP_GT_OQ));
+		inView = _mm256_and_ps(inView, _mm256_cmp_ps(u, limit, _CMP_LT_OQ));
+		inView = _mm256_and_ps(inView, _mm256_cmp_ps(v, outside, _CMP_GT_OQ));
+		inView = _mm256_and_ps(inView, _mm256_cmp_ps(v, limit, _CMP_LT_OQ));
+
+		u = _mm256_blendv_ps(outside, u, inView);
+		v = _mm256_blendv_ps(outside, v, inView);
+
+		_mm256_storeu_si256((__m256i *) &batch->newX[i], _mm256_cvtps_epi32(u));
+		_mm256_storeu_si256((__m256i *) &batch->newY[i], _mm256_cvtps_epi32(v));
+	}
+
+	rotateProjectScalar(batch, i, rotation, camera);
+}
+
+#endif
+
+static void updateStatistics(caerModuleData moduleData, const struct timespec *now) {
+	motionState state = moduleData->moduleState;
+
+	double elapsed = (double) (now->tv_sec - state->statsTime.tv_sec)
+		+ ((double) (now->tv_nsec - state->statsTime.tv_nsec) / 1000000000);
+
+	if (elapsed < MOTION_STATS_INTERVAL) {
+		return;
+	}
+
+	sshsNodePutLong(moduleData->moduleNode, "compensatedEvents", state->compensatedEvents);
+	sshsNodePutLong(moduleData->moduleNode, "invalidatedEvents", state->invalidatedEvents);
+	sshsNodePutLong(moduleData->moduleNode, "uncompensatedEvents", state->uncompensatedEvents);
+
+	state->statsTime = *now;
+}
@@ -0,0 +1,18 @@
+/*
+ * motioncompensation.h
+ *
+ *  Moves polarity events along the camera rotation measured by the gyro, so
+ *  that all events of a packet appear as seen at one common time.
+ */
+
+#ifndef MOTIONCOMPENSATION_H_
+#define MOTIONCOMPENSATION_H_
+
+#include "main.h"
+
+#include <libcaer/events/polarity.h>
+#include <libcaer/events/imu6.h>
+
+void caerMotionCompensation(uint16_t moduleID, caerPolarityEventPacket polarity, caerIMU6EventPacket imu);
+
+#endif /* MOTIONCOMPENSATION_H_ */
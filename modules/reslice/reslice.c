@@ -0,0 +1,713 @@
+/*
+ * reslice.c
+ *
+ *  Cuts the events of a source into windows, independent of how the input
+ *  packed them into packets: either windowTime µs long, or windowEvents
+ *  events of countEventType long (with the other event types covering the
+ *  same time). Consecutive windows overlap by overlap µs or events.
+ *
+ *  Events are held per event type until all windows they belong to are
+ *  complete, so they're copied once on the way in, and once into each
+ *  window. Input packets can't be referenced instead, as they're freed at
+ *  the end of each mainloop run. Complete windows are queued, and handed
+ *  out one per run. A run can complete more windows than that, so while
+ *  windows are queued, dataAvailable is held up to have the mainloop run
+ *  again right away. At most maxQueuedWindows are kept, the oldest ones are
+ *  dropped beyond that.
+ *
+ *  Windows never span a timestamp overflow, as a packet can only have one:
+ *  the one reaching it is cut short there.
+ */
+
+#include "reslice.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "ext/uthash/utarray.h"
+
+#include <endian.h>
+
+// Event types from 0 up to this are resliced, others are ignored.
+#define RESLICE_MAX_EVENT_TYPES 16
+
+// Events of one type waiting for their windows. They all have the same
+// timestamp overflow, and are ordered by time.
+struct reslice_run {
+	uint8_t *events;
+	int32_t capacity; // In events.
+	int32_t start; // First event still needed.
+	int32_t end;
+	int32_t tsOverflow;
+};
+
+struct reslice_type {
+	int32_t eventSize; // Zero until the first packet of this type.
+	int32_t eventTSOffset;
+	// Current run, and the next one when timestamps overflow.
+	struct reslice_run runs[2];
+};
+
+struct reslice_state {
+	int16_t sourceID; // Source being resliced, the first one seen.
+	bool otherSourceLogged;
+	struct reslice_type types[RESLICE_MAX_EVENT_TYPES];
+	int16_t eventTypesNumber;
+	// Settings.
+	int32_t windowTime;
+	int32_t windowEvents;
+	int16_t countEventType;
+	int32_t overlap;
+	int32_t maxQueuedWindows;
+	// Progress, as 64 bit timestamps.
+	int64_t lastTimestamp;
+	int64_t discardedBefore;
+	int64_t windowStart; // By time: start of the next window.
+	bool windowStartValid;
+	int64_t rangeStart; // By count: start of the time the next window covers.
+	bool rangeStartValid;
+	// Complete windows not handed out yet.
+	UT_array *windows;
+	caerMainloopData mainloop;
+	bool dataAvailableRaised;
+	// Statistics.
+	int64_t windowsCount;
+	int64_t droppedWindows;
+	int64_t lateEvents;
+};
+
+typedef struct reslice_state *resliceState;
+
+static bool caerResliceInit(caerModuleData moduleData);
+static void caerResliceRun(caerModuleData moduleData, size_t argsNumber, va_list args);
+static void caerResliceConfig(caerModuleData moduleData);
+static void caerResliceExit(caerModuleData moduleData);
+static void takePacket(caerModuleData moduleData, caerEventPacketHeader packet);
+static bool runReserve(struct reslice_run *run, int32_t eventSize, int32_t events);
+static int32_t runLowerBound(const struct reslice_run *run, const struct reslice_type *type, int64_t timestamp);
+static struct reslice_run *typeRun(struct reslice_type *type, int32_t tsOverflow);
+static int64_t oldestTimestamp(resliceState state);
+static void discardBefore(resliceState state, int64_t timestamp);
+static void resliceByTime(caerModuleData moduleData);
+static void resliceByCount(caerModuleData moduleData);
+static void windowEmit(caerModuleData moduleData, int64_t start, int64_t end, int32_t countedStart,
+	int32_t countedNumber);
+static void updateDataAvailable(resliceState state);
+
+static inline int32_t eventTimestamp(const uint8_t *event, int32_t tsOffset) {
+	uint32_t timestamp;
+	memcpy(&timestamp, event + tsOffset, sizeof(uint32_t));
+
+	return (I32T(le32toh(timestamp)));
+}
+
+static inline int64_t runTimestamp64(const struct reslice_run *run, const struct reslice_type *type, int32_t index) {
+	const uint8_t *event = run->events + ((size_t) index * (size_t) type->eventSize);
+
+	return (I64T((U64T(run->tsOverflow) << TS_OVERFLOW_SHIFT) | U64T(eventTimestamp(event, type->eventTSOffset))));
+}
+
+static struct caer_module_functions caerResliceFunctions = { .moduleInit = &caerResliceInit, .moduleRun =
+	&caerResliceRun, .moduleConfig = &caerResliceConfig, .moduleExit = &caerResliceExit };
+
+caerEventPacketContainer caerReslice(uint16_t moduleID, size_t inputsNumber, ...) {
+	caerModuleData moduleData = caerMainloopFindModule(moduleID, "Reslice");
+
+	va_list args;
+	va_start(args, inputsNumber);
+	caerModuleSMv(&caerResliceFunctions, moduleData, sizeof(struct reslice_state), inputsNumber, args);
+	va_end(args);
+
+	// Not running, or just started.
+	resliceState state = moduleData->moduleState;
+	if (state == NULL || utarray_len(state->windows) == 0) {
+		return (NULL);
+	}
+
+	caerEventPacketContainer window = *((caerEventPacketContainer *) utarray_front(state->windows));
+	utarray_erase(state->windows, 0, 1);
+
+	caerMainloopFreeAfterLoop((void (*)(void *)) &caerEventPacketContainerFree, window);
+
+	sshsNodePutInt(moduleData->moduleNode, "queuedWindows", I32T(utarray_len(state->windows)));
+
+	updateDataAvailable(state);
+
+	return (window);
+}
+
+static bool caerResliceInit(caerModuleData moduleData) {
+	// Window length in µs, used if windowEvents is zero.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "windowTime", 10000);
+	// Window length in events of countEventType, zero to cut by time.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "windowEvents", 0);
+	sshsNodePutShortIfAbsent(moduleData->moduleNode, "countEventType", POLARITY_EVENT);
+	// How much consecutive windows overlap, in µs or events.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "overlap", 0);
+	// Windows waiting to be returned beyond this many are dropped, oldest first.
+	sshsNodePutIntIfAbsent(moduleData->moduleNode, "maxQueuedWindows", 16);
+
+	// Statistics, read-only.
+	sshsNodePutLong(moduleData->moduleNode, "windows", 0);
+	sshsNodePutInt(moduleData->moduleNode, "queuedWindows", 0);
+	sshsNodePutLong(moduleData->moduleNode, "droppedWindows", 0);
+	sshsNodePutLong(moduleData->moduleNode, "lateEvents", 0);
+
+	resliceState state = moduleData->moduleState;
+
+	state->sourceID = -1;
+
+	// Init runs in the mainloop thread.
+	state->mainloop = caerMainloopGetReference();
+
+	utarray_new(state->windows, &ut_ptr_icd);
+
+	caerResliceConfig(moduleData);
+
+	// Add config listeners last, to avoid having them dangling if Init doesn't succeed.
+	sshsNodeAddAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	return (true);
+}
+
+static void caerResliceRun(caerModuleData moduleData, size_t argsNumber, va_list args) {
+	resliceState state = moduleData->moduleState;
+
+	// Interpret variable arguments (same as above in main function).
+	for (size_t i = 0; i < argsNumber; i++) {
+		caerEventPacketHeader packet = va_arg(args, caerEventPacketHeader);
+
+		if (packet != NULL) {
+			takePacket(moduleData, packet);
+		}
+	}
+
+	int64_t windowsCount = state->windowsCount;
+	int64_t droppedWindows = state->droppedWindows;
+	int64_t lateEvents = state->lateEvents;
+
+	if (state->windowEvents > 0) {
+		resliceByCount(moduleData);
+	}
+	else {
+		resliceByTime(moduleData);
+	}
+
+	if (state->windowsCount != windowsCount) {
+		sshsNodePutLong(moduleData->moduleNode, "windows", state->windowsCount);
+		sshsNodePutInt(moduleData->moduleNode, "queuedWindows", I32T(utarray_len(state->windows)));
+	}
+
+	if (state->droppedWindows != droppedWindows) {
+		sshsNodePutLong(moduleData->moduleNode, "droppedWindows", state->droppedWindows);
+	}
+
+	if (state->lateEvents != lateEvents) {
+		sshsNodePutLong(moduleData->moduleNode, "lateEvents", state->lateEvents);
+	}
+}
+
+static void caerResliceConfig(caerModuleData moduleData) {
+	caerModuleConfigUpdateReset(moduleData);
+
+	resliceState state = moduleData->moduleState;
+
+	int32_t windowTime = sshsNodeGetInt(moduleData->moduleNode, "windowTime");
+	int32_t windowEvents = sshsNodeGetInt(moduleData->moduleNode, "windowEvents");
+	int16_t countEventType = sshsNodeGetShort(moduleData->moduleNode, "countEventType");
+	int32_t overlap = sshsNodeGetInt(moduleData->moduleNode, "overlap");
+	int32_t maxQueuedWindows = sshsNodeGetInt(moduleData->moduleNode, "maxQueuedWindows");
+
+	if (windowTime < 1) {
+		windowTime = 1;
+	}
+
+	if (windowEvents < 0) {
+		windowEvents = 0;
+	}
+
+	if (countEventType < 0 || countEventType >= RESLICE_MAX_EVENT_TYPES) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Event type %" PRIi16 " can't be counted, counting polarity events.", countEventType);
+		countEventType = POLARITY_EVENT;
+	}
+
+	// Windows must advance.
+	int32_t windowLength = (windowEvents > 0) ? (windowEvents) : (windowTime);
+
+	if (maxQueuedWindows < 1) {
+		maxQueuedWindows = 1;
+	}
+
+	if (overlap < 0) {
+		overlap = 0;
+	}
+	else if (overlap >= windowLength) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Overlap must be smaller than the window, using %" PRIi32 ".", windowLength - 1);
+		overlap = windowLength - 1;
+	}
+
+	// A different kind of window starts over from the next events.
+	if (windowTime != state->windowTime || windowEvents != state->windowEvents
+		|| countEventType != state->countEventType) {
+		state->windowStartValid = false;
+		state->rangeStartValid = false;
+	}
+
+	state->windowTime = windowTime;
+	state->windowEvents = windowEvents;
+	state->countEventType = countEventType;
+	state->overlap = overlap;
+	state->maxQueuedWindows = maxQueuedWindows;
+}
+
+static void caerResliceExit(caerModuleData moduleData) {
+	// Remove listener, which can reference invalid memory in userData.
+	sshsNodeRemoveAttributeListener(moduleData->moduleNode, moduleData, &caerModuleConfigDefaultListener);
+
+	resliceState state = moduleData->moduleState;
+
+	for (size_t t = 0; t < RESLICE_MAX_EVENT_TYPES; t++) {
+		free(state->types[t].runs[0].events);
+		free(state->types[t].runs[1].events);
+	}
+
+	caerEventPacketContainer *window = NULL;
+	while ((window = (caerEventPacketContainer *) utarray_next(state->windows, window)) != NULL) {
+		caerEventPacketContainerFree(*window);
+	}
+
+	utarray_free(state->windows);
+
+	if (state->dataAvailableRaised) {
+		atomic_fetch_sub_explicit(&state->mainloop->dataAvailable, 1, memory_order_relaxed);
+		state->dataAvailableRaised = false;
+	}
+}
+
+static void takePacket(caerModuleData moduleData, caerEventPacketHeader packet) {
+	resliceState state = moduleData->moduleState;
+
+	int32_t eventValid = caerEventPacketHeaderGetEventValid(packet);
+	if (eventValid == 0) {
+		return;
+	}
+
+	int16_t eventType = caerEventPacketHeaderGetEventType(packet);
+	if (eventType < 0 || eventType >= RESLICE_MAX_EVENT_TYPES) {
+		return;
+	}
+
+	// Windows are of one source only.
+	int16_t sourceID = caerEventPacketHeaderGetEventSource(packet);
+
+	if (state->sourceID < 0) {
+		state->sourceID = sourceID;
+	}
+	else if (sourceID != state->sourceID) {
+		if (!state->otherSourceLogged) {
+			caerLog(CAER_LOG_WARNING, moduleData->moduleSubSystemString,
+				"Ignoring packets from source %" PRIi16 ", only source %" PRIi16 " is resliced.", sourceID,
+				state->sourceID);
+			state->otherSourceLogged = true;
+		}
+
+		return;
+	}
+
+	struct reslice_type *type = &state->types[eventType];
+
+	int32_t eventSize = caerEventPacketHeaderGetEventSize(packet);
+	int32_t tsOffset = caerEventPacketHeaderGetEventTSOffset(packet);
+	int32_t tsOverflow = caerEventPacketHeaderGetEventTSOverflow(packet);
+
+	if (type->eventSize == 0) {
+		type->eventSize = eventSize;
+		type->eventTSOffset = tsOffset;
+
+		if (eventType >= state->eventTypesNumber) {
+			state->eventTypesNumber = I16T(eventType + 1);
+		}
+	}
+	else if (type->eventSize != eventSize || type->eventTSOffset != tsOffset) {
+		// Frame size changed, what's held can't go into the same packets.
+		type->runs[0].start = type->runs[0].end = 0;
+		type->runs[1].start = type->runs[1].end = 0;
+		type->eventSize = eventSize;
+		type->eventTSOffset = tsOffset;
+	}
+
+	// Events with a new timestamp overflow go into the second run.
+	struct reslice_run *run = &type->runs[0];
+
+	if (run->start != run->end && run->tsOverflow != tsOverflow) {
+		run = &type->runs[1];
+
+		if (run->start != run->end && run->tsOverflow != tsOverflow) {
+			// A third overflow: the oldest events won't be needed anymore.
+			struct reslice_run swap = type->runs[0];
+			type->runs[0] = type->runs[1];
+			type->runs[1] = swap;
+			run->start = run->end = 0;
+		}
+	}
+
+	if (run->start == run->end) {
+		run->start = run->end = 0;
+		run->tsOverflow = tsOverflow;
+	}
+
+	if (!runReserve(run, eventSize, eventValid)) {
+		caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+			"Failed to allocate memory for events, dropping packet.");
+		return;
+	}
+
+	uint8_t *events = run->events + ((size_t) run->end * (size_t) eventSize);
+	int32_t eventNumber = caerEventPacketHeaderGetEventNumber(packet);
+
+	// Only valid events are kept.
+	if (eventValid == eventNumber) {
+		memcpy(events, caerGenericEventGetEvent(packet, 0), (size_t) eventNumber * (size_t) eventSize);
+	}
+	else {
+		uint8_t *event = events;
+
+		for (int32_t i = 0; i < eventNumber; i++) {
+			const void *inEvent = caerGenericEventGetEvent(packet, i);
+
+			if (caerGenericEventIsValid(inEvent)) {
+				memcpy(event, inEvent, (size_t) eventSize);
+				event += eventSize;
+			}
+		}
+	}
+
+	int32_t firstEvent = run->end;
+	run->end += eventValid;
+
+	// Events for windows already done are lost.
+	for (int32_t i = firstEvent; i < run->end && runTimestamp64(run, type, i) < state->discardedBefore; i++) {
+		state->lateEvents++;
+	}
+
+	int64_t lastTimestamp = runTimestamp64(run, type, run->end - 1);
+	if (lastTimestamp > state->lastTimestamp) {
+		state->lastTimestamp = lastTimestamp;
+	}
+}
+
+// Make space for events more events at the end of the run.
+static bool runReserve(struct reslice_run *run, int32_t eventSize, int32_t events) {
+	if ((run->end + events) <= run->capacity) {
+		return (true);
+	}
+
+	// Drop what's not needed anymore first.
+	if (run->start > 0) {
+		memmove(run->events, run->events + ((size_t) run->start * (size_t) eventSize),
+			(size_t) (run->end - run->start) * (size_t) eventSize);
+		run->end -= run->start;
+		run->start = 0;
+
+		if ((run->end + events) <= run->capacity) {
+			return (true);
+		}
+	}
+
+	int32_t newCapacity = (run->capacity == 0) ? (1024) : (run->capacity * 2);
+	if (newCapacity < (run->end + events)) {
+		newCapacity = run->end + events;
+	}
+
+	uint8_t *newEvents = realloc(run->events, (size_t) newCapacity * (size_t) eventSize);
+	if (newEvents == NULL) {
+		return (false);
+	}
+
+	run->events = newEvents;
+	run->capacity = newCapacity;
+
+	return (true);
+}
+
+// First event in the run not older than timestamp.
+static int32_t runLowerBound(const struct reslice_run *run, const struct reslice_type *type, int64_t timestamp) {
+	int32_t low = run->start;
+	int32_t high = run->end;
+
+	while (low < high) {
+		int32_t middle = low + ((high - low) / 2);
+
+		if (runTimestamp64(run, type, middle) < timestamp) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+
+	return (low);
+}
+
+static struct reslice_run *typeRun(struct reslice_type *type, int32_t tsOverflow) {
+	for (size_t r = 0; r < 2; r++) {
+		if (type->runs[r].start != type->runs[r].end && type->runs[r].tsOverflow == tsOverflow) {
+			return (&type->runs[r]);
+		}
+	}
+
+	return (NULL);
+}
+
+static int64_t oldestTimestamp(resliceState state) {
+	int64_t oldest = INT64_MAX;
+
+	for (size_t t = 0; t < RESLICE_MAX_EVENT_TYPES; t++) {
+		struct reslice_type *type = &state->types[t];
+
+		if (type->runs[0].start != type->runs[0].end) {
+			int64_t timestamp = runTimestamp64(&type->runs[0], type, type->runs[0].start);
+
+			if (timestamp < oldest) {
+				oldest = timestamp;
+			}
+		}
+	}
+
+	return (oldest);
+}
+
+static void discardBefore(resliceState state, int64_t timestamp) {
+	int32_t tsOverflow = I32T(timestamp >> TS_OVERFLOW_SHIFT);
+
+	for (size_t t = 0; t < RESLICE_MAX_EVENT_TYPES; t++) {
+		struct reslice_type *type = &state->types[t];
+
+		for (size_t r = 0; r < 2; r++) {
+			struct reslice_run *run = &type->runs[r];
+
+			if (run->start == run->end) {
+				continue;
+			}
+
+			if (run->tsOverflow < tsOverflow) {
+				run->start = run->end;
+			}
+			else if (run->tsOverflow == tsOverflow) {
+				run->start = runLowerBound(run, type, timestamp);
+			}
+		}
+
+		if (type->runs[0].start == type->runs[0].end && type->runs[1].start != type->runs[1].end) {
+			struct reslice_run swap = type->runs[0];
+			type->runs[0] = type->runs[1];
+			type->runs[1] = swap;
+		}
+	}
+
+	if (timestamp > state->discardedBefore) {
+		state->discardedBefore = timestamp;
+	}
+}
+
+static void resliceByTime(caerModuleData moduleData) {
+	resliceState state = moduleData->moduleState;
+
+	int64_t step = state->windowTime - state->overlap;
+
+	for (;;) {
+		int64_t oldest = oldestTimestamp(state);
+		if (oldest == INT64_MAX) {
+			return;
+		}
+
+		// Windows start at multiples of the step. Ones without any events are
+		// skipped.
+		if (!state->windowStartValid || (oldest - state->windowStart) >= state->windowTime) {
+			int64_t windowStart = oldest - (oldest % step);
+
+			if (!state->windowStartValid || windowStart > state->windowStart) {
+				state->windowStart = windowStart;
+				state->windowStartValid = true;
+			}
+		}
+
+		int64_t overflowEnd = I64T((U64T(state->windowStart >> TS_OVERFLOW_SHIFT) + 1) << TS_OVERFLOW_SHIFT);
+
+		int64_t windowEnd = state->windowStart + state->windowTime;
+		if (windowEnd > overflowEnd) {
+			windowEnd = overflowEnd;
+		}
+
+		// Complete once anything after it has arrived.
+		if (state->lastTimestamp < windowEnd) {
+			return;
+		}
+
+		windowEmit(moduleData, state->windowStart, windowEnd, 0, 0);
+
+		state->windowStart += step;
+		if (windowEnd == overflowEnd && state->windowStart > overflowEnd) {
+			state->windowStart = overflowEnd;
+		}
+
+		discardBefore(state, state->windowStart);
+	}
+}
+
+static void resliceByCount(caerModuleData moduleData) {
+	resliceState state = moduleData->moduleState;
+
+	struct reslice_type *counted = &state->types[state->countEventType];
+	if (counted->eventSize == 0) {
+		return;
+	}
+
+	int32_t step = state->windowEvents - state->overlap;
+
+	for (;;) {
+		struct reslice_run *run = &counted->runs[0];
+
+		int32_t available = run->end - run->start;
+		if (available == 0) {
+			return;
+		}
+
+		int32_t events = state->windowEvents;
+
+		if (available < state->windowEvents) {
+			// Cut short only at a timestamp overflow.
+			if (counted->runs[1].start == counted->runs[1].end) {
+				return;
+			}
+
+			events = available;
+		}
+
+		int64_t firstTimestamp = runTimestamp64(run, counted, run->start);
+		int64_t lastTimestamp = runTimestamp64(run, counted, run->start + events - 1);
+
+		// Other event types cover the time since the last window, so nothing
+		// between windows is lost.
+		int64_t rangeStart = firstTimestamp;
+		if (state->rangeStartValid && state->rangeStart < rangeStart) {
+			rangeStart = state->rangeStart;
+		}
+
+		windowEmit(moduleData, rangeStart, lastTimestamp + 1, run->start, events);
+
+		state->rangeStart = lastTimestamp + 1;
+		state->rangeStartValid = true;
+
+		run->start += (events < state->windowEvents) ? (events) : (step);
+
+		// Counted events go by index, other types by time.
+		int64_t keepFrom = state->rangeStart;
+		if (run->start != run->end) {
+			int64_t nextTimestamp = runTimestamp64(run, counted, run->start);
+
+			if (nextTimestamp < keepFrom) {
+				keepFrom = nextTimestamp;
+			}
+		}
+
+		discardBefore(state, keepFrom);
+	}
+}
+
+// Queue a container with the events of [start, end). For the counted type,
+// the given events are taken instead.
+static void windowEmit(caerModuleData moduleData, int64_t start, int64_t end, int32_t countedStart,
+	int32_t countedNumber) {
+	resliceState state = moduleData->moduleState;
+
+	int32_t tsOverflow = I32T(start >> TS_OVERFLOW_SHIFT);
+	caerEventPacketContainer window = NULL;
+
+	for (int16_t t = 0; t < state->eventTypesNumber; t++) {
+		struct reslice_type *type = &state->types[t];
+
+		struct reslice_run *run = typeRun(type, tsOverflow);
+		if (run == NULL) {
+			continue;
+		}
+
+		int32_t first;
+		int32_t last;
+
+		if (countedNumber > 0 && t == state->countEventType) {
+			first = countedStart;
+			last = countedStart + countedNumber;
+		}
+		else {
+			first = runLowerBound(run, type, start);
+			last = runLowerBound(run, type, end);
+		}
+
+		int32_t events = last - first;
+		if (events == 0) {
+			continue;
+		}
+
+		size_t eventsSize = (size_t) events * (size_t) type->eventSize;
+
+		caerEventPacketHeader packet = malloc(CAER_EVENT_PACKET_HEADER_SIZE + eventsSize);
+		if (packet == NULL) {
+			caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+				"Failed to allocate memory for window, dropping %" PRIi32 " events.", events);
+			continue;
+		}
+
+		caerEventPacketHeaderSetEventType(packet, t);
+		caerEventPacketHeaderSetEventSource(packet, state->sourceID);
+		caerEventPacketHeaderSetEventSize(packet, type->eventSize);
+		caerEventPacketHeaderSetEventTSOffset(packet, type->eventTSOffset);
+		caerEventPacketHeaderSetEventTSOverflow(packet, tsOverflow);
+		caerEventPacketHeaderSetEventCapacity(packet, events);
+		caerEventPacketHeaderSetEventNumber(packet, events);
+		caerEventPacketHeaderSetEventValid(packet, events);
+
+		memcpy(caerGenericEventGetEvent(packet, 0), run->events + ((size_t) first * (size_t) type->eventSize),
+			eventsSize);
+
+		if (window == NULL) {
+			window = caerEventPacketContainerAllocate(state->eventTypesNumber);
+			if (window == NULL) {
+				caerLog(CAER_LOG_ERROR, moduleData->moduleSubSystemString,
+					"Failed to allocate event packet container, dropping window.");
+				free(packet);
+				return;
+			}
+		}
+
+		caerEventPacketContainerSetEventPacket(window, t, packet);
+	}
+
+	if (window != NULL) {
+		utarray_push_back(state->windows, &window);
+		state->windowsCount++;
+	}
+
+	// Keep the latency bounded when windows complete faster than they're
+	// returned: the oldest ones are the least useful.
+	while (utarray_len(state->windows) > (size_t) state->maxQueuedWindows) {
+		caerEventPacketContainerFree(*((caerEventPacketContainer *) utarray_front(state->windows)));
+		utarray_erase(state->windows, 0, 1);
+		state->droppedWindows++;
+	}
+}
+
+// Hold dataAvailable up while windows are queued, so the mainloop comes
+// back for them without waiting for new input.
+static void updateDataAvailable(resliceState state) {
+	bool windowsQueued = (utarray_len(state->windows) > 0);
+
+	if (windowsQueued && !state->dataAvailableRaised) {
+		atomic_fetch_add_explicit(&state->mainloop->dataAvailable, 1, memory_order_release);
+		state->dataAvailableRaised = true;
+	}
+	else if (!windowsQueued && state->dataAvailableRaised) {
+		atomic_fetch_sub_explicit(&state->mainloop->dataAvailable, 1, memory_order_relaxed);
+		state->dataAvailableRaised = false;
+	}
+}
@@ -0,0 +1,20 @@
+/*
+ * reslice.h
+ *
+ *  Cuts the events of a source into windows of fixed duration or of a fixed
+ *  number of events, optionally overlapping.
+ */
+
+#ifndef RESLICE_H_
+#define RESLICE_H_
+
+#include "main.h"
+
+#include <libcaer/events/packetContainer.h>
+
+// Takes any number of event packets (caerEventPacketHeader) from one source,
+// and returns the next complete window, or NULL if there is none yet: a
+// container with one packet per event type, at the index of that type.
+caerEventPacketContainer caerReslice(uint16_t moduleID, size_t inputsNumber, ...);
+
+#endif /* RESLICE_H_ */
@@ -2,6 +2,7 @@
 #include "base/mainloop.h"
 #include "ext/c11threads_posix.h"
 #include "ext/ringbuffer/ringbuffer.h"
+#include "ext/validcompact/validcompact.h"
 #include "modules/statistics/statistics.h"
 
 #include <math.h>
@@ -300,13 +301,17 @@ void caerVisualizerUpdate(caerVisualizerState state, caerEventPacketHeader packe
 		return;
 	}
 
-	caerEventPacketHeader packetHeaderCopy = caerCopyEventPacketOnlyEvents(packetHeader);
+	// Renderers only ever look at valid events, so only copy those.
+	caerEventPacketHeader packetHeaderCopy = malloc(
+		caerValidCompactPacketSize(packetHeader) + CAER_VALID_COMPACT_SLACK);
 	if (packetHeaderCopy == NULL) {
 		caerLog(CAER_LOG_ERROR, state->parentModule->moduleSubSystemString,
 			"Visualizer: Failed to copy event packet for rendering.");
 		return;
 	}
 
+	caerValidCompactPacket((uint8_t *) packetHeaderCopy, packetHeader);
+
 	if (!ringBufferPut(state->dataTransfer, packetHeaderCopy)) {
 		free(packetHeaderCopy);
 
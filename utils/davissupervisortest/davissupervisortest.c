@@ -0,0 +1,316 @@
+/*
+ * davissupervisortest.c
+ *
+ *  Runs the DAVIS input against a fake device in a real mainloop, unplugs
+ *  it, keeps it away for a few reconnect attempts, plugs it back in, and
+ *  checks the supervisor's Disconnects, ReconnectAttempts and OutageTime.
+ */
+
+#include "main.h"
+#include "base/mainloop.h"
+#include "base/module.h"
+#include "modules/ini/davis_common.h"
+#include "ext/portable_time.h"
+
+#include <libcaer/events/special.h>
+
+// Reconnect attempts that find no device, before it comes back.
+#define FAILED_ATTEMPTS 3
+// Short, so the test is quick (ms).
+#define RECONNECT_INTERVAL 50
+// Data runs before the device is unplugged.
+#define DATA_RUNS 10
+// Give up after this long (s).
+#define TIMEOUT 10
+
+#define FAKE_SERIAL_NUMBER "FAKE0001"
+
+static char fakeDeviceString[] = "DAVIS FAKE ID-1 SN-" FAKE_SERIAL_NUMBER;
+
+enum test_phase {
+	CONNECTING, OUTAGE, RECOVERING, DONE
+};
+
+// The fake device. Only ever used from the mainloop thread.
+static struct {
+	bool pluggedIn;
+	bool running;
+	int64_t dataRuns;
+	void (*shutdownNotify)(void *ptr);
+	void *shutdownUserPtr;
+} fakeDevice;
+
+static struct {
+	enum test_phase phase;
+	sshsNode moduleNode;
+	struct timespec startTime;
+	struct timespec unplugTime;
+	struct timespec replugTime;
+	struct timespec endTime;
+	bool timedOut;
+} test;
+
+static caerDeviceHandle fakeOpen(uint16_t deviceID, uint16_t deviceType, uint8_t busNumberRestrict,
+	uint8_t devAddressRestrict, const char *serialNumberRestrict);
+static bool fakeClose(caerDeviceHandle *handlePtr);
+static bool fakeDataStart(caerDeviceHandle handle, void (*dataNotifyIncrease)(void *ptr),
+	void (*dataNotifyDecrease)(void *ptr), void *dataNotifyUserPtr, void (*dataShutdownNotify)(void *ptr),
+	void *dataShutdownUserPtr);
+static bool fakeDataStop(caerDeviceHandle handle);
+static caerEventPacketContainer fakeDataGet(caerDeviceHandle handle);
+static bool fakeConfigSet(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t param);
+static bool fakeConfigGet(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t *param);
+static struct caer_davis_info fakeInfoGet(caerDeviceHandle handle);
+
+static const struct caer_input_davis_backend fakeBackend = { .open = &fakeOpen, .close = &fakeClose, .dataStart =
+	&fakeDataStart, .dataStop = &fakeDataStop, .dataGet = &fakeDataGet, .configSet = &fakeConfigSet, .configGet =
+	&fakeConfigGet, .infoGet = &fakeInfoGet };
+
+static bool fakeInputInit(caerModuleData moduleData);
+
+// Same as the DAVIS FX3 input.
+static struct caer_module_functions fakeInputFunctions = { .moduleInit = &fakeInputInit, .moduleRun =
+	&caerInputDAVISRun, .moduleConfig = NULL, .moduleExit = &caerInputDAVISExit };
+
+static bool mainloopTest(void);
+static void testStep(void);
+static int64_t elapsedMicro(const struct timespec *from, const struct timespec *to);
+
+int main(void) {
+	caerLogLevelSet(CAER_LOG_INFO);
+
+	caerInputDAVISSetBackend(&fakeBackend);
+
+	fakeDevice.pluggedIn = true;
+	test.phase = CONNECTING;
+	portable_clock_gettime_monotonic(&test.startTime);
+
+	struct caer_mainloop_definition mainLoops[1] = { { 1, &mainloopTest } };
+	caerMainloopRun(&mainLoops, 1);
+
+	if (test.timedOut) {
+		printf("Timed out after %d s in phase %d.\n", TIMEOUT, test.phase);
+		return (EXIT_FAILURE);
+	}
+
+	int64_t disconnects = sshsNodeGetLong(test.moduleNode, "Disconnects");
+	int64_t reconnectAttempts = sshsNodeGetLong(test.moduleNode, "ReconnectAttempts");
+	int64_t outageTime = sshsNodeGetLong(test.moduleNode, "OutageTime");
+
+	// The outage lasts from the unplug to the first data after the replug.
+	int64_t outageMin = elapsedMicro(&test.unplugTime, &test.replugTime);
+	int64_t outageMax = elapsedMicro(&test.unplugTime, &test.endTime);
+
+	bool disconnectsOk = (disconnects == 1);
+	bool attemptsOk = (reconnectAttempts == (FAILED_ATTEMPTS + 1));
+	bool outageOk = (outageTime >= outageMin && outageTime <= outageMax);
+
+	printf("Disconnects: %" PRIi64 " (expected 1): %s.\n", disconnects, (disconnectsOk) ? ("ok") : ("FAILED"));
+	printf("ReconnectAttempts: %" PRIi64 " (expected %d): %s.\n", reconnectAttempts, FAILED_ATTEMPTS + 1,
+		(attemptsOk) ? ("ok") : ("FAILED"));
+	printf("OutageTime: %" PRIi64 " µs (expected %" PRIi64 " to %" PRIi64 " µs): %s.\n", outageTime, outageMin,
+		outageMax, (outageOk) ? ("ok") : ("FAILED"));
+
+	return ((disconnectsOk && attemptsOk && outageOk) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
+
+static bool mainloopTest(void) {
+	static bool keepRunning = false;
+
+	// Hold dataAvailable up, so the mainloop runs continuously and reconnect
+	// attempts follow ReconnectInterval, not the once-a-second idle run.
+	if (!keepRunning) {
+		atomic_fetch_add(&caerMainloopGetReference()->dataAvailable, 1);
+		keepRunning = true;
+	}
+
+	caerEventPacketContainer container = NULL;
+
+	caerModuleData moduleData = caerMainloopFindModule(1, "DAVISFake");
+
+	if (test.moduleNode == NULL) {
+		test.moduleNode = moduleData->moduleNode;
+		sshsNodePutInt(moduleData->moduleNode, "ReconnectInterval", RECONNECT_INTERVAL);
+	}
+
+	caerModuleSM(&fakeInputFunctions, moduleData, 0, 1, &container);
+
+	testStep();
+
+	return (true);
+}
+
+// Unplug once data flows, plug back in after FAILED_ATTEMPTS, and stop once
+// the outage is over.
+static void testStep(void) {
+	struct timespec now;
+	portable_clock_gettime_monotonic(&now);
+
+	if (test.phase != DONE && elapsedMicro(&test.startTime, &now) > (TIMEOUT * 1000000LL)) {
+		test.timedOut = true;
+		test.phase = DONE;
+		sshsNodePutBool(sshsGetNode(sshsGetGlobal(), "/"), "shutdown", true);
+		return;
+	}
+
+	switch (test.phase) {
+		case CONNECTING:
+			if (fakeDevice.dataRuns >= DATA_RUNS) {
+				// What libcaer's data acquisition thread does on a USB error.
+				fakeDevice.pluggedIn = false;
+				fakeDevice.running = false;
+				test.unplugTime = now;
+				test.phase = OUTAGE;
+
+				fakeDevice.shutdownNotify(fakeDevice.shutdownUserPtr);
+			}
+			break;
+
+		case OUTAGE:
+			if (sshsNodeGetLong(test.moduleNode, "ReconnectAttempts") >= FAILED_ATTEMPTS) {
+				fakeDevice.pluggedIn = true;
+				test.replugTime = now;
+				test.phase = RECOVERING;
+			}
+			break;
+
+		case RECOVERING:
+			if (sshsNodeGetLong(test.moduleNode, "OutageTime") > 0) {
+				test.endTime = now;
+				test.phase = DONE;
+				sshsNodePutBool(sshsGetNode(sshsGetGlobal(), "/"), "shutdown", true);
+			}
+			break;
+
+		case DONE:
+			break;
+	}
+}
+
+static int64_t elapsedMicro(const struct timespec *from, const struct timespec *to) {
+	return (I64T(to->tv_sec - from->tv_sec) * 1000000LL + I64T(to->tv_nsec - from->tv_nsec) / 1000);
+}
+
+static bool fakeInputInit(caerModuleData moduleData) {
+	return (caerInputDAVISInit(moduleData, CAER_DEVICE_DAVIS_FX3));
+}
+
+static caerDeviceHandle fakeOpen(uint16_t deviceID, uint16_t deviceType, uint8_t busNumberRestrict,
+	uint8_t devAddressRestrict, const char *serialNumberRestrict) {
+	UNUSED_ARGUMENT(deviceID);
+	UNUSED_ARGUMENT(deviceType);
+	UNUSED_ARGUMENT(busNumberRestrict);
+	UNUSED_ARGUMENT(devAddressRestrict);
+
+	if (!fakeDevice.pluggedIn) {
+		return (NULL);
+	}
+
+	// Like libcaer, an empty serial number matches any device.
+	if (serialNumberRestrict != NULL && serialNumberRestrict[0] != '\0'
+		&& !caerStrEquals(serialNumberRestrict, FAKE_SERIAL_NUMBER)) {
+		return (NULL);
+	}
+
+	// Never dereferenced, all access goes through this backend.
+	return ((caerDeviceHandle) &fakeDevice);
+}
+
+static bool fakeClose(caerDeviceHandle *handlePtr) {
+	*handlePtr = NULL;
+
+	return (true);
+}
+
+static bool fakeDataStart(caerDeviceHandle handle, void (*dataNotifyIncrease)(void *ptr),
+	void (*dataNotifyDecrease)(void *ptr), void *dataNotifyUserPtr, void (*dataShutdownNotify)(void *ptr),
+	void *dataShutdownUserPtr) {
+	UNUSED_ARGUMENT(handle);
+	UNUSED_ARGUMENT(dataNotifyIncrease);
+	UNUSED_ARGUMENT(dataNotifyDecrease);
+	UNUSED_ARGUMENT(dataNotifyUserPtr);
+
+	fakeDevice.running = true;
+	fakeDevice.shutdownNotify = dataShutdownNotify;
+	fakeDevice.shutdownUserPtr = dataShutdownUserPtr;
+
+	return (true);
+}
+
+static bool fakeDataStop(caerDeviceHandle handle) {
+	UNUSED_ARGUMENT(handle);
+
+	fakeDevice.running = false;
+
+	return (true);
+}
+
+// One timestamp reset per run, while plugged in.
+static caerEventPacketContainer fakeDataGet(caerDeviceHandle handle) {
+	UNUSED_ARGUMENT(handle);
+
+	if (!fakeDevice.running) {
+		return (NULL);
+	}
+
+	caerEventPacketContainer container = caerEventPacketContainerAllocate(1);
+	if (container == NULL) {
+		return (NULL);
+	}
+
+	caerSpecialEventPacket special = caerSpecialEventPacketAllocate(1, 1, 0);
+	if (special == NULL) {
+		caerEventPacketContainerFree(container);
+		return (NULL);
+	}
+
+	caerSpecialEvent event = caerSpecialEventPacketGetEvent(special, 0);
+	caerSpecialEventSetTimestamp(event, 0);
+	caerSpecialEventSetType(event, TIMESTAMP_RESET);
+	caerSpecialEventValidate(event, special);
+
+	caerEventPacketContainerSetEventPacket(container, SPECIAL_EVENT, (caerEventPacketHeader) special);
+
+	fakeDevice.dataRuns++;
+
+	return (container);
+}
+
+static bool fakeConfigSet(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t param) {
+	UNUSED_ARGUMENT(handle);
+	UNUSED_ARGUMENT(modAddr);
+	UNUSED_ARGUMENT(paramAddr);
+	UNUSED_ARGUMENT(param);
+
+	return (fakeDevice.pluggedIn);
+}
+
+static bool fakeConfigGet(caerDeviceHandle handle, int8_t modAddr, uint8_t paramAddr, uint32_t *param) {
+	UNUSED_ARGUMENT(handle);
+	UNUSED_ARGUMENT(modAddr);
+	UNUSED_ARGUMENT(paramAddr);
+
+	*param = 0;
+
+	return (fakeDevice.pluggedIn);
+}
+
+// A DAVIS240C, the smallest configuration.
+static struct caer_davis_info fakeInfoGet(caerDeviceHandle handle) {
+	UNUSED_ARGUMENT(handle);
+
+	struct caer_davis_info info;
+	memset(&info, 0, sizeof(struct caer_davis_info));
+
+	info.deviceID = 1;
+	strncpy(info.deviceSerialNumber, FAKE_SERIAL_NUMBER, 8);
+	info.deviceSerialNumber[8] = '\0';
+	info.deviceString = fakeDeviceString;
+	info.chipID = DAVIS_CHIP_DAVIS240C;
+	info.dvsSizeX = 240;
+	info.dvsSizeY = 180;
+	info.apsSizeX = 240;
+	info.apsSizeY = 180;
+
+	return (info);
+}
@@ -15,6 +15,9 @@
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <time.h>
+#include "ext/nets.h"
+#include "ext/udpstream.h"
 
 #include <libcaer/events/common.h>
 
@@ -23,6 +26,8 @@
 
 static atomic_bool globalShutdown = ATOMIC_VAR_INIT(false);
 
+static void printLossReport(struct caer_udp_stream_stats *stats, uint64_t invalid);
+
 static void globalShutdownSignalHandler(int signal) {
 	// Simply set the running flag to false on SIGTERM and SIGINT (CTRL+C) for global shutdown.
 	if (signal == SIGTERM || signal == SIGINT) {
@@ -82,11 +87,40 @@ int main(int argc, char *argv[]) {
 	listenUDPAddress.sin_port = htons(portNumber);
 	inet_aton(ipAddress, &listenUDPAddress.sin_addr); // htonl() is implicit here.
 
+	// For multicast groups, listen on all addresses and join the group.
+	struct in_addr multicastGroup = listenUDPAddress.sin_addr;
+	bool multicast = IN_MULTICAST(ntohl(multicastGroup.s_addr));
+
+	if (multicast) {
+		socketReuseAddr(listenUDPSocket, true);
+		listenUDPAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+	}
+
 	if (bind(listenUDPSocket, (struct sockaddr *) &listenUDPAddress, sizeof(struct sockaddr_in)) < 0) {
 		fprintf(stderr, "Failed to listen on UDP socket.\n");
 		return (EXIT_FAILURE);
 	}
 
+	if (multicast) {
+		struct ip_mreq membership;
+		membership.imr_multiaddr = multicastGroup;
+		membership.imr_interface.s_addr = htonl(INADDR_ANY);
+
+		if (setsockopt(listenUDPSocket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(struct ip_mreq)) < 0) {
+			fprintf(stderr, "Failed to join multicast group.\n");
+			return (EXIT_FAILURE);
+		}
+	}
+
+	// Stream statistics, if the sender adds stream headers. A loss report
+	// is printed every second, and at exit.
+	struct caer_udp_stream_stats streamStats;
+	memset(&streamStats, 0, sizeof(struct caer_udp_stream_stats));
+	uint64_t invalidDatagrams = 0;
+	time_t lastReport = time(NULL);
+
+	struct caer_udp_stream_fec *streamFEC = calloc(1, sizeof(struct caer_udp_stream_fec));
+
 	// 64K data buffer should be enough for the UDP packets.
 	size_t dataBufferLength = 1024 * 64;
 	uint8_t *dataBuffer = malloc(dataBufferLength);
@@ -103,6 +137,57 @@ int main(int argc, char *argv[]) {
 		// Decode successfully received data.
 		caerEventPacketHeader header = (caerEventPacketHeader) dataBuffer;
 
+		caerUDPStreamHeader streamHeader = (caerUDPStreamHeader) dataBuffer;
+
+		if (caerUDPStreamHeaderParse(streamHeader, (size_t) result)) {
+			uint8_t *payload = dataBuffer + CAER_UDP_STREAM_HEADER_SIZE;
+			size_t payloadLength = (size_t) result - CAER_UDP_STREAM_HEADER_SIZE;
+
+			if (time(NULL) != lastReport) {
+				lastReport = time(NULL);
+				printLossReport(&streamStats, invalidDatagrams);
+			}
+
+			if (streamHeader->flags & CAER_UDP_STREAM_FLAG_PARITY) {
+				streamStats.parityReceived++;
+
+				uint16_t recoveredLength = 0;
+				uint32_t recoveredSequenceNumber = 0;
+
+				if (streamFEC != NULL
+					&& caerUDPStreamFECRecover(streamFEC, streamHeader, payload, payloadLength, &recoveredLength,
+						&recoveredSequenceNumber) != NULL) {
+					caerUDPStreamStatsRecovered(&streamStats, recoveredSequenceNumber);
+
+					printf("Recovered datagram %" PRIu32 " (%" PRIu16 " bytes) from parity.\n\n",
+						recoveredSequenceNumber, recoveredLength);
+				}
+
+				continue;
+			}
+
+			struct timespec currentTime;
+			clock_gettime(CLOCK_REALTIME, &currentTime);
+
+			caerUDPStreamStatsUpdate(&streamStats, streamHeader->sequenceNumber);
+			caerUDPStreamStatsLatency(&streamStats, streamHeader->sourceTimestamp,
+				(uint64_t) currentTime.tv_sec * 1000000 + (uint64_t) currentTime.tv_nsec / 1000);
+
+			if (streamFEC != NULL) {
+				caerUDPStreamFECAddData(streamFEC, streamHeader, payload);
+			}
+
+			printf("Sequence number: %" PRIu32 ", source timestamp: %" PRIu64 ".\n", streamHeader->sequenceNumber,
+				streamHeader->sourceTimestamp);
+
+			header = (caerEventPacketHeader) payload;
+
+			if (payloadLength < CAER_EVENT_PACKET_HEADER_SIZE) {
+				invalidDatagrams++;
+				continue;
+			}
+		}
+
 		int16_t eventType = caerEventPacketHeaderGetEventType(header);
 		int16_t eventSource = caerEventPacketHeaderGetEventSource(header);
 		int32_t eventSize = caerEventPacketHeaderGetEventSize(header);
@@ -131,10 +216,26 @@ int main(int argc, char *argv[]) {
 		printf("\n\n");
 	}
 
+	if (streamStats.received > 0) {
+		printLossReport(&streamStats, invalidDatagrams);
+	}
+
 	// Close connection.
 	close(listenUDPSocket);
 
 	free(dataBuffer);
+	free(streamFEC);
 
 	return (EXIT_SUCCESS);
 }
+
+static void printLossReport(struct caer_udp_stream_stats *stats, uint64_t invalid) {
+	uint64_t expected = stats->received + stats->lost;
+
+	printf("Loss report: received = %" PRIu64 ", lost = %" PRIu64 " (%.3f%%), reordered = %" PRIu64
+		", recovered (FEC) = %" PRIu64 ", parity = %" PRIu64 ", invalid = %" PRIu64 ", average latency = %" PRIu64
+		" us.\n\n", stats->received, stats->lost,
+		(expected == 0) ? (0) : (100 * (double) stats->lost / (double) expected), stats->reordered,
+		stats->recovered, stats->parityReceived, invalid,
+		(stats->latencyCount == 0) ? (0) : (stats->latencySum / stats->latencyCount));
+}
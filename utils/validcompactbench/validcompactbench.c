@@ -0,0 +1,186 @@
+/*
+ * validcompactbench.c
+ *
+ *  Benchmark for the valid event compaction in ext/validcompact: compares
+ *  caerValidCompactEvents() against a plain per-event copy loop, over a
+ *  range of valid event ratios, and checks that both produce identical
+ *  output for all common event sizes.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include "ext/validcompact/validcompact.h"
+
+#include <libcaer/events/common.h>
+
+#define DEFAULT_EVENT_NUMBER 100000
+#define DEFAULT_REPETITIONS 100
+
+// Polarity/special (8), point 1D/2D (16, 20), IMU6 (28), IMU9 (40), and a
+// large event that goes through the run-based copy.
+static const size_t eventSizes[] = { 8, 16, 20, 28, 40, 256 };
+
+static uint32_t randomState = 0x12345678;
+
+static uint32_t randomNext(void);
+static void fillEvents(uint8_t *events, size_t eventSize, size_t eventNumber, uint32_t validPercent);
+static size_t compactReference(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber);
+static uint64_t timeNow(void);
+
+int main(int argc, char *argv[]) {
+	// Optionally pass the number of events per packet and the repetitions.
+	size_t eventNumber = DEFAULT_EVENT_NUMBER;
+	size_t repetitions = DEFAULT_REPETITIONS;
+
+	if (argc != 1 && argc != 3) {
+		fprintf(stderr, "Incorrect argument number. Either pass none for the default of %d events "
+			"and %d repetitions, or pass the number of events followed by the repetitions.\n",
+		DEFAULT_EVENT_NUMBER, DEFAULT_REPETITIONS);
+		return (EXIT_FAILURE);
+	}
+
+	if (argc == 3) {
+		sscanf(argv[1], "%zu", &eventNumber);
+		sscanf(argv[2], "%zu", &repetitions);
+
+		if (eventNumber == 0 || repetitions == 0) {
+			fprintf(stderr, "Number of events and repetitions must be positive.\n");
+			return (EXIT_FAILURE);
+		}
+	}
+
+	size_t maxEventSize = eventSizes[(sizeof(eventSizes) / sizeof(eventSizes[0])) - 1];
+	size_t maxBytes = (maxEventSize * eventNumber) + CAER_VALID_COMPACT_SLACK;
+
+	uint8_t *events = malloc(maxBytes);
+	uint8_t *outReference = malloc(maxBytes);
+	uint8_t *outCompact = malloc(maxBytes);
+
+	if (events == NULL || outReference == NULL || outCompact == NULL) {
+		fprintf(stderr, "Failed to allocate memory for events.\n");
+		return (EXIT_FAILURE);
+	}
+
+	bool identical = true;
+
+	// First check that the output is the same as the per-event copy, for
+	// every event size and valid ratio.
+	for (size_t s = 0; s < (sizeof(eventSizes) / sizeof(eventSizes[0])); s++) {
+		for (uint32_t validPercent = 0; validPercent <= 100; validPercent += 10) {
+			fillEvents(events, eventSizes[s], eventNumber, validPercent);
+
+			size_t referenceEvents = compactReference(outReference, events, eventSizes[s], eventNumber);
+			size_t compactEvents = caerValidCompactEvents(outCompact, events, eventSizes[s], eventNumber);
+
+			if (referenceEvents != compactEvents
+				|| memcmp(outReference, outCompact, referenceEvents * eventSizes[s]) != 0) {
+				printf("Output differs: event size %zu, %" PRIu32 "%% valid (%zu vs %zu events).\n", eventSizes[s],
+					validPercent, referenceEvents, compactEvents);
+				identical = false;
+			}
+		}
+	}
+
+	printf("Output identical to per-event copy for all event sizes: %s.\n\n", (identical) ? ("yes") : ("no"));
+
+	// Then time the 8 byte (polarity) case, the one outputs see the most.
+	// The best of all repetitions is reported, to filter out noise.
+	printf("%zu events of 8 bytes, best of %zu repetitions:\n", eventNumber, repetitions);
+	printf("%8s %14s %14s %9s\n", "valid", "per-event [µs]", "compact [µs]", "speedup");
+
+	for (uint32_t validPercent = 0; validPercent <= 100; validPercent += 10) {
+		fillEvents(events, 8, eventNumber, validPercent);
+
+		uint64_t bestReference = UINT64_MAX;
+		uint64_t bestCompact = UINT64_MAX;
+		size_t checksum = 0;
+
+		for (size_t r = 0; r < repetitions; r++) {
+			uint64_t start = timeNow();
+			checksum += compactReference(outReference, events, 8, eventNumber);
+			uint64_t middle = timeNow();
+			checksum += caerValidCompactEvents(outCompact, events, 8, eventNumber);
+			uint64_t end = timeNow();
+
+			if ((middle - start) < bestReference) {
+				bestReference = middle - start;
+			}
+			if ((end - middle) < bestCompact) {
+				bestCompact = end - middle;
+			}
+		}
+
+		// Use the results, so the copies can't be optimized away.
+		if (checksum != (2 * repetitions * compactReference(outReference, events, 8, eventNumber))) {
+			identical = false;
+		}
+
+		printf("%7" PRIu32 "%% %14.1f %14.1f %8.1fx\n", validPercent, (double) bestReference / 1000,
+			(double) bestCompact / 1000,
+			(bestCompact > 0) ? ((double) bestReference / (double) bestCompact) : (0));
+	}
+
+	free(events);
+	free(outReference);
+	free(outCompact);
+
+	return ((identical) ? (EXIT_SUCCESS) : (EXIT_FAILURE));
+}
+
+// Fixed seed xorshift, so that runs are comparable.
+static uint32_t randomNext(void) {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+
+	return (randomState);
+}
+
+// Random event contents, with the valid mark (bit 0 of the first 32 bits)
+// set for validPercent percent of the events, in random order, so that
+// valid and invalid events are finely interleaved like after a filter.
+static void fillEvents(uint8_t *events, size_t eventSize, size_t eventNumber, uint32_t validPercent) {
+	for (size_t i = 0; i < (eventSize * eventNumber); i += sizeof(uint32_t)) {
+		uint32_t value = randomNext();
+		memcpy(events + i, &value, sizeof(uint32_t));
+	}
+
+	for (size_t i = 0; i < eventNumber; i++) {
+		uint8_t *event = events + (i * eventSize);
+
+		if ((randomNext() % 100) < validPercent) {
+			event[0] |= 0x01;
+		}
+		else {
+			event[0] &= 0xFE;
+		}
+	}
+}
+
+// What the outputs did before: check each event and copy it if valid.
+static size_t compactReference(uint8_t *out, const uint8_t *events, size_t eventSize, size_t eventNumber) {
+	size_t outEvents = 0;
+
+	for (size_t i = 0; i < eventNumber; i++) {
+		const uint8_t *event = events + (i * eventSize);
+
+		if (caerGenericEventIsValid(event)) {
+			memcpy(out + (outEvents * eventSize), event, eventSize);
+			outEvents++;
+		}
+	}
+
+	return (outEvents);
+}
+
+static uint64_t timeNow(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec);
+}